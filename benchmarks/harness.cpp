@@ -0,0 +1,90 @@
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace benchmarks {
+
+Harness::Harness(std::string filter, std::chrono::duration<double> min_time, uint32_t repetitions)
+    : filter(std::move(filter)), min_time(min_time), repetitions(std::max(repetitions, 1u)) {}
+
+void Harness::run(const std::string& name, uint64_t size, uint64_t bytes, uint64_t items, const std::function<void()>& iteration) {
+    if (name.find(filter) == std::string::npos) {
+        return;
+    }
+
+    // grow the iteration count until one repetition takes long enough to time reliably
+    uint64_t count = 1;
+    double seconds = timeIterations(iteration, count);
+    while (seconds < min_time.count()) {
+        double growth = seconds > 0.0 ? 1.2 * min_time.count() / seconds : max_growth;
+        count = static_cast<uint64_t>(std::ceil(count * std::clamp(growth, 2.0, max_growth)));
+        seconds = timeIterations(iteration, count);
+    }
+
+    std::vector<double> samples = {seconds};
+    for (uint32_t i = 1; i < repetitions; i++) {
+        samples.push_back(timeIterations(iteration, count));
+    }
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2] / count;
+
+    Result result;
+    result.name = name;
+    result.size = size;
+    result.iterations = count;
+    result.ns_per_iteration = median * 1e9;
+    if (bytes > 0) {
+        result.bytes_per_second = bytes / median;
+    }
+    if (items > 0) {
+        result.items_per_second = items / median;
+    }
+
+    std::cerr << name << " [" << size << "]: " << result.ns_per_iteration << " ns" << std::endl;
+    completed.push_back(result);
+}
+
+const std::vector<Result>& Harness::results() const {
+    return completed;
+}
+
+void Harness::writeJson(std::ostream& out) const {
+    auto optional = [&out](const std::optional<double>& value) {
+        if (value.has_value()) {
+            out << *value;
+        } else {
+            out << "null";
+        }
+    };
+
+    out << std::fixed << std::setprecision(3);
+    out << "[\n";
+    for (size_t i = 0; i < completed.size(); i++) {
+        const auto& result = completed[i];
+        out << "  {\"name\": \"" << result.name << "\", "
+            << "\"size\": " << result.size << ", "
+            << "\"iterations\": " << result.iterations << ", "
+            << "\"ns_per_iteration\": " << result.ns_per_iteration << ", "
+            << "\"bytes_per_second\": ";
+        optional(result.bytes_per_second);
+        out << ", \"items_per_second\": ";
+        optional(result.items_per_second);
+        out << "}" << (i + 1 < completed.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+double Harness::timeIterations(const std::function<void()>& iteration, uint64_t count) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < count; i++) {
+        iteration();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,66 @@
+#ifndef BB8_BENCHMARKS_HARNESS_HPP
+#define BB8_BENCHMARKS_HARNESS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+class Result {
+public:
+    std::string name;
+    // scale of the synthetic input, e.g. element count or image side length
+    uint64_t size;
+    uint64_t iterations;
+
+    // median over repetitions
+    double ns_per_iteration;
+    std::optional<double> bytes_per_second;
+    std::optional<double> items_per_second;
+};
+
+// Minimal microbenchmark runner. Each benchmark is calibrated to run for at least
+// `min_time`, then timed `repetitions` times, reporting the median so that one-off
+// interruptions don't skew results.
+class Harness {
+public:
+    // only benchmarks whose name contains `filter` run
+    Harness(std::string filter = "",
+            std::chrono::duration<double> min_time = std::chrono::milliseconds(250),
+            uint32_t repetitions = 5);
+
+    // times `iteration`, which processes `bytes` bytes and `items` items (zero if not meaningful) per call
+    void run(const std::string& name, uint64_t size, uint64_t bytes, uint64_t items, const std::function<void()>& iteration);
+
+    const std::vector<Result>& results() const;
+
+    // results as a JSON array, one object per benchmark and size
+    void writeJson(std::ostream& out) const;
+
+private:
+    static double timeIterations(const std::function<void()>& iteration, uint64_t count);
+
+    // upper bound on how much calibration grows the iteration count in one step
+    static constexpr double max_growth = 10.0;
+
+    std::string filter;
+    std::chrono::duration<double> min_time;
+    uint32_t repetitions;
+
+    std::vector<Result> completed;
+};
+
+// keeps the compiler from discarding a computed value, or the work producing it
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace benchmarks
+
+#endif  // !BB8_BENCHMARKS_HARNESS_HPP
@@ -0,0 +1,424 @@
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "harness.hpp"
+#include "synthetic.hpp"
+#include "visualization/geometry/bvh.hpp"
+#include "visualization/geometry/heightfield.hpp"
+#include "visualization/physics/contact_generator.hpp"
+#include "visualization/resources/image.hpp"
+#include "visualization/resources/mesh.hpp"
+#include "visualization/sensors/lidar.hpp"
+#include "visualization/sensors/range_scanner.hpp"
+#include "visualization/vulkan/buffer.hpp"
+#include "visualization/vulkan/device.hpp"
+#include "visualization/vulkan/memory.hpp"
+#include "visualization/vulkan/shaders/vertex.hpp"
+
+namespace {
+
+using visualization::geometry::Bvh;
+using visualization::geometry::Ray;
+using visualization::geometry::Triangle;
+using visualization::vulkan::shaders::Vertex;
+
+// Vulkan objects for the benchmarks that need a device. No surface is created,
+// so they also run on headless machines, e.g. with lavapipe
+class Gpu {
+public:
+    Gpu()
+        : instance(buildInstance(context)),
+          device(instance, vk::SurfaceKHR(), {}, {}) {}
+
+    vk::raii::Context context;
+    vk::raii::Instance instance;
+    visualization::vulkan::Device device;
+
+private:
+    static vk::raii::Instance buildInstance(const vk::raii::Context& context) {
+        auto app_info = vk::ApplicationInfo("bb8_microbenchmarks", VK_MAKE_VERSION(0, 0, 1), nullptr, 0, VK_API_VERSION_1_1);
+        auto create_info = vk::InstanceCreateInfo({}, &app_info, {}, {});
+        return vk::raii::Instance(context, create_info);
+    }
+};
+
+void benchmarkMeshLoad(benchmarks::Harness& harness, const benchmarks::Synthetic& synthetic) {
+    for (uint32_t side : {64u, 256u, 512u}) {
+        auto obj = synthetic.gridObj(side);
+        auto bytes = std::filesystem::file_size(obj);
+        uint64_t triangles = 2ull * side * side;
+
+        harness.run("mesh_load/grid", side, bytes, triangles, [&obj]() {
+            auto mesh = visualization::resources::Mesh::load(obj);
+            benchmarks::doNotOptimize(mesh.getIndices().data());
+        });
+    }
+
+    std::filesystem::path viking_room = "resources/models/viking_room.obj";
+    if (std::filesystem::exists(viking_room)) {
+        auto bytes = std::filesystem::file_size(viking_room);
+        harness.run("mesh_load/viking_room", 1, bytes, 0, [&viking_room]() {
+            auto mesh = visualization::resources::Mesh::load(viking_room);
+            benchmarks::doNotOptimize(mesh.getIndices().data());
+        });
+    }
+}
+
+void benchmarkVertexHash(benchmarks::Harness& harness) {
+    for (uint32_t side : {16u, 128u, 512u}) {
+        auto vertices = benchmarks::Synthetic::gridVertices(side);
+
+        harness.run("vertex_hash", vertices.size(), vertices.size() * sizeof(Vertex), vertices.size(), [&vertices]() {
+            size_t combined = 0;
+            for (const auto& vertex : vertices) {
+                combined ^= std::hash<Vertex>()(vertex);
+            }
+            benchmarks::doNotOptimize(combined);
+        });
+
+        // deduplication as Mesh::load does it, which is where the hash is used
+        harness.run("vertex_dedup", vertices.size(), vertices.size() * sizeof(Vertex), vertices.size(), [&vertices]() {
+            std::unordered_map<Vertex, uint32_t> vertex_indices;
+            std::vector<uint32_t> indices;
+            indices.reserve(vertices.size());
+            for (const auto& vertex : vertices) {
+                auto entry = vertex_indices.try_emplace(vertex, static_cast<uint32_t>(vertex_indices.size()));
+                indices.push_back(entry.first->second);
+            }
+            benchmarks::doNotOptimize(indices.data());
+        });
+    }
+}
+
+void benchmarkImageLoad(benchmarks::Harness& harness, const benchmarks::Synthetic& synthetic) {
+    for (uint32_t side : {256u, 1024u, 4096u}) {
+        auto ppm = synthetic.gradientPpm(side);
+        uint64_t pixels = static_cast<uint64_t>(side) * side;
+
+        harness.run("image_load/ppm", side, std::filesystem::file_size(ppm), pixels, [&ppm]() {
+            auto image = visualization::resources::Image::load(ppm);
+            benchmarks::doNotOptimize(image.data());
+        });
+    }
+
+    std::filesystem::path viking_room = "resources/textures/viking_room.png";
+    if (std::filesystem::exists(viking_room)) {
+        harness.run("image_load/viking_room_png", 1, std::filesystem::file_size(viking_room), 0, [&viking_room]() {
+            auto image = visualization::resources::Image::load(viking_room);
+            benchmarks::doNotOptimize(image.data());
+        });
+    }
+}
+
+// queries are batched, so items per second are queries per second on one core
+void benchmarkBvhQueries(benchmarks::Harness& harness, const std::string& name, uint64_t size, const std::vector<Triangle>& triangles) {
+    constexpr size_t query_count = 4096;
+
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    for (const auto& triangle : triangles) {
+        for (int corner = 0; corner < 3; corner++) {
+            min = glm::min(min, triangle.corner(corner));
+            max = glm::max(max, triangle.corner(corner));
+        }
+    }
+    glm::vec3 center = 0.5f * (min + max);
+    float radius = 0.5f * glm::length(max - min);
+
+    harness.run("bvh_build/" + name, size, triangles.size() * sizeof(Triangle), triangles.size(), [&triangles]() {
+        auto bvh = Bvh::build(triangles);
+        benchmarks::doNotOptimize(bvh.nodeCount());
+    });
+
+    auto bvh = Bvh::build(triangles);
+
+    // rays from a sphere around the bounds towards points inside them, and points scattered within the bounds
+    std::mt19937 random(0x5eed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto inside = [&]() {
+        return glm::vec3(unit(random), unit(random), unit(random));
+    };
+
+    std::vector<Ray> rays;
+    std::vector<glm::vec3> points;
+    rays.reserve(query_count);
+    points.reserve(query_count);
+    for (size_t i = 0; i < query_count; i++) {
+        glm::vec3 origin = center + 2.0f * radius * glm::normalize(inside() + glm::vec3(0.0f, 0.0f, 1e-3f));
+        glm::vec3 target = center + 0.5f * (max - min) * inside();
+        rays.push_back(Ray{origin, target - origin});
+        points.push_back(center + 0.5f * (max - min) * inside());
+    }
+
+    harness.run("bvh_ray/" + name, size, 0, query_count, [&bvh, &rays]() {
+        uint32_t hits = 0;
+        for (const auto& ray : rays) {
+            hits += bvh.intersect(ray, std::numeric_limits<float>::infinity()).has_value() ? 1 : 0;
+        }
+        benchmarks::doNotOptimize(hits);
+    });
+
+    harness.run("bvh_occluded/" + name, size, 0, query_count, [&bvh, &rays]() {
+        uint32_t hits = 0;
+        for (const auto& ray : rays) {
+            hits += bvh.occluded(ray, std::numeric_limits<float>::infinity()) ? 1 : 0;
+        }
+        benchmarks::doNotOptimize(hits);
+    });
+
+    float sphere_radius = 0.02f * radius;
+    harness.run("bvh_sphere/" + name, size, 0, query_count, [&bvh, &points, sphere_radius]() {
+        std::array<uint32_t, 64> found;
+        size_t total = 0;
+        for (const auto& point : points) {
+            total += bvh.overlapSphere(point, sphere_radius, found.data(), found.size());
+        }
+        benchmarks::doNotOptimize(total);
+    });
+
+    harness.run("bvh_closest/" + name, size, 0, query_count, [&bvh, &points]() {
+        float total = 0.0f;
+        for (const auto& point : points) {
+            auto closest = bvh.closestPoint(point, std::numeric_limits<float>::infinity());
+            total += closest.has_value() ? closest->distance : 0.0f;
+        }
+        benchmarks::doNotOptimize(total);
+    });
+}
+
+void benchmarkBvh(benchmarks::Harness& harness) {
+    for (uint32_t side : {64u, 256u, 1024u}) {
+        benchmarkBvhQueries(harness, "grid", side, benchmarks::Synthetic::gridTriangles(side));
+    }
+
+    std::filesystem::path viking_room = "resources/models/viking_room.obj";
+    if (std::filesystem::exists(viking_room)) {
+        auto mesh = visualization::resources::Mesh::load(viking_room);
+        benchmarkBvhQueries(harness, "viking_room", 1, benchmarks::Synthetic::meshTriangles(mesh));
+    }
+}
+
+// one sensor per robot, scanning the same scene from slightly different positions
+void benchmarkLidarScans(benchmarks::Harness& harness, const std::string& name, uint64_t size, const Bvh& scene, glm::vec3 position) {
+    using visualization::sensors::Lidar;
+    using visualization::sensors::RangeScanner;
+
+    constexpr size_t robot_count = 16;
+
+    auto lidar = Lidar(Lidar::Settings());
+    std::vector<float> ranges(robot_count * lidar.rayCount());
+
+    std::vector<RangeScanner::Scan> scans;
+    for (size_t robot = 0; robot < robot_count; robot++) {
+        glm::mat4 pose(1.0f);
+        pose[3] = glm::vec4(position + glm::vec3(0.01f * static_cast<float>(robot), 0.0f, 0.0f), 1.0f);
+        scans.push_back(RangeScanner::Scan{&lidar, pose, ranges.data() + robot * lidar.rayCount()});
+    }
+
+    // the same beams cast one ray at a time, for comparison with packets
+    harness.run("lidar_single_rays/" + name, size, 0, lidar.rayCount(), [&]() {
+        lidar.scanSingle(scene, scans[0].pose, ranges.data());
+        benchmarks::doNotOptimize(ranges.data());
+    });
+
+    harness.run("lidar_scan/" + name, size, 0, lidar.rayCount(), [&]() {
+        lidar.scan(scene, scans[0].pose, ranges.data());
+        benchmarks::doNotOptimize(ranges.data());
+    });
+
+    // items are divided by the thread count, so items per second are rays per second per core
+    RangeScanner scanner;
+    harness.run("lidar_batch/" + name, size, 0, robot_count * lidar.rayCount() / scanner.threadCount(), [&]() {
+        scanner.run(scene, scans.data(), scans.size());
+        benchmarks::doNotOptimize(ranges.data());
+    });
+}
+
+void benchmarkLidar(benchmarks::Harness& harness) {
+    for (uint32_t side : {64u, 1024u}) {
+        // just above the middle of the unit grid, so the lower channels hit it
+        benchmarkLidarScans(harness, "grid", side, Bvh::build(benchmarks::Synthetic::gridTriangles(side)), glm::vec3(0.5f, 0.5f, 0.1f));
+    }
+
+    std::filesystem::path viking_room = "resources/models/viking_room.obj";
+    if (std::filesystem::exists(viking_room)) {
+        auto mesh = visualization::resources::Mesh::load(viking_room);
+
+        // inside the room, where every beam hits a wall
+        benchmarkLidarScans(harness, "viking_room", 1, Bvh::build(benchmarks::Synthetic::meshTriangles(mesh)), mesh.boundsCenter());
+    }
+}
+
+// one rolling body per robot, resting a couple of millimeters deep in the ground, so
+// items per second are contact queries per second on one core
+void benchmarkContacts(benchmarks::Harness& harness) {
+    using visualization::geometry::Heightfield;
+    using visualization::physics::ContactGenerator;
+
+    constexpr size_t robot_count = 4096;
+    constexpr float radius = 0.5f;
+    constexpr float depth = 0.002f;
+
+    std::mt19937 random(0x5eed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::array<ContactGenerator::Contact, 8> contacts;
+
+    for (uint32_t side : {256u, 2048u}) {
+        // rolling hills of 10 cm cells
+        constexpr float spacing = 0.1f;
+        std::vector<float> heights(static_cast<size_t>(side) * side);
+        for (uint32_t row = 0; row < side; row++) {
+            for (uint32_t column = 0; column < side; column++) {
+                heights[row * side + column] = 0.5f * std::sin(0.02f * static_cast<float>(column)) * std::cos(0.03f * static_cast<float>(row));
+            }
+        }
+        auto heightfield = Heightfield(side, side, spacing, glm::vec2(0.0f), std::move(heights));
+        auto generator = ContactGenerator(&heightfield, {}, ContactGenerator::Settings());
+
+        float extent = spacing * static_cast<float>(side - 1);
+        std::vector<glm::vec3> centers;
+        centers.reserve(robot_count);
+        for (size_t robot = 0; robot < robot_count; robot++) {
+            auto position = extent * glm::vec2(unit(random), unit(random));
+            centers.emplace_back(position, heightfield.height(position) + radius - depth);
+        }
+
+        harness.run("contacts_heightfield", side, 0, robot_count, [&]() {
+            size_t total = 0;
+            for (const auto& center : centers) {
+                total += generator.collide(center, radius, contacts.data(), contacts.size());
+            }
+            benchmarks::doNotOptimize(total);
+        });
+    }
+
+    // 4 m tiles of a gently curved grid mesh, as placed models would be, with spheres resting on them
+    for (uint32_t side : {16u, 64u}) {
+        auto tile = Bvh::build(benchmarks::Synthetic::gridTriangles(side));
+
+        constexpr uint32_t tiles_across = 16;
+        constexpr float tile_size = 4.0f;
+        std::vector<ContactGenerator::Mesh> meshes;
+        for (uint32_t y = 0; y < tiles_across; y++) {
+            for (uint32_t x = 0; x < tiles_across; x++) {
+                glm::mat4 pose = glm::scale(glm::translate(glm::mat4(1.0f), tile_size * glm::vec3(x, y, 0.0f)), glm::vec3(tile_size));
+                meshes.push_back(ContactGenerator::Mesh{&tile, pose});
+            }
+        }
+        auto generator = ContactGenerator(nullptr, std::move(meshes), ContactGenerator::Settings());
+
+        std::vector<glm::vec3> centers;
+        centers.reserve(robot_count);
+        for (size_t robot = 0; robot < robot_count; robot++) {
+            // within a tile, where the grid's height is 0.1 u v in tile units
+            glm::vec2 tile_position(unit(random), unit(random));
+            glm::vec2 corner = tile_size * glm::floor(static_cast<float>(tiles_across) * glm::vec2(unit(random), unit(random)));
+            float height = tile_size * 0.1f * tile_position.x * tile_position.y;
+            centers.emplace_back(corner + tile_size * tile_position, height + radius - depth);
+        }
+
+        harness.run("contacts_mesh", side, 0, robot_count, [&]() {
+            size_t total = 0;
+            for (const auto& center : centers) {
+                total += generator.collide(center, radius, contacts.data(), contacts.size());
+            }
+            benchmarks::doNotOptimize(total);
+        });
+    }
+}
+
+void benchmarkMemory(benchmarks::Harness& harness, const visualization::vulkan::Device& device) {
+    using flags = vk::MemoryPropertyFlagBits;
+    auto host_visible = vk::MemoryPropertyFlags(flags::eHostVisible | flags::eHostCoherent);
+    auto device_local = vk::MemoryPropertyFlags(flags::eDeviceLocal);
+
+    harness.run("memory_find_type/host_visible", 1, 0, 1, [&device, host_visible]() {
+        benchmarks::doNotOptimize(visualization::vulkan::Memory::findType(device, ~0u, host_visible));
+    });
+    harness.run("memory_find_type/device_local", 1, 0, 1, [&device, device_local]() {
+        benchmarks::doNotOptimize(visualization::vulkan::Memory::findType(device, ~0u, device_local));
+    });
+}
+
+void benchmarkBufferFill(benchmarks::Harness& harness, const visualization::vulkan::Device& device) {
+    for (size_t size : {size_t(64) << 10, size_t(1) << 20, size_t(16) << 20, size_t(64) << 20}) {
+        auto source = std::vector<uint8_t>(size, 0x5a);
+        auto buffer = visualization::vulkan::Buffer(device, visualization::vulkan::Buffer::Requirements::staging(size));
+
+        harness.run("buffer_fill", size, size, 0, [&source, &buffer]() {
+            buffer.fill(source.data(), source.size());
+        });
+    }
+}
+
+void printUsage() {
+    std::cerr << "usage: bb8_microbenchmarks [--filter NAME] [--output FILE]\n"
+              << "  --filter NAME  only run benchmarks whose name contains NAME\n"
+              << "  --output FILE  write JSON results to FILE instead of stdout\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::optional<std::string> output_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    auto harness = benchmarks::Harness(filter);
+    auto synthetic = benchmarks::Synthetic(std::filesystem::temp_directory_path() / "bb8_benchmarks");
+
+    try {
+        benchmarkMeshLoad(harness, synthetic);
+        benchmarkVertexHash(harness);
+        benchmarkImageLoad(harness, synthetic);
+        benchmarkBvh(harness);
+        benchmarkLidar(harness);
+        benchmarkContacts(harness);
+
+        std::unique_ptr<Gpu> gpu;
+        try {
+            gpu = std::make_unique<Gpu>();
+        } catch (std::exception& e) {
+            std::cerr << "skipping device benchmarks: " << e.what() << std::endl;
+        }
+
+        if (gpu) {
+            benchmarkMemory(harness, gpu->device);
+            benchmarkBufferFill(harness, gpu->device);
+        }
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (output_path.has_value()) {
+        std::ofstream output(*output_path);
+        harness.writeJson(output);
+    } else {
+        harness.writeJson(std::cout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "synthetic.hpp"
+
+#include <array>
+#include <fstream>
+#include <string>
+
+namespace benchmarks {
+
+Synthetic::Synthetic(std::filesystem::path directory) : directory(std::move(directory)) {
+    std::filesystem::create_directories(this->directory);
+}
+
+std::filesystem::path Synthetic::gridObj(uint32_t side) const {
+    auto path = directory / ("grid_" + std::to_string(side) + ".obj");
+    if (std::filesystem::exists(path)) {
+        return path;
+    }
+
+    std::ofstream obj(path);
+    for (uint32_t y = 0; y <= side; y++) {
+        for (uint32_t x = 0; x <= side; x++) {
+            float u = static_cast<float>(x) / side;
+            float v = static_cast<float>(y) / side;
+            obj << "v " << u << " " << v << " " << 0.1f * u * v << "\n";
+            obj << "vt " << u << " " << v << "\n";
+        }
+    }
+
+    // OBJ indices are 1-based
+    auto corner = [side](uint32_t x, uint32_t y) {
+        auto index = std::to_string(y * (side + 1) + x + 1);
+        return index + "/" + index;
+    };
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            obj << "f " << corner(x, y) << " " << corner(x + 1, y) << " " << corner(x + 1, y + 1) << "\n";
+            obj << "f " << corner(x, y) << " " << corner(x + 1, y + 1) << " " << corner(x, y + 1) << "\n";
+        }
+    }
+
+    return path;
+}
+
+std::filesystem::path Synthetic::gradientPpm(uint32_t side) const {
+    auto path = directory / ("gradient_" + std::to_string(side) + ".ppm");
+    if (std::filesystem::exists(path)) {
+        return path;
+    }
+
+    std::ofstream ppm(path, std::ios::binary);
+    ppm << "P6\n"
+        << side << " " << side << "\n255\n";
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            auto pixel = std::array<char, 3>{static_cast<char>(x * 255 / side), static_cast<char>(y * 255 / side), static_cast<char>((x ^ y) & 0xff)};
+            ppm.write(pixel.data(), pixel.size());
+        }
+    }
+
+    return path;
+}
+
+std::vector<visualization::vulkan::shaders::Vertex> Synthetic::gridVertices(uint32_t side) {
+    std::vector<visualization::vulkan::shaders::Vertex> vertices;
+    vertices.reserve(6 * side * side);
+
+    auto corner = [side](uint32_t x, uint32_t y) {
+        float u = static_cast<float>(x) / side;
+        float v = static_cast<float>(y) / side;
+        return visualization::vulkan::shaders::Vertex(glm::vec3(u, v, 0.1f * u * v), glm::vec3(1.0f), glm::vec2(u, 1.0f - v));
+    };
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            vertices.push_back(corner(x, y));
+            vertices.push_back(corner(x + 1, y));
+            vertices.push_back(corner(x + 1, y + 1));
+            vertices.push_back(corner(x, y));
+            vertices.push_back(corner(x + 1, y + 1));
+            vertices.push_back(corner(x, y + 1));
+        }
+    }
+
+    return vertices;
+}
+
+std::vector<visualization::geometry::Triangle> Synthetic::gridTriangles(uint32_t side) {
+    using visualization::geometry::Triangle;
+
+    auto vertices = gridVertices(side);
+    std::vector<Triangle> triangles;
+    triangles.reserve(vertices.size() / 3);
+    for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        triangles.push_back(Triangle::fromCorners(vertices[i].position, vertices[i + 1].position, vertices[i + 2].position));
+    }
+
+    return triangles;
+}
+
+std::vector<visualization::geometry::Triangle> Synthetic::meshTriangles(const visualization::resources::Mesh& mesh) {
+    using visualization::geometry::Triangle;
+
+    const auto& vertices = mesh.getVertices();
+    const auto& indices = mesh.getIndices();
+    const auto& full_detail = mesh.getLods().front();
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(full_detail.index_count / 3);
+    for (uint32_t i = full_detail.first_index; i + 2 < full_detail.first_index + full_detail.index_count; i += 3) {
+        triangles.push_back(Triangle::fromCorners(vertices[indices[i]].position, vertices[indices[i + 1]].position, vertices[indices[i + 2]].position));
+    }
+
+    return triangles;
+}
+
+}  // namespace benchmarks
@@ -0,0 +1,40 @@
+#ifndef BB8_BENCHMARKS_SYNTHETIC_HPP
+#define BB8_BENCHMARKS_SYNTHETIC_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "visualization/geometry/triangle.hpp"
+#include "visualization/resources/mesh.hpp"
+#include "visualization/vulkan/shaders/vertex.hpp"
+
+namespace benchmarks {
+
+// Generated inputs whose size scales with a single parameter, written to a
+// scratch directory so loaders can be benchmarked on files of any size.
+class Synthetic {
+public:
+    explicit Synthetic(std::filesystem::path directory);
+
+    // OBJ of a `side` x `side` quad grid, with positions and texture coordinates
+    // shared between neighbouring faces as exported models do
+    std::filesystem::path gridObj(uint32_t side) const;
+
+    // binary PPM of a `side` x `side` gradient, decoded by the same stb_image path as PNGs
+    std::filesystem::path gradientPpm(uint32_t side) const;
+
+    // vertices of a grid as Mesh::load sees them, each shared vertex repeated once per triangle using it
+    static std::vector<visualization::vulkan::shaders::Vertex> gridVertices(uint32_t side);
+    // triangles of gridVertices(side), for building BVHs over the grid
+    static std::vector<visualization::geometry::Triangle> gridTriangles(uint32_t side);
+    // full-detail triangles of a loaded mesh, as Model builds its BVH from
+    static std::vector<visualization::geometry::Triangle> meshTriangles(const visualization::resources::Mesh& mesh);
+
+private:
+    std::filesystem::path directory;
+};
+
+}  // namespace benchmarks
+
+#endif  // !BB8_BENCHMARKS_SYNTHETIC_HPP
@@ -1,14 +1,172 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
 
+#include "visualization/benchmark.hpp"
+#include "visualization/geometry/heightfield.hpp"
+#include "visualization/profiling/allocation_tracker.hpp"
+#include "visualization/profiling/metrics_segment.hpp"
+#include "visualization/utilities.hpp"
+#include "visualization/vulkan/memory_usage.hpp"
 #include "visualization/visualization.hpp"
 
-int main() {
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: bb8_simulation [--on-demand] [--benchmark] [--frames N] [--warmup N] [--output FILE] [--startup-profile FILE]\n"
+              << "                      [--pipeline-statistics] [--zero-allocations] [--memory-log SECONDS] [--memory-report FILE]\n"
+              << "                      [--metrics [SEGMENT]] [--points N] [--terrain FILE] [--terrain-spacing M] [--terrain-height M]\n"
+              << "  --on-demand            only draw when the scene changes, with the demo model still, rather than continuously\n"
+              << "  --benchmark            render a scripted camera path and report frame times as JSON\n"
+              << "  --frames N             frames to record (default 1000)\n"
+              << "  --warmup N             frames drawn before recording (default 100)\n"
+              << "  --output F             write the JSON report to F instead of stdout\n"
+              << "  --pipeline-statistics  also report vertex, primitive and shader invocation counts per pass\n"
+              << "  --points N             stream N point cloud points every benchmark frame\n"
+              << "  --startup-profile F    write startup phase timings and time to first frame to F as JSON\n"
+              << "  --zero-allocations     run the benchmark and fail if recorded frames allocate, printing where they did\n"
+              << "  --memory-log S         log device memory usage by heap and category every S seconds\n"
+              << "  --memory-report F      write device memory usage and heap budgets to F as JSON on exit\n"
+              << "  --metrics [SEGMENT]    publish frame, memory and upload metrics into shared memory (default /bb8_metrics)\n"
+              << "  --terrain F            draw terrain from the 8 or 16-bit grayscale heightmap F\n"
+              << "  --terrain-spacing M    meters between heightmap pixels (default 0.1)\n"
+              << "  --terrain-height M     height of white heightmap pixels in meters, black being zero (default 5)\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool on_demand = false;
+    bool benchmark = false;
+    visualization::Benchmark::Settings benchmark_settings;
+    std::optional<std::string> output_path;
+    std::optional<std::string> startup_profile_path;
+    bool zero_allocations = false;
+    visualization::vulkan::MemoryUsage::Settings memory_settings;
+    std::optional<std::string> memory_report_path;
+    std::optional<std::string> metrics_segment;
+    std::optional<std::string> terrain_path;
+    float terrain_spacing = 0.1f;
+    float terrain_height = 5.0f;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        // cleared by options whose value doesn't parse
+        bool valid = true;
+
+        if (arg == "--on-demand") {
+            on_demand = true;
+        } else if (arg == "--benchmark") {
+            benchmark = true;
+        } else if (arg == "--frames" && has_value) {
+            valid = visualization::parseNumber(argv[++i], benchmark_settings.frames);
+        } else if (arg == "--warmup" && has_value) {
+            valid = visualization::parseNumber(argv[++i], benchmark_settings.warmup_frames);
+        } else if (arg == "--output" && has_value) {
+            output_path = argv[++i];
+        } else if (arg == "--pipeline-statistics") {
+            benchmark_settings.pipeline_statistics = true;
+        } else if (arg == "--points" && has_value) {
+            valid = visualization::parseNumber(argv[++i], benchmark_settings.points);
+        } else if (arg == "--startup-profile" && has_value) {
+            startup_profile_path = argv[++i];
+        } else if (arg == "--memory-log" && has_value) {
+            double seconds = 0.0;
+            valid = visualization::parseNumber(argv[++i], seconds) && std::isfinite(seconds) && seconds > 0.0;
+            if (valid) {
+                memory_settings.log_interval = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>(seconds));
+            }
+        } else if (arg == "--memory-report" && has_value) {
+            memory_report_path = argv[++i];
+        } else if (arg == "--metrics") {
+            // the segment name is optional, and POSIX shared memory names start with a slash
+            bool has_segment = has_value && argv[i + 1][0] == '/';
+            metrics_segment = has_segment ? argv[++i] : visualization::profiling::MetricsSegment::default_name;
+        } else if (arg == "--terrain" && has_value) {
+            terrain_path = argv[++i];
+        } else if (arg == "--terrain-spacing" && has_value) {
+            valid = visualization::parseNumber(argv[++i], terrain_spacing);
+        } else if (arg == "--terrain-height" && has_value) {
+            valid = visualization::parseNumber(argv[++i], terrain_height);
+        } else if (arg == "--zero-allocations") {
+            benchmark = true;
+            zero_allocations = true;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            printUsage();
+            return 1;
+        }
+    }
+
+    using visualization::profiling::AllocationTracker;
+    if (zero_allocations) {
+        if (!AllocationTracker::isEnabled()) {
+            std::cerr << "--zero-allocations requires a build with -Dallocation_tracking=true" << std::endl;
+            return 1;
+        }
+        // every allocation in steady state is a violation, so record where each one came from
+        benchmark_settings.allocation_sampling_interval = 1;
+    }
+
     visualization::Visualization visualization("BB-8 Simulation");
 
     try {
-        visualization.run();
+        visualization.application().memoryUsage().setSettings(memory_settings);
+        if (metrics_segment.has_value()) {
+            visualization.application().enableMetrics(*metrics_segment);
+        }
+        if (terrain_path.has_value()) {
+            using visualization::geometry::Heightfield;
+            visualization.application().setTerrain(Heightfield::load(*terrain_path, terrain_spacing, 0.0f, terrain_height));
+        }
+#ifdef BB8_SHADER_HOT_RELOAD
+        // development builds pick up shader edits without restarting
+        visualization.application().enableShaderHotReload(BB8_SHADER_SOURCE_DIR, BB8_SHADER_CACHE_DIR);
+#endif
+        if (benchmark) {
+            auto result = visualization::Benchmark(benchmark_settings).run(visualization);
+            visualization.application().exit();
+
+            if (output_path.has_value()) {
+                std::ofstream output(*output_path);
+                result.writeJson(output);
+            } else {
+                result.writeJson(std::cout);
+            }
+
+            if (zero_allocations && result.allocations.value_or(0) > 0) {
+                std::cerr << *result.allocations << " heap allocations in " << result.frames << " steady-state frames, latest:\n";
+                AllocationTracker::writeSamples(std::cerr);
+                return 1;
+            }
+        } else {
+            if (on_demand) {
+                // a spinning model would change every frame
+                visualization.application().setAnimated(false);
+                visualization.setRenderMode(visualization::Visualization::RenderMode::on_demand);
+            }
+            visualization.run();
+        }
+
+        if (memory_report_path.has_value()) {
+            std::ofstream memory_report(*memory_report_path);
+            visualization.application().memoryUsage().report().writeJson(memory_report);
+        }
+
+        if (startup_profile_path.has_value()) {
+            std::ofstream startup_profile(*startup_profile_path);
+            visualization.application().startupProfile().writeJson(startup_profile);
+        }
     } catch (std::exception& e) {
         std::cerr << e.what() << std::endl;
+        return 1;
     }
 
     return 0;
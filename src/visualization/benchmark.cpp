@@ -0,0 +1,257 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+
+#include "profiling/allocation_tracker.hpp"
+
+namespace visualization {
+
+std::optional<Benchmark::Summary> Benchmark::Summary::of(std::vector<double> samples) {
+    if (samples.empty()) {
+        return std::nullopt;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    Summary summary;
+    summary.min = samples.front();
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    summary.p50 = percentile(samples, 0.50);
+    summary.p95 = percentile(samples, 0.95);
+    summary.p99 = percentile(samples, 0.99);
+    summary.max = samples.back();
+
+    return summary;
+}
+
+void Benchmark::Result::writeJson(std::ostream& out) const {
+    auto write_summary = [&out](const char* name, const std::optional<Summary>& summary) {
+        out << "  \"" << name << "\": ";
+        if (!summary.has_value()) {
+            out << "null";
+            return;
+        }
+
+        out << "{"
+            << "\"min\": " << summary->min << ", "
+            << "\"mean\": " << summary->mean << ", "
+            << "\"p50\": " << summary->p50 << ", "
+            << "\"p95\": " << summary->p95 << ", "
+            << "\"p99\": " << summary->p99 << ", "
+            << "\"max\": " << summary->max << "}";
+    };
+
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"points\": " << points << ",\n";
+    out << "  \"seconds\": " << seconds << ",\n";
+    out << "  \"frames_per_second\": " << frames_per_second << ",\n";
+    write_summary("cpu_frame_ms", cpu_frame_ms);
+    out << ",\n";
+    write_summary("gpu_frame_ms", gpu_frame_ms);
+    out << ",\n";
+    out << "  \"allocations\": ";
+    if (allocations.has_value()) {
+        out << *allocations << ",\n";
+        out << "  \"allocations_per_frame\": " << *allocations_per_frame << ",\n";
+    } else {
+        out << "null,\n";
+        out << "  \"allocations_per_frame\": null,\n";
+    }
+
+    out << "  \"terrain\": ";
+    if (terrain_triangles.has_value()) {
+        out << "{\"triangles\": " << *terrain_triangles << ", \"texels_per_frame\": " << *terrain_texels_per_frame << "},\n";
+    } else {
+        out << "null,\n";
+    }
+
+    out << "  \"pipeline_statistics\": ";
+    if (!pipeline_statistics.has_value()) {
+        out << "null\n";
+    } else {
+        out << "{\n";
+        for (size_t pass = 0; pass < vulkan::PipelineStatistics::pass_count; pass++) {
+            const auto& counters = (*pipeline_statistics)[pass];
+            out << "    \"" << vulkan::PipelineStatistics::passName(static_cast<vulkan::PipelineStatistics::Pass>(pass)) << "\": {"
+                << "\"input_vertices\": " << counters.input_vertices << ", "
+                << "\"input_primitives\": " << counters.input_primitives << ", "
+                << "\"vertex_invocations\": " << counters.vertex_invocations << ", "
+                << "\"clipping_invocations\": " << counters.clipping_invocations << ", "
+                << "\"clipping_primitives\": " << counters.clipping_primitives << ", "
+                << "\"fragment_invocations\": " << counters.fragment_invocations << ", "
+                << "\"compute_invocations\": " << counters.compute_invocations << "}"
+                << (pass + 1 < vulkan::PipelineStatistics::pass_count ? "," : "") << "\n";
+        }
+        out << "  }\n";
+    }
+    out << "}\n";
+}
+
+Benchmark::Benchmark(Settings settings) : settings(settings) {
+    if (settings.frames == 0) {
+        throw std::runtime_error("benchmark must record at least one frame");
+    }
+}
+
+Benchmark::Result Benchmark::run(Visualization& visualization) const {
+    auto& application = visualization.application();
+
+    // measure the renderer rather than the display, at a fixed resolution
+    application.setVsync(false);
+    auto resolution = vulkan::DynamicResolution::Settings();
+    resolution.min_scale = 1.0f;
+    resolution.max_scale = 1.0f;
+    application.setDynamicResolution(resolution);
+    application.setAnimated(true);
+    bool pipeline_statistics = settings.pipeline_statistics && application.enablePipelineStatistics();
+
+    auto cloud = pointCloud(settings.points);
+
+    std::vector<double> cpu_samples;
+    std::vector<double> gpu_samples;
+    cpu_samples.reserve(settings.frames);
+    gpu_samples.reserve(settings.frames);
+
+    using clock = std::chrono::steady_clock;
+    auto recording_start = clock::now();
+    // counts allocations by this thread, which records and submits every frame
+    std::optional<profiling::AllocationScope> allocations;
+    vulkan::PipelineStatistics::Frame statistics_total{};
+    uint32_t statistics_frames = 0;
+    uint64_t terrain_texels = 0;
+
+    for (uint32_t frame = 0; frame < settings.warmup_frames + settings.frames; frame++) {
+        double time = frame * settings.time_step;
+        application.setAnimationTime(time);
+        application.getCamera() = cameraAt(time);
+
+        if (frame == settings.warmup_frames) {
+            recording_start = clock::now();
+            allocations.emplace();
+            profiling::AllocationTracker::clearSamples();
+            profiling::AllocationTracker::setSamplingInterval(settings.allocation_sampling_interval);
+        }
+
+        auto frame_start = clock::now();
+        if (!cloud.empty()) {
+            auto points = application.pointCloud().allocate(cloud.size());
+            std::memcpy(points, cloud.data(), cloud.size() * sizeof(vulkan::shaders::Point));
+        }
+        if (!visualization.step()) {
+            throw std::runtime_error("window closed before benchmark finished");
+        }
+        auto frame_end = clock::now();
+
+        if (frame < settings.warmup_frames) {
+            continue;
+        }
+
+        cpu_samples.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+        // trails by the frames in flight, which doesn't matter for the distribution
+        if (auto gpu_ms = application.lastGpuFrameTime()) {
+            gpu_samples.push_back(*gpu_ms);
+        }
+        if (auto statistics = application.lastPipelineStatistics()) {
+            accumulate(statistics_total, *statistics);
+            statistics_frames++;
+        }
+        if (auto terrain = application.getTerrain()) {
+            terrain_texels += terrain->texelsUploaded();
+        }
+    }
+
+    auto allocated = allocations->counted();
+    profiling::AllocationTracker::setSamplingInterval(0);
+    application.setAnimationTime(std::nullopt);
+
+    Result result;
+    result.frames = settings.frames;
+    result.points = settings.points;
+    result.seconds = std::chrono::duration<double>(clock::now() - recording_start).count();
+    result.frames_per_second = settings.frames / result.seconds;
+    result.cpu_frame_ms = Summary::of(std::move(cpu_samples));
+    result.gpu_frame_ms = Summary::of(std::move(gpu_samples));
+    if (profiling::AllocationTracker::isEnabled()) {
+        result.allocations = allocated.allocations;
+        result.allocations_per_frame = static_cast<double>(allocated.allocations) / settings.frames;
+    }
+    if (auto terrain = application.getTerrain()) {
+        result.terrain_triangles = terrain->triangleCount();
+        result.terrain_texels_per_frame = static_cast<double>(terrain_texels) / settings.frames;
+    }
+
+    if (pipeline_statistics && statistics_frames > 0) {
+        for (auto& counters : statistics_total) {
+            counters.input_vertices /= statistics_frames;
+            counters.input_primitives /= statistics_frames;
+            counters.vertex_invocations /= statistics_frames;
+            counters.clipping_invocations /= statistics_frames;
+            counters.clipping_primitives /= statistics_frames;
+            counters.fragment_invocations /= statistics_frames;
+            counters.compute_invocations /= statistics_frames;
+        }
+        result.pipeline_statistics = statistics_total;
+    }
+
+    return result;
+}
+
+scene::Camera Benchmark::cameraAt(double time) {
+    // orbits the model while bobbing up and down and moving in and out,
+    // so views include close-ups, overviews and grazing angles
+    double angle = 2.0 * glm::pi<double>() * time / orbit_period;
+    float radius = static_cast<float>(3.0 + 1.0 * std::sin(2.0 * angle));
+    float height = static_cast<float>(1.5 + 1.0 * std::sin(3.0 * angle));
+
+    auto position = glm::vec3(radius * std::cos(angle), radius * std::sin(angle), height);
+    return scene::Camera(position, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::radians(45.0f), 0.1f, 10.0f);
+}
+
+std::vector<vulkan::shaders::Point> Benchmark::pointCloud(uint32_t count) {
+    std::vector<vulkan::shaders::Point> cloud(count);
+
+    // golden angle spiral, so points cover the disc evenly at any count
+    constexpr float radius = 4.0f;
+    const float golden_angle = glm::pi<float>() * (3.0f - std::sqrt(5.0f));
+    for (uint32_t i = 0; i < count; i++) {
+        float distance = radius * std::sqrt((i + 0.5f) / count);
+        float angle = i * golden_angle;
+        float x = distance * std::cos(angle);
+        float y = distance * std::sin(angle);
+        float height = 0.1f * std::sin(3.0f * x) * std::cos(3.0f * y) - 0.5f;
+
+        float shade = 0.5f + 5.0f * (height + 0.5f);
+        cloud[i] = vulkan::shaders::Point{glm::vec3(x, y, height), glm::packUnorm4x8(glm::vec4(shade, shade, 1.0f, 1.0f))};
+    }
+
+    return cloud;
+}
+
+void Benchmark::accumulate(vulkan::PipelineStatistics::Frame& total, const vulkan::PipelineStatistics::Frame& frame) {
+    for (size_t pass = 0; pass < total.size(); pass++) {
+        total[pass].input_vertices += frame[pass].input_vertices;
+        total[pass].input_primitives += frame[pass].input_primitives;
+        total[pass].vertex_invocations += frame[pass].vertex_invocations;
+        total[pass].clipping_invocations += frame[pass].clipping_invocations;
+        total[pass].clipping_primitives += frame[pass].clipping_primitives;
+        total[pass].fragment_invocations += frame[pass].fragment_invocations;
+        total[pass].compute_invocations += frame[pass].compute_invocations;
+    }
+}
+
+double Benchmark::percentile(const std::vector<double>& sorted, double fraction) {
+    auto rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+}  // namespace visualization
@@ -0,0 +1,102 @@
+#ifndef BB8_VISUALIZATION_BENCHMARK_HPP
+#define BB8_VISUALIZATION_BENCHMARK_HPP
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "scene/camera.hpp"
+#include "vulkan/pipeline_statistics.hpp"
+#include "vulkan/shaders/point.hpp"
+#include "visualization.hpp"
+
+namespace visualization {
+
+// Renders a fixed number of frames along a scripted camera and animation path,
+// recording CPU and GPU frame times. Every frame advances the animation by the
+// same time step regardless of how long it took, so runs are repeatable and
+// comparable between builds and machines.
+class Benchmark {
+public:
+    class Settings {
+    public:
+        uint32_t frames = 1000;
+        // frames drawn before recording starts, while pipelines and caches warm up
+        uint32_t warmup_frames = 100;
+        // simulated seconds between frames
+        double time_step = 1.0 / 60.0;
+        // samples the call stack of every nth allocation in recorded frames, zero disables sampling
+        uint32_t allocation_sampling_interval = 0;
+        // count vertices, primitives and shader invocations per pass, where the device supports it
+        bool pipeline_statistics = false;
+        // points streamed into the point cloud every frame, as a sensor would
+        uint32_t points = 0;
+    };
+
+    // frame time distribution, in milliseconds
+    class Summary {
+    public:
+        double min;
+        double mean;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+
+        // nullopt if there are no samples
+        static std::optional<Summary> of(std::vector<double> samples);
+    };
+
+    class Result {
+    public:
+        uint32_t frames;
+        uint32_t points;
+        double seconds;
+        double frames_per_second;
+
+        std::optional<Summary> cpu_frame_ms;
+        // nullopt if the device doesn't support timestamps
+        std::optional<Summary> gpu_frame_ms;
+
+        // heap allocations made by the recorded frames, nullopt if allocation tracking isn't built in
+        std::optional<uint64_t> allocations;
+        std::optional<double> allocations_per_frame;
+
+        // triangles the terrain draws per frame, and height texels it uploads per recorded frame, nullopt without terrain
+        std::optional<uint64_t> terrain_triangles;
+        std::optional<double> terrain_texels_per_frame;
+
+        // mean counters of each pass per frame, nullopt unless enabled and supported
+        std::optional<vulkan::PipelineStatistics::Frame> pipeline_statistics;
+
+        void writeJson(std::ostream& out) const;
+    };
+
+    explicit Benchmark(Settings settings);
+
+    // runs the benchmark, throws if the window is closed before it finishes
+    Result run(Visualization& visualization) const;
+
+    // camera of the scripted path at `time` seconds
+    static scene::Camera cameraAt(double time);
+
+private:
+    // adds every counter of `frame` to `total`
+    static void accumulate(vulkan::PipelineStatistics::Frame& total, const vulkan::PipelineStatistics::Frame& frame);
+
+    // deterministic scan-like cloud of rippled ground around the model
+    static std::vector<vulkan::shaders::Point> pointCloud(uint32_t count);
+
+    // nearest-rank percentile of sorted samples
+    static double percentile(const std::vector<double>& sorted, double fraction);
+
+    // one orbit of the scripted camera path
+    static constexpr double orbit_period = 12.0;
+
+    Settings settings;
+};
+
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_BENCHMARK_HPP
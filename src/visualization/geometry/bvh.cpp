@@ -0,0 +1,721 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace visualization {
+namespace geometry {
+
+namespace {
+
+constexpr float infinity = std::numeric_limits<float>::infinity();
+
+// infinite squared radii would also enter unused slots, whose distance is infinite
+float clampSquared(float distance) {
+    return std::min(distance * distance, std::numeric_limits<float>::max());
+}
+
+// a tiny stand-in for zero keeps origins lying on a slab plane from producing 0 * inf
+float reciprocal(float direction) {
+    return 1.0f / (direction == 0.0f ? std::numeric_limits<float>::min() : direction);
+}
+
+}  // namespace
+
+Bvh::Bounds::Bounds() : min(infinity), max(-infinity) {}
+
+void Bvh::Bounds::extend(glm::vec3 point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void Bvh::Bounds::extend(const Bounds& other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+float Bvh::Bounds::area() const {
+    glm::vec3 extent = max - min;
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+void Bvh::Node::clear() {
+    min_x.fill(infinity);
+    min_y.fill(infinity);
+    min_z.fill(infinity);
+    max_x.fill(-infinity);
+    max_y.fill(-infinity);
+    max_z.fill(-infinity);
+    child.fill(0);
+    count.fill(0);
+}
+
+void Bvh::Node::set(size_t slot, const Bounds& bounds, uint32_t child_index, uint32_t child_count) {
+    min_x[slot] = bounds.min.x;
+    min_y[slot] = bounds.min.y;
+    min_z[slot] = bounds.min.z;
+    max_x[slot] = bounds.max.x;
+    max_y[slot] = bounds.max.y;
+    max_z[slot] = bounds.max.z;
+    child[slot] = child_index;
+    count[slot] = child_count;
+}
+
+Bvh::SlabRay::SlabRay(const Ray& ray) : origin(ray.origin) {
+    for (int axis = 0; axis < 3; axis++) {
+        inverse_direction[axis] = reciprocal(ray.direction[axis]);
+        negative[static_cast<size_t>(axis)] = inverse_direction[axis] < 0.0f;
+    }
+}
+
+void Bvh::RayPacket::set(size_t index, const Ray& ray) {
+    origin_x[index] = ray.origin.x;
+    origin_y[index] = ray.origin.y;
+    origin_z[index] = ray.origin.z;
+    direction_x[index] = ray.direction.x;
+    direction_y[index] = ray.direction.y;
+    direction_z[index] = ray.direction.z;
+}
+
+Bvh::SlabPacket::SlabPacket(const RayPacket& packet) {
+    for (size_t lane = 0; lane < RayPacket::size; lane++) {
+        inverse_x[lane] = reciprocal(packet.direction_x[lane]);
+        inverse_y[lane] = reciprocal(packet.direction_y[lane]);
+        inverse_z[lane] = reciprocal(packet.direction_z[lane]);
+    }
+}
+
+Bvh Bvh::build(std::vector<Triangle> input) {
+    Bvh bvh;
+    if (input.empty()) {
+        return bvh;
+    }
+
+    std::vector<BuildReference> references(input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        auto& reference = references[i];
+        for (int corner = 0; corner < 3; corner++) {
+            reference.bounds.extend(input[i].corner(corner));
+        }
+        reference.centroid = 0.5f * (reference.bounds.min + reference.bounds.max);
+        reference.triangle = static_cast<uint32_t>(i);
+    }
+
+    auto root = buildNode(references, 0, static_cast<uint32_t>(references.size()), 0);
+
+    bvh.triangles.reserve(input.size());
+    bvh.triangle_ids.reserve(input.size());
+    bvh.flatten(*root, references, input);
+
+    bvh.triangle_slots.resize(input.size());
+    for (size_t slot = 0; slot < bvh.triangle_ids.size(); slot++) {
+        bvh.triangle_slots[bvh.triangle_ids[slot]] = static_cast<uint32_t>(slot);
+    }
+
+    return bvh;
+}
+
+std::optional<Bvh::Hit> Bvh::intersect(const Ray& ray, float max_distance) const {
+    return traverse<false>(ray, max_distance);
+}
+
+bool Bvh::occluded(const Ray& ray, float max_distance) const {
+    return traverse<true>(ray, max_distance).has_value();
+}
+
+void Bvh::intersect(const RayPacket& packet, float max_distance, float* distances) const {
+    alignas(16) PacketLimits limits;
+    for (size_t lane = 0; lane < RayPacket::size; lane++) {
+        limits[lane] = lane < packet.count ? max_distance : -1.0f;
+    }
+
+    if (!nodes.empty() && packet.count > 0) {
+        SlabPacket slabs(packet);
+
+        std::array<StackEntry, stack_size> stack;
+        size_t stack_top = 0;
+        stack[stack_top++] = StackEntry{0, 0.0f};
+
+        while (stack_top > 0) {
+            auto entry = stack[--stack_top];
+            if (entry.distance > *std::max_element(limits.begin(), limits.end())) {
+                continue;
+            }
+            const Node& node = nodes[entry.node];
+
+            std::array<StackEntry, width> pending;
+            size_t pending_count = 0;
+
+            for (size_t slot = 0; slot < width; slot++) {
+                // unused slots' inverted bounds would still pass the order-independent slab test below
+                float entry_distance;
+                if (node.min_x[slot] > node.max_x[slot] || !packetEntersSlot(node, slot, packet, slabs, limits, entry_distance)) {
+                    continue;
+                }
+
+                if (node.count[slot] == 0) {
+                    insertPending(pending, pending_count, StackEntry{node.child[slot], entry_distance});
+                    continue;
+                }
+
+                for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++) {
+                    intersectPacketTriangle(triangles[i], packet, limits);
+                }
+            }
+
+            for (size_t i = 0; i < pending_count; i++) {
+                stack[stack_top++] = pending[i];
+            }
+        }
+    }
+
+    std::copy(limits.begin(), limits.begin() + packet.count, distances);
+}
+
+size_t Bvh::overlapSphere(glm::vec3 center, float radius, uint32_t* found, size_t capacity) const {
+    size_t found_count = 0;
+    overlapSphere(center, radius, [found, capacity, &found_count](uint32_t triangle) {
+        if (found_count < capacity) {
+            found[found_count] = triangle;
+        }
+        found_count++;
+    });
+
+    return found_count;
+}
+
+std::optional<Bvh::Closest> Bvh::closestPoint(glm::vec3 point, float max_distance) const {
+    if (nodes.empty()) {
+        return std::nullopt;
+    }
+
+    float best_squared = clampSquared(max_distance);
+    std::optional<Closest> closest;
+
+    std::array<StackEntry, stack_size> stack;
+    size_t stack_top = 0;
+    stack[stack_top++] = StackEntry{0, 0.0f};
+
+    while (stack_top > 0) {
+        auto entry = stack[--stack_top];
+        if (entry.distance > best_squared) {
+            continue;
+        }
+        const Node& node = nodes[entry.node];
+
+        std::array<float, width> distances;
+        uint32_t mask = overlapNode(node, point, best_squared, distances);
+
+        std::array<StackEntry, width> pending;
+        size_t pending_count = 0;
+
+        for (size_t slot = 0; slot < width; slot++) {
+            if ((mask & (1u << slot)) == 0) {
+                continue;
+            }
+
+            if (node.count[slot] == 0) {
+                insertPending(pending, pending_count, StackEntry{node.child[slot], distances[slot]});
+                continue;
+            }
+
+            for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++) {
+                glm::vec3 candidate = triangles[i].closestPoint(point);
+                glm::vec3 offset = candidate - point;
+                float distance_squared = glm::dot(offset, offset);
+                if (distance_squared <= best_squared) {
+                    best_squared = distance_squared;
+                    closest = Closest{candidate, std::sqrt(distance_squared), triangle_ids[i]};
+                }
+            }
+        }
+
+        for (size_t i = 0; i < pending_count; i++) {
+            stack[stack_top++] = pending[i];
+        }
+    }
+
+    return closest;
+}
+
+size_t Bvh::triangleCount() const {
+    return triangles.size();
+}
+
+size_t Bvh::nodeCount() const {
+    return nodes.size();
+}
+
+const Triangle& Bvh::triangle(uint32_t index) const {
+    return triangles[triangle_slots[index]];
+}
+
+std::unique_ptr<Bvh::BuildNode> Bvh::buildNode(std::vector<BuildReference>& references, uint32_t first, uint32_t count, uint32_t depth) {
+    auto node = std::make_unique<BuildNode>();
+    for (uint32_t i = first; i < first + count; i++) {
+        node->bounds.extend(references[i].bounds);
+    }
+
+    if (count <= max_leaf_size) {
+        node->first = first;
+        node->count = count;
+        return node;
+    }
+
+    uint32_t left_count = split(references, first, count, depth);
+
+    // halves are disjoint ranges of `references`, so they can be built concurrently
+    if (count >= parallel_threshold && depth < max_parallel_depth) {
+        auto left = std::async(std::launch::async, [&references, first, left_count, depth]() {
+            return buildNode(references, first, left_count, depth + 1);
+        });
+        node->children[1] = buildNode(references, first + left_count, count - left_count, depth + 1);
+        node->children[0] = left.get();
+    } else {
+        node->children[0] = buildNode(references, first, left_count, depth + 1);
+        node->children[1] = buildNode(references, first + left_count, count - left_count, depth + 1);
+    }
+
+    return node;
+}
+
+uint32_t Bvh::split(std::vector<BuildReference>& references, uint32_t first, uint32_t count, uint32_t depth) {
+    auto begin = references.begin() + first;
+    auto end = begin + count;
+
+    Bounds centroid_bounds;
+    for (auto reference = begin; reference != end; reference++) {
+        centroid_bounds.extend(reference->centroid);
+    }
+    glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+
+    if (depth < max_sah_depth) {
+        float best_cost = infinity;
+        int best_axis = -1;
+        uint32_t best_bin = 0;
+
+        // nearly flat axes can't be binned reliably, and tiny extents would overflow the scale
+        glm::vec3 magnitude = glm::max(glm::abs(centroid_bounds.min), glm::abs(centroid_bounds.max));
+        float min_extent = min_relative_extent * std::max({magnitude.x, magnitude.y, magnitude.z});
+        glm::vec3 bin_scale = glm::vec3(0.0f);
+        for (int axis = 0; axis < 3; axis++) {
+            float scale = sah_bins / extent[axis];
+            if (extent[axis] > min_extent && std::isfinite(scale)) {
+                bin_scale[axis] = scale;
+            }
+        }
+
+        auto binIndex = [&centroid_bounds, &bin_scale](const BuildReference& reference, int axis) {
+            float offset = (reference.centroid[axis] - centroid_bounds.min[axis]) * bin_scale[axis];
+            return static_cast<uint32_t>(std::clamp(offset, 0.0f, static_cast<float>(sah_bins - 1)));
+        };
+
+        for (int axis = 0; axis < 3; axis++) {
+            if (bin_scale[axis] == 0.0f) {
+                continue;
+            }
+
+            std::array<Bounds, sah_bins> bin_bounds;
+            std::array<uint32_t, sah_bins> bin_counts{};
+            for (auto reference = begin; reference != end; reference++) {
+                uint32_t bin = binIndex(*reference, axis);
+                bin_bounds[bin].extend(reference->bounds);
+                bin_counts[bin]++;
+            }
+
+            // cost of everything right of the plane before each bin
+            std::array<float, sah_bins> right_costs{};
+            Bounds right;
+            uint32_t right_count = 0;
+            for (uint32_t bin = sah_bins - 1; bin > 0; bin--) {
+                right.extend(bin_bounds[bin]);
+                right_count += bin_counts[bin];
+                right_costs[bin] = right_count > 0 ? right.area() * static_cast<float>(right_count) : 0.0f;
+            }
+
+            Bounds left;
+            uint32_t left_count = 0;
+            for (uint32_t bin = 1; bin < sah_bins; bin++) {
+                left.extend(bin_bounds[bin - 1]);
+                left_count += bin_counts[bin - 1];
+                if (left_count == 0 || left_count == count) {
+                    continue;
+                }
+
+                float cost = left.area() * static_cast<float>(left_count) + right_costs[bin];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = bin;
+                }
+            }
+        }
+
+        if (best_axis >= 0) {
+            auto middle = std::partition(begin, end, [&binIndex, best_axis, best_bin](const BuildReference& reference) {
+                return binIndex(reference, best_axis) < best_bin;
+            });
+            return static_cast<uint32_t>(middle - begin);
+        }
+    }
+
+    // too deep, or all centroids coincide
+    int axis = 0;
+    if (extent.y > extent[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent[axis]) {
+        axis = 2;
+    }
+
+    uint32_t half = count / 2;
+    std::nth_element(begin, begin + half, end, [axis](const BuildReference& a, const BuildReference& b) {
+        return a.centroid[axis] < b.centroid[axis];
+    });
+    return half;
+}
+
+uint32_t Bvh::flatten(const BuildNode& root, const std::vector<BuildReference>& references, const std::vector<Triangle>& input) {
+    auto index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].clear();
+
+    // open the largest internal children until the node is full
+    std::array<const BuildNode*, width> children{};
+    size_t child_count = 0;
+    if (root.count > 0) {
+        children[child_count++] = &root;
+    } else {
+        children[child_count++] = root.children[0].get();
+        children[child_count++] = root.children[1].get();
+    }
+
+    while (child_count < width) {
+        size_t largest = width;
+        float largest_area = -1.0f;
+        for (size_t i = 0; i < child_count; i++) {
+            if (children[i]->count == 0 && children[i]->bounds.area() > largest_area) {
+                largest = i;
+                largest_area = children[i]->bounds.area();
+            }
+        }
+
+        if (largest == width) {
+            break;
+        }
+
+        const BuildNode* opened = children[largest];
+        children[largest] = opened->children[0].get();
+        children[child_count++] = opened->children[1].get();
+    }
+
+    for (size_t slot = 0; slot < child_count; slot++) {
+        const BuildNode& child = *children[slot];
+
+        if (child.count > 0) {
+            auto first_triangle = static_cast<uint32_t>(triangles.size());
+            for (uint32_t i = child.first; i < child.first + child.count; i++) {
+                triangles.push_back(input[references[i].triangle]);
+                triangle_ids.push_back(references[i].triangle);
+            }
+            nodes[index].set(slot, child.bounds, first_triangle, child.count);
+        } else {
+            // flattening the child may reallocate `nodes`
+            uint32_t child_index = flatten(child, references, input);
+            nodes[index].set(slot, child.bounds, child_index, 0);
+        }
+    }
+
+    return index;
+}
+
+uint32_t Bvh::intersectNode(const Node& node, const SlabRay& ray, float max_distance, std::array<float, width>& distances) {
+    const float* near_x = ray.negative[0] ? node.max_x.data() : node.min_x.data();
+    const float* far_x = ray.negative[0] ? node.min_x.data() : node.max_x.data();
+    const float* near_y = ray.negative[1] ? node.max_y.data() : node.min_y.data();
+    const float* far_y = ray.negative[1] ? node.min_y.data() : node.max_y.data();
+    const float* near_z = ray.negative[2] ? node.max_z.data() : node.min_z.data();
+    const float* far_z = ray.negative[2] ? node.min_z.data() : node.max_z.data();
+
+#if defined(__SSE2__)
+    __m128 origin_x = _mm_set1_ps(ray.origin.x);
+    __m128 origin_y = _mm_set1_ps(ray.origin.y);
+    __m128 origin_z = _mm_set1_ps(ray.origin.z);
+    __m128 inverse_x = _mm_set1_ps(ray.inverse_direction.x);
+    __m128 inverse_y = _mm_set1_ps(ray.inverse_direction.y);
+    __m128 inverse_z = _mm_set1_ps(ray.inverse_direction.z);
+
+    __m128 enter_x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(near_x), origin_x), inverse_x);
+    __m128 enter_y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(near_y), origin_y), inverse_y);
+    __m128 enter_z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(near_z), origin_z), inverse_z);
+    __m128 exit_x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(far_x), origin_x), inverse_x);
+    __m128 exit_y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(far_y), origin_y), inverse_y);
+    __m128 exit_z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(far_z), origin_z), inverse_z);
+
+    __m128 enter = _mm_max_ps(_mm_max_ps(enter_x, enter_y), _mm_max_ps(enter_z, _mm_setzero_ps()));
+    __m128 exit = _mm_min_ps(_mm_min_ps(exit_x, exit_y), _mm_min_ps(exit_z, _mm_set1_ps(max_distance)));
+
+    _mm_storeu_ps(distances.data(), enter);
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(enter, exit)));
+#else
+    uint32_t mask = 0;
+    for (size_t slot = 0; slot < width; slot++) {
+        float enter_x = (near_x[slot] - ray.origin.x) * ray.inverse_direction.x;
+        float enter_y = (near_y[slot] - ray.origin.y) * ray.inverse_direction.y;
+        float enter_z = (near_z[slot] - ray.origin.z) * ray.inverse_direction.z;
+        float exit_x = (far_x[slot] - ray.origin.x) * ray.inverse_direction.x;
+        float exit_y = (far_y[slot] - ray.origin.y) * ray.inverse_direction.y;
+        float exit_z = (far_z[slot] - ray.origin.z) * ray.inverse_direction.z;
+
+        float enter = std::max(std::max(enter_x, enter_y), std::max(enter_z, 0.0f));
+        float exit = std::min(std::min(exit_x, exit_y), std::min(exit_z, max_distance));
+
+        distances[slot] = enter;
+        if (enter <= exit) {
+            mask |= 1u << slot;
+        }
+    }
+    return mask;
+#endif
+}
+
+uint32_t Bvh::overlapNode(const Node& node, glm::vec3 point, float radius_squared, std::array<float, width>& distances) {
+#if defined(__SSE2__)
+    __m128 zero = _mm_setzero_ps();
+    __m128 point_x = _mm_set1_ps(point.x);
+    __m128 point_y = _mm_set1_ps(point.y);
+    __m128 point_z = _mm_set1_ps(point.z);
+
+    // distance outside each slab, zero inside it
+    __m128 offset_x = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.min_x.data()), point_x), _mm_sub_ps(point_x, _mm_load_ps(node.max_x.data()))), zero);
+    __m128 offset_y = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.min_y.data()), point_y), _mm_sub_ps(point_y, _mm_load_ps(node.max_y.data()))), zero);
+    __m128 offset_z = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.min_z.data()), point_z), _mm_sub_ps(point_z, _mm_load_ps(node.max_z.data()))), zero);
+
+    __m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offset_x, offset_x), _mm_mul_ps(offset_y, offset_y)), _mm_mul_ps(offset_z, offset_z));
+
+    _mm_storeu_ps(distances.data(), squared);
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(squared, _mm_set1_ps(radius_squared))));
+#else
+    uint32_t mask = 0;
+    for (size_t slot = 0; slot < width; slot++) {
+        float offset_x = std::max(std::max(node.min_x[slot] - point.x, point.x - node.max_x[slot]), 0.0f);
+        float offset_y = std::max(std::max(node.min_y[slot] - point.y, point.y - node.max_y[slot]), 0.0f);
+        float offset_z = std::max(std::max(node.min_z[slot] - point.z, point.z - node.max_z[slot]), 0.0f);
+
+        distances[slot] = offset_x * offset_x + offset_y * offset_y + offset_z * offset_z;
+        if (distances[slot] <= radius_squared) {
+            mask |= 1u << slot;
+        }
+    }
+    return mask;
+#endif
+}
+
+bool Bvh::packetEntersSlot(const Node& node, size_t slot, const RayPacket& packet, const SlabPacket& slabs, const PacketLimits& limits, float& entry) {
+#if defined(__SSE2__)
+    // rays differ in direction signs, so each axis' entry and exit are the min and max of both planes
+    __m128 min_x = _mm_set1_ps(node.min_x[slot]);
+    __m128 min_y = _mm_set1_ps(node.min_y[slot]);
+    __m128 min_z = _mm_set1_ps(node.min_z[slot]);
+    __m128 max_x = _mm_set1_ps(node.max_x[slot]);
+    __m128 max_y = _mm_set1_ps(node.max_y[slot]);
+    __m128 max_z = _mm_set1_ps(node.max_z[slot]);
+
+    int mask = 0;
+    __m128 nearest = _mm_set1_ps(infinity);
+
+    for (size_t lane = 0; lane < packet.count; lane += 4) {
+        __m128 origin_x = _mm_load_ps(&packet.origin_x[lane]);
+        __m128 origin_y = _mm_load_ps(&packet.origin_y[lane]);
+        __m128 origin_z = _mm_load_ps(&packet.origin_z[lane]);
+        __m128 inverse_x = _mm_load_ps(&slabs.inverse_x[lane]);
+        __m128 inverse_y = _mm_load_ps(&slabs.inverse_y[lane]);
+        __m128 inverse_z = _mm_load_ps(&slabs.inverse_z[lane]);
+
+        __m128 low_x = _mm_mul_ps(_mm_sub_ps(min_x, origin_x), inverse_x);
+        __m128 low_y = _mm_mul_ps(_mm_sub_ps(min_y, origin_y), inverse_y);
+        __m128 low_z = _mm_mul_ps(_mm_sub_ps(min_z, origin_z), inverse_z);
+        __m128 high_x = _mm_mul_ps(_mm_sub_ps(max_x, origin_x), inverse_x);
+        __m128 high_y = _mm_mul_ps(_mm_sub_ps(max_y, origin_y), inverse_y);
+        __m128 high_z = _mm_mul_ps(_mm_sub_ps(max_z, origin_z), inverse_z);
+
+        __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(low_x, high_x), _mm_min_ps(low_y, high_y)),
+                                  _mm_max_ps(_mm_min_ps(low_z, high_z), _mm_setzero_ps()));
+        __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(low_x, high_x), _mm_max_ps(low_y, high_y)),
+                                 _mm_min_ps(_mm_max_ps(low_z, high_z), _mm_load_ps(&limits[lane])));
+
+        __m128 hit = _mm_cmple_ps(enter, exit);
+        mask |= _mm_movemask_ps(hit);
+        nearest = _mm_min_ps(nearest, _mm_or_ps(_mm_and_ps(hit, enter), _mm_andnot_ps(hit, _mm_set1_ps(infinity))));
+    }
+
+    alignas(16) std::array<float, 4> nearest_lanes;
+    _mm_store_ps(nearest_lanes.data(), nearest);
+    entry = *std::min_element(nearest_lanes.begin(), nearest_lanes.end());
+    return mask != 0;
+#else
+    bool entered = false;
+    entry = infinity;
+
+    for (size_t lane = 0; lane < packet.count; lane++) {
+        float low_x = (node.min_x[slot] - packet.origin_x[lane]) * slabs.inverse_x[lane];
+        float low_y = (node.min_y[slot] - packet.origin_y[lane]) * slabs.inverse_y[lane];
+        float low_z = (node.min_z[slot] - packet.origin_z[lane]) * slabs.inverse_z[lane];
+        float high_x = (node.max_x[slot] - packet.origin_x[lane]) * slabs.inverse_x[lane];
+        float high_y = (node.max_y[slot] - packet.origin_y[lane]) * slabs.inverse_y[lane];
+        float high_z = (node.max_z[slot] - packet.origin_z[lane]) * slabs.inverse_z[lane];
+
+        float enter = std::max(std::max(std::min(low_x, high_x), std::min(low_y, high_y)), std::max(std::min(low_z, high_z), 0.0f));
+        float exit = std::min(std::min(std::max(low_x, high_x), std::max(low_y, high_y)), std::min(std::max(low_z, high_z), limits[lane]));
+
+        if (enter <= exit) {
+            entered = true;
+            entry = std::min(entry, enter);
+        }
+    }
+
+    return entered;
+#endif
+}
+
+void Bvh::intersectPacketTriangle(const Triangle& triangle, const RayPacket& packet, PacketLimits& limits) {
+#if defined(__SSE2__)
+    // Moller-Trumbore as in Triangle::intersect, for four rays at once
+    __m128 v0_x = _mm_set1_ps(triangle.v0.x);
+    __m128 v0_y = _mm_set1_ps(triangle.v0.y);
+    __m128 v0_z = _mm_set1_ps(triangle.v0.z);
+    __m128 e1_x = _mm_set1_ps(triangle.e1.x);
+    __m128 e1_y = _mm_set1_ps(triangle.e1.y);
+    __m128 e1_z = _mm_set1_ps(triangle.e1.z);
+    __m128 e2_x = _mm_set1_ps(triangle.e2.x);
+    __m128 e2_y = _mm_set1_ps(triangle.e2.y);
+    __m128 e2_z = _mm_set1_ps(triangle.e2.z);
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 parallel_epsilon = _mm_set1_ps(1e-12f);
+
+    for (size_t lane = 0; lane < packet.count; lane += 4) {
+        __m128 direction_x = _mm_load_ps(&packet.direction_x[lane]);
+        __m128 direction_y = _mm_load_ps(&packet.direction_y[lane]);
+        __m128 direction_z = _mm_load_ps(&packet.direction_z[lane]);
+
+        __m128 p_x = _mm_sub_ps(_mm_mul_ps(direction_y, e2_z), _mm_mul_ps(direction_z, e2_y));
+        __m128 p_y = _mm_sub_ps(_mm_mul_ps(direction_z, e2_x), _mm_mul_ps(direction_x, e2_z));
+        __m128 p_z = _mm_sub_ps(_mm_mul_ps(direction_x, e2_y), _mm_mul_ps(direction_y, e2_x));
+        __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1_x, p_x), _mm_mul_ps(e1_y, p_y)), _mm_mul_ps(e1_z, p_z));
+        __m128 inverse_determinant = _mm_div_ps(one, determinant);
+
+        __m128 s_x = _mm_sub_ps(_mm_load_ps(&packet.origin_x[lane]), v0_x);
+        __m128 s_y = _mm_sub_ps(_mm_load_ps(&packet.origin_y[lane]), v0_y);
+        __m128 s_z = _mm_sub_ps(_mm_load_ps(&packet.origin_z[lane]), v0_z);
+        __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s_x, p_x), _mm_mul_ps(s_y, p_y)), _mm_mul_ps(s_z, p_z)), inverse_determinant);
+
+        __m128 q_x = _mm_sub_ps(_mm_mul_ps(s_y, e1_z), _mm_mul_ps(s_z, e1_y));
+        __m128 q_y = _mm_sub_ps(_mm_mul_ps(s_z, e1_x), _mm_mul_ps(s_x, e1_z));
+        __m128 q_z = _mm_sub_ps(_mm_mul_ps(s_x, e1_y), _mm_mul_ps(s_y, e1_x));
+        __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(direction_x, q_x), _mm_mul_ps(direction_y, q_y)), _mm_mul_ps(direction_z, q_z)), inverse_determinant);
+        __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2_x, q_x), _mm_mul_ps(e2_y, q_y)), _mm_mul_ps(e2_z, q_z)), inverse_determinant);
+
+        __m128 limit = _mm_load_ps(&limits[lane]);
+        __m128 valid = _mm_cmpge_ps(_mm_andnot_ps(sign, determinant), parallel_epsilon);
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero)));
+        valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(distance, zero), _mm_cmple_ps(distance, limit)));
+
+        _mm_store_ps(&limits[lane], _mm_or_ps(_mm_and_ps(valid, distance), _mm_andnot_ps(valid, limit)));
+    }
+#else
+    for (size_t lane = 0; lane < packet.count; lane++) {
+        if (limits[lane] < 0.0f) {
+            continue;
+        }
+
+        auto ray = Ray{glm::vec3(packet.origin_x[lane], packet.origin_y[lane], packet.origin_z[lane]),
+                       glm::vec3(packet.direction_x[lane], packet.direction_y[lane], packet.direction_z[lane])};
+        auto hit = triangle.intersect(ray, limits[lane]);
+        if (hit.has_value()) {
+            limits[lane] = hit->distance;
+        }
+    }
+#endif
+}
+
+void Bvh::insertPending(std::array<StackEntry, width>& pending, size_t& pending_count, StackEntry entry) {
+    size_t position = pending_count++;
+    while (position > 0 && pending[position - 1].distance < entry.distance) {
+        pending[position] = pending[position - 1];
+        position--;
+    }
+    pending[position] = entry;
+}
+
+template <bool any_hit>
+std::optional<Bvh::Hit> Bvh::traverse(const Ray& ray, float max_distance) const {
+    if (nodes.empty()) {
+        return std::nullopt;
+    }
+
+    SlabRay slab_ray(ray);
+    std::optional<Hit> closest;
+
+    // at most three siblings are left behind per level, and the build limits the depth
+    std::array<StackEntry, stack_size> stack;
+    size_t stack_top = 0;
+    stack[stack_top++] = StackEntry{0, 0.0f};
+
+    while (stack_top > 0) {
+        auto entry = stack[--stack_top];
+        if (entry.distance > max_distance) {
+            continue;
+        }
+        const Node& node = nodes[entry.node];
+
+        std::array<float, width> distances;
+        uint32_t mask = intersectNode(node, slab_ray, max_distance, distances);
+
+        // nearest child is pushed last, so it's visited first
+        std::array<StackEntry, width> pending;
+        size_t pending_count = 0;
+
+        for (size_t slot = 0; slot < width; slot++) {
+            if ((mask & (1u << slot)) == 0) {
+                continue;
+            }
+
+            if (node.count[slot] == 0) {
+                insertPending(pending, pending_count, StackEntry{node.child[slot], distances[slot]});
+                continue;
+            }
+
+            for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++) {
+                auto hit = triangles[i].intersect(ray, max_distance);
+                if (!hit.has_value()) {
+                    continue;
+                }
+
+                closest = Hit{hit->distance, triangle_ids[i], hit->barycentric};
+                if (any_hit) {
+                    return closest;
+                }
+                max_distance = hit->distance;
+            }
+        }
+
+        for (size_t i = 0; i < pending_count; i++) {
+            stack[stack_top++] = pending[i];
+        }
+    }
+
+    return closest;
+}
+
+}  // namespace geometry
+}  // namespace visualization
@@ -0,0 +1,243 @@
+#ifndef BB8_VISUALIZATION_GEOMETRY_BVH_HPP
+#define BB8_VISUALIZATION_GEOMETRY_BVH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "../vulkan/glm.hpp"
+#include "triangle.hpp"
+
+namespace visualization {
+namespace geometry {
+
+// Bounding volume hierarchy over a triangle soup, for ray, sphere and closest-point
+// queries on the CPU. Built top-down with binned SAH, then collapsed into nodes of
+// four children whose bounds are stored as separate coordinate arrays, so one node
+// is tested against a query with a few SSE instructions. Triangles are copied into
+// leaf order, and reported by their index in the input.
+class Bvh {
+public:
+    class Hit {
+    public:
+        float distance;
+        uint32_t triangle;
+        glm::vec2 barycentric;
+    };
+
+    class Closest {
+    public:
+        glm::vec3 point;
+        float distance;
+        uint32_t triangle;
+    };
+
+    // Rays traversed together, so coherent rays such as neighbouring sensor beams share
+    // node visits. Stored as coordinate arrays, four rays to an SSE register.
+    class RayPacket {
+    public:
+        static constexpr size_t size = 16;
+
+        void set(size_t index, const Ray& ray);
+
+        alignas(16) std::array<float, size> origin_x{};
+        alignas(16) std::array<float, size> origin_y{};
+        alignas(16) std::array<float, size> origin_z{};
+        alignas(16) std::array<float, size> direction_x{};
+        alignas(16) std::array<float, size> direction_y{};
+        alignas(16) std::array<float, size> direction_z{};
+        // rays past `count` are ignored
+        uint32_t count = 0;
+    };
+
+    static constexpr size_t width = 4;
+    static constexpr uint32_t max_leaf_size = 4;
+
+    // empty hierarchy, which nothing hits
+    Bvh() = default;
+
+    // subtrees are built in parallel for large inputs
+    static Bvh build(std::vector<Triangle> triangles);
+
+    // closest hit within `max_distance`
+    std::optional<Hit> intersect(const Ray& ray, float max_distance) const;
+    // whether anything is hit within `max_distance`, which is cheaper to answer
+    bool occluded(const Ray& ray, float max_distance) const;
+    // writes the closest hit distance of each ray in the packet to `distances`, or
+    // `max_distance` for rays hitting nothing within it
+    void intersect(const RayPacket& packet, float max_distance, float* distances) const;
+
+    // writes up to `capacity` triangles touching the sphere to `triangles`, and returns how many there are in total
+    size_t overlapSphere(glm::vec3 center, float radius, uint32_t* triangles, size_t capacity) const;
+    // calls `visit` with each triangle touching the sphere, in one traversal however many there are
+    template <typename Visit>
+    void overlapSphere(glm::vec3 center, float radius, Visit&& visit) const {
+        if (nodes.empty()) {
+            return;
+        }
+
+        // infinite squared radii would also enter unused slots, whose distance is infinite
+        float radius_squared = std::min(radius * radius, std::numeric_limits<float>::max());
+
+        std::array<uint32_t, stack_size> stack;
+        size_t stack_top = 0;
+        stack[stack_top++] = 0;
+
+        while (stack_top > 0) {
+            const Node& node = nodes[stack[--stack_top]];
+
+            std::array<float, width> distances;
+            uint32_t mask = overlapNode(node, center, radius_squared, distances);
+
+            for (size_t slot = 0; slot < width; slot++) {
+                if ((mask & (1u << slot)) == 0) {
+                    continue;
+                }
+
+                if (node.count[slot] == 0) {
+                    stack[stack_top++] = node.child[slot];
+                    continue;
+                }
+
+                for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++) {
+                    glm::vec3 offset = triangles[i].closestPoint(center) - center;
+                    if (glm::dot(offset, offset) <= radius_squared) {
+                        visit(triangle_ids[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // closest point on any triangle within `max_distance`
+    std::optional<Closest> closestPoint(glm::vec3 point, float max_distance) const;
+
+    size_t triangleCount() const;
+    size_t nodeCount() const;
+    const Triangle& triangle(uint32_t index) const;
+
+private:
+    class Bounds {
+    public:
+        Bounds();
+
+        void extend(glm::vec3 point);
+        void extend(const Bounds& other);
+        float area() const;
+
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // binary node of the initial build, before collapsing into wide nodes
+    class BuildNode {
+    public:
+        Bounds bounds;
+        // leaves hold the range [first, first + count) of the build order
+        uint32_t first = 0;
+        uint32_t count = 0;
+        std::array<std::unique_ptr<BuildNode>, 2> children;
+    };
+
+    class BuildReference {
+    public:
+        Bounds bounds;
+        glm::vec3 centroid;
+        uint32_t triangle;
+    };
+
+    // Four child slots. Internal children have a count of zero and index `nodes`,
+    // leaves index `count` triangles. Unused slots have inverted bounds, so no query
+    // ever enters them.
+    class alignas(64) Node {
+    public:
+        void clear();
+        void set(size_t slot, const Bounds& bounds, uint32_t child, uint32_t count);
+
+        std::array<float, width> min_x;
+        std::array<float, width> min_y;
+        std::array<float, width> min_z;
+        std::array<float, width> max_x;
+        std::array<float, width> max_y;
+        std::array<float, width> max_z;
+        std::array<uint32_t, width> child;
+        std::array<uint32_t, width> count;
+    };
+
+    // ray with its reciprocal direction, and which slab planes it enters through
+    class SlabRay {
+    public:
+        explicit SlabRay(const Ray& ray);
+
+        glm::vec3 origin;
+        glm::vec3 inverse_direction;
+        std::array<bool, 3> negative;
+    };
+
+    class SlabPacket {
+    public:
+        explicit SlabPacket(const RayPacket& packet);
+
+        alignas(16) std::array<float, RayPacket::size> inverse_x;
+        alignas(16) std::array<float, RayPacket::size> inverse_y;
+        alignas(16) std::array<float, RayPacket::size> inverse_z;
+    };
+
+    // per-ray distance limits of a packet traversal, negative for unused rays
+    using PacketLimits = std::array<float, RayPacket::size>;
+
+    class StackEntry {
+    public:
+        uint32_t node;
+        // entry distance along a ray, or squared distance from a point
+        float distance;
+    };
+
+    static constexpr uint32_t sah_bins = 16;
+    // axes whose centroids spread less than this fraction of their coordinates' magnitude aren't binned
+    static constexpr float min_relative_extent = 1e-6f;
+    // deeper nodes are split at the median, which bounds the depth and so the traversal stack
+    static constexpr uint32_t max_sah_depth = 48;
+    static constexpr size_t stack_size = 256;
+
+    // subtrees with at least this many triangles are built on another thread, down to `max_parallel_depth`
+    static constexpr uint32_t parallel_threshold = 8192;
+    static constexpr uint32_t max_parallel_depth = 4;
+
+    static std::unique_ptr<BuildNode> buildNode(std::vector<BuildReference>& references, uint32_t first, uint32_t count, uint32_t depth);
+    // partitions [first, first + count) and returns the size of the first half
+    static uint32_t split(std::vector<BuildReference>& references, uint32_t first, uint32_t count, uint32_t depth);
+
+    uint32_t flatten(const BuildNode& root, const std::vector<BuildReference>& references, const std::vector<Triangle>& input);
+
+    // masks of the slots a ray enters within `max_distance`, or that lie within
+    // sqrt(`radius_squared`) of a point, with the entry or squared distances
+    static uint32_t intersectNode(const Node& node, const SlabRay& ray, float max_distance, std::array<float, width>& distances);
+    static uint32_t overlapNode(const Node& node, glm::vec3 point, float radius_squared, std::array<float, width>& distances);
+
+    // whether any ray of the packet enters the slot before its limit, and the nearest entry distance
+    static bool packetEntersSlot(const Node& node, size_t slot, const RayPacket& packet, const SlabPacket& slabs, const PacketLimits& limits, float& entry);
+    // shortens the limits of rays hitting the triangle
+    static void intersectPacketTriangle(const Triangle& triangle, const RayPacket& packet, PacketLimits& limits);
+
+    // adds an internal child to children waiting to be pushed, kept farthest first
+    static void insertPending(std::array<StackEntry, width>& pending, size_t& pending_count, StackEntry entry);
+
+    template <bool any_hit>
+    std::optional<Hit> traverse(const Ray& ray, float max_distance) const;
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+    // input index of each triangle in leaf order, and the reverse
+    std::vector<uint32_t> triangle_ids;
+    std::vector<uint32_t> triangle_slots;
+};
+
+}  // namespace geometry
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_GEOMETRY_BVH_HPP
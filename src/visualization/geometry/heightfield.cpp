@@ -0,0 +1,120 @@
+#include "heightfield.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stb_image.h>
+#include <stdexcept>
+
+namespace visualization {
+namespace geometry {
+
+Heightfield::Heightfield(uint32_t columns, uint32_t rows, float spacing, glm::vec2 origin, std::vector<float> heights)
+    : column_count(columns), row_count(rows), sample_spacing(spacing), grid_origin(origin), heights(std::move(heights)) {
+    if (columns == 0 || rows == 0 || this->heights.size() != size_t(columns) * rows) {
+        throw std::runtime_error("heightfield samples don't match its size");
+    }
+    if (!(spacing > 0.0f)) {
+        throw std::runtime_error("heightfield spacing must be positive");
+    }
+
+    auto [min, max] = std::minmax_element(this->heights.begin(), this->heights.end());
+    min_height = *min;
+    max_height = *max;
+}
+
+Heightfield Heightfield::load(std::filesystem::path image_file, float spacing, float min_height, float max_height) {
+    int width, height, channels;
+    stbi_us* pixels = stbi_load_16(image_file.string().c_str(), &width, &height, &channels, STBI_grey);
+    if (!pixels) {
+        throw std::runtime_error("failed to load heightfield image");
+    }
+
+    // 8-bit images are widened to the full 16-bit range
+    std::vector<float> heights(size_t(width) * height);
+    float scale = (max_height - min_height) / 65535.0f;
+    for (size_t i = 0; i < heights.size(); i++) {
+        heights[i] = min_height + pixels[i] * scale;
+    }
+    stbi_image_free(pixels);
+
+    auto origin = -0.5f * spacing * glm::vec2(width - 1, height - 1);
+    return Heightfield(static_cast<uint32_t>(width), static_cast<uint32_t>(height), spacing, origin, std::move(heights));
+}
+
+float Heightfield::sample(int64_t column, int64_t row) const {
+    column = std::clamp<int64_t>(column, 0, column_count - 1);
+    row = std::clamp<int64_t>(row, 0, row_count - 1);
+    return heights[row * column_count + column];
+}
+
+float Heightfield::height(glm::vec2 position) const {
+    int64_t column, row;
+    glm::vec2 fraction;
+    locate(position, column, row, fraction);
+
+    float h00 = sample(column, row);
+    float h11 = sample(column + 1, row + 1);
+    if (fraction.x >= fraction.y) {
+        float h10 = sample(column + 1, row);
+        return h00 + fraction.x * (h10 - h00) + fraction.y * (h11 - h10);
+    } else {
+        float h01 = sample(column, row + 1);
+        return h00 + fraction.y * (h01 - h00) + fraction.x * (h11 - h01);
+    }
+}
+
+glm::vec3 Heightfield::normal(glm::vec2 position) const {
+    int64_t column, row;
+    glm::vec2 fraction;
+    locate(position, column, row, fraction);
+
+    // slopes of the triangle containing the position
+    float h00 = sample(column, row);
+    float h11 = sample(column + 1, row + 1);
+    glm::vec2 slope;
+    if (fraction.x >= fraction.y) {
+        float h10 = sample(column + 1, row);
+        slope = glm::vec2(h10 - h00, h11 - h10);
+    } else {
+        float h01 = sample(column, row + 1);
+        slope = glm::vec2(h11 - h01, h01 - h00);
+    }
+
+    return glm::normalize(glm::vec3(-slope, sample_spacing));
+}
+
+uint32_t Heightfield::columns() const {
+    return column_count;
+}
+
+uint32_t Heightfield::rows() const {
+    return row_count;
+}
+
+float Heightfield::spacing() const {
+    return sample_spacing;
+}
+
+glm::vec2 Heightfield::origin() const {
+    return grid_origin;
+}
+
+float Heightfield::minHeight() const {
+    return min_height;
+}
+
+float Heightfield::maxHeight() const {
+    return max_height;
+}
+
+void Heightfield::locate(glm::vec2 position, int64_t& column, int64_t& row, glm::vec2& fraction) const {
+    // clamped to the grid, where the surface is flat outside
+    auto grid = glm::clamp((position - grid_origin) / sample_spacing, glm::vec2(0.0f), glm::vec2(column_count - 1, row_count - 1));
+    auto cell = glm::floor(grid);
+    column = static_cast<int64_t>(cell.x);
+    row = static_cast<int64_t>(cell.y);
+    fraction = grid - cell;
+}
+
+}  // namespace geometry
+}  // namespace visualization
@@ -0,0 +1,58 @@
+#ifndef BB8_VISUALIZATION_GEOMETRY_HEIGHTFIELD_HPP
+#define BB8_VISUALIZATION_GEOMETRY_HEIGHTFIELD_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace geometry {
+
+// Regular grid of terrain heights over the xy plane, with z up. Each cell is split
+// into two triangles along its diagonal from the corner nearest the origin, which is
+// how the terrain renders it, so queries agree with what is drawn.
+class Heightfield {
+public:
+    // `heights` holds `columns` samples of each of `rows` rows in turn,
+    // `spacing` apart and starting at `origin`
+    Heightfield(uint32_t columns, uint32_t rows, float spacing, glm::vec2 origin, std::vector<float> heights);
+
+    // 8 or 16-bit grayscale image with a sample per pixel, black at `min_height`
+    // and white at `max_height`, centered on the origin
+    static Heightfield load(std::filesystem::path image_file, float spacing, float min_height, float max_height);
+
+    // sample of a column and row, the nearest edge sample outside the grid
+    float sample(int64_t column, int64_t row) const;
+
+    // height of the surface above a position, which continues flat past the edges
+    float height(glm::vec2 position) const;
+    // upward surface normal at a position
+    glm::vec3 normal(glm::vec2 position) const;
+
+    uint32_t columns() const;
+    uint32_t rows() const;
+    float spacing() const;
+    glm::vec2 origin() const;
+    float minHeight() const;
+    float maxHeight() const;
+
+private:
+    // cell containing a position, and the position within it in [0, 1]
+    void locate(glm::vec2 position, int64_t& column, int64_t& row, glm::vec2& fraction) const;
+
+    uint32_t column_count;
+    uint32_t row_count;
+    float sample_spacing;
+    glm::vec2 grid_origin;
+    std::vector<float> heights;
+
+    float min_height;
+    float max_height;
+};
+
+}  // namespace geometry
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_GEOMETRY_HEIGHTFIELD_HPP
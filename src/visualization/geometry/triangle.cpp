@@ -0,0 +1,105 @@
+#include "triangle.hpp"
+
+#include <cmath>
+
+namespace visualization {
+namespace geometry {
+
+Triangle Triangle::fromCorners(glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+    return Triangle{a, b - a, c - a};
+}
+
+glm::vec3 Triangle::corner(int index) const {
+    switch (index) {
+        case 1:
+            return v0 + e1;
+        case 2:
+            return v0 + e2;
+        default:
+            return v0;
+    }
+}
+
+glm::vec3 Triangle::normal() const {
+    return glm::normalize(glm::cross(e1, e2));
+}
+
+std::optional<Triangle::Hit> Triangle::intersect(const Ray& ray, float max_distance) const {
+    constexpr float parallel_epsilon = 1e-12f;
+
+    glm::vec3 p = glm::cross(ray.direction, e2);
+    float determinant = glm::dot(e1, p);
+    if (std::abs(determinant) < parallel_epsilon) {
+        return std::nullopt;
+    }
+    float inverse_determinant = 1.0f / determinant;
+
+    glm::vec3 s = ray.origin - v0;
+    float u = glm::dot(s, p) * inverse_determinant;
+    if (u < 0.0f || u > 1.0f) {
+        return std::nullopt;
+    }
+
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(ray.direction, q) * inverse_determinant;
+    if (v < 0.0f || u + v > 1.0f) {
+        return std::nullopt;
+    }
+
+    float distance = glm::dot(e2, q) * inverse_determinant;
+    if (distance < 0.0f || distance > max_distance) {
+        return std::nullopt;
+    }
+
+    return Hit{distance, glm::vec2(u, v)};
+}
+
+glm::vec3 Triangle::closestPoint(glm::vec3 point) const {
+    // Voronoi regions of the corners, then the edges, then the face,
+    // from Ericson's Real-Time Collision Detection
+    glm::vec3 a = v0;
+    glm::vec3 b = v0 + e1;
+    glm::vec3 c = v0 + e2;
+
+    glm::vec3 ap = point - a;
+    float d1 = glm::dot(e1, ap);
+    float d2 = glm::dot(e2, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        return a;
+    }
+
+    glm::vec3 bp = point - b;
+    float d3 = glm::dot(e1, bp);
+    float d4 = glm::dot(e2, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        return b;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return a + e1 * (d1 / (d1 - d3));
+    }
+
+    glm::vec3 cp = point - c;
+    float d5 = glm::dot(e1, cp);
+    float d6 = glm::dot(e2, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        return c;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return a + e2 * (d2 / (d2 - d6));
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    float denominator = 1.0f / (va + vb + vc);
+    return a + e1 * (vb * denominator) + e2 * (vc * denominator);
+}
+
+}  // namespace geometry
+}  // namespace visualization
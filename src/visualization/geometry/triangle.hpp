@@ -0,0 +1,47 @@
+#ifndef BB8_VISUALIZATION_GEOMETRY_TRIANGLE_HPP
+#define BB8_VISUALIZATION_GEOMETRY_TRIANGLE_HPP
+
+#include <optional>
+
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace geometry {
+
+class Ray {
+public:
+    glm::vec3 origin;
+    // needn't be normalized, distances along the ray are in multiples of its length
+    glm::vec3 direction;
+};
+
+// Triangle stored as a corner and two edges, the form ray tests need
+class Triangle {
+public:
+    class Hit {
+    public:
+        float distance;
+        // weights of the second and third corners
+        glm::vec2 barycentric;
+    };
+
+    static Triangle fromCorners(glm::vec3 a, glm::vec3 b, glm::vec3 c);
+
+    glm::vec3 corner(int index) const;
+    glm::vec3 normal() const;
+
+    // Moller-Trumbore, only hits within [0, max_distance] count, from either side
+    std::optional<Hit> intersect(const Ray& ray, float max_distance) const;
+
+    // point on the triangle, including its interior, closest to `point`
+    glm::vec3 closestPoint(glm::vec3 point) const;
+
+    glm::vec3 v0;
+    glm::vec3 e1;
+    glm::vec3 e2;
+};
+
+}  // namespace geometry
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_GEOMETRY_TRIANGLE_HPP
@@ -0,0 +1,396 @@
+#include "contact_generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace visualization {
+namespace physics {
+
+namespace {
+
+constexpr float infinity = std::numeric_limits<float>::infinity();
+
+// closer than this, the direction from a surface to the sphere's center is taken from the surface instead
+constexpr float min_separation = 1e-6f;
+
+int64_t floorDivide(int64_t value, int64_t divisor) {
+    return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+}
+
+}  // namespace
+
+ContactGenerator::ContactGenerator(const geometry::Heightfield* heightfield, std::vector<Mesh> input, Settings settings)
+    : heightfield(heightfield) {
+    if (!(settings.cell_size > 0.0f)) {
+        throw std::runtime_error("contact grid cell size must be positive");
+    }
+
+    meshes.reserve(input.size());
+    for (const auto& mesh : input) {
+        if (mesh.bvh == nullptr) {
+            throw std::runtime_error("contact mesh has no BVH");
+        }
+
+        float scale = glm::length(glm::vec3(mesh.pose[0]));
+        if (!(scale > 0.0f)) {
+            throw std::runtime_error("contact mesh pose must have a positive scale");
+        }
+
+        Bounds bounds{glm::vec3(infinity), glm::vec3(-infinity)};
+        for (uint32_t i = 0; i < mesh.bvh->triangleCount(); i++) {
+            const auto& triangle = mesh.bvh->triangle(i);
+            for (int corner = 0; corner < 3; corner++) {
+                auto position = glm::vec3(mesh.pose * glm::vec4(triangle.corner(corner), 1.0f));
+                bounds.min = glm::min(bounds.min, position);
+                bounds.max = glm::max(bounds.max, position);
+            }
+        }
+
+        meshes.push_back(Placement{mesh.bvh, mesh.pose, glm::inverse(mesh.pose), scale, bounds});
+    }
+
+    if (heightfield != nullptr) {
+        buildBlocks();
+    }
+    buildGrid(settings.cell_size);
+}
+
+size_t ContactGenerator::collide(glm::vec3 center, float radius, Contact* contacts, size_t capacity) const {
+    size_t count = 0;
+
+    if (heightfield != nullptr) {
+        collideHeightfield(center, radius, contacts, count, capacity);
+    }
+
+    if (cell_starts.empty()) {
+        return count;
+    }
+
+    auto query_min = glm::vec2(center) - radius;
+    auto query_max = glm::vec2(center) + radius;
+    auto grid_max = grid_origin + grid_cell_size * glm::vec2(grid_size);
+    if (glm::any(glm::lessThan(query_max, grid_origin)) || glm::any(glm::greaterThan(query_min, grid_max))) {
+        return count;
+    }
+
+    glm::ivec2 first = gridCell(query_min);
+    glm::ivec2 last = gridCell(query_max);
+    float radius_squared = radius * radius;
+
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            auto cell = static_cast<size_t>(y) * grid_size.x + x;
+            for (uint32_t i = cell_starts[cell]; i < cell_starts[cell + 1]; i++) {
+                uint32_t mesh = cell_meshes[i];
+                const auto& bounds = meshes[mesh].bounds;
+
+                auto bounds_min = glm::vec2(bounds.min);
+                auto bounds_max = glm::vec2(bounds.max);
+                if (glm::any(glm::lessThan(query_max, bounds_min)) || glm::any(glm::greaterThan(query_min, bounds_max))) {
+                    continue;
+                }
+
+                // meshes spanning several cells are only tested from the one holding the
+                // corner of their overlap with the query nearest the grid's origin
+                if (gridCell(glm::max(query_min, bounds_min)) != glm::ivec2(x, y)) {
+                    continue;
+                }
+
+                glm::vec3 offset = glm::clamp(center, bounds.min, bounds.max) - center;
+                if (glm::dot(offset, offset) > radius_squared) {
+                    continue;
+                }
+
+                collideMesh(mesh, center, radius, contacts, count, capacity);
+            }
+        }
+    }
+
+    return count;
+}
+
+size_t ContactGenerator::meshCount() const {
+    return meshes.size();
+}
+
+void ContactGenerator::buildBlocks() {
+    // cells lie between samples, so a grid of n samples has n - 1 cells
+    auto columns = static_cast<int64_t>(heightfield->columns());
+    auto rows = static_cast<int64_t>(heightfield->rows());
+    block_columns = std::max<int64_t>(1, (columns - 1 + block_cells - 1) / block_cells);
+    block_rows = std::max<int64_t>(1, (rows - 1 + block_cells - 1) / block_cells);
+
+    block_tops.assign(static_cast<size_t>(block_columns * block_rows), -infinity);
+    for (int64_t block_row = 0; block_row < block_rows; block_row++) {
+        for (int64_t block_column = 0; block_column < block_columns; block_column++) {
+            float& top = block_tops[block_row * block_columns + block_column];
+            for (int64_t row = block_row * block_cells; row <= (block_row + 1) * block_cells; row++) {
+                for (int64_t column = block_column * block_cells; column <= (block_column + 1) * block_cells; column++) {
+                    top = std::max(top, heightfield->sample(column, row));
+                }
+            }
+        }
+    }
+}
+
+void ContactGenerator::buildGrid(float cell_size) {
+    Bounds total{glm::vec3(infinity), glm::vec3(-infinity)};
+    for (const auto& mesh : meshes) {
+        total.min = glm::min(total.min, mesh.bounds.min);
+        total.max = glm::max(total.max, mesh.bounds.max);
+    }
+    // also leaves out meshes without triangles, whose bounds are inverted
+    if (!(total.min.x <= total.max.x)) {
+        return;
+    }
+
+    grid_origin = glm::vec2(total.min);
+    grid_cell_size = cell_size;
+    auto extent = glm::vec2(total.max) - grid_origin;
+    auto cellsAcross = [&](float length) {
+        return std::max(1, static_cast<int>(std::ceil(length / grid_cell_size)));
+    };
+    while (static_cast<size_t>(cellsAcross(extent.x)) * cellsAcross(extent.y) > max_grid_cells) {
+        grid_cell_size *= 2.0f;
+    }
+    grid_size = glm::ivec2(cellsAcross(extent.x), cellsAcross(extent.y));
+
+    // counted first, then filled, so each cell's meshes are contiguous
+    cell_starts.assign(static_cast<size_t>(grid_size.x) * grid_size.y + 1, 0);
+    auto forEachCell = [&](const Bounds& bounds, auto visit) {
+        if (!(bounds.min.x <= bounds.max.x)) {
+            return;
+        }
+        glm::ivec2 first = gridCell(glm::vec2(bounds.min));
+        glm::ivec2 last = gridCell(glm::vec2(bounds.max));
+        for (int y = first.y; y <= last.y; y++) {
+            for (int x = first.x; x <= last.x; x++) {
+                visit(static_cast<size_t>(y) * grid_size.x + x);
+            }
+        }
+    };
+
+    for (const auto& mesh : meshes) {
+        forEachCell(mesh.bounds, [&](size_t cell) { cell_starts[cell + 1]++; });
+    }
+    for (size_t cell = 1; cell < cell_starts.size(); cell++) {
+        cell_starts[cell] += cell_starts[cell - 1];
+    }
+
+    cell_meshes.resize(cell_starts.back());
+    std::vector<uint32_t> cursors(cell_starts.begin(), cell_starts.end() - 1);
+    for (uint32_t mesh = 0; mesh < meshes.size(); mesh++) {
+        forEachCell(meshes[mesh].bounds, [&](size_t cell) { cell_meshes[cursors[cell]++] = mesh; });
+    }
+}
+
+void ContactGenerator::collideHeightfield(glm::vec3 center, float radius, Contact* contacts, size_t& count, size_t capacity) const {
+    float radius_squared = radius * radius;
+    float reach = reachRadius(center, radius_squared, heightfield->maxHeight());
+    if (reach < 0.0f) {
+        return;
+    }
+
+    float spacing = heightfield->spacing();
+    glm::vec2 origin = heightfield->origin();
+
+    auto columnOf = [&](float x) {
+        return static_cast<int64_t>(std::floor((x - origin.x) / spacing));
+    };
+    auto rowOf = [&](float y) {
+        return static_cast<int64_t>(std::floor((y - origin.y) / spacing));
+    };
+    auto corner = [&](int64_t column, int64_t row) {
+        return origin + spacing * glm::vec2(static_cast<float>(column), static_cast<float>(row));
+    };
+
+    int64_t first_column = columnOf(center.x - reach);
+    int64_t last_column = columnOf(center.x + reach);
+    int64_t first_row = rowOf(center.y - reach);
+    int64_t last_row = rowOf(center.y + reach);
+
+    // only a center under the surface is pushed back up through it, one merely below the
+    // plane of a triangle, past a ridge, is pushed away from it as from any other surface
+    bool buried = center.z < heightfield->height(glm::vec2(center));
+
+    Candidates candidates;
+    for (int64_t block_row = floorDivide(first_row, block_cells); block_row <= floorDivide(last_row, block_cells); block_row++) {
+        for (int64_t block_column = floorDivide(first_column, block_cells); block_column <= floorDivide(last_column, block_cells); block_column++) {
+            // blocks past the edges have the heights of the edge blocks
+            auto top_index = std::clamp<int64_t>(block_row, 0, block_rows - 1) * block_columns + std::clamp<int64_t>(block_column, 0, block_columns - 1);
+            float block_reach = reachRadius(center, radius_squared, block_tops[top_index]);
+            if (block_reach < 0.0f) {
+                continue;
+            }
+
+            int64_t row_start = std::max({first_row, block_row * block_cells, rowOf(center.y - block_reach)});
+            int64_t row_end = std::min({last_row, block_row * block_cells + block_cells - 1, rowOf(center.y + block_reach)});
+            int64_t column_start = std::max(first_column, block_column * block_cells);
+            int64_t column_end = std::min(last_column, block_column * block_cells + block_cells - 1);
+
+            for (int64_t row = row_start; row <= row_end; row++) {
+                // only the cells of the row under the disc the sphere reaches below the block's top over
+                float row_min = corner(0, row).y;
+                float row_offset = std::max({0.0f, row_min - center.y, center.y - (row_min + spacing)});
+                float half_width = std::sqrt(std::max(0.0f, block_reach * block_reach - row_offset * row_offset));
+
+                int64_t row_column_end = std::min(column_end, columnOf(center.x + half_width));
+                for (int64_t column = std::max(column_start, columnOf(center.x - half_width)); column <= row_column_end; column++) {
+                    float h00 = heightfield->sample(column, row);
+                    float h10 = heightfield->sample(column + 1, row);
+                    float h01 = heightfield->sample(column, row + 1);
+                    float h11 = heightfield->sample(column + 1, row + 1);
+
+                    glm::vec2 cell_min = corner(column, row);
+                    glm::vec2 cell_max = corner(column + 1, row + 1);
+                    if (!reachesBelow(center, radius_squared, cell_min, cell_max, std::max(std::max(h00, h10), std::max(h01, h11)))) {
+                        continue;
+                    }
+
+                    // split along the same diagonal as the heightfield, both facing up
+                    auto p00 = glm::vec3(cell_min, h00);
+                    auto p10 = glm::vec3(cell_max.x, cell_min.y, h10);
+                    auto p01 = glm::vec3(cell_min.x, cell_max.y, h01);
+                    auto p11 = glm::vec3(cell_max, h11);
+                    addTriangle(geometry::Triangle::fromCorners(p00, p10, p11), center, radius, heightfield_shape, buried, candidates);
+                    addTriangle(geometry::Triangle::fromCorners(p00, p11, p01), center, radius, heightfield_shape, buried, candidates);
+                }
+            }
+        }
+    }
+
+    // a sphere that tunneled entirely below the surface touches no triangle
+    if (candidates.face_count == 0 && candidates.feature_count == 0) {
+        auto position = glm::vec2(center);
+        float height = heightfield->height(position);
+        if (center.z < height) {
+            glm::vec3 normal = heightfield->normal(position);
+            addContact(Contact{glm::vec3(position, height), normal, (height - center.z) * normal.z + radius, heightfield_shape}, contacts, count, capacity);
+        }
+        return;
+    }
+
+    addCandidates(candidates, plane_tolerance, contacts, count, capacity);
+}
+
+void ContactGenerator::collideMesh(uint32_t mesh, glm::vec3 center, float radius, Contact* contacts, size_t& count, size_t capacity) const {
+    const auto& placement = meshes[mesh];
+
+    auto local_center = glm::vec3(placement.inverse_pose * glm::vec4(center, 1.0f));
+    float local_radius = radius / placement.scale;
+
+    Candidates candidates;
+    placement.bvh->overlapSphere(local_center, local_radius, [&](uint32_t triangle) {
+        addTriangle(placement.bvh->triangle(triangle), local_center, local_radius, mesh, false, candidates);
+    });
+
+    auto toWorld = [&](Contact& contact) {
+        contact.point = glm::vec3(placement.pose * glm::vec4(contact.point, 1.0f));
+        contact.normal = glm::normalize(glm::vec3(placement.pose * glm::vec4(contact.normal, 0.0f)));
+        contact.depth *= placement.scale;
+    };
+    std::for_each(candidates.faces.begin(), candidates.faces.begin() + candidates.face_count, toWorld);
+    std::for_each(candidates.features.begin(), candidates.features.begin() + candidates.feature_count, toWorld);
+
+    // candidates were classified in model space, whose distances are scaled into world space
+    addCandidates(candidates, plane_tolerance * placement.scale, contacts, count, capacity);
+}
+
+float ContactGenerator::reachRadius(glm::vec3 center, float radius_squared, float top) {
+    float above = std::max(0.0f, center.z - top);
+    float reach_squared = radius_squared - above * above;
+    return reach_squared < 0.0f ? -1.0f : std::sqrt(reach_squared);
+}
+
+bool ContactGenerator::reachesBelow(glm::vec3 center, float radius_squared, glm::vec2 min, glm::vec2 max, float top) {
+    // the lowest point over the rectangle is below the center by sqrt(radius^2 - d^2), where d is its distance from the center
+    glm::vec2 offset = glm::clamp(glm::vec2(center), min, max) - glm::vec2(center);
+    float reach_squared = radius_squared - glm::dot(offset, offset);
+    if (reach_squared < 0.0f) {
+        return false;
+    }
+    float above = center.z - top;
+    return above <= 0.0f || above * above <= reach_squared;
+}
+
+void ContactGenerator::addTriangle(const geometry::Triangle& triangle, glm::vec3 center, float radius, uint32_t shape, bool buried, Candidates& candidates) {
+    glm::vec3 closest = triangle.closestPoint(center);
+    glm::vec3 offset = center - closest;
+    float distance_squared = glm::dot(offset, offset);
+    if (distance_squared > radius * radius) {
+        return;
+    }
+
+    // the closest point is on the face, rather than an edge or corner, when the offset is along the normal
+    glm::vec3 face_normal = triangle.normal();
+    float along = glm::dot(offset, face_normal);
+    glm::vec3 across = offset - along * face_normal;
+    bool face = glm::dot(across, across) <= plane_tolerance * plane_tolerance;
+
+    float distance = std::sqrt(distance_squared);
+    glm::vec3 normal = distance > min_separation ? offset / distance : face_normal;
+    float depth = radius - distance;
+    if (buried && along < 0.0f) {
+        normal = face || distance <= min_separation ? face_normal : -normal;
+        depth = radius + distance;
+    }
+    auto contact = Contact{closest, normal, depth, shape};
+
+    if (face) {
+        addContact(contact, candidates.faces.data(), candidates.face_count, candidates.faces.size());
+    } else {
+        addContact(contact, candidates.features.data(), candidates.feature_count, candidates.features.size());
+    }
+}
+
+void ContactGenerator::addCandidates(const Candidates& candidates, float tolerance, Contact* contacts, size_t& count, size_t capacity) {
+    for (size_t i = 0; i < candidates.face_count; i++) {
+        addContact(candidates.faces[i], contacts, count, capacity);
+    }
+
+    // edges and corners shared with a face the sphere touches give it nothing the face doesn't,
+    // and would push it sideways where the surface is flat
+    for (size_t i = 0; i < candidates.feature_count; i++) {
+        const auto& feature = candidates.features[i];
+        bool in_face_plane = std::any_of(candidates.faces.begin(), candidates.faces.begin() + candidates.face_count, [&](const Contact& face) {
+            return std::abs(glm::dot(feature.point - face.point, face.normal)) <= tolerance;
+        });
+        if (!in_face_plane) {
+            addContact(feature, contacts, count, capacity);
+        }
+    }
+}
+
+void ContactGenerator::addContact(const Contact& contact, Contact* contacts, size_t& count, size_t capacity) {
+    for (size_t i = 0; i < count; i++) {
+        if (contacts[i].shape == contact.shape && glm::dot(contacts[i].normal, contact.normal) > merge_cosine) {
+            if (contact.depth > contacts[i].depth) {
+                contacts[i] = contact;
+            }
+            return;
+        }
+    }
+
+    if (count < capacity) {
+        contacts[count++] = contact;
+        return;
+    }
+
+    auto shallowest = std::min_element(contacts, contacts + count, [](const Contact& a, const Contact& b) {
+        return a.depth < b.depth;
+    });
+    if (shallowest != contacts + count && contact.depth > shallowest->depth) {
+        *shallowest = contact;
+    }
+}
+
+glm::ivec2 ContactGenerator::gridCell(glm::vec2 position) const {
+    auto cell = glm::ivec2(glm::floor((position - grid_origin) / grid_cell_size));
+    return glm::clamp(cell, glm::ivec2(0), grid_size - 1);
+}
+
+}  // namespace physics
+}  // namespace visualization
@@ -0,0 +1,151 @@
+#ifndef BB8_VISUALIZATION_PHYSICS_CONTACT_GENERATOR_HPP
+#define BB8_VISUALIZATION_PHYSICS_CONTACT_GENERATOR_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../geometry/bvh.hpp"
+#include "../geometry/heightfield.hpp"
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace physics {
+
+// Contacts of spheres, such as the rolling body, against static terrain and meshes.
+//
+// The heightfield is queried in place, over the disc where the sphere's lower surface
+// reaches below the highest sample of the heightfield, then of each block of cells,
+// then of each cell, so a resting sphere only tests the few triangles right under it.
+// Meshes, such as the BVHs of models from Model::load, are placed with rigid poses and
+// found through a uniform grid over the ground plane, then queried in their own space
+// through their BVH. Contacts against coplanar triangles are merged, and contacts with
+// the edges and corners of triangles are dropped where they lie in the plane of a face
+// the sphere touches, so a sphere resting on a flat patch reports one contact however
+// many triangles it touches.
+//
+// Nothing is allocated or changed by a query, so any number of threads can query one
+// generator at once.
+class ContactGenerator {
+public:
+    class Settings {
+    public:
+        // side of the grid cells meshes are indexed in, around the size of a typical mesh
+        float cell_size = 4.0f;
+    };
+
+    class Mesh {
+    public:
+        // must outlive the generator
+        const geometry::Bvh* bvh;
+        // model space to world space, rigid with an optional uniform scale
+        glm::mat4 pose;
+    };
+
+    class Contact {
+    public:
+        // on the shape's surface
+        glm::vec3 point;
+        // unit direction pushing the sphere out of the shape
+        glm::vec3 normal;
+        // how far the sphere reaches into the shape along the normal
+        float depth;
+        // index of the mesh touched, or `heightfield_shape`
+        uint32_t shape;
+    };
+
+    static constexpr uint32_t heightfield_shape = ~0u;
+
+    // `heightfield` may be null, and must otherwise outlive the generator
+    ContactGenerator(const geometry::Heightfield* heightfield, std::vector<Mesh> meshes, Settings settings);
+
+    // Writes the contacts of a sphere to `contacts` and returns how many there are, at most
+    // `capacity`. When there are more, the deepest are kept.
+    size_t collide(glm::vec3 center, float radius, Contact* contacts, size_t capacity) const;
+
+    size_t meshCount() const;
+
+private:
+    class Bounds {
+    public:
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // distinct contacts with one shape of each kind, past which the deepest are kept
+    static constexpr size_t max_candidates = 16;
+
+    // contacts with one shape, with those against triangle faces kept apart from those
+    // against edges and corners until the latter can be checked against the former
+    class Candidates {
+    public:
+        std::array<Contact, max_candidates> faces;
+        size_t face_count = 0;
+        std::array<Contact, max_candidates> features;
+        size_t feature_count = 0;
+    };
+
+    class Placement {
+    public:
+        const geometry::Bvh* bvh;
+        glm::mat4 pose;
+        glm::mat4 inverse_pose;
+        float scale;
+        Bounds bounds;
+    };
+
+    // heightfield cells per side of a block, whose highest sample is kept to skip it whole
+    static constexpr int64_t block_cells = 8;
+    // meshes are indexed in at most this many grid cells, which are made larger to fit
+    static constexpr size_t max_grid_cells = size_t(1) << 20;
+    // contacts on the same shape whose normals are closer than this cosine are merged, about 2.5 degrees
+    static constexpr float merge_cosine = 0.999f;
+    // distance within which a closest point counts as on a triangle's face, or an edge in a face's plane
+    static constexpr float plane_tolerance = 1e-4f;
+
+    void buildBlocks();
+    void buildGrid(float cell_size);
+
+    void collideHeightfield(glm::vec3 center, float radius, Contact* contacts, size_t& count, size_t capacity) const;
+    void collideMesh(uint32_t mesh, glm::vec3 center, float radius, Contact* contacts, size_t& count, size_t capacity) const;
+
+    // radius of the disc of the ground plane over which the sphere's surface reaches below
+    // `top`, or negative when it doesn't reach below it anywhere
+    static float reachRadius(glm::vec3 center, float radius_squared, float top);
+    // whether the sphere's surface reaches below `top` anywhere over the rectangle [min, max] of the ground plane
+    static bool reachesBelow(glm::vec3 center, float radius_squared, glm::vec2 min, glm::vec2 max, float top);
+
+    // Adds the contact of a sphere touching a triangle to the candidates. With its center
+    // `buried` under a solid surface and below the triangle's plane, the sphere is pushed
+    // back up through the triangle, whether it touches the face, an edge or a corner.
+    static void addTriangle(const geometry::Triangle& triangle, glm::vec3 center, float radius, uint32_t shape, bool buried, Candidates& candidates);
+    // adds the face candidates, and the others that don't lie within `tolerance` of the plane of a face.
+    // The tolerance is plane_tolerance in the units the candidates were classified in
+    static void addCandidates(const Candidates& candidates, float tolerance, Contact* contacts, size_t& count, size_t capacity);
+
+    // merges a contact with one of the same shape and normal, or adds it, replacing the
+    // shallowest when full
+    static void addContact(const Contact& contact, Contact* contacts, size_t& count, size_t capacity);
+
+    // grid cell containing a position, the nearest edge cell outside the grid
+    glm::ivec2 gridCell(glm::vec2 position) const;
+
+    const geometry::Heightfield* heightfield;
+    // highest sample of each block, including the samples on its far edges
+    int64_t block_columns = 0;
+    int64_t block_rows = 0;
+    std::vector<float> block_tops;
+
+    std::vector<Placement> meshes;
+    glm::vec2 grid_origin = glm::vec2(0.0f);
+    float grid_cell_size = 1.0f;
+    glm::ivec2 grid_size = glm::ivec2(0);
+    // meshes overlapping each cell are cell_meshes[cell_starts[cell], cell_starts[cell + 1])
+    std::vector<uint32_t> cell_starts;
+    std::vector<uint32_t> cell_meshes;
+};
+
+}  // namespace physics
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_PHYSICS_CONTACT_GENERATOR_HPP
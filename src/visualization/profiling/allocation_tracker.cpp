@@ -0,0 +1,269 @@
+#include "allocation_tracker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define BB8_HAS_BACKTRACE
+#endif
+
+namespace visualization {
+namespace profiling {
+
+namespace {
+
+constexpr size_t max_samples = 64;
+// operator new and recordAllocation, which every sampled stack starts with
+constexpr uint32_t hook_frames = 2;
+
+// trivially constructible, so thread-local storage is set up without allocating
+thread_local AllocationTracker::Counters thread_counters;
+thread_local uint32_t allocations_since_sample = 0;
+// set while a sample is taken, since capturing a stack can allocate itself
+thread_local bool sampling = false;
+
+std::atomic<uint64_t> total_allocations{0};
+std::atomic<uint64_t> total_deallocations{0};
+std::atomic<uint64_t> total_bytes{0};
+std::atomic<uint32_t> sampling_interval{0};
+
+std::mutex samples_mutex;
+std::array<AllocationTracker::Sample, max_samples> sample_ring;
+// samples ever recorded, the ring holds the latest
+size_t samples_recorded = 0;
+
+}  // namespace
+
+AllocationTracker::Counters AllocationTracker::Counters::operator-(const Counters& other) const {
+    Counters difference;
+    difference.allocations = allocations - other.allocations;
+    difference.deallocations = deallocations - other.deallocations;
+    difference.bytes = bytes - other.bytes;
+    return difference;
+}
+
+bool AllocationTracker::isEnabled() {
+#ifdef BB8_ALLOCATION_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationTracker::Counters AllocationTracker::thisThread() {
+    return thread_counters;
+}
+
+AllocationTracker::Counters AllocationTracker::total() {
+    Counters counters;
+    counters.allocations = total_allocations.load(std::memory_order_relaxed);
+    counters.deallocations = total_deallocations.load(std::memory_order_relaxed);
+    counters.bytes = total_bytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void AllocationTracker::setSamplingInterval(uint32_t interval) {
+    sampling_interval.store(interval, std::memory_order_relaxed);
+}
+
+std::vector<AllocationTracker::Sample> AllocationTracker::samples() {
+    // copied out before allocating the result, since that allocation may be sampled too
+    std::array<Sample, max_samples> latest;
+    size_t count;
+    {
+        std::lock_guard<std::mutex> lock(samples_mutex);
+        count = std::min(samples_recorded, max_samples);
+        for (size_t i = 0; i < count; i++) {
+            latest[i] = sample_ring[(samples_recorded - count + i) % max_samples];
+        }
+    }
+
+    return std::vector<Sample>(latest.begin(), latest.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+void AllocationTracker::clearSamples() {
+    std::lock_guard<std::mutex> lock(samples_mutex);
+    samples_recorded = 0;
+}
+
+void AllocationTracker::writeSamples(std::ostream& out) {
+    for (const auto& sample : samples()) {
+        out << "allocation of " << sample.size << " bytes\n";
+
+#ifdef BB8_HAS_BACKTRACE
+        char** symbols = backtrace_symbols(sample.frames.data(), static_cast<int>(sample.depth));
+        for (uint32_t i = std::min(hook_frames, sample.depth); i < sample.depth; i++) {
+            out << "    " << (symbols != nullptr ? symbols[i] : "?") << "\n";
+        }
+        std::free(symbols);
+#else
+        out << "    (call stacks unavailable on this platform)\n";
+#endif
+    }
+}
+
+void AllocationTracker::recordAllocation(size_t size) {
+    thread_counters.allocations += 1;
+    thread_counters.bytes += size;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+    total_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    uint32_t interval = sampling_interval.load(std::memory_order_relaxed);
+    if (interval == 0 || sampling || ++allocations_since_sample < interval) {
+        return;
+    }
+    allocations_since_sample = 0;
+    sampling = true;
+
+    Sample sample;
+    sample.size = size;
+#ifdef BB8_HAS_BACKTRACE
+    sample.depth = static_cast<uint32_t>(backtrace(sample.frames.data(), static_cast<int>(max_sample_depth)));
+#else
+    sample.depth = 0;
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(samples_mutex);
+        sample_ring[samples_recorded % max_samples] = sample;
+        samples_recorded += 1;
+    }
+
+    sampling = false;
+}
+
+void AllocationTracker::recordDeallocation() {
+    thread_counters.deallocations += 1;
+    total_deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope() : start(AllocationTracker::thisThread()) {}
+
+AllocationTracker::Counters AllocationScope::counted() const {
+    return AllocationTracker::thisThread() - start;
+}
+
+}  // namespace profiling
+}  // namespace visualization
+
+#ifdef BB8_ALLOCATION_TRACKING
+
+// Replacement global allocation functions, forwarding to malloc and free.
+// Every replaceable form is defined, so no allocation bypasses the counters.
+
+namespace {
+
+void* allocate(std::size_t size) {
+    visualization::profiling::AllocationTracker::recordAllocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    visualization::profiling::AllocationTracker::recordAllocation(size);
+
+    // aligned_alloc requires the size to be a multiple of the alignment
+    auto align = static_cast<std::size_t>(alignment);
+    std::size_t padded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    return std::aligned_alloc(align, padded);
+}
+
+void deallocate(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        visualization::profiling::AllocationTracker::recordDeallocation();
+        std::free(pointer);
+    }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (void* pointer = allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* pointer = allocateAligned(size, alignment)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate(pointer);
+}
+
+#endif  // BB8_ALLOCATION_TRACKING
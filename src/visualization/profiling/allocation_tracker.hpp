@@ -0,0 +1,70 @@
+#ifndef BB8_VISUALIZATION_PROFILING_ALLOCATION_TRACKER_HPP
+#define BB8_VISUALIZATION_PROFILING_ALLOCATION_TRACKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace visualization {
+namespace profiling {
+
+// Counts heap allocations made through operator new, per thread and in total,
+// and optionally samples the call stacks making them. Counting is done by
+// replacement global operator new/delete, which are only compiled in with the
+// allocation_tracking build option; otherwise all counters stay zero.
+class AllocationTracker {
+public:
+    static constexpr size_t max_sample_depth = 24;
+
+    class Counters {
+    public:
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t bytes = 0;
+
+        Counters operator-(const Counters& other) const;
+    };
+
+    class Sample {
+    public:
+        size_t size;
+        uint32_t depth;
+        std::array<void*, max_sample_depth> frames;
+    };
+
+    static bool isEnabled();
+
+    // allocations by the calling thread since it started
+    static Counters thisThread();
+    static Counters total();
+
+    // records the call stack of every `interval`th allocation on each thread, zero disables sampling.
+    // Only the most recent samples are kept
+    static void setSamplingInterval(uint32_t interval);
+    static std::vector<Sample> samples();
+    static void clearSamples();
+    // samples with symbolized call stacks
+    static void writeSamples(std::ostream& out);
+
+    // called by the operator new and delete replacements
+    static void recordAllocation(size_t size);
+    static void recordDeallocation();
+};
+
+// Allocations made by the current thread during the scope's lifetime
+class AllocationScope {
+public:
+    AllocationScope();
+
+    AllocationTracker::Counters counted() const;
+
+private:
+    AllocationTracker::Counters start;
+};
+
+}  // namespace profiling
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_PROFILING_ALLOCATION_TRACKER_HPP
@@ -0,0 +1,121 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace visualization {
+namespace profiling {
+
+Metrics::Counter::Counter(MetricsSegment::Metric* slot) : slot(slot) {}
+
+void Metrics::Counter::add(uint64_t amount) const {
+    if (slot != nullptr) {
+        slot->value.fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+Metrics::Gauge::Gauge(MetricsSegment::Metric* slot) : slot(slot) {}
+
+void Metrics::Gauge::set(double value) const {
+    if (slot != nullptr) {
+        slot->value.store(MetricsSegment::toBits(value), std::memory_order_relaxed);
+    }
+}
+
+Metrics::Histogram::Histogram(MetricsSegment::Histogram* slot) : slot(slot) {}
+
+void Metrics::Histogram::record(double value) const {
+    if (slot == nullptr) {
+        return;
+    }
+
+    auto bounds_end = slot->bounds.begin() + slot->bound_count;
+    auto bucket = std::lower_bound(slot->bounds.begin(), bounds_end, value) - slot->bounds.begin();
+    slot->buckets[static_cast<size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+
+    // only one thread records each histogram in practice, so this rarely retries
+    uint64_t sum = slot->sum.load(std::memory_order_relaxed);
+    while (!slot->sum.compare_exchange_weak(sum, MetricsSegment::toBits(MetricsSegment::fromBits(sum) + value), std::memory_order_relaxed)) {
+    }
+    slot->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+Metrics::Metrics(const std::string& segment_name)
+    : segment(MetricsSegment::create(segment_name, metric_capacity, histogram_capacity)) {}
+
+Metrics::Counter Metrics::counter(std::string_view name) {
+    return Counter(&addMetric(name, MetricsSegment::Kind::counter));
+}
+
+Metrics::Gauge Metrics::gauge(std::string_view name) {
+    return Gauge(&addMetric(name, MetricsSegment::Kind::gauge));
+}
+
+Metrics::Histogram Metrics::histogram(std::string_view name, const std::vector<double>& bounds) {
+    if (bounds.size() > MetricsSegment::max_bounds) {
+        throw std::runtime_error("histogram " + std::string(name) + " has too many buckets");
+    }
+    if (!std::is_sorted(bounds.begin(), bounds.end())) {
+        throw std::runtime_error("histogram " + std::string(name) + " bounds aren't ascending");
+    }
+
+    std::lock_guard<std::mutex> lock(registration_mutex);
+
+    auto& header = segment.header();
+    uint32_t index = header.histogram_count.load(std::memory_order_relaxed);
+    if (index == header.histogram_capacity) {
+        throw std::runtime_error("too many histograms for the metrics segment");
+    }
+
+    auto& slot = segment.histogram(index);
+    copyName(name, slot.name);
+    slot.bound_count = static_cast<uint32_t>(bounds.size());
+    std::copy(bounds.begin(), bounds.end(), slot.bounds.begin());
+
+    // publishes the slot to readers
+    header.histogram_count.store(index + 1, std::memory_order_release);
+    return Histogram(&slot);
+}
+
+std::vector<double> Metrics::exponentialBounds(double first, double factor, size_t count) {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+
+    double bound = first;
+    for (size_t i = 0; i < count; i++) {
+        bounds.push_back(bound);
+        bound *= factor;
+    }
+
+    return bounds;
+}
+
+MetricsSegment::Metric& Metrics::addMetric(std::string_view name, MetricsSegment::Kind kind) {
+    std::lock_guard<std::mutex> lock(registration_mutex);
+
+    auto& header = segment.header();
+    uint32_t index = header.metric_count.load(std::memory_order_relaxed);
+    if (index == header.metric_capacity) {
+        throw std::runtime_error("too many metrics for the metrics segment");
+    }
+
+    auto& slot = segment.metric(index);
+    copyName(name, slot.name);
+    slot.kind = kind;
+
+    // publishes the slot to readers
+    header.metric_count.store(index + 1, std::memory_order_release);
+    return slot;
+}
+
+void Metrics::copyName(std::string_view name, std::array<char, MetricsSegment::name_length>& destination) {
+    if (name.size() >= destination.size()) {
+        throw std::runtime_error("metric name " + std::string(name) + " is too long");
+    }
+
+    std::copy(name.begin(), name.end(), destination.begin());
+    destination[name.size()] = '\0';
+}
+
+}  // namespace profiling
+}  // namespace visualization
@@ -0,0 +1,96 @@
+#ifndef BB8_VISUALIZATION_PROFILING_METRICS_HPP
+#define BB8_VISUALIZATION_PROFILING_METRICS_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "metrics_segment.hpp"
+
+namespace visualization {
+namespace profiling {
+
+// Registry of counters, gauges and histograms published into a shared-memory
+// segment (see MetricsSegment for its layout), for external monitoring.
+// Registering takes a lock, but updating a metric is a few atomic operations
+// on mapped memory, without system calls, locks or allocation, so metrics can
+// be updated from the render loop. Handles of a registry that was never created
+// are no-ops.
+class Metrics {
+public:
+    class Counter {
+    public:
+        Counter() = default;
+
+        void add(uint64_t amount = 1) const;
+
+    private:
+        friend class Metrics;
+        explicit Counter(MetricsSegment::Metric* slot);
+
+        MetricsSegment::Metric* slot = nullptr;
+    };
+
+    class Gauge {
+    public:
+        Gauge() = default;
+
+        void set(double value) const;
+
+    private:
+        friend class Metrics;
+        explicit Gauge(MetricsSegment::Metric* slot);
+
+        MetricsSegment::Metric* slot = nullptr;
+    };
+
+    class Histogram {
+    public:
+        Histogram() = default;
+
+        void record(double value) const;
+
+    private:
+        friend class Metrics;
+        explicit Histogram(MetricsSegment::Histogram* slot);
+
+        MetricsSegment::Histogram* slot = nullptr;
+    };
+
+    static constexpr uint32_t metric_capacity = 64;
+    static constexpr uint32_t histogram_capacity = 16;
+
+    // creates the segment `segment_name`, which is removed when the registry is destroyed
+    explicit Metrics(const std::string& segment_name = MetricsSegment::default_name);
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    Metrics(Metrics&&) = delete;
+    Metrics& operator=(Metrics&&) = delete;
+
+    ~Metrics() = default;
+
+    // throw if the segment is full, or the name is too long
+    Counter counter(std::string_view name);
+    Gauge gauge(std::string_view name);
+    // `bounds` are ascending bucket upper bounds, at most MetricsSegment::max_bounds of them
+    Histogram histogram(std::string_view name, const std::vector<double>& bounds);
+
+    // bucket bounds growing by `factor` from `first`, e.g. for latencies
+    static std::vector<double> exponentialBounds(double first, double factor, size_t count);
+
+private:
+    MetricsSegment::Metric& addMetric(std::string_view name, MetricsSegment::Kind kind);
+    static void copyName(std::string_view name, std::array<char, MetricsSegment::name_length>& destination);
+
+    std::mutex registration_mutex;
+    MetricsSegment segment;
+};
+
+}  // namespace profiling
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_PROFILING_METRICS_HPP
@@ -0,0 +1,224 @@
+#include "metrics_segment.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <optional>
+#include <signal.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace visualization {
+namespace profiling {
+
+namespace {
+
+std::runtime_error segmentError(const std::string& message, const std::string& name) {
+    return std::runtime_error(message + " " + name + ": " + std::strerror(errno));
+}
+
+// process id of the writer of an existing segment, if that process is still running
+std::optional<pid_t> liveWriter(const std::string& name) {
+    int descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (descriptor < 0) {
+        return std::nullopt;
+    }
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(MetricsSegment::Header)) {
+        mapping = mmap(nullptr, sizeof(MetricsSegment::Header), PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+
+    if (mapping == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    const auto* header = static_cast<const MetricsSegment::Header*>(mapping);
+    std::optional<pid_t> writer;
+    if (header->magic == MetricsSegment::magic) {
+        writer = static_cast<pid_t>(header->writer_pid);
+    }
+    munmap(mapping, sizeof(MetricsSegment::Header));
+
+    // EPERM means the process exists but belongs to another user
+    if (writer.has_value() && (kill(*writer, 0) == 0 || errno == EPERM)) {
+        return writer;
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+MetricsSegment MetricsSegment::create(const std::string& name, uint32_t metric_capacity, uint32_t histogram_capacity) {
+    if (auto writer = liveWriter(name)) {
+        throw std::runtime_error("metrics segment " + name + " is in use by process " + std::to_string(*writer));
+    }
+
+    // a segment left by a writer that crashed would otherwise keep its old size and contents
+    shm_unlink(name.c_str());
+
+    int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (descriptor < 0) {
+        throw segmentError("failed to create metrics segment", name);
+    }
+
+    size_t mapping_size = size(metric_capacity, histogram_capacity);
+    void* mapping = MAP_FAILED;
+    if (ftruncate(descriptor, static_cast<off_t>(mapping_size)) == 0) {
+        mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+
+    if (mapping == MAP_FAILED) {
+        auto error = segmentError("failed to map metrics segment", name);
+        shm_unlink(name.c_str());
+        throw error;
+    }
+
+    auto segment = MetricsSegment(name, mapping, mapping_size, true);
+
+    // memory is zeroed by ftruncate, but the atomics still need constructing
+    auto* header = new (mapping) Header();
+    header->metric_capacity = metric_capacity;
+    header->histogram_capacity = histogram_capacity;
+    for (uint32_t index = 0; index < metric_capacity; index++) {
+        new (&segment.metric(index)) Metric();
+    }
+    for (uint32_t index = 0; index < histogram_capacity; index++) {
+        new (&segment.histogram(index)) Histogram();
+    }
+
+    header->version = version;
+    header->writer_pid = static_cast<uint32_t>(getpid());
+    auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    header->created_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+    // readers check the magic number first, so it's written once the rest of the header is
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = magic;
+
+    return segment;
+}
+
+MetricsSegment MetricsSegment::open(const std::string& name) {
+    int descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (descriptor < 0) {
+        throw segmentError("failed to open metrics segment", name);
+    }
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    size_t mapping_size = 0;
+    if (fstat(descriptor, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(Header)) {
+        mapping_size = static_cast<size_t>(status.st_size);
+        mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("failed to map metrics segment " + name);
+    }
+
+    auto segment = MetricsSegment(name, mapping, mapping_size, false);
+
+    const auto& header = segment.header();
+    if (header.magic != magic || header.version != version) {
+        throw std::runtime_error(name + " isn't a version " + std::to_string(version) + " metrics segment");
+    }
+    if (size(header.metric_capacity, header.histogram_capacity) > mapping_size) {
+        throw std::runtime_error("metrics segment " + name + " is truncated");
+    }
+
+    return segment;
+}
+
+MetricsSegment::MetricsSegment(std::string name, void* mapping, size_t mapping_size, bool owner)
+    : name(std::move(name)), mapping(mapping), mapping_size(mapping_size), owner(owner) {}
+
+MetricsSegment::MetricsSegment(MetricsSegment&& other)
+    : name(std::move(other.name)),
+      mapping(std::exchange(other.mapping, nullptr)),
+      mapping_size(other.mapping_size),
+      owner(std::exchange(other.owner, false)) {}
+
+MetricsSegment& MetricsSegment::operator=(MetricsSegment&& other) {
+    if (this != &other) {
+        unmap();
+
+        name = std::move(other.name);
+        mapping = std::exchange(other.mapping, nullptr);
+        mapping_size = other.mapping_size;
+        owner = std::exchange(other.owner, false);
+    }
+
+    return *this;
+}
+
+MetricsSegment::~MetricsSegment() {
+    unmap();
+}
+
+const MetricsSegment::Header& MetricsSegment::header() const {
+    return *static_cast<const Header*>(mapping);
+}
+
+MetricsSegment::Header& MetricsSegment::header() {
+    return *static_cast<Header*>(mapping);
+}
+
+const MetricsSegment::Metric& MetricsSegment::metric(uint32_t index) const {
+    auto* metrics = reinterpret_cast<const Metric*>(static_cast<const std::byte*>(mapping) + sizeof(Header));
+    return metrics[index];
+}
+
+MetricsSegment::Metric& MetricsSegment::metric(uint32_t index) {
+    return const_cast<Metric&>(std::as_const(*this).metric(index));
+}
+
+const MetricsSegment::Histogram& MetricsSegment::histogram(uint32_t index) const {
+    auto offset = sizeof(Header) + header().metric_capacity * sizeof(Metric);
+    auto* histograms = reinterpret_cast<const Histogram*>(static_cast<const std::byte*>(mapping) + offset);
+    return histograms[index];
+}
+
+MetricsSegment::Histogram& MetricsSegment::histogram(uint32_t index) {
+    return const_cast<Histogram&>(std::as_const(*this).histogram(index));
+}
+
+uint64_t MetricsSegment::toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double MetricsSegment::fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t MetricsSegment::size(uint32_t metric_capacity, uint32_t histogram_capacity) {
+    return sizeof(Header) + metric_capacity * sizeof(Metric) + histogram_capacity * sizeof(Histogram);
+}
+
+void MetricsSegment::unmap() {
+    if (mapping == nullptr) {
+        return;
+    }
+
+    munmap(mapping, mapping_size);
+    mapping = nullptr;
+    if (owner) {
+        shm_unlink(name.c_str());
+        owner = false;
+    }
+}
+
+}  // namespace profiling
+}  // namespace visualization
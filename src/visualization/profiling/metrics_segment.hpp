@@ -0,0 +1,129 @@
+#ifndef BB8_VISUALIZATION_PROFILING_METRICS_SEGMENT_HPP
+#define BB8_VISUALIZATION_PROFILING_METRICS_SEGMENT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace visualization {
+namespace profiling {
+
+// A POSIX shared-memory segment metrics are published into, mapped by the
+// process writing them and by any number of readers.
+//
+// Layout, version 1. Integers and doubles are in the writer's native byte order:
+//
+//   Header                                   at offset 0
+//   Metric[header.metric_capacity]           at offset sizeof(Header)
+//   Histogram[header.histogram_capacity]     after the metrics
+//
+// Slots are filled in order. A slot's name, kind and bounds are written before
+// the matching count in the header is incremented with release ordering, so
+// readers loading the count with acquire ordering only see complete slots.
+// Values are only written with atomic stores and read-modify-writes, so readers
+// may map the segment read-only and read it at any time, without locking.
+class MetricsSegment {
+public:
+    static constexpr uint32_t magic = 0x4d384242;  // "BB8M"
+    static constexpr uint32_t version = 1;
+    // including the terminating null
+    static constexpr size_t name_length = 48;
+    // histograms have an overflow bucket beyond their last bound
+    static constexpr size_t max_bounds = 15;
+    static constexpr size_t bucket_count = max_bounds + 1;
+
+    enum class Kind : uint32_t {
+        // monotonically increasing count
+        counter = 0,
+        // double, stored as its bits
+        gauge = 1,
+    };
+
+    class Header {
+    public:
+        uint32_t magic;
+        uint32_t version;
+        uint32_t metric_capacity;
+        uint32_t histogram_capacity;
+        std::atomic<uint32_t> metric_count;
+        std::atomic<uint32_t> histogram_count;
+        uint32_t writer_pid;
+        uint32_t reserved;
+        // when the writer created the segment, in nanoseconds since the Unix epoch
+        uint64_t created_ns;
+    };
+
+    class Metric {
+    public:
+        std::array<char, name_length> name;
+        Kind kind;
+        uint32_t reserved;
+        std::atomic<uint64_t> value;
+    };
+
+    // values are counted in the first bucket whose upper bound they don't exceed
+    class Histogram {
+    public:
+        std::array<char, name_length> name;
+        uint32_t bound_count;
+        uint32_t reserved;
+        std::array<double, max_bounds> bounds;
+        // bound_count + 1 are used, the last counting values above every bound
+        std::array<std::atomic<uint64_t>, bucket_count> buckets;
+        std::atomic<uint64_t> count;
+        // double, stored as its bits
+        std::atomic<uint64_t> sum;
+    };
+
+    static constexpr const char* default_name = "/bb8_metrics";
+
+    // creates the segment `name`, replacing any left behind by a writer that has exited, and removes it once
+    // destroyed. Throws if the writer of an existing segment is still running
+    static MetricsSegment create(const std::string& name, uint32_t metric_capacity, uint32_t histogram_capacity);
+    // maps an existing segment read-only, throws if it doesn't exist or has an unknown layout
+    static MetricsSegment open(const std::string& name);
+
+    MetricsSegment(const MetricsSegment&) = delete;
+    MetricsSegment& operator=(const MetricsSegment&) = delete;
+
+    MetricsSegment(MetricsSegment&& other);
+    MetricsSegment& operator=(MetricsSegment&& other);
+
+    ~MetricsSegment();
+
+    const Header& header() const;
+    Header& header();
+
+    const Metric& metric(uint32_t index) const;
+    Metric& metric(uint32_t index);
+    const Histogram& histogram(uint32_t index) const;
+    Histogram& histogram(uint32_t index);
+
+    static uint64_t toBits(double value);
+    static double fromBits(uint64_t bits);
+
+    static size_t size(uint32_t metric_capacity, uint32_t histogram_capacity);
+
+private:
+    MetricsSegment(std::string name, void* mapping, size_t mapping_size, bool owner);
+
+    void unmap();
+
+    std::string name;
+    void* mapping;
+    size_t mapping_size;
+    // the writer unlinks the segment once it's done
+    bool owner;
+};
+
+// readers need lock-free atomics to share them across processes
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+}  // namespace profiling
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_PROFILING_METRICS_SEGMENT_HPP
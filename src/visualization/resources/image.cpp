@@ -23,6 +23,10 @@ Image Image::load(std::filesystem::path image_file) {
     return Image(pixels, width, height, desired_channels);
 }
 
+Image::Image(Image&& other) : pixel_data(other.pixel_data), dimensions(other.dimensions) {
+    other.pixel_data = nullptr;
+}
+
 Image::~Image() {
     stbi_image_free(pixel_data);
 }
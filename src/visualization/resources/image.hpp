@@ -11,6 +11,13 @@ class Image {
 public:
     static Image load(std::filesystem::path image_file);
 
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    // decoded images are handed between threads, the moved-from image owns nothing
+    Image(Image&& other);
+    Image& operator=(Image&&) = delete;
+
     ~Image();
 
     const unsigned char* data() const;
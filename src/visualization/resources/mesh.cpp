@@ -0,0 +1,146 @@
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#include "mesh_simplifier.hpp"
+#include "meshlet_builder.hpp"
+
+namespace visualization {
+namespace resources {
+
+Mesh Mesh::load(std::filesystem::path obj_file) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    auto file_string = obj_file.string();
+    const char* file = file_string.c_str();
+    bool success = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file);
+    if (!success) {
+        throw std::runtime_error(warn + err);
+    }
+
+    std::vector<vulkan::shaders::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::unordered_map<vulkan::shaders::Vertex, uint32_t> vertex_indices{};
+
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            glm::vec3 position = {
+                attrib.vertices[3 * index.vertex_index + 0],
+                attrib.vertices[3 * index.vertex_index + 1],
+                attrib.vertices[3 * index.vertex_index + 2]};
+            glm::vec2 texture_coordinate = {
+                attrib.texcoords[2 * index.texcoord_index + 0],
+                // OBJ uses (0, 0) as lower left corner, need to invert
+                1.0 - attrib.texcoords[2 * index.texcoord_index + 1]};
+            glm::vec3 color = {1.0f, 1.0f, 1.0f};
+
+            // if we already have seen vertex, reference previous copy
+            auto vertex = vulkan::shaders::Vertex(position, color, texture_coordinate);
+            if (vertex_indices.count(vertex) == 0) {
+                vertices.push_back(vertex);
+                vertex_indices[vertex] = vertices.size() - 1;
+            }
+
+            indices.push_back(vertex_indices[vertex]);
+        }
+    }
+
+    return Mesh(std::move(vertices), std::move(indices));
+}
+
+void Mesh::generateLods(size_t count) {
+    const auto& full_detail = lods.front();
+    auto simplifier = MeshSimplifier(vertices, std::vector<uint32_t>(indices.begin(), indices.begin() + full_detail.index_count));
+
+    size_t previous_triangles = full_detail.index_count / 3;
+    for (size_t level = 0; level < count; level++) {
+        size_t target_triangles = previous_triangles / 2;
+        float max_error = max_relative_error * bounds_radius;
+        auto min_reduction = static_cast<size_t>((1.0f - min_lod_reduction) * previous_triangles);
+
+        simplifier.simplify(target_triangles, max_error, true);
+        if (simplifier.triangleCount() > min_reduction) {
+            // heavily seamed meshes (e.g. scanned texture atlases) stall when seams are preserved,
+            // texture stretching is acceptable at the distances coarse levels are used at
+            simplifier.simplify(target_triangles, max_error, false);
+        }
+
+        size_t triangles = simplifier.triangleCount();
+        if (triangles > min_reduction) {
+            break;
+        }
+
+        const auto& simplified = simplifier.getIndices();
+        auto first_index = static_cast<uint32_t>(indices.size());
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+        lods.push_back(Lod{first_index, static_cast<uint32_t>(simplified.size()), simplifier.getError()});
+
+        previous_triangles = triangles;
+    }
+}
+
+void Mesh::generateMeshlets() {
+    const auto& full_detail = lods.front();
+    meshlet_indices.clear();
+    meshlets = MeshletBuilder::build(vertices, indices.data() + full_detail.first_index, full_detail.index_count, meshlet_indices);
+}
+
+const std::vector<vulkan::shaders::Vertex>& Mesh::getVertices() const {
+    return vertices;
+}
+
+const std::vector<uint32_t>& Mesh::getIndices() const {
+    return indices;
+}
+
+const std::vector<Mesh::Lod>& Mesh::getLods() const {
+    return lods;
+}
+
+const std::vector<vulkan::shaders::Meshlet>& Mesh::getMeshlets() const {
+    return meshlets;
+}
+
+const std::vector<uint32_t>& Mesh::getMeshletIndices() const {
+    return meshlet_indices;
+}
+
+glm::vec3 Mesh::boundsCenter() const {
+    return bounds_center;
+}
+
+float Mesh::boundsRadius() const {
+    return bounds_radius;
+}
+
+Mesh::Mesh(std::vector<vulkan::shaders::Vertex> vertices, std::vector<uint32_t> indices)
+    : vertices(std::move(vertices)), indices(std::move(indices)), bounds_center(0.0f), bounds_radius(0.0f) {
+    lods.push_back(Lod{0, static_cast<uint32_t>(this->indices.size()), 0.0f});
+
+    if (this->vertices.empty()) {
+        return;
+    }
+
+    glm::vec3 lower = this->vertices.front().position;
+    glm::vec3 upper = lower;
+    for (const auto& vertex : this->vertices) {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+
+    bounds_center = 0.5f * (lower + upper);
+    for (const auto& vertex : this->vertices) {
+        bounds_radius = std::max(bounds_radius, glm::length(vertex.position - bounds_center));
+    }
+}
+
+}  // namespace resources
+}  // namespace visualization
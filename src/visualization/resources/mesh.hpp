@@ -0,0 +1,67 @@
+#ifndef BB8_VISUALIZATION_RESOURCES_MESH_HPP
+#define BB8_VISUALIZATION_RESOURCES_MESH_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "../vulkan/shaders/meshlet.hpp"
+#include "../vulkan/shaders/vertex.hpp"
+
+namespace visualization {
+namespace resources {
+
+// CPU-side triangle mesh. Levels of detail are stored as consecutive index ranges,
+// all referencing the same vertices, with level 0 being the full-detail mesh.
+class Mesh {
+public:
+    class Lod {
+    public:
+        uint32_t first_index;
+        uint32_t index_count;
+
+        // approximate distance from this level's surface to the full-detail surface
+        float error;
+    };
+
+    static Mesh load(std::filesystem::path obj_file);
+
+    // appends up to `count` progressively simplified levels of detail,
+    // each with roughly half the triangles of the previous level
+    void generateLods(size_t count);
+
+    // splits the full-detail level into meshlets for cluster culling
+    void generateMeshlets();
+
+    const std::vector<vulkan::shaders::Vertex>& getVertices() const;
+    const std::vector<uint32_t>& getIndices() const;
+    const std::vector<Lod>& getLods() const;
+    const std::vector<vulkan::shaders::Meshlet>& getMeshlets() const;
+    const std::vector<uint32_t>& getMeshletIndices() const;
+
+    glm::vec3 boundsCenter() const;
+    float boundsRadius() const;
+
+private:
+    Mesh(std::vector<vulkan::shaders::Vertex> vertices, std::vector<uint32_t> indices);
+
+    // levels must remove at least this fraction of the previous level's triangles to be kept
+    static constexpr float min_lod_reduction = 0.15f;
+    // maximum simplification error, relative to the bounding radius
+    static constexpr float max_relative_error = 0.05f;
+
+    std::vector<vulkan::shaders::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Lod> lods;
+
+    std::vector<vulkan::shaders::Meshlet> meshlets;
+    std::vector<uint32_t> meshlet_indices;
+
+    glm::vec3 bounds_center;
+    float bounds_radius;
+};
+
+}  // namespace resources
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_RESOURCES_MESH_HPP
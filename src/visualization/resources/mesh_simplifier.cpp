@@ -0,0 +1,369 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace visualization {
+namespace resources {
+
+namespace {
+
+constexpr uint32_t invalid = std::numeric_limits<uint32_t>::max();
+
+}
+
+MeshSimplifier::Quadric::Quadric()
+    : a00(0.0), a01(0.0), a02(0.0), a11(0.0), a12(0.0), a22(0.0), b0(0.0), b1(0.0), b2(0.0), c(0.0), weight(0.0) {}
+
+MeshSimplifier::Quadric::Quadric(glm::vec3 normal, float distance, float weight)
+    : a00(weight * normal.x * normal.x),
+      a01(weight * normal.x * normal.y),
+      a02(weight * normal.x * normal.z),
+      a11(weight * normal.y * normal.y),
+      a12(weight * normal.y * normal.z),
+      a22(weight * normal.z * normal.z),
+      b0(weight * normal.x * distance),
+      b1(weight * normal.y * distance),
+      b2(weight * normal.z * distance),
+      c(weight * distance * distance),
+      weight(weight) {}
+
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other) {
+    a00 += other.a00;
+    a01 += other.a01;
+    a02 += other.a02;
+    a11 += other.a11;
+    a12 += other.a12;
+    a22 += other.a22;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+    return *this;
+}
+
+float MeshSimplifier::Quadric::error(glm::vec3 p) const {
+    double x = p.x, y = p.y, z = p.z;
+    double quadratic = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z);
+    double linear = 2.0 * (b0 * x + b1 * y + b2 * z);
+    double squared_distance = (quadratic + linear + c) / std::max(weight, 1e-12);
+
+    // normalized by total area, so this is the RMS distance to the accumulated planes
+    return static_cast<float>(std::sqrt(std::max(squared_distance, 0.0)));
+}
+
+MeshSimplifier::MeshSimplifier(const std::vector<vulkan::shaders::Vertex>& vertices, const std::vector<uint32_t>& indices)
+    : indices(indices), error(0.0f) {
+    // weld vertices by position, so texture seams don't look like borders
+    std::unordered_map<glm::vec3, uint32_t> position_ids;
+    vertex_positions.reserve(vertices.size());
+    for (const auto& vertex : vertices) {
+        auto [it, inserted] = position_ids.try_emplace(vertex.position, static_cast<uint32_t>(positions.size()));
+        if (inserted) {
+            positions.push_back(vertex.position);
+        }
+        vertex_positions.push_back(it->second);
+    }
+
+    wedge_offsets.assign(positions.size() + 1, 0);
+    for (uint32_t position : vertex_positions) {
+        wedge_offsets[position + 1] += 1;
+    }
+    for (size_t i = 1; i < wedge_offsets.size(); i++) {
+        wedge_offsets[i] += wedge_offsets[i - 1];
+    }
+
+    wedges.resize(vertices.size());
+    std::vector<uint32_t> fill(wedge_offsets.begin(), wedge_offsets.end() - 1);
+    for (uint32_t vertex = 0; vertex < vertices.size(); vertex++) {
+        wedges[fill[vertex_positions[vertex]]++] = vertex;
+    }
+
+    quadrics.resize(positions.size());
+    std::unordered_map<uint64_t, uint32_t> edge_counts;
+    std::unordered_map<uint64_t, glm::vec3> edge_normals;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t p[3] = {vertex_positions[indices[i]], vertex_positions[indices[i + 1]], vertex_positions[indices[i + 2]]};
+
+        glm::vec3 normal = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+        float double_area = glm::length(normal);
+        if (double_area > 0.0f) {
+            normal /= double_area;
+            auto plane = Quadric(normal, -glm::dot(normal, positions[p[0]]), 0.5f * double_area);
+            for (uint32_t position : p) {
+                quadrics[position] += plane;
+            }
+        }
+
+        for (int edge = 0; edge < 3; edge++) {
+            uint32_t a = p[edge];
+            uint32_t b = p[(edge + 1) % 3];
+            if (a != b) {
+                edge_counts[edgeKey(a, b)] += 1;
+                edge_normals[edgeKey(a, b)] = normal;
+            }
+        }
+    }
+
+    kinds.assign(positions.size(), interior);
+    std::vector<uint32_t> open_edges(positions.size(), 0);
+    for (const auto& [key, count] : edge_counts) {
+        auto a = static_cast<uint32_t>(key >> 32);
+        auto b = static_cast<uint32_t>(key & 0xFFFFFFFF);
+
+        if (count > 2) {
+            // non-manifold edges would tear if either end moved
+            kinds[a] = locked;
+            kinds[b] = locked;
+        } else if (count == 1) {
+            open_edges[a] += 1;
+            open_edges[b] += 1;
+            border_edges.push_back(key);
+
+            // penalize moving the border away from its original line,
+            // using a plane through the edge perpendicular to the adjacent face
+            glm::vec3 edge = positions[b] - positions[a];
+            glm::vec3 normal = glm::cross(edge, edge_normals[key]);
+            float length = glm::length(normal);
+            if (length > 0.0f) {
+                normal /= length;
+                auto plane = Quadric(normal, -glm::dot(normal, positions[a]), border_weight * glm::dot(edge, edge));
+                quadrics[a] += plane;
+                quadrics[b] += plane;
+            }
+        }
+    }
+    std::sort(border_edges.begin(), border_edges.end());
+
+    for (uint32_t position = 0; position < positions.size(); position++) {
+        if (kinds[position] != locked && open_edges[position] > 0) {
+            // a simple border vertex has exactly one incoming and one outgoing border edge
+            kinds[position] = open_edges[position] == 2 ? border : locked;
+        }
+    }
+}
+
+void MeshSimplifier::simplify(size_t target_triangles, float max_error, bool preserve_seams) {
+    while (triangleCount() > target_triangles) {
+        if (pass(target_triangles, max_error, preserve_seams) == 0) {
+            break;
+        }
+    }
+}
+
+const std::vector<uint32_t>& MeshSimplifier::getIndices() const {
+    return indices;
+}
+
+size_t MeshSimplifier::triangleCount() const {
+    return indices.size() / 3;
+}
+
+float MeshSimplifier::getError() const {
+    return error;
+}
+
+uint64_t MeshSimplifier::edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+size_t MeshSimplifier::pass(size_t target_triangles, float max_error, bool preserve_seams) {
+    size_t triangle_count = triangleCount();
+
+    live_vertices.assign(vertex_positions.size(), 0);
+    vertex_edges.clear();
+    triangle_offsets.assign(positions.size() + 1, 0);
+
+    std::vector<uint64_t> position_edges;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = indices[i + corner];
+            uint32_t b = indices[i + (corner + 1) % 3];
+            live_vertices[a] = 1;
+            vertex_edges.push_back(edgeKey(a, b));
+            position_edges.push_back(edgeKey(vertex_positions[a], vertex_positions[b]));
+            triangle_offsets[vertex_positions[a] + 1] += 1;
+        }
+    }
+
+    std::sort(vertex_edges.begin(), vertex_edges.end());
+    vertex_edges.erase(std::unique(vertex_edges.begin(), vertex_edges.end()), vertex_edges.end());
+    std::sort(position_edges.begin(), position_edges.end());
+    position_edges.erase(std::unique(position_edges.begin(), position_edges.end()), position_edges.end());
+
+    for (size_t i = 1; i < triangle_offsets.size(); i++) {
+        triangle_offsets[i] += triangle_offsets[i - 1];
+    }
+    position_triangles.resize(indices.size());
+    std::vector<uint32_t> fill(triangle_offsets.begin(), triangle_offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++) {
+        position_triangles[fill[vertex_positions[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<Collapse> collapses;
+    for (uint64_t key : position_edges) {
+        auto a = static_cast<uint32_t>(key >> 32);
+        auto b = static_cast<uint32_t>(key & 0xFFFFFFFF);
+
+        Collapse best = {invalid, invalid, std::numeric_limits<float>::max()};
+        for (auto [from, to] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+            if (!canCollapse(from, to, preserve_seams)) {
+                continue;
+            }
+
+            Quadric combined = quadrics[from];
+            combined += quadrics[to];
+            float collapse_error = combined.error(positions[to]);
+            if (collapse_error < best.error) {
+                best = {from, to, collapse_error};
+            }
+        }
+
+        if (best.from != invalid) {
+            collapses.push_back(best);
+        }
+    }
+
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.error < r.error; });
+
+    std::vector<uint32_t> remap(vertex_positions.size());
+    for (uint32_t vertex = 0; vertex < remap.size(); vertex++) {
+        remap[vertex] = vertex;
+    }
+
+    // each position is only touched by one collapse per pass, so adjacency stays valid
+    std::vector<uint8_t> touched(positions.size(), 0);
+    size_t applied = 0;
+    size_t removed_triangles = 0;
+    for (const auto& collapse : collapses) {
+        if (collapse.error > max_error || triangle_count - removed_triangles <= target_triangles) {
+            break;
+        }
+
+        if (touched[collapse.from] || touched[collapse.to] || flipsTriangles(collapse.from, collapse.to)) {
+            continue;
+        }
+
+        for (uint32_t w = wedge_offsets[collapse.from]; w < wedge_offsets[collapse.from + 1]; w++) {
+            uint32_t wedge = wedges[w];
+            if (live_vertices[wedge]) {
+                remap[wedge] = findPartner(wedge, collapse.to, preserve_seams);
+            }
+        }
+
+        for (uint32_t t = triangle_offsets[collapse.from]; t < triangle_offsets[collapse.from + 1]; t++) {
+            uint32_t triangle = position_triangles[t];
+            bool contains_to = false;
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t position = vertex_positions[indices[3 * triangle + corner]];
+                touched[position] = 1;
+                contains_to = contains_to || position == collapse.to;
+            }
+            removed_triangles += contains_to ? 1 : 0;
+        }
+
+        quadrics[collapse.to] += quadrics[collapse.from];
+        error = std::max(error, collapse.error);
+        applied++;
+    }
+
+    if (applied == 0) {
+        return 0;
+    }
+
+    size_t write = 0;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t v0 = remap[indices[i]];
+        uint32_t v1 = remap[indices[i + 1]];
+        uint32_t v2 = remap[indices[i + 2]];
+
+        uint32_t p0 = vertex_positions[v0];
+        uint32_t p1 = vertex_positions[v1];
+        uint32_t p2 = vertex_positions[v2];
+        if (p0 == p1 || p1 == p2 || p0 == p2) {
+            continue;
+        }
+
+        indices[write++] = v0;
+        indices[write++] = v1;
+        indices[write++] = v2;
+    }
+    indices.resize(write);
+
+    return applied;
+}
+
+uint32_t MeshSimplifier::findPartner(uint32_t wedge, uint32_t position, bool preserve_seams) const {
+    uint32_t fallback = invalid;
+    for (uint32_t w = wedge_offsets[position]; w < wedge_offsets[position + 1]; w++) {
+        uint32_t candidate = wedges[w];
+        if (!live_vertices[candidate]) {
+            continue;
+        }
+
+        if (std::binary_search(vertex_edges.begin(), vertex_edges.end(), edgeKey(wedge, candidate))) {
+            return candidate;
+        }
+
+        fallback = fallback == invalid ? candidate : fallback;
+    }
+
+    return preserve_seams ? invalid : fallback;
+}
+
+bool MeshSimplifier::canCollapse(uint32_t from, uint32_t to, bool preserve_seams) const {
+    if (kinds[from] == locked) {
+        return false;
+    }
+
+    // border vertices may only move along the border, otherwise holes would open or close
+    if (kinds[from] == border && !std::binary_search(border_edges.begin(), border_edges.end(), edgeKey(from, to))) {
+        return false;
+    }
+
+    // every attribute wedge at `from` must slide along an edge onto a wedge at `to`,
+    // otherwise texture coordinates would be stretched across a seam
+    for (uint32_t w = wedge_offsets[from]; w < wedge_offsets[from + 1]; w++) {
+        uint32_t wedge = wedges[w];
+        if (live_vertices[wedge] && findPartner(wedge, to, preserve_seams) == invalid) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MeshSimplifier::flipsTriangles(uint32_t from, uint32_t to) const {
+    for (uint32_t t = triangle_offsets[from]; t < triangle_offsets[from + 1]; t++) {
+        uint32_t triangle = position_triangles[t];
+
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        bool degenerates = false;
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t position = vertex_positions[indices[3 * triangle + corner]];
+            degenerates = degenerates || position == to;
+            before[corner] = positions[position];
+            after[corner] = position == from ? positions[to] : positions[position];
+        }
+
+        // triangles containing the collapsed edge disappear, so can't flip
+        if (degenerates) {
+            continue;
+        }
+
+        glm::vec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normal_before, normal_after) <= 0.0f) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}  // namespace resources
+}  // namespace visualization
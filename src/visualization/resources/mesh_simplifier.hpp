@@ -0,0 +1,101 @@
+#ifndef BB8_VISUALIZATION_RESOURCES_MESH_SIMPLIFIER_HPP
+#define BB8_VISUALIZATION_RESOURCES_MESH_SIMPLIFIER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../vulkan/shaders/vertex.hpp"
+
+namespace visualization {
+namespace resources {
+
+// Edge-collapse simplification driven by quadric error metrics.
+//
+// Vertices are collapsed onto existing neighbours, so simplified index lists
+// reference the original vertex data. Vertices sharing a position (texture seams)
+// are collapsed together with their seam partners, vertices on open borders only
+// slide along the border, and non-manifold vertices are locked.
+// Simplification is incremental: successive calls to simplify() continue from
+// the previous result, so levels of detail can be generated coarsest-last.
+class MeshSimplifier {
+public:
+    MeshSimplifier(const std::vector<vulkan::shaders::Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+    // collapses edges until at most target_triangles remain,
+    // or until the next collapse would exceed max_error.
+    // Without preserve_seams, attribute wedges may collapse across texture seams,
+    // which stretches textures but lets heavily seamed meshes simplify much further.
+    void simplify(size_t target_triangles, float max_error, bool preserve_seams);
+
+    const std::vector<uint32_t>& getIndices() const;
+    size_t triangleCount() const;
+
+    // approximate distance from the simplified surface to the original surface
+    float getError() const;
+
+private:
+    class Quadric {
+    public:
+        Quadric();
+        Quadric(glm::vec3 normal, float distance, float weight);
+
+        Quadric& operator+=(const Quadric& other);
+        float error(glm::vec3 position) const;
+
+    private:
+        // symmetric 3x3 matrix, linear term, constant term, and accumulated weight
+        double a00, a01, a02, a11, a12, a22;
+        double b0, b1, b2;
+        double c;
+        double weight;
+    };
+
+    enum Kind : uint8_t {
+        interior,
+        border,
+        locked,
+    };
+
+    class Collapse {
+    public:
+        uint32_t from;
+        uint32_t to;
+        float error;
+    };
+
+    static uint64_t edgeKey(uint32_t a, uint32_t b);
+
+    // relative weight of border-preserving planes against surface planes
+    static constexpr float border_weight = 10.0f;
+
+    size_t pass(size_t target_triangles, float max_error, bool preserve_seams);
+
+    uint32_t findPartner(uint32_t wedge, uint32_t position, bool preserve_seams) const;
+    bool canCollapse(uint32_t from, uint32_t to, bool preserve_seams) const;
+    bool flipsTriangles(uint32_t from, uint32_t to) const;
+
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> vertex_positions;
+
+    // vertices sharing each position, in compressed row format
+    std::vector<uint32_t> wedge_offsets;
+    std::vector<uint32_t> wedges;
+
+    std::vector<Quadric> quadrics;
+    std::vector<uint8_t> kinds;
+    std::vector<uint64_t> border_edges;
+
+    std::vector<uint32_t> indices;
+    float error;
+
+    // rebuilt at the start of each pass
+    std::vector<uint8_t> live_vertices;
+    std::vector<uint64_t> vertex_edges;
+    std::vector<uint32_t> triangle_offsets;
+    std::vector<uint32_t> position_triangles;
+};
+
+}  // namespace resources
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_RESOURCES_MESH_SIMPLIFIER_HPP
@@ -0,0 +1,184 @@
+#include "meshlet_builder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace visualization {
+namespace resources {
+
+std::vector<vulkan::shaders::Meshlet> MeshletBuilder::build(const std::vector<vulkan::shaders::Vertex>& vertices,
+                                                            const uint32_t* indices,
+                                                            size_t index_count,
+                                                            std::vector<uint32_t>& meshlet_indices) {
+    constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    size_t triangle_count = index_count / 3;
+
+    // triangles adjacent to each vertex, in compressed row format
+    std::vector<uint32_t> adjacency_offsets(vertices.size() + 1, 0);
+    for (size_t i = 0; i < 3 * triangle_count; i++) {
+        adjacency_offsets[indices[i] + 1] += 1;
+    }
+    for (size_t i = 1; i < adjacency_offsets.size(); i++) {
+        adjacency_offsets[i] += adjacency_offsets[i - 1];
+    }
+    std::vector<uint32_t> adjacency(3 * triangle_count);
+    std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (size_t i = 0; i < 3 * triangle_count; i++) {
+        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<vulkan::shaders::Meshlet> meshlets;
+    std::vector<uint8_t> used(triangle_count, 0);
+    std::vector<uint32_t> vertex_meshlet(vertices.size(), none);
+    std::vector<uint32_t> candidates;
+
+    auto meshlet_id = static_cast<uint32_t>(meshlets.size());
+    auto first_index = static_cast<uint32_t>(meshlet_indices.size());
+    size_t meshlet_vertices = 0;
+    size_t meshlet_triangles = 0;
+    size_t next_seed = 0;
+
+    auto finish = [&]() {
+        auto count = static_cast<uint32_t>(meshlet_indices.size()) - first_index;
+        meshlets.push_back(computeBounds(vertices, meshlet_indices, first_index, count));
+
+        meshlet_id += 1;
+        first_index = static_cast<uint32_t>(meshlet_indices.size());
+        meshlet_vertices = 0;
+        meshlet_triangles = 0;
+    };
+
+    auto new_vertices = [&](uint32_t triangle) {
+        size_t count = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            count += vertex_meshlet[indices[3 * triangle + corner]] != meshlet_id ? 1 : 0;
+        }
+        return count;
+    };
+
+    while (true) {
+        // grow the meshlet with the adjacent triangle adding the fewest vertices,
+        // so meshlets stay compact and their bounds tight
+        uint32_t best = none;
+        size_t best_cost = 4;
+        for (uint32_t candidate : candidates) {
+            if (!used[candidate]) {
+                size_t cost = new_vertices(candidate);
+                if (cost < best_cost) {
+                    best = candidate;
+                    best_cost = cost;
+                }
+            }
+        }
+
+        if (best == none) {
+            while (next_seed < triangle_count && used[next_seed]) {
+                next_seed++;
+            }
+
+            if (next_seed == triangle_count) {
+                break;
+            }
+
+            best = static_cast<uint32_t>(next_seed);
+            best_cost = new_vertices(best);
+        }
+
+        if (meshlet_vertices + best_cost > max_vertices || meshlet_triangles + 1 > max_triangles) {
+            finish();
+            candidates.clear();
+            candidates.push_back(best);
+            continue;
+        }
+
+        used[best] = 1;
+        meshlet_vertices += best_cost;
+        meshlet_triangles += 1;
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t vertex = indices[3 * best + corner];
+            vertex_meshlet[vertex] = meshlet_id;
+            meshlet_indices.push_back(vertex);
+
+            for (uint32_t a = adjacency_offsets[vertex]; a < adjacency_offsets[vertex + 1]; a++) {
+                if (!used[adjacency[a]]) {
+                    candidates.push_back(adjacency[a]);
+                }
+            }
+        }
+
+        // drop consumed candidates occasionally, so scanning stays cheap
+        if (candidates.size() > 8 * max_triangles) {
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](uint32_t t) { return used[t] != 0; }), candidates.end());
+        }
+    }
+
+    if (meshlet_triangles > 0) {
+        finish();
+    }
+
+    return meshlets;
+}
+
+vulkan::shaders::Meshlet MeshletBuilder::computeBounds(const std::vector<vulkan::shaders::Vertex>& vertices,
+                                                       const std::vector<uint32_t>& meshlet_indices,
+                                                       uint32_t first_index,
+                                                       uint32_t index_count) {
+    glm::vec3 lower = vertices[meshlet_indices[first_index]].position;
+    glm::vec3 upper = lower;
+    for (uint32_t i = first_index; i < first_index + index_count; i++) {
+        lower = glm::min(lower, vertices[meshlet_indices[i]].position);
+        upper = glm::max(upper, vertices[meshlet_indices[i]].position);
+    }
+
+    glm::vec3 center = 0.5f * (lower + upper);
+    float radius = 0.0f;
+    for (uint32_t i = first_index; i < first_index + index_count; i++) {
+        radius = std::max(radius, glm::length(vertices[meshlet_indices[i]].position - center));
+    }
+
+    std::vector<glm::vec3> normals;
+    glm::vec3 axis = glm::vec3(0.0f);
+    for (uint32_t i = first_index; i + 2 < first_index + index_count; i += 3) {
+        glm::vec3 a = vertices[meshlet_indices[i]].position;
+        glm::vec3 b = vertices[meshlet_indices[i + 1]].position;
+        glm::vec3 c = vertices[meshlet_indices[i + 2]].position;
+
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        if (length > 0.0f) {
+            normals.push_back(normal / length);
+            axis += normal / length;
+        }
+    }
+
+    float cutoff = 1.0f;
+    float axis_length = glm::length(axis);
+    if (axis_length > 0.0f) {
+        axis /= axis_length;
+
+        float min_dot = 1.0f;
+        for (const auto& normal : normals) {
+            min_dot = std::min(min_dot, glm::dot(axis, normal));
+        }
+
+        // all normals lie within acos(min_dot) of the axis, so viewers within
+        // asin(cutoff) of the axis see only back faces
+        if (min_dot > min_cone_spread) {
+            cutoff = std::sqrt(1.0f - min_dot * min_dot);
+        }
+    }
+
+    vulkan::shaders::Meshlet meshlet;
+    meshlet.sphere = glm::vec4(center, radius);
+    meshlet.cone = glm::vec4(axis, cutoff);
+    meshlet.first_index = first_index;
+    meshlet.index_count = index_count;
+    meshlet.padding[0] = 0;
+    meshlet.padding[1] = 0;
+
+    return meshlet;
+}
+
+}  // namespace resources
+}  // namespace visualization
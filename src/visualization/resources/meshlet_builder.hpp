@@ -0,0 +1,39 @@
+#ifndef BB8_VISUALIZATION_RESOURCES_MESHLET_BUILDER_HPP
+#define BB8_VISUALIZATION_RESOURCES_MESHLET_BUILDER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../vulkan/shaders/meshlet.hpp"
+#include "../vulkan/shaders/vertex.hpp"
+
+namespace visualization {
+namespace resources {
+
+// Splits triangle lists into meshlets of spatially adjacent triangles,
+// each with a bounding sphere and backface normal cone for cluster culling
+class MeshletBuilder {
+public:
+    static constexpr size_t max_vertices = 64;
+    static constexpr size_t max_triangles = 124;
+
+    // meshlet indices are appended to `meshlet_indices`, and reference the original vertices
+    static std::vector<vulkan::shaders::Meshlet> build(const std::vector<vulkan::shaders::Vertex>& vertices,
+                                                       const uint32_t* indices,
+                                                       size_t index_count,
+                                                       std::vector<uint32_t>& meshlet_indices);
+
+private:
+    static vulkan::shaders::Meshlet computeBounds(const std::vector<vulkan::shaders::Vertex>& vertices,
+                                                  const std::vector<uint32_t>& meshlet_indices,
+                                                  uint32_t first_index,
+                                                  uint32_t index_count);
+
+    // normal cones wider than this (cosine of half angle) would rarely cull anything
+    static constexpr float min_cone_spread = 0.1f;
+};
+
+}  // namespace resources
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_RESOURCES_MESHLET_BUILDER_HPP
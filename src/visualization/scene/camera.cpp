@@ -0,0 +1,35 @@
+#include "camera.hpp"
+
+#include <cmath>
+
+namespace visualization {
+namespace scene {
+
+Camera::Camera(glm::vec3 position, glm::vec3 target, glm::vec3 up, float vertical_fov, float near_plane, float far_plane)
+    : position(position), target(target), up(up), vertical_fov(vertical_fov), near_plane(near_plane), far_plane(far_plane) {}
+
+glm::mat4 Camera::view() const {
+    return glm::lookAt(position, target, up);
+}
+
+glm::mat4 Camera::projection(float aspect_ratio) const {
+    auto projection = glm::perspective(vertical_fov, aspect_ratio, near_plane, far_plane);
+    projection[1][1] *= -1.0;
+    return projection;
+}
+
+float Camera::pixelsPerUnit(float viewport_height) const {
+    return viewport_height / (2.0f * std::tan(0.5f * vertical_fov));
+}
+
+bool Camera::operator==(const Camera& other) const {
+    return position == other.position && target == other.target && up == other.up &&
+           vertical_fov == other.vertical_fov && near_plane == other.near_plane && far_plane == other.far_plane;
+}
+
+bool Camera::operator!=(const Camera& other) const {
+    return !(*this == other);
+}
+
+}  // namespace scene
+}  // namespace visualization
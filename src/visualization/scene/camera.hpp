@@ -0,0 +1,36 @@
+#ifndef BB8_VISUALIZATION_SCENE_CAMERA_HPP
+#define BB8_VISUALIZATION_SCENE_CAMERA_HPP
+
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace scene {
+
+class Camera {
+public:
+    Camera(glm::vec3 position, glm::vec3 target, glm::vec3 up, float vertical_fov, float near_plane, float far_plane);
+
+    glm::mat4 view() const;
+
+    // projection into Vulkan clip space (y axis pointing down)
+    glm::mat4 projection(float aspect_ratio) const;
+
+    // pixels spanned by a unit length at unit distance, for a viewport of the given height
+    float pixelsPerUnit(float viewport_height) const;
+
+    bool operator==(const Camera& other) const;
+    bool operator!=(const Camera& other) const;
+
+    glm::vec3 position;
+    glm::vec3 target;
+    glm::vec3 up;
+
+    float vertical_fov;
+    float near_plane;
+    float far_plane;
+};
+
+}  // namespace scene
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_SCENE_CAMERA_HPP
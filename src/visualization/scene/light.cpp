@@ -0,0 +1,30 @@
+#include "light.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+namespace visualization {
+namespace scene {
+
+Light Light::point(glm::vec3 position, glm::vec3 color, float range) {
+    return Light{position, glm::vec3(0.0f, 0.0f, -1.0f), color, range, glm::pi<float>(), glm::pi<float>()};
+}
+
+Light Light::spot(glm::vec3 position, glm::vec3 direction, glm::vec3 color, float range, float inner_angle, float outer_angle) {
+    return Light{position, glm::normalize(direction), color, range, inner_angle, outer_angle};
+}
+
+bool Light::isSpot() const {
+    return outer_angle < glm::pi<float>();
+}
+
+bool Light::operator==(const Light& other) const {
+    return position == other.position && direction == other.direction && color == other.color &&
+           range == other.range && inner_angle == other.inner_angle && outer_angle == other.outer_angle;
+}
+
+bool Light::operator!=(const Light& other) const {
+    return !(*this == other);
+}
+
+}  // namespace scene
+}  // namespace visualization
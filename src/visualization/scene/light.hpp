@@ -0,0 +1,37 @@
+#ifndef BB8_VISUALIZATION_SCENE_LIGHT_HPP
+#define BB8_VISUALIZATION_SCENE_LIGHT_HPP
+
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace scene {
+
+// Local point or spot light with a finite range, lighting is windowed to reach zero at the range
+class Light {
+public:
+    static Light point(glm::vec3 position, glm::vec3 color, float range);
+
+    // cone half-angles in radians, light fades out between the inner and outer angle
+    static Light spot(glm::vec3 position, glm::vec3 direction, glm::vec3 color, float range, float inner_angle, float outer_angle);
+
+    bool isSpot() const;
+
+    bool operator==(const Light& other) const;
+    bool operator!=(const Light& other) const;
+
+    glm::vec3 position;
+    // direction light shines in, unused by point lights
+    glm::vec3 direction;
+    // linear color scaled by intensity
+    glm::vec3 color;
+    float range;
+
+    // half-angles of the cone, an outer angle of pi makes a point light
+    float inner_angle;
+    float outer_angle;
+};
+
+}  // namespace scene
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_SCENE_LIGHT_HPP
@@ -0,0 +1,212 @@
+#include "scene_graph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BB8_SCENE_GRAPH_SSE
+#endif
+
+namespace visualization {
+namespace scene {
+
+SceneGraph::NodeId SceneGraph::createNode(NodeId parent, const glm::mat4& local) {
+    uint32_t parent_slot = parent == none ? none : node_slots.at(parent);
+    uint32_t slot = parent == none ? static_cast<uint32_t>(slot_nodes.size()) : parent_slot + subtree_sizes[parent_slot];
+    NodeId node = static_cast<NodeId>(node_slots.size());
+
+    parents.insert(parents.begin() + slot, parent_slot);
+    subtree_sizes.insert(subtree_sizes.begin() + slot, 1);
+    locals.insert(locals.begin() + slot, local);
+    worlds.insert(worlds.begin() + slot, local);
+    slot_nodes.insert(slot_nodes.begin() + slot, node);
+    static_flags.insert(static_flags.begin() + slot, 0);
+
+    node_slots.push_back(slot);
+    dirty_flags.push_back(0);
+
+    // slots after the insertion point have shifted by one
+    for (uint32_t i = slot + 1; i < slot_nodes.size(); i++) {
+        node_slots[slot_nodes[i]] = i;
+        if (parents[i] != none && parents[i] >= slot) {
+            parents[i] += 1;
+        }
+    }
+
+    for (uint32_t ancestor = parent_slot; ancestor != none; ancestor = parents[ancestor]) {
+        subtree_sizes[ancestor] += 1;
+    }
+
+    markDirty(node);
+
+    // slot layout changed, so previously packed instance data can't be patched incrementally
+    structure_generation = generation + 1;
+
+    return node;
+}
+
+void SceneGraph::setLocal(NodeId node, const glm::mat4& local) {
+    locals[node_slots.at(node)] = local;
+    markDirty(node);
+}
+
+const glm::mat4& SceneGraph::getLocal(NodeId node) const {
+    return locals[node_slots.at(node)];
+}
+
+const glm::mat4& SceneGraph::getWorld(NodeId node) const {
+    return worlds[node_slots.at(node)];
+}
+
+void SceneGraph::setStatic(NodeId node, bool is_static) {
+    auto& flag = static_flags[node_slots.at(node)];
+    if (flag != is_static) {
+        flag = is_static;
+        static_generation += 1;
+    }
+}
+
+bool SceneGraph::isStatic(uint32_t slot) const {
+    return static_flags[slot] != 0;
+}
+
+uint64_t SceneGraph::staticGeneration() const {
+    return static_generation;
+}
+
+uint32_t SceneGraph::instanceIndex(NodeId node) const {
+    return node_slots.at(node);
+}
+
+size_t SceneGraph::size() const {
+    return slot_nodes.size();
+}
+
+const std::vector<glm::mat4>& SceneGraph::worldMatrices() const {
+    return worlds;
+}
+
+bool SceneGraph::hasChanges() const {
+    return !dirty_nodes.empty();
+}
+
+size_t SceneGraph::update() {
+    if (dirty_nodes.empty()) {
+        return 0;
+    }
+
+    dirty_slots.clear();
+    for (NodeId node : dirty_nodes) {
+        dirty_slots.push_back(node_slots[node]);
+        dirty_flags[node] = 0;
+    }
+    dirty_nodes.clear();
+
+    std::sort(dirty_slots.begin(), dirty_slots.end());
+
+    generation += 1;
+    auto& changes = history[generation % history_length];
+    changes.generation = generation;
+    changes.ranges.clear();
+
+    size_t recomputed = 0;
+    uint32_t covered = 0;
+    for (uint32_t root : dirty_slots) {
+        // already recomputed as part of a dirty ancestor's subtree
+        if (root < covered) {
+            continue;
+        }
+
+        uint32_t end = root + subtree_sizes[root];
+        uint8_t moved_static = 0;
+        for (uint32_t slot = root; slot < end; slot++) {
+            uint32_t parent = parents[slot];
+            if (parent == none) {
+                worlds[slot] = locals[slot];
+            } else {
+                multiply(worlds[parent], locals[slot], worlds[slot]);
+            }
+            moved_static |= static_flags[slot];
+        }
+
+        if (moved_static) {
+            static_generation += 1;
+        }
+
+        changes.ranges.push_back(Range{root, end});
+        recomputed += end - root;
+        covered = end;
+    }
+
+    return recomputed;
+}
+
+size_t SceneGraph::packWorldMatrices(glm::mat4* destination, uint64_t& packed_generation) const {
+    if (packed_generation == generation) {
+        return 0;
+    }
+
+    size_t copied = 0;
+    bool history_available = generation - packed_generation <= history_length;
+    if (packed_generation < structure_generation || !history_available) {
+        std::memcpy(destination, worlds.data(), worlds.size() * sizeof(glm::mat4));
+        copied = worlds.size();
+    } else {
+        for (uint64_t g = packed_generation + 1; g <= generation; g++) {
+            const auto& changes = history[g % history_length];
+            assert(changes.generation == g);
+
+            for (const auto& range : changes.ranges) {
+                std::memcpy(destination + range.begin, worlds.data() + range.begin, (range.end - range.begin) * sizeof(glm::mat4));
+                copied += range.end - range.begin;
+            }
+        }
+    }
+
+    packed_generation = generation;
+    return copied;
+}
+
+void SceneGraph::markDirty(NodeId node) {
+    if (dirty_flags[node] == 0) {
+        dirty_flags[node] = 1;
+        dirty_nodes.push_back(node);
+    }
+}
+
+#ifdef BB8_SCENE_GRAPH_SSE
+
+void SceneGraph::multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& world) {
+    // glm matrices are column major, so each column of the result is
+    // a linear combination of the parent's columns
+    const float* a = &parent[0][0];
+    const float* b = &local[0][0];
+    float* result = &world[0][0];
+
+    __m128 a0 = _mm_loadu_ps(a + 0);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+
+    for (int column = 0; column < 4; column++) {
+        const float* b_column = b + 4 * column;
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(b_column[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(b_column[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b_column[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(b_column[3])));
+        _mm_storeu_ps(result + 4 * column, sum);
+    }
+}
+
+#else
+
+void SceneGraph::multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& world) {
+    world = parent * local;
+}
+
+#endif
+
+}  // namespace scene
+}  // namespace visualization
@@ -0,0 +1,101 @@
+#ifndef BB8_VISUALIZATION_SCENE_SCENE_GRAPH_HPP
+#define BB8_VISUALIZATION_SCENE_SCENE_GRAPH_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace scene {
+
+// Transform hierarchy stored as structure-of-arrays, indexed by slot.
+// Slots are kept in depth-first order, so every node's parent has a lower
+// slot and the subtree of slot s is the contiguous range [s, s + subtree size).
+// Only subtrees containing a modified node are recomputed by update().
+class SceneGraph {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId none = std::numeric_limits<NodeId>::max();
+
+    NodeId createNode(NodeId parent, const glm::mat4& local);
+
+    void setLocal(NodeId node, const glm::mat4& local);
+    const glm::mat4& getLocal(NodeId node) const;
+
+    // static nodes are expected to rarely move, so data derived from them (e.g. shadows) can be cached
+    void setStatic(NodeId node, bool is_static);
+    // takes a slot, i.e. an instance index, so draws can be checked in instance order. Slots and
+    // nodes are both plain integers, so passing a node compiles but reads the wrong flag
+    bool isStatic(uint32_t slot) const;
+
+    // changes whenever a static node is created, moved, or changes mobility
+    uint64_t staticGeneration() const;
+
+    // world transforms are only valid after update()
+    const glm::mat4& getWorld(NodeId node) const;
+
+    // index of the node's world matrix in packed instance data
+    uint32_t instanceIndex(NodeId node) const;
+    size_t size() const;
+
+    // world transforms of all nodes, in instance index order
+    const std::vector<glm::mat4>& worldMatrices() const;
+
+    // whether any node was created or modified since the last update()
+    bool hasChanges() const;
+
+    // recomputes world transforms of dirty subtrees, returns number of nodes recomputed
+    size_t update();
+
+    // copies world matrices changed since `generation` into `destination` (one per slot),
+    // and advances `generation` to the current generation. Returns the number of matrices copied
+    size_t packWorldMatrices(glm::mat4* destination, uint64_t& generation) const;
+
+private:
+    class Range {
+    public:
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    class History {
+    public:
+        uint64_t generation = 0;
+        std::vector<Range> ranges;
+    };
+
+    static void multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& world);
+
+    void markDirty(NodeId node);
+
+    // number of past updates remembered for incremental packing, must cover all frames in flight
+    static constexpr size_t history_length = 4;
+
+    // per slot
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> subtree_sizes;
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<NodeId> slot_nodes;
+    std::vector<uint8_t> static_flags;
+
+    // per node
+    std::vector<uint32_t> node_slots;
+    std::vector<uint8_t> dirty_flags;
+
+    std::vector<NodeId> dirty_nodes;
+    std::vector<uint32_t> dirty_slots;
+
+    uint64_t generation = 0;
+    uint64_t structure_generation = 0;
+    uint64_t static_generation = 0;
+    std::array<History, history_length> history;
+};
+
+}  // namespace scene
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_SCENE_SCENE_GRAPH_HPP
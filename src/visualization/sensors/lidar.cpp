@@ -0,0 +1,86 @@
+#include "lidar.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace visualization {
+namespace sensors {
+
+Lidar::Lidar(Settings settings) : settings(settings) {
+    if (settings.horizontal_samples == 0 || settings.channels == 0) {
+        throw std::runtime_error("lidar needs at least one channel and horizontal sample");
+    }
+    if (!(settings.min_range < settings.max_range)) {
+        throw std::runtime_error("lidar minimum range must be below its maximum range");
+    }
+
+    directions.reserve(static_cast<size_t>(settings.channels) * settings.horizontal_samples);
+    for (uint32_t channel = 0; channel < settings.channels; channel++) {
+        float elevation = settings.channels == 1
+                              ? 0.5f * (settings.min_elevation + settings.max_elevation)
+                              : settings.min_elevation + (settings.max_elevation - settings.min_elevation) * static_cast<float>(channel) / static_cast<float>(settings.channels - 1);
+
+        for (uint32_t sample = 0; sample < settings.horizontal_samples; sample++) {
+            float azimuth = glm::two_pi<float>() * static_cast<float>(sample) / static_cast<float>(settings.horizontal_samples);
+            directions.emplace_back(std::cos(elevation) * std::cos(azimuth), std::cos(elevation) * std::sin(azimuth), std::sin(elevation));
+        }
+    }
+}
+
+const Lidar::Settings& Lidar::getSettings() const {
+    return settings;
+}
+
+uint32_t Lidar::rayCount() const {
+    return static_cast<uint32_t>(directions.size());
+}
+
+uint32_t Lidar::packetCount() const {
+    constexpr auto packet_size = static_cast<uint32_t>(geometry::Bvh::RayPacket::size);
+    return (rayCount() + packet_size - 1) / packet_size;
+}
+
+void Lidar::scan(const geometry::Bvh& scene, const glm::mat4& pose, float* ranges) const {
+    scanPackets(scene, pose, ranges, 0, packetCount());
+}
+
+void Lidar::scanPackets(const geometry::Bvh& scene, const glm::mat4& pose, float* ranges, uint32_t first, uint32_t count) const {
+    constexpr size_t packet_size = geometry::Bvh::RayPacket::size;
+
+    glm::vec3 origin = glm::vec3(pose[3]);
+    // rays start at the minimum range, so nothing closer can block them
+    float max_distance = settings.max_range - settings.min_range;
+
+    geometry::Bvh::RayPacket packet;
+    for (uint32_t packet_index = first; packet_index < first + count; packet_index++) {
+        size_t first_ray = packet_index * packet_size;
+        packet.count = static_cast<uint32_t>(std::min(packet_size, directions.size() - first_ray));
+
+        for (size_t lane = 0; lane < packet.count; lane++) {
+            glm::vec3 direction = glm::vec3(pose * glm::vec4(directions[first_ray + lane], 0.0f));
+            direction = glm::normalize(direction);
+            packet.set(lane, geometry::Ray{origin + settings.min_range * direction, direction});
+        }
+
+        float* packet_ranges = ranges + first_ray;
+        scene.intersect(packet, max_distance, packet_ranges);
+        for (size_t lane = 0; lane < packet.count; lane++) {
+            packet_ranges[lane] += settings.min_range;
+        }
+    }
+}
+
+void Lidar::scanSingle(const geometry::Bvh& scene, const glm::mat4& pose, float* ranges) const {
+    glm::vec3 origin = glm::vec3(pose[3]);
+    float max_distance = settings.max_range - settings.min_range;
+
+    for (size_t ray = 0; ray < directions.size(); ray++) {
+        glm::vec3 direction = glm::normalize(glm::vec3(pose * glm::vec4(directions[ray], 0.0f)));
+        auto hit = scene.intersect(geometry::Ray{origin + settings.min_range * direction, direction}, max_distance);
+        ranges[ray] = hit.has_value() ? hit->distance + settings.min_range : settings.max_range;
+    }
+}
+
+}  // namespace sensors
+}  // namespace visualization
@@ -0,0 +1,56 @@
+#ifndef BB8_VISUALIZATION_SENSORS_LIDAR_HPP
+#define BB8_VISUALIZATION_SENSORS_LIDAR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../geometry/bvh.hpp"
+#include "../vulkan/glm.hpp"
+
+namespace visualization {
+namespace sensors {
+
+// Spinning lidar, as channels of beams at fixed elevations swept through a full turn.
+// The sensor frame has x forward, y left and z up, and a single channel at zero
+// elevation makes a planar scanner. Neighbouring beams of a channel are cast
+// together as ray packets, since they share an origin and nearly a direction.
+class Lidar {
+public:
+    class Settings {
+    public:
+        uint32_t horizontal_samples = 1024;
+        uint32_t channels = 16;
+        // elevations of the lowest and highest channels, in radians
+        float min_elevation = -0.26f;
+        float max_elevation = 0.26f;
+        float min_range = 0.1f;
+        float max_range = 100.0f;
+    };
+
+    explicit Lidar(Settings settings);
+
+    const Settings& getSettings() const;
+    uint32_t rayCount() const;
+    uint32_t packetCount() const;
+
+    // Casts every beam from `pose`, which maps the sensor frame into the scene's space, and
+    // writes ranges ordered by channel then azimuth to `ranges`, which must hold rayCount()
+    // floats. Beams hitting nothing within range read max_range.
+    void scan(const geometry::Bvh& scene, const glm::mat4& pose, float* ranges) const;
+
+    // casts packets [first, first + count) of a scan, so one scan can be split between threads
+    void scanPackets(const geometry::Bvh& scene, const glm::mat4& pose, float* ranges, uint32_t first, uint32_t count) const;
+
+    // same as scan(), but casting one ray at a time instead of packets, for comparison
+    void scanSingle(const geometry::Bvh& scene, const glm::mat4& pose, float* ranges) const;
+
+private:
+    Settings settings;
+    // unit beam directions in the sensor frame, in output order
+    std::vector<glm::vec3> directions;
+};
+
+}  // namespace sensors
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_SENSORS_LIDAR_HPP
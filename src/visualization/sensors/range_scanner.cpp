@@ -0,0 +1,101 @@
+#include "range_scanner.hpp"
+
+#include <algorithm>
+
+namespace visualization {
+namespace sensors {
+
+RangeScanner::RangeScanner(uint32_t thread_count) {
+    for (uint32_t i = 1; i < std::max(thread_count, 1u); i++) {
+        workers.emplace_back(&RangeScanner::work, this);
+    }
+}
+
+RangeScanner::~RangeScanner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void RangeScanner::run(const geometry::Bvh& scene, const Scan* scans, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        this->scene = &scene;
+        this->scans = scans;
+
+        chunk_ends.clear();
+        uint32_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            total += (scans[i].lidar->packetCount() + packets_per_chunk - 1) / packets_per_chunk;
+            chunk_ends.push_back(total);
+        }
+
+        next_chunk.store(0, std::memory_order_relaxed);
+        busy_workers = static_cast<uint32_t>(workers.size());
+        generation++;
+    }
+    work_available.notify_all();
+
+    castChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this]() { return busy_workers == 0; });
+}
+
+uint32_t RangeScanner::threadCount() const {
+    return static_cast<uint32_t>(workers.size()) + 1;
+}
+
+uint32_t RangeScanner::defaultThreadCount() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void RangeScanner::work() {
+    uint64_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        work_available.wait(lock, [this, seen_generation]() { return stopping || generation != seen_generation; });
+        if (stopping) {
+            return;
+        }
+        seen_generation = generation;
+
+        lock.unlock();
+        castChunks();
+        lock.lock();
+
+        if (--busy_workers == 0) {
+            work_done.notify_all();
+        }
+    }
+}
+
+void RangeScanner::castChunks() {
+    uint32_t chunk_count = chunk_ends.empty() ? 0 : chunk_ends.back();
+
+    while (true) {
+        uint32_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunk_count) {
+            return;
+        }
+
+        auto scan_index = static_cast<size_t>(std::upper_bound(chunk_ends.begin(), chunk_ends.end(), chunk) - chunk_ends.begin());
+        uint32_t scan_first_chunk = scan_index == 0 ? 0 : chunk_ends[scan_index - 1];
+
+        const auto& scan = scans[scan_index];
+        uint32_t first_packet = (chunk - scan_first_chunk) * packets_per_chunk;
+        uint32_t packet_count = std::min(packets_per_chunk, scan.lidar->packetCount() - first_packet);
+        scan.lidar->scanPackets(*scene, scan.pose, scan.ranges, first_packet, packet_count);
+    }
+}
+
+}  // namespace sensors
+}  // namespace visualization
@@ -0,0 +1,80 @@
+#ifndef BB8_VISUALIZATION_SENSORS_RANGE_SCANNER_HPP
+#define BB8_VISUALIZATION_SENSORS_RANGE_SCANNER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../geometry/bvh.hpp"
+#include "lidar.hpp"
+
+namespace visualization {
+namespace sensors {
+
+// Casts the scans of many range sensors on a pool of worker threads. Scans are split
+// into chunks of ray packets which threads claim from a shared counter, so one long
+// scan is shared between threads as well as many short ones. Ranges are written
+// straight into buffers the caller owns, and once a batch of a given size has been
+// run, running it again doesn't allocate.
+class RangeScanner {
+public:
+    class Scan {
+    public:
+        const Lidar* lidar;
+        // sensor frame to scene space
+        glm::mat4 pose;
+        // holds lidar->rayCount() floats
+        float* ranges;
+    };
+
+    explicit RangeScanner(uint32_t thread_count = defaultThreadCount());
+
+    RangeScanner(const RangeScanner&) = delete;
+    RangeScanner& operator=(const RangeScanner&) = delete;
+
+    // workers refer back to the scanner, so it can't be moved
+    RangeScanner(RangeScanner&&) = delete;
+    RangeScanner& operator=(RangeScanner&&) = delete;
+
+    ~RangeScanner();
+
+    // blocks until every scan's ranges are written, the calling thread casts rays too
+    void run(const geometry::Bvh& scene, const Scan* scans, size_t count);
+
+    // including the thread calling run()
+    uint32_t threadCount() const;
+
+    static uint32_t defaultThreadCount();
+
+private:
+    // a chunk of 8 packets is 128 rays, enough to amortize claiming it
+    static constexpr uint32_t packets_per_chunk = 8;
+
+    void work();
+    // casts chunks of the current batch until none are left
+    void castChunks();
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    uint64_t generation = 0;
+    uint32_t busy_workers = 0;
+    bool stopping = false;
+
+    // current batch, only changed while no worker is busy
+    const geometry::Bvh* scene = nullptr;
+    const Scan* scans = nullptr;
+    // running total of chunks up to and including each scan
+    std::vector<uint32_t> chunk_ends;
+    std::atomic<uint32_t> next_chunk{0};
+
+    std::vector<std::thread> workers;
+};
+
+}  // namespace sensors
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_SENSORS_RANGE_SCANNER_HPP
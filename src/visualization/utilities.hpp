@@ -0,0 +1,30 @@
+#ifndef BB8_VISUALIZATION_UTILITIES_HPP
+#define BB8_VISUALIZATION_UTILITIES_HPP
+
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+namespace visualization {
+
+// parses all of `text` as a number into `value`, leaving it unchanged if `text` isn't one
+template <typename Number>
+bool parseNumber(const char* text, Number& value) {
+    // streams wrap negative numbers into unsigned types rather than failing
+    if (std::is_unsigned_v<Number> && std::strchr(text, '-') != nullptr) {
+        return false;
+    }
+
+    std::istringstream stream(text);
+    Number parsed;
+    if (!(stream >> parsed) || !stream.eof()) {
+        return false;
+    }
+
+    value = parsed;
+    return true;
+}
+
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_UTILITIES_HPP
@@ -6,14 +6,29 @@ namespace visualization {
 
 Visualization::Visualization(std::string name) : window(name), vulkan(name, &window), minimized(window.is_minimized()) {
     window.setResizeCallback(std::bind(&Visualization::resizeCallback, this));
+    window.setRefreshCallback(std::bind(&Visualization::refreshCallback, this));
 }
 
 void Visualization::run() {
     while (true) {
-        bool should_close = minimized ? window.wait() : window.update();
+        bool should_close;
+        if (minimized) {
+            should_close = window.wait();
+        } else if (shouldDraw()) {
+            should_close = window.update();
+        } else {
+            // woken early by window events and requestRedraw()
+            should_close = window.wait(idle_timeout);
+        }
+
         if (should_close) {
             break;
-        } else if (!minimized) {
+        } else if (!minimized && shouldDraw()) {
+            // requests arriving while drawing are kept for the next frame
+            if (redraw_requested.exchange(false)) {
+                vulkan.invalidate();
+            }
+
             vulkan.update();
         }
     }
@@ -21,6 +36,34 @@ void Visualization::run() {
     vulkan.exit();
 }
 
+bool Visualization::step() {
+    if (minimized) {
+        return !window.wait();
+    } else if (window.update()) {
+        return false;
+    }
+
+    vulkan.update();
+    return true;
+}
+
+void Visualization::setRenderMode(RenderMode mode) {
+    render_mode = mode;
+}
+
+void Visualization::requestRedraw() {
+    redraw_requested = true;
+    vulkan::Window::wake();
+}
+
+vulkan::Application& Visualization::application() {
+    return vulkan;
+}
+
+bool Visualization::shouldDraw() const {
+    return render_mode == RenderMode::continuous || redraw_requested || vulkan.needsRedraw();
+}
+
 void Visualization::resizeCallback() {
     minimized = window.is_minimized();
     if (!minimized) {
@@ -28,4 +71,8 @@ void Visualization::resizeCallback() {
     }
 }
 
+void Visualization::refreshCallback() {
+    vulkan.invalidate();
+}
+
 }  // namespace visualization
@@ -1,6 +1,7 @@
 #ifndef BB8_VISUALIZATION_VISUALIZATION_HPP
 #define BB8_VISUALIZATION_VISUALIZATION_HPP
 
+#include <atomic>
 #include <string>
 
 #include "vulkan/application.hpp"
@@ -10,17 +11,42 @@ namespace visualization {
 
 class Visualization {
 public:
+    enum class RenderMode {
+        // draws a new frame as fast as presentation allows
+        continuous,
+        // draws only when something changed, otherwise sleeps until events arrive
+        on_demand,
+    };
+
     Visualization(std::string name);
 
     void run();
+    // handles window events and draws one frame regardless of render mode,
+    // returns false once the window is closing
+    bool step();
+
+    void setRenderMode(RenderMode mode);
+
+    // asks for a new frame, e.g. when new simulation state has arrived. Safe to call from any thread
+    void requestRedraw();
+
+    vulkan::Application& application();
 
 private:
+    // longest an idle on-demand loop sleeps before checking for changes again
+    static constexpr double idle_timeout = 0.25;
+
     vulkan::Window window;
     vulkan::Application vulkan;
 
     bool minimized;
+    RenderMode render_mode = RenderMode::continuous;
+    std::atomic<bool> redraw_requested{false};
+
+    bool shouldDraw() const;
 
     void resizeCallback();
+    void refreshCallback();
 };
 
 }  // namespace visualization
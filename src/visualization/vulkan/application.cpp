@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
 #include <fstream>
+#include <glm/gtc/constants.hpp>
 #include <iostream>
 #include <limits>
 #include <sstream>
@@ -11,9 +13,17 @@
 
 #include "glm.hpp"
 #include "model.hpp"
+#include "pipeline_state.hpp"
 #include "shaders.hpp"
+#include "shaders/cull_uniforms.hpp"
+#include "shaders/instance.hpp"
+#include "shaders/lighting_uniforms.hpp"
+#include "shaders/line_vertex.hpp"
+#include "shaders/point.hpp"
+#include "shaders/terrain.hpp"
 #include "shaders/uniform_buffer_object.hpp"
 #include "shaders/vertex.hpp"
+#include "specialization.hpp"
 
 namespace visualization {
 namespace vulkan {
@@ -23,27 +33,62 @@ const std::vector<std::string> Application::device_extensions = {VK_KHR_SWAPCHAI
 
 Application::Application(std::string name, Window* window)
     : window(window),
-      instance(buildInstance(context, window, name, VK_MAKE_VERSION(0, 0, 1))),
-      surface(window->createSurface(instance)),
-      device(buildDevice(instance, *surface)),
+      assets(std::async(std::launch::async, [this]() {
+          return startup.measure("asset_decode", []() { return Model::decode(model_file, texture_file); });
+      })),
+      instance(startup.measure("instance", [&]() { return buildInstance(context, window, name, VK_MAKE_VERSION(0, 0, 1)); })),
+      surface(startup.measure("surface", [&]() { return window->createSurface(instance); })),
+      device(startup.measure("device", [&]() { return buildDevice(instance, *surface); })),
       descriptor_set_layout(buildDescriptorLayout(device)),
       pipeline_layout(nullptr),
       render_pass(nullptr),
-      pipeline(nullptr),
+      pipelines(device),
       command_pool(device.createPool(false)),
       descriptor_pool(createDescriptorPool(device)),
       depth_buffer(device, 1, 1),
+      render_target(device, vk::Format::eB8G8R8A8Unorm, vk::Extent2D(1, 1)),
+      dynamic_resolution(DynamicResolution::Settings()),
+      gpu_timer(device, max_frames_in_flight),
+      depth_pyramid(device, depth_buffer, vk::Extent2D(1, 1)),
       model(createModel()),
-      frames({FrameResources(device, *command_pool, *descriptor_pool, *descriptor_set_layout, model.getTexture()),
-              FrameResources(device, *command_pool, *descriptor_pool, *descriptor_set_layout, model.getTexture())}),
+      cluster_culler(device, model, max_frames_in_flight),
+      debug_draw(device, max_frames_in_flight),
+      point_cloud(device, max_frames_in_flight),
+      shadow_maps(device),
+      light_direction(glm::normalize(glm::vec3(-0.4f, -0.3f, -1.0f))),
+      clustered_lighting(device, max_frames_in_flight),
+      model_node(scene.createNode(scene::SceneGraph::none, glm::mat4(1.0f))),
+      camera(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::radians(45.0f), 0.1f, 10.0f),
+      frames({FrameResources(device, *command_pool, *descriptor_pool, *descriptor_set_layout, model.getTexture(), shadow_maps),
+              FrameResources(device, *command_pool, *descriptor_pool, *descriptor_set_layout, model.getTexture(), shadow_maps)}),
       swap_chain(device, *surface, window->size()) {
-    buildRenderPass();
-    buildSwapChain();
-    buildGraphicsPipeline();
+    startup.measure("render_pass", [this]() { buildRenderPass(); });
+    startup.measure("swap_chain", [this]() { buildSwapChain(); });
+    // only requests compilation, which continues in the background until the first frame needs them
+    startup.measure("pipeline_requests", [this]() {
+        buildGraphicsPipeline();
+        buildLinePipeline();
+        buildPointPipeline();
+        buildShadowPipeline();
+    });
+
+    // ring of colored work lights around the model
+    constexpr int light_count = 8;
+    for (int i = 0; i < light_count; i++) {
+        float angle = 2.0f * glm::pi<float>() * i / light_count;
+        glm::vec3 position = glm::vec3(1.5f * std::cos(angle), 1.5f * std::sin(angle), 0.75f);
+        glm::vec3 color = glm::vec3(0.5f + 0.5f * std::cos(angle), 0.5f + 0.5f * std::cos(angle + 2.1f), 0.5f + 0.5f * std::cos(angle + 4.2f));
+        lights.push_back(scene::Light::point(position, 0.5f * color, 2.0f));
+    }
 }
 
 void Application::update() {
+    auto frame_start = std::chrono::steady_clock::now();
     drawFrame();
+
+    if (metrics) {
+        publishMetrics(frame_start, std::chrono::steady_clock::now());
+    }
 }
 
 void Application::exit() {
@@ -54,10 +99,211 @@ void Application::onResize() {
     buildSwapChain();
 }
 
+bool Application::needsRedraw() const {
+    return hasChanged() || settling_frames > 0 || (shader_reloader && shader_reloader->hasUpdates());
+}
+
+void Application::invalidate() {
+    damaged = true;
+}
+
+void Application::setAnimated(bool animate) {
+    animated = animate;
+    setStatic(model_node, !animate);
+}
+
+void Application::setAnimationTime(std::optional<double> seconds) {
+    animation_time = seconds;
+}
+
+void Application::setVsync(bool enable) {
+    if (vsync != enable) {
+        vsync = enable;
+        buildSwapChain();
+    }
+}
+
+std::optional<double> Application::lastGpuFrameTime() const {
+    return gpu_frame_ms;
+}
+
+bool Application::enablePipelineStatistics() {
+    if (!PipelineStatistics::isSupported(device)) {
+        return false;
+    }
+
+    if (!pipeline_statistics.has_value()) {
+        pipeline_statistics.emplace(device, max_frames_in_flight);
+    }
+    return true;
+}
+
+std::optional<PipelineStatistics::Frame> Application::lastPipelineStatistics() const {
+    return frame_statistics;
+}
+
+scene::Camera& Application::getCamera() {
+    return camera;
+}
+
+scene::SceneGraph::NodeId Application::getModelNode() const {
+    return model_node;
+}
+
+void Application::setStatic(scene::SceneGraph::NodeId node, bool is_static) {
+    auto generation = scene.staticGeneration();
+    scene.setStatic(node, is_static);
+
+    // cached shadows change even though no transform did
+    if (scene.staticGeneration() != generation) {
+        damaged = true;
+    }
+}
+
+DebugDraw& Application::debugDraw() {
+    return debug_draw;
+}
+
+PointCloud& Application::pointCloud() {
+    return point_cloud;
+}
+
+std::vector<scene::Light>& Application::getLights() {
+    return lights;
+}
+
+void Application::setTerrain(geometry::Heightfield heightfield, Terrain::Settings settings) {
+    device.waitIdle();
+
+    // the pipeline layout belongs to the terrain, so the previous pipeline can't be a fallback
+    if (terrain_pipeline.has_value()) {
+        pipelines.release(*terrain_pipeline);
+        terrain_pipeline.reset();
+    }
+
+    terrain.reset();
+    terrain.emplace(device, std::move(heightfield), max_frames_in_flight, settings);
+    buildTerrainPipeline();
+    damaged = true;
+}
+
+const Terrain* Application::getTerrain() const {
+    return terrain.has_value() ? &terrain.value() : nullptr;
+}
+
+void Application::enableSensors(vk::Extent2D resolution, uint32_t camera_count) {
+    device.waitIdle();
+
+    // the pipeline layout and render pass belong to the renderer, so the previous pipeline can't be a fallback
+    if (sensor_pipeline.has_value()) {
+        pipelines.release(*sensor_pipeline);
+        sensor_pipeline.reset();
+    }
+
+    sensor_renderer.reset();
+    sensor_renderer.emplace(device, model, resolution, camera_count);
+    buildSensorPipeline();
+    sensor_cameras.resize(camera_count, camera);
+    damaged = true;
+}
+
+std::vector<scene::Camera>& Application::getSensorCameras() {
+    return sensor_cameras;
+}
+
+SensorRenderer* Application::sensorRenderer() {
+    return sensor_renderer.has_value() ? &sensor_renderer.value() : nullptr;
+}
+
+void Application::enableSensorOutputs() {
+    if (sensor_outputs_enabled) {
+        return;
+    }
+
+    device.waitIdle();
+    sensor_outputs_enabled = true;
+
+    // releasing waits for pending compiles, which refer to the render pass about to be destroyed
+    for (auto* handle : {&pipeline, &line_pipeline, &point_pipeline, &terrain_pipeline}) {
+        if (handle->has_value()) {
+            pipelines.release(**handle);
+            handle->reset();
+        }
+    }
+    for (auto handle : retired_pipelines) {
+        pipelines.release(handle);
+    }
+    retired_pipelines.clear();
+
+    buildRenderPass();
+    buildSwapChain();
+    buildGraphicsPipeline();
+    buildLinePipeline();
+    buildPointPipeline();
+    buildTerrainPipeline();
+}
+
+std::optional<SensorOutputs::Readback> Application::readSensorOutputs() {
+    if (!sensor_outputs.has_value() || !last_submitted_frame.has_value()) {
+        return std::nullopt;
+    }
+
+    frames[*last_submitted_frame].waitUntilReady(device);
+    return sensor_outputs->readback(*last_submitted_frame);
+}
+
+void Application::enableShaderHotReload(std::filesystem::path source_directory, std::filesystem::path cache_directory) {
+    shader_reloader = std::make_unique<ShaderReloader>(std::move(source_directory), std::move(cache_directory));
+}
+
+void Application::setDynamicResolution(DynamicResolution::Settings settings) {
+    device.waitIdle();
+    dynamic_resolution.setSettings(settings);
+
+    // largest render extent may have changed
+    buildRenderTargets();
+}
+
+const DynamicResolution& Application::dynamicResolution() const {
+    return dynamic_resolution;
+}
+
+const StartupProfile& Application::startupProfile() const {
+    return startup;
+}
+
+MemoryUsage& Application::memoryUsage() {
+    return device.memoryUsage();
+}
+
+void Application::enableMetrics(const std::string& segment_name) {
+    metrics = std::make_unique<profiling::Metrics>(segment_name);
+
+    auto frame_time_bounds = profiling::Metrics::exponentialBounds(0.5, 1.5, 15);
+    frame_metrics.frames = metrics->counter("frames");
+    frame_metrics.cpu_frame_ms = metrics->histogram("cpu_frame_ms", frame_time_bounds);
+    frame_metrics.gpu_frame_ms = metrics->histogram("gpu_frame_ms", frame_time_bounds);
+    frame_metrics.frame_rate = metrics->gauge("frame_rate");
+    frame_metrics.device_memory_bytes = metrics->gauge("device_memory_bytes");
+    frame_metrics.uploaded_bytes = metrics->counter("uploaded_bytes");
+}
+
 vk::raii::DescriptorSetLayout Application::buildDescriptorLayout(const Device& device) {
     auto ubo_layout_binding = shaders::UniformBufferObject::layoutBinding();
     auto texture_sampler_layout_binding = vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment);
-    std::vector<vk::DescriptorSetLayoutBinding> layout_bindings = {ubo_layout_binding, texture_sampler_layout_binding};
+    auto lighting_layout_binding = vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eFragment);
+    auto static_shadow_layout_binding = vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment);
+    auto dynamic_shadow_layout_binding = vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment);
+    auto lights_layout_binding = vk::DescriptorSetLayoutBinding(5, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eFragment);
+    auto cluster_lights_layout_binding = vk::DescriptorSetLayoutBinding(6, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eFragment);
+    std::vector<vk::DescriptorSetLayoutBinding> layout_bindings = {
+        ubo_layout_binding,
+        texture_sampler_layout_binding,
+        lighting_layout_binding,
+        static_shadow_layout_binding,
+        dynamic_shadow_layout_binding,
+        lights_layout_binding,
+        cluster_lights_layout_binding};
 
     auto descriptor_layout_create_info = vk::DescriptorSetLayoutCreateInfo({}, layout_bindings);
     return vk::raii::DescriptorSetLayout(device.logical(), descriptor_layout_create_info);
@@ -88,9 +334,32 @@ Device Application::buildDevice(const vk::raii::Instance& instance, const vk::Su
 void Application::buildSwapChain() {
     device.waitIdle();
 
-    swap_chain = SwapChain(device, *surface, window->size());
-    depth_buffer = DepthBuffer(device, swap_chain.getExtent().width, swap_chain.getExtent().height);
-    swap_chain.initializeFramebuffers(device, *render_pass, depth_buffer);
+    swap_chain = SwapChain(device, *surface, window->size(), vsync);
+    buildRenderTargets();
+}
+
+void Application::buildRenderTargets() {
+    // sized for the largest scale, so scale changes only change the rendered region
+    auto extent = dynamic_resolution.maxExtent(swap_chain.getExtent());
+    render_extent = dynamic_resolution.renderExtent(swap_chain.getExtent());
+
+    depth_buffer = DepthBuffer(device, extent.width, extent.height);
+    render_target = RenderTarget(device, swap_chain.getFormat(), extent);
+
+    if (sensor_outputs_enabled) {
+        sensor_outputs.reset();
+        sensor_outputs.emplace(device, extent, max_frames_in_flight);
+        render_target.initializeFramebuffer(device, *render_pass, depth_buffer, sensor_outputs->views());
+    } else {
+        render_target.initializeFramebuffer(device, *render_pass, depth_buffer);
+    }
+
+    depth_pyramid = DepthPyramid(device, depth_buffer, extent);
+    depth_pyramid_valid = false;
+
+    point_cloud.resize(extent);
+
+    damaged = true;
 }
 
 void Application::buildRenderPass() {
@@ -103,88 +372,125 @@ void Application::buildRenderPass() {
         vk::AttachmentLoadOp::eDontCare,
         vk::AttachmentStoreOp::eDontCare,
         vk::ImageLayout::eUndefined,
-        vk::ImageLayout::ePresentSrcKHR);
+        vk::ImageLayout::eTransferSrcOptimal);
 
     auto depth_attachment = vk::AttachmentDescription(
         {},
         depth_buffer.getFormat(),
         vk::SampleCountFlagBits::e1,
         vk::AttachmentLoadOp::eClear,
-        vk::AttachmentStoreOp::eDontCare,
+        vk::AttachmentStoreOp::eStore,
         vk::AttachmentLoadOp::eDontCare,
         vk::AttachmentStoreOp::eDontCare,
         vk::ImageLayout::eUndefined,
-        vk::ImageLayout::eDepthStencilAttachmentOptimal);
+        DepthPyramid::depth_layout);
 
-    auto color_reference = vk::AttachmentReference(0, vk::ImageLayout::eColorAttachmentOptimal);
+    auto attachments = std::vector<vk::AttachmentDescription>{color_attachment, depth_attachment};
+    auto color_references = std::vector<vk::AttachmentReference>{vk::AttachmentReference(0, vk::ImageLayout::eColorAttachmentOptimal)};
     auto depth_reference = vk::AttachmentReference(1, vk::ImageLayout::eDepthStencilAttachmentOptimal);
 
-    auto subpass = vk::SubpassDescription({}, vk::PipelineBindPoint::eGraphics, {}, color_reference, {}, &depth_reference, {});
+    // sensor outputs follow depth, and are written to fragment outputs after color
+    if (sensor_outputs_enabled) {
+        for (const auto& description : SensorOutputs::attachmentDescriptions()) {
+            color_references.emplace_back(static_cast<uint32_t>(attachments.size()), vk::ImageLayout::eColorAttachmentOptimal);
+            attachments.push_back(description);
+        }
+    }
+
+    auto subpass = vk::SubpassDescription({}, vk::PipelineBindPoint::eGraphics, {}, color_references, {}, &depth_reference, {});
 
+    // depth is cleared only after the previous frame's depth pyramid build has finished reading it,
+    // and color and sensor outputs only once the previous frame has copied them out
     auto subpass_dependency = vk::SubpassDependency(
         VK_SUBPASS_EXTERNAL,
         0u,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
         vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
         {},
         vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
         {});
 
-    auto attachments = std::vector<vk::AttachmentDescription>{color_attachment, depth_attachment};
-    auto render_pass_create_info = vk::RenderPassCreateInfo({}, attachments, subpass, subpass_dependency, nullptr);
+    // depth pyramid is built from the depth buffer once rendering finishes
+    auto depth_read_dependency = vk::SubpassDependency(
+        0u,
+        VK_SUBPASS_EXTERNAL,
+        vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::AccessFlagBits::eShaderRead,
+        {});
+
+    // color is upscaled onto the swap chain, and sensor outputs copied to their readback buffers, once rendering finishes
+    auto color_read_dependency = vk::SubpassDependency(
+        0u,
+        VK_SUBPASS_EXTERNAL,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::AccessFlagBits::eColorAttachmentWrite,
+        vk::AccessFlagBits::eTransferRead,
+        {});
+
+    auto dependencies = std::vector<vk::SubpassDependency>{subpass_dependency, depth_read_dependency, color_read_dependency};
+    auto render_pass_create_info = vk::RenderPassCreateInfo({}, attachments, subpass, dependencies, nullptr);
 
     render_pass = vk::raii::RenderPass(device.logical(), render_pass_create_info, nullptr);
 }
 
+uint32_t Application::colorAttachmentCount() const {
+    return sensor_outputs_enabled ? 1 + static_cast<uint32_t>(SensorOutputs::attachmentDescriptions().size()) : 1;
+}
+
 vk::raii::DescriptorPool Application::createDescriptorPool(const Device& device) {
-    auto ubo_size = vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, max_frames_in_flight);
-    auto sampler_size = vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, max_frames_in_flight);
-    auto pool_sizes = std::vector<vk::DescriptorPoolSize>{ubo_size, sampler_size};
+    // view/projection and lighting uniforms, texture and two shadow map samplers, lights and clusters per frame
+    auto ubo_size = vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, 2 * max_frames_in_flight);
+    auto sampler_size = vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, 3 * max_frames_in_flight);
+    auto storage_size = vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 2 * max_frames_in_flight);
+    auto pool_sizes = std::vector<vk::DescriptorPoolSize>{ubo_size, sampler_size, storage_size};
     auto create_info = vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, max_frames_in_flight, pool_sizes);
 
     return vk::raii::DescriptorPool(device.logical(), create_info);
 }
 
 Model Application::createModel() {
-    return Model::load(device, "resources/models/viking_room.obj", "resources/textures/viking_room.png");
+    auto decoded = startup.measure("asset_wait", [this]() { return assets.get(); });
+    return startup.measure("model_upload", [this, &decoded]() { return Model::load(device, std::move(decoded)); });
 }
 
 void Application::buildGraphicsPipeline() {
-    auto vert_shader_create_info = vk::ShaderModuleCreateInfo({}, shaders::vert_shader, nullptr);
-    auto vert_shader_module = vk::raii::ShaderModule(device.logical(), vert_shader_create_info);
-
-    auto frag_shader_create_info = vk::ShaderModuleCreateInfo({}, shaders::frag_shader, nullptr);
-    auto frag_shader_module = vk::raii::ShaderModule(device.logical(), frag_shader_create_info);
-
-    std::array<vk::PipelineShaderStageCreateInfo, 2> shader_stages = {
-        vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eVertex, *vert_shader_module, "main"),
-        vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eFragment, *frag_shader_module, "main")};
-
-    auto binding_descriptions = shaders::Vertex::getBindingDescription();
-    auto attribute_descriptions = shaders::Vertex::getAttributeDescriptions();
-    auto vertex_input = vk::PipelineVertexInputStateCreateInfo(vk::PipelineVertexInputStateCreateFlags(), binding_descriptions, attribute_descriptions, nullptr);
-
-    auto input_assembly = vk::PipelineInputAssemblyStateCreateInfo({}, vk::PrimitiveTopology::eTriangleList, false, nullptr);
-
-    auto viewport_create_info = vk::PipelineViewportStateCreateInfo({}, 1, nullptr, 1, nullptr);
-
-    std::vector<vk::DynamicState> dynamic_states = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
-    auto dynamic_states_create_info = vk::PipelineDynamicStateCreateInfo({}, dynamic_states, nullptr);
-
-    auto rasterizer = vk::PipelineRasterizationStateCreateInfo({},                                // flags
-                                                               false,                             // depthClampEnable
-                                                               false,                             // rasterizerDiscardEnable
-                                                               vk::PolygonMode::eFill,            // polygonMode
-                                                               vk::CullModeFlagBits::eNone,       // cullMode
-                                                               vk::FrontFace::eCounterClockwise,  // frontFace
-                                                               false,                             // depthBiasEnable
-                                                               0.0f,                              // depthBiasConstantFactor
-                                                               0.0f,                              // depthBiasClamp
-                                                               0.0f,                              // depthBiasSlopeFactor
-                                                               1.0f                               // lineWidth
-    );
+    // layout outlives pipeline rebuilds, older pipelines may still be bound by frames in flight
+    if (!*pipeline_layout) {
+        auto layout_create_info = vk::PipelineLayoutCreateInfo({}, *descriptor_set_layout, {});
+        pipeline_layout = vk::raii::PipelineLayout(device.logical(), layout_create_info);
+    }
 
-    auto multisample = vk::PipelineMultisampleStateCreateInfo({}, vk::SampleCountFlagBits::e1);
+    auto state = PipelineState(*pipeline_layout, *render_pass);
+
+    auto vert_shader = shaderCode("vert_shader");
+    auto frag_shader = shaderCode("frag_shader");
+    state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+    // fragment shader variant that also writes sensor outputs
+    state.addStage(vk::ShaderStageFlagBits::eFragment, frag_shader.code, frag_shader.size, Specialization().setBool(0, sensor_outputs_enabled));
+
+    auto vertex_attributes = shaders::Vertex::getAttributeDescriptions();
+    auto instance_attributes = shaders::Instance::getAttributeDescriptions();
+    state.bindings = {shaders::Vertex::getBindingDescription(), shaders::Instance::getBindingDescription()};
+    state.attributes.assign(vertex_attributes.begin(), vertex_attributes.end());
+    state.attributes.insert(state.attributes.end(), instance_attributes.begin(), instance_attributes.end());
+
+    state.topology = vk::PrimitiveTopology::eTriangleList;
+
+    state.rasterization = vk::PipelineRasterizationStateCreateInfo({},                                // flags
+                                                                   false,                             // depthClampEnable
+                                                                   false,                             // rasterizerDiscardEnable
+                                                                   vk::PolygonMode::eFill,            // polygonMode
+                                                                   vk::CullModeFlagBits::eNone,       // cullMode
+                                                                   vk::FrontFace::eCounterClockwise,  // frontFace
+                                                                   false,                             // depthBiasEnable
+                                                                   0.0f,                              // depthBiasConstantFactor
+                                                                   0.0f,                              // depthBiasClamp
+                                                                   0.0f,                              // depthBiasSlopeFactor
+                                                                   1.0f                               // lineWidth
+    );
 
     using ccflags = vk::ColorComponentFlagBits;
     auto color_write_mask = vk::ColorComponentFlags(ccflags::eR | ccflags::eG | ccflags::eB | ccflags::eA);
@@ -198,17 +504,10 @@ void Application::buildGraphicsPipeline() {
                                                                         color_write_mask         // colorWriteMask
     );
 
-    auto color_blend = vk::PipelineColorBlendStateCreateInfo({},                         // flags
-                                                             false,                      // logicOpEnable
-                                                             vk::LogicOp::eNoOp,         // logicOp
-                                                             color_blend_attachment,     // attachments
-                                                             {{1.0f, 1.0f, 1.0f, 1.0f}}  // blendConstants
-    );
-
-    auto layout_create_info = vk::PipelineLayoutCreateInfo({}, *descriptor_set_layout, {});
-    pipeline_layout = vk::raii::PipelineLayout(device.logical(), layout_create_info);
+    // sensor outputs are written without blending, like color
+    state.blend_attachments = std::vector<vk::PipelineColorBlendAttachmentState>(colorAttachmentCount(), color_blend_attachment);
 
-    auto depth_stencil = vk::PipelineDepthStencilStateCreateInfo(
+    state.depth_stencil = vk::PipelineDepthStencilStateCreateInfo(
         {},                    // flags
         true,                  // depth test enable
         true,                  // depth write enable
@@ -221,64 +520,391 @@ void Application::buildGraphicsPipeline() {
         1.0                    // max depth bound
     );
 
-    auto pipeline_create_info = vk::GraphicsPipelineCreateInfo(
-        {},                           // flags
-        shader_stages,                // stages
-        &vertex_input,                // vertex input state
-        &input_assembly,              // input assembly state
-        nullptr,                      // tessellation state
-        &viewport_create_info,        // viewport state
-        &rasterizer,                  // rasterization state
-        &multisample,                 // multisample state
-        &depth_stencil,               // depth stencil state
-        &color_blend,                 // color blend state
-        &dynamic_states_create_info,  // dynamic state
-        *pipeline_layout,             // layout
-        *render_pass                  // render pass
+    replacePipeline(pipeline, std::move(state));
+}
+
+void Application::buildLinePipeline() {
+    auto state = PipelineState(*pipeline_layout, *render_pass);
+
+    auto vert_shader = shaderCode("line_vert_shader");
+    auto frag_shader = shaderCode("line_frag_shader");
+    state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+    state.addStage(vk::ShaderStageFlagBits::eFragment, frag_shader.code, frag_shader.size);
+
+    auto attribute_descriptions = shaders::LineVertex::getAttributeDescriptions();
+    state.bindings = {shaders::LineVertex::getBindingDescription()};
+    state.attributes.assign(attribute_descriptions.begin(), attribute_descriptions.end());
+
+    state.topology = vk::PrimitiveTopology::eLineList;
+
+    state.rasterization = vk::PipelineRasterizationStateCreateInfo({}, false, false, vk::PolygonMode::eFill, vk::CullModeFlagBits::eNone, vk::FrontFace::eCounterClockwise, false, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    using ccflags = vk::ColorComponentFlagBits;
+    auto color_write_mask = vk::ColorComponentFlags(ccflags::eR | ccflags::eG | ccflags::eB | ccflags::eA);
+    auto color_blend_attachment = vk::PipelineColorBlendAttachmentState(true,                                // blendEnable
+                                                                        vk::BlendFactor::eSrcAlpha,          // srcColorBlendFactor
+                                                                        vk::BlendFactor::eOneMinusSrcAlpha,  // dstColorBlendFactor
+                                                                        vk::BlendOp::eAdd,                   // colorBlendOp
+                                                                        vk::BlendFactor::eOne,               // srcAlphaBlendFactor
+                                                                        vk::BlendFactor::eZero,              // dstAlphaBlendFactor
+                                                                        vk::BlendOp::eAdd,                   // alphaBlendOp
+                                                                        color_write_mask                     // colorWriteMask
     );
+    // lines only draw color, sensor outputs are left untouched
+    state.blend_attachments = std::vector<vk::PipelineColorBlendAttachmentState>(colorAttachmentCount(), vk::PipelineColorBlendAttachmentState());
+    state.blend_attachments[0] = color_blend_attachment;
 
-    pipeline = vk::raii::Pipeline(device.logical(), nullptr, pipeline_create_info);
+    // lines are depth tested but don't write depth, so they never occlude geometry
+    // (or affect occlusion culling through the depth pyramid)
+    state.depth_stencil = vk::PipelineDepthStencilStateCreateInfo({}, true, false, vk::CompareOp::eLessOrEqual, false, false, {}, {}, 0.0, 1.0);
+
+    // shares the main pipeline's layout and descriptors, only the view/projection uniforms are used
+    replacePipeline(line_pipeline, std::move(state));
 }
 
-void Application::updateUniformBuffer() {
-    static auto startTime = std::chrono::high_resolution_clock::now();
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+void Application::buildPointPipeline() {
+    auto state = PipelineState(point_cloud.pipelineLayout(), *render_pass);
+
+    if (point_cloud.usesCompute()) {
+        // composites the splatted visibility buffer with a fullscreen triangle
+        auto vert_shader = shaderCode("point_resolve_vert_shader");
+        auto frag_shader = shaderCode("point_resolve_frag_shader");
+        state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+        state.addStage(vk::ShaderStageFlagBits::eFragment, frag_shader.code, frag_shader.size);
+        state.topology = vk::PrimitiveTopology::eTriangleList;
+    } else {
+        auto vert_shader = shaderCode("point_vert_shader");
+        auto frag_shader = shaderCode("line_frag_shader");
+        state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+        state.addStage(vk::ShaderStageFlagBits::eFragment, frag_shader.code, frag_shader.size);
+
+        auto attribute_descriptions = shaders::Point::getAttributeDescriptions();
+        state.bindings = {shaders::Point::getBindingDescription()};
+        state.attributes.assign(attribute_descriptions.begin(), attribute_descriptions.end());
+        state.topology = vk::PrimitiveTopology::ePointList;
+    }
+
+    state.rasterization = vk::PipelineRasterizationStateCreateInfo({}, false, false, vk::PolygonMode::eFill, vk::CullModeFlagBits::eNone, vk::FrontFace::eCounterClockwise, false, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    // points only draw color, sensor outputs are left untouched
+    using ccflags = vk::ColorComponentFlagBits;
+    auto color_write_mask = vk::ColorComponentFlags(ccflags::eR | ccflags::eG | ccflags::eB | ccflags::eA);
+    state.blend_attachments = std::vector<vk::PipelineColorBlendAttachmentState>(colorAttachmentCount(), vk::PipelineColorBlendAttachmentState());
+    state.blend_attachments[0].colorWriteMask = color_write_mask;
+
+    // like lines, points are depth tested against the scene but don't write depth
+    state.depth_stencil = vk::PipelineDepthStencilStateCreateInfo({}, true, false, vk::CompareOp::eLessOrEqual, false, false, {}, {}, 0.0, 1.0);
+
+    // uses the point cloud's own layout, with its constants and visibility buffer
+    replacePipeline(point_pipeline, std::move(state));
+}
+
+void Application::buildTerrainPipeline() {
+    if (!terrain.has_value()) {
+        return;
+    }
+
+    auto state = PipelineState(terrain->pipelineLayout(), *render_pass);
+
+    auto vert_shader = shaderCode("terrain_vert_shader");
+    auto frag_shader = shaderCode("terrain_frag_shader");
+    state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+    state.addStage(vk::ShaderStageFlagBits::eFragment, frag_shader.code, frag_shader.size, Specialization().setBool(0, sensor_outputs_enabled));
+
+    auto attribute_descriptions = shaders::TerrainVertex::getAttributeDescriptions();
+    state.bindings = {shaders::TerrainVertex::getBindingDescription()};
+    state.attributes.assign(attribute_descriptions.begin(), attribute_descriptions.end());
+
+    // strips are drawn with their axes swapped, which flips their winding
+    state.rasterization = vk::PipelineRasterizationStateCreateInfo({}, false, false, vk::PolygonMode::eFill, vk::CullModeFlagBits::eNone, vk::FrontFace::eCounterClockwise, false, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    // opaque like the model, including its sensor outputs
+    using ccflags = vk::ColorComponentFlagBits;
+    auto color_write_mask = vk::ColorComponentFlags(ccflags::eR | ccflags::eG | ccflags::eB | ccflags::eA);
+    auto color_blend_attachment = vk::PipelineColorBlendAttachmentState();
+    color_blend_attachment.colorWriteMask = color_write_mask;
+    state.blend_attachments = std::vector<vk::PipelineColorBlendAttachmentState>(colorAttachmentCount(), color_blend_attachment);
+
+    state.depth_stencil = vk::PipelineDepthStencilStateCreateInfo({}, true, true, vk::CompareOp::eLess, false, false, {}, {}, 0.0, 1.0);
+
+    replacePipeline(terrain_pipeline, std::move(state));
+}
+
+void Application::buildShadowPipeline() {
+    replacePipeline(shadow_pipeline, shadow_maps.pipelineState(shaderCode("shadow_vert_shader")));
+}
+
+void Application::buildSensorPipeline() {
+    if (!sensor_renderer.has_value()) {
+        return;
+    }
+
+    auto vert_shader = shaderCode(sensor_renderer->usesMultiview() ? "sensor_vert_shader" : "sensor_layered_vert_shader");
+    auto frag_shader = shaderCode("sensor_frag_shader");
+    replacePipeline(sensor_pipeline, sensor_renderer->pipelineState(vert_shader, frag_shader));
+}
+
+void Application::replacePipeline(std::optional<PipelineManager::Handle>& handle, PipelineState state) {
+    auto previous = handle;
+    handle = pipelines.request(std::move(state), previous);
+
+    // reverting an edit deduplicates to a handle retired earlier, which is back in use
+    retired_pipelines.erase(std::remove(retired_pipelines.begin(), retired_pipelines.end(), *handle), retired_pipelines.end());
+
+    // an unchanged state is deduplicated to the same handle
+    if (previous.has_value() && *previous != *handle) {
+        retired_pipelines.push_back(*previous);
+    }
+}
+
+void Application::reloadShaders() {
+    if (shader_reloader && shader_reloader->update()) {
+        buildGraphicsPipeline();
+        buildLinePipeline();
+        buildPointPipeline();
+        buildTerrainPipeline();
+        buildShadowPipeline();
+        buildSensorPipeline();
+    }
+
+    if (retired_pipelines.empty() || !pipelinesReady()) {
+        return;
+    }
+
+    // a replacement that failed to compile keeps falling back to its predecessor until sources are fixed
+    for (const auto* handle : {&pipeline, &line_pipeline, &point_pipeline, &terrain_pipeline, &shadow_pipeline, &sensor_pipeline}) {
+        if (handle->has_value() && pipelines.hasFailed(**handle)) {
+            return;
+        }
+    }
+
+    device.waitIdle();
+    for (auto handle : retired_pipelines) {
+        bool in_use = false;
+        for (const auto* current : {&pipeline, &line_pipeline, &point_pipeline, &terrain_pipeline, &shadow_pipeline, &sensor_pipeline}) {
+            in_use = in_use || *current == handle;
+        }
+
+        if (!in_use) {
+            pipelines.release(handle);
+        }
+    }
+    retired_pipelines.clear();
+    damaged = true;
+}
+
+bool Application::pipelinesReady() const {
+    for (const auto* handle : {&pipeline, &line_pipeline, &point_pipeline, &terrain_pipeline, &shadow_pipeline, &sensor_pipeline}) {
+        if (handle->has_value() && !pipelines.isReady(**handle)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ShaderCode Application::shaderCode(std::string_view name) const {
+    return shader_reloader ? shader_reloader->code(name) : ShaderReloader::embedded(name);
+}
+
+bool Application::hasChanged() const {
+    if (damaged || animated || scene.hasChanges() || debug_draw.lineCount() > 0 || point_cloud.pointCount() > 0) {
+        return true;
+    }
+
+    // frames keep drawing with fallbacks until pipelines finish compiling
+    if (!pipelinesReady()) {
+        return true;
+    }
+
+    return drawn_camera != camera || drawn_lights != lights || drawn_sensor_cameras != sensor_cameras;
+}
 
+void Application::updateScene() {
+    if (animated) {
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        float time = static_cast<float>(animation_time.value_or(elapsed));
+
+        scene.setLocal(model_node, glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+    }
+
+    scene.update();
+
+    frames[frame_index].writeInstances(device, scene);
+}
+
+void Application::selectLods() {
+    const auto& worlds = scene.worldMatrices();
+    instance_lods.resize(worlds.size(), 0);
+
+    // detail follows the resolution actually rendered at
+    float pixels_per_unit = camera.pixelsPerUnit(static_cast<float>(render_extent.height));
+    for (size_t instance = 0; instance < worlds.size(); instance++) {
+        const auto& world = worlds[instance];
+        float scale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        glm::vec3 center = glm::vec3(world * glm::vec4(model.boundsCenter(), 1.0f));
+
+        // distance to the nearest point of the bounding sphere, so close-up instances keep full detail
+        float distance = std::max(glm::length(camera.position - center) - scale * model.boundsRadius(), camera.near_plane);
+        instance_lods[instance] = model.selectLod(scale * pixels_per_unit / distance, instance_lods[instance]);
+    }
+}
+
+void Application::updateUniformBuffer() {
     shaders::UniformBufferObject ubo;
-    ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ubo.view = camera.view();
     float aspect_ratio = swap_chain.getExtent().width / (float)swap_chain.getExtent().height;
-    ubo.projection = glm::perspective(glm::radians(45.0f), aspect_ratio, 0.1f, 10.0f);
-    ubo.projection[1][1] *= -1.0;
+    ubo.projection = camera.projection(aspect_ratio);
 
     frames[frame_index].writeUniformBuffer(ubo);
+
+    shadow_maps.update(camera, aspect_ratio, light_direction, scene, model);
+
+    shaders::LightingUniforms lighting;
+    shadow_maps.writeUniforms(lighting);
+    lighting.camera_position = glm::vec4(camera.position, 1.0f);
+    clustered_lighting.prepare(device, frame_index, lights, camera, render_extent, lighting);
+
+    auto& frame = frames[frame_index];
+    frame.writeLightingUniforms(lighting);
+    clustered_lighting.bind(device, frame_index, frame.getUniformBuffer(), frame.getLightingBuffer());
+    frame.writeLightBuffers(device, clustered_lighting.getLights(frame_index), clustered_lighting.getClusters(frame_index));
 }
 
-void Application::recordCommandBuffer(vk::CommandBuffer command_buffer, const vk::Framebuffer& framebuffer) {
+void Application::updateCulling() {
+    float aspect_ratio = swap_chain.getExtent().width / (float)swap_chain.getExtent().height;
+    glm::mat4 view_projection = camera.projection(aspect_ratio) * camera.view();
+
+    shaders::CullUniforms uniforms;
+    ClusterCuller::frustumPlanes(view_projection, uniforms.frustum_planes);
+    uniforms.occlusion_view_projection = depth_pyramid_view_projection;
+    uniforms.camera_position = glm::vec4(camera.position, 1.0f);
+    uniforms.pyramid_size = glm::vec2(depth_pyramid.getExtent().width, depth_pyramid.getExtent().height);
+    uniforms.enable_cone_culling = 1;
+    uniforms.enable_occlusion_culling = depth_pyramid_valid ? 1 : 0;
+
+    cluster_culler.prepare(device, frame_index, instance_lods, frames[frame_index].getInstances(), depth_pyramid, uniforms);
+
+    // pyramid built at the end of this frame is used by the next one
+    depth_pyramid_view_projection = view_projection;
+    depth_pyramid_valid = true;
+}
+
+void Application::recordCommandBuffer(vk::CommandBuffer command_buffer, uint32_t image_index) {
     auto buffer_begin_info = vk::CommandBufferBeginInfo({}, nullptr);
     command_buffer.begin(buffer_begin_info);
 
+    gpu_timer.recordStart(command_buffer, frame_index);
+
+    float aspect_ratio = swap_chain.getExtent().width / (float)swap_chain.getExtent().height;
+    glm::mat4 view_projection = camera.projection(aspect_ratio) * camera.view();
+
+    // passes are only counted while pipeline statistics are enabled
+    auto begin_pass = [&](PipelineStatistics::Pass pass) {
+        if (pipeline_statistics.has_value()) {
+            pipeline_statistics->recordBegin(command_buffer, frame_index, pass);
+        }
+    };
+    auto end_pass = [&](PipelineStatistics::Pass pass) {
+        if (pipeline_statistics.has_value()) {
+            pipeline_statistics->recordEnd(command_buffer, frame_index, pass);
+        }
+    };
+    if (pipeline_statistics.has_value()) {
+        pipeline_statistics->recordReset(command_buffer, frame_index);
+    }
+
+    begin_pass(PipelineStatistics::Pass::compute);
+    cluster_culler.recordCulling(command_buffer, frame_index);
+    clustered_lighting.recordBinning(command_buffer, frame_index);
+    point_cloud.recordSplat(command_buffer, view_projection, render_extent);
+    if (terrain.has_value()) {
+        terrain->recordUpdate(command_buffer, frame_index);
+    }
+    end_pass(PipelineStatistics::Pass::compute);
+
+    begin_pass(PipelineStatistics::Pass::shadows);
+    // shadows can't be skipped, so this only blocks until the shadow pipeline has first compiled
+    auto shadow_draw = pipelines.get(*shadow_pipeline);
+    shadow_draw = shadow_draw ? shadow_draw : pipelines.wait(*shadow_pipeline);
+    shadow_maps.record(command_buffer, shadow_draw, model, frames[frame_index].getInstances().get(), scene, instance_lods);
+    end_pass(PipelineStatistics::Pass::shadows);
+
     auto clear_color = vk::ClearValue(vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f));
     auto clear_depth = vk::ClearValue(vk::ClearDepthStencilValue(1.0, 0));
-    auto clear_values = std::vector<vk::ClearValue>{clear_color, clear_depth};
-    auto render_area = vk::Rect2D({0, 0}, swap_chain.getExtent());
-    auto render_pass_info = vk::RenderPassBeginInfo(*render_pass, framebuffer, render_area, clear_values);
+    auto sensor_clear_values = SensorOutputs::clearValues();
+    auto clear_values = std::array<vk::ClearValue, 4>{clear_color, clear_depth, sensor_clear_values[0], sensor_clear_values[1]};
+    // sensor attachments are only part of the render pass while sensor outputs are enabled
+    uint32_t clear_value_count = sensor_outputs_enabled ? 4 : 2;
+    auto render_area = vk::Rect2D({0, 0}, render_extent);
+    auto render_pass_info =
+        vk::RenderPassBeginInfo(*render_pass, render_target.getFramebuffer(), render_area, clear_value_count, clear_values.data());
+    begin_pass(PipelineStatistics::Pass::main);
     command_buffer.beginRenderPass(render_pass_info, vk::SubpassContents::eInline);
 
-    command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline);
-    command_buffer.bindVertexBuffers(0, model.getVertices().get(), vk::DeviceSize(0));
+    auto viewport = vk::Viewport(0.0, 0.0, render_extent.width, render_extent.height, 0.0, 1.0);
+    command_buffer.setViewport(0, viewport);
+    command_buffer.setScissor(0, render_area);
+
+    // drawn first, as it binds its own buffers and descriptors; skipped until its pipeline has compiled
+    if (terrain_pipeline.has_value()) {
+        if (auto terrain_draw = pipelines.get(*terrain_pipeline)) {
+            command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, terrain_draw);
+            terrain->recordDraw(command_buffer, view_projection, light_direction);
+        }
+    }
+
+    // only blocks until the main pipeline has first compiled, later replacements fall back to it
+    auto main_pipeline = pipelines.get(*pipeline);
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, main_pipeline ? main_pipeline : pipelines.wait(*pipeline));
+    auto vertex_buffers = std::array<vk::Buffer, 2>{model.getVertices().get(), frames[frame_index].getInstances().get()};
+    auto vertex_offsets = std::array<vk::DeviceSize, 2>{0, 0};
+    command_buffer.bindVertexBuffers(0, vertex_buffers, vertex_offsets);
     command_buffer.bindIndexBuffer(model.getIndices().get(), vk::DeviceSize(0), vk::IndexType::eUint32);
 
     command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0, frames[frame_index].getDescriptors(), {});
 
-    auto viewport = vk::Viewport(0.0, 0.0, swap_chain.getExtent().width, swap_chain.getExtent().height, 0.0, 1.0);
-    command_buffer.setViewport(0, viewport);
-    command_buffer.setScissor(0, render_area);
+    // instances are drawn in runs sharing a level of detail,
+    // full-detail instances are drawn from the cluster culling output where supported
+    const auto& lods = model.getLods();
+    uint32_t run_start = 0;
+    for (uint32_t instance = 1; instance <= instance_lods.size(); instance++) {
+        if (instance == instance_lods.size() || instance_lods[instance] != instance_lods[run_start]) {
+            if (instance_lods[run_start] != 0 || !cluster_culler.isSupported()) {
+                const auto& lod = lods[instance_lods[run_start]];
+                command_buffer.drawIndexed(lod.index_count, instance - run_start, lod.first_index, 0, run_start);
+            }
+            run_start = instance;
+        }
+    }
+
+    cluster_culler.recordDraw(command_buffer, frame_index);
+
+    // debug lines are skipped until their pipeline has compiled
+    if (auto lines = pipelines.get(*line_pipeline)) {
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, lines);
+        debug_draw.recordDraw(command_buffer);
+    }
 
-    command_buffer.drawIndexed(static_cast<uint32_t>(model.indexCount()), 1, 0, 0, 0);
+    if (auto points = pipelines.get(*point_pipeline)) {
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, points);
+        point_cloud.recordDraw(command_buffer, view_projection, render_extent);
+    }
 
     command_buffer.endRenderPass();
+    end_pass(PipelineStatistics::Pass::main);
+
+    begin_pass(PipelineStatistics::Pass::post);
+    depth_pyramid.recordBuild(command_buffer, render_extent);
+
+    if (sensor_outputs.has_value()) {
+        sensor_outputs->recordReadback(command_buffer, frame_index, render_extent);
+    }
+
+    render_target.recordUpscale(command_buffer, render_extent, swap_chain.getImage(image_index), swap_chain.getExtent());
+    end_pass(PipelineStatistics::Pass::post);
+
+    gpu_timer.recordEnd(command_buffer, frame_index);
     command_buffer.end();
 }
 
@@ -287,8 +913,25 @@ void Application::drawFrame() {
 
     frame.waitUntilReady(device);
 
+    // pipelines are only swapped between frames
+    reloadShaders();
+
+    device.memoryUsage().poll();
+
+    // frame's previous commands have completed, so their timing feeds this frame's resolution
+    gpu_frame_ms = gpu_timer.read(frame_index);
+    if (gpu_frame_ms.has_value()) {
+        dynamic_resolution.update(*gpu_frame_ms);
+        render_extent = dynamic_resolution.renderExtent(swap_chain.getExtent());
+    }
+    if (pipeline_statistics.has_value()) {
+        frame_statistics = pipeline_statistics->read(frame_index);
+    }
+
     auto [acquire_result, image_index] = frame.acquireNextImage(swap_chain);
     if (acquire_result == vk::Result::eErrorOutOfDateKHR) {
+        debug_draw.clear();
+        point_cloud.clear();
         return;
     } else if (acquire_result != vk::Result::eSuccess && acquire_result != vk::Result::eSuboptimalKHR) {
         throw std::runtime_error("failed to acquire swap chain image");
@@ -297,11 +940,37 @@ void Application::drawFrame() {
 
     frame.reset(device);
 
+    // one more frame is drawn after any change, so occlusion culling catches up with disoccluded geometry
+    if (hasChanged()) {
+        settling_frames = 1;
+    } else if (settling_frames > 0) {
+        settling_frames--;
+    }
+
+    updateScene();
+    selectLods();
     updateUniformBuffer();
+    updateCulling();
+    if (terrain.has_value()) {
+        terrain->update(frame_index, camera.position);
+    }
 
-    recordCommandBuffer(frame.getCommandBuffer(), swap_chain.getFramebuffer(image_index));
+    recordCommandBuffer(frame.getCommandBuffer(), image_index);
 
     frame.submitTo(device.graphicsQueue());
+    last_submitted_frame = frame_index;
+
+    damaged = false;
+    drawn_camera = camera;
+    drawn_lights = lights;
+    drawn_sensor_cameras = sensor_cameras;
+    debug_draw.endFrame();
+    point_cloud.endFrame();
+
+    if (sensor_renderer.has_value()) {
+        auto sensor_draw = pipelines.get(*sensor_pipeline);
+        sensor_renderer->render(sensor_draw ? sensor_draw : pipelines.wait(*sensor_pipeline), sensor_cameras, scene, light_direction);
+    }
 
     auto present_result = frame.presentTo(device.presentQueue(), swap_chain, image_index);
     if (present_result == vk::Result::eErrorOutOfDateKHR) {
@@ -310,8 +979,35 @@ void Application::drawFrame() {
         throw std::runtime_error("failed to present rendered image to swap chain");
     }
 
+    // queued for presentation, which is as close to on-screen as the application can observe
+    startup.markFirstFrame();
+
     frame_index = (frame_index + 1) % max_frames_in_flight;
 }
 
+void Application::publishMetrics(std::chrono::steady_clock::time_point frame_start, std::chrono::steady_clock::time_point frame_end) {
+    frame_metrics.frames.add();
+    frame_metrics.cpu_frame_ms.record(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+    if (gpu_frame_ms.has_value()) {
+        frame_metrics.gpu_frame_ms.record(*gpu_frame_ms);
+    }
+
+    // smoothed over roughly the last ten frames, from the time between frames rather than their duration
+    if (last_frame_start.has_value()) {
+        double period = std::chrono::duration<double>(frame_start - *last_frame_start).count();
+        if (period > 0.0) {
+            smoothed_frame_rate = smoothed_frame_rate > 0.0 ? 0.9 * smoothed_frame_rate + 0.1 / period : 1.0 / period;
+            frame_metrics.frame_rate.set(smoothed_frame_rate);
+        }
+    }
+    last_frame_start = frame_start;
+
+    auto& memory_usage = device.memoryUsage();
+    frame_metrics.device_memory_bytes.set(static_cast<double>(memory_usage.allocatedBytes()));
+    uint64_t uploaded = memory_usage.uploadedBytes();
+    frame_metrics.uploaded_bytes.add(uploaded - published_uploads);
+    published_uploads = uploaded;
+}
+
 }  // namespace vulkan
 }  // namespace visualization
@@ -1,15 +1,37 @@
 #ifndef BB8_VISUALIZATION_VULKAN_APPLICATION_HPP
 #define BB8_VISUALIZATION_VULKAN_APPLICATION_HPP
 
+#include <chrono>
+#include <future>
 #include <vulkan/vulkan_raii.hpp>
 
+#include "../profiling/metrics.hpp"
+#include "../scene/camera.hpp"
+#include "../scene/light.hpp"
+#include "../scene/scene_graph.hpp"
 #include "buffer.hpp"
+#include "cluster_culler.hpp"
+#include "clustered_lighting.hpp"
+#include "debug_draw.hpp"
 #include "depth_buffer.hpp"
+#include "depth_pyramid.hpp"
 #include "device.hpp"
+#include "dynamic_resolution.hpp"
 #include "frame_resources.hpp"
+#include "gpu_timer.hpp"
 #include "model.hpp"
+#include "pipeline_manager.hpp"
+#include "pipeline_statistics.hpp"
+#include "point_cloud.hpp"
+#include "render_target.hpp"
+#include "sensor_outputs.hpp"
+#include "sensor_renderer.hpp"
 #include "shaders/vertex.hpp"
+#include "shader_reloader.hpp"
+#include "shadow_maps.hpp"
+#include "startup_profile.hpp"
 #include "swap_chain.hpp"
+#include "terrain.hpp"
 #include "texture.hpp"
 #include "utilities.hpp"
 #include "window.hpp"
@@ -26,6 +48,80 @@ public:
 
     void onResize();
 
+    // whether the next frame would differ from the last one drawn: the scene, cameras,
+    // lights or debug drawing changed, or a redraw was requested
+    bool needsRedraw() const;
+    // forces the next frame to be drawn, e.g. after the window's contents were damaged
+    void invalidate();
+
+    // the demo model spins continuously while animated, which redraws every frame.
+    // Otherwise it is marked static, so its shadows are cached
+    void setAnimated(bool animated);
+    // fixes the animation at `seconds` since start, for deterministic frames. Follows the clock when unset
+    void setAnimationTime(std::optional<double> seconds);
+
+    // presenting without vsync lets frame rate exceed the display's refresh rate
+    void setVsync(bool vsync);
+
+    // GPU time of the most recently completed frame, if timestamps are supported
+    std::optional<double> lastGpuFrameTime() const;
+
+    // counts vertices, primitives and shader invocations of each pass, returns false if the device can't
+    bool enablePipelineStatistics();
+    // counters of the most recently completed frame, while pipeline statistics are enabled
+    std::optional<PipelineStatistics::Frame> lastPipelineStatistics() const;
+
+    scene::Camera& getCamera();
+
+    // node of the demo model in the scene graph
+    scene::SceneGraph::NodeId getModelNode() const;
+    // static nodes render into cached shadow cascades, which are only redrawn when a static node moves
+    void setStatic(scene::SceneGraph::NodeId node, bool is_static);
+
+    // debug primitives drawn with the next frame
+    DebugDraw& debugDraw();
+
+    // sensor points drawn with the next frame
+    PointCloud& pointCloud();
+
+    // local point and spot lights, shaded through clustered lighting
+    std::vector<scene::Light>& getLights();
+
+    // replaces the terrain drawn around the camera
+    void setTerrain(geometry::Heightfield heightfield, Terrain::Settings settings = Terrain::Settings());
+    // nullptr until terrain is set
+    const Terrain* getTerrain() const;
+
+    // renders `camera_count` simulated sensor cameras in one batch after every frame
+    void enableSensors(vk::Extent2D resolution, uint32_t camera_count);
+    // one camera per sensor image, only valid once sensors are enabled
+    std::vector<scene::Camera>& getSensorCameras();
+    // nullptr until sensors are enabled
+    SensorRenderer* sensorRenderer();
+
+    // adds linear depth and instance ID attachments to the main pass, read back every frame
+    void enableSensorOutputs();
+    // waits for the last submitted frame, and returns its outputs
+    std::optional<SensorOutputs::Readback> readSensorOutputs();
+
+    // frames render at a fraction of the window resolution chosen from measured GPU frame time
+    void setDynamicResolution(DynamicResolution::Settings settings);
+    const DynamicResolution& dynamicResolution() const;
+
+    // startup phases from construction until the first presented frame
+    const StartupProfile& startupProfile() const;
+
+    // device memory by category and heap, checked against the heap budgets every frame
+    MemoryUsage& memoryUsage();
+
+    // publishes frame times, frame rate, device memory and uploads into the shared-memory segment
+    // `segment_name` every frame, for external monitoring
+    void enableMetrics(const std::string& segment_name);
+
+    // recompiles shaders when their sources in `source_directory` change, and swaps
+    // pipelines once recompiled. Needs the shader_hot_reload build option
+    void enableShaderHotReload(std::filesystem::path source_directory, std::filesystem::path cache_directory);
+
 private:
     class QueueFamilyIndices {
     public:
@@ -43,18 +139,42 @@ private:
 
     void buildRenderPass();
     void buildSwapChain();
+    void buildRenderTargets();
     void buildGraphicsPipeline();
+    void buildLinePipeline();
+    void buildPointPipeline();
+    void buildTerrainPipeline();
+    void buildShadowPipeline();
+    void buildSensorPipeline();
+    // replaces `handle` with a pipeline compiled from `state`, which falls back to the previous one until ready
+    void replacePipeline(std::optional<PipelineManager::Handle>& handle, PipelineState state);
+    void reloadShaders();
+    ShaderCode shaderCode(std::string_view name) const;
+
+    // color attachments of the main subpass, in fragment output order
+    uint32_t colorAttachmentCount() const;
 
+    bool hasChanged() const;
+    // whether every pipeline in use has compiled
+    bool pipelinesReady() const;
+
+    void updateScene();
+    void selectLods();
     void updateUniformBuffer();
-    void recordCommandBuffer(vk::CommandBuffer command_buffer, const vk::Framebuffer& framebuffer);
+    void updateCulling();
+    void recordCommandBuffer(vk::CommandBuffer command_buffer, uint32_t image_index);
 
     void drawFrame();
+    void publishMetrics(std::chrono::steady_clock::time_point frame_start, std::chrono::steady_clock::time_point frame_end);
 
     static const std::vector<std::string> validation_layers;
     static const std::vector<std::string> device_extensions;
 
     static constexpr uint32_t api_version = VK_API_VERSION_1_1;
 
+    static constexpr const char* model_file = "resources/models/viking_room.obj";
+    static constexpr const char* texture_file = "resources/textures/viking_room.png";
+
 #ifdef NDEBUG
     static constexpr bool enable_validation_layers = false;
 #else
@@ -63,6 +183,10 @@ private:
 
     Window* window;
 
+    StartupProfile startup;
+    // decoded on a worker thread while the instance and device are created
+    std::future<Model::Assets> assets;
+
     vk::raii::Context context;
     vk::raii::Instance instance;
 
@@ -73,19 +197,101 @@ private:
     vk::raii::DescriptorSetLayout descriptor_set_layout;
     vk::raii::PipelineLayout pipeline_layout;
     vk::raii::RenderPass render_pass;
-    vk::raii::Pipeline pipeline;
+
+    // declared before the pipeline manager, so it outlives compiles still reading its shaders
+    std::unique_ptr<ShaderReloader> shader_reloader;
+    PipelineManager pipelines;
+    std::optional<PipelineManager::Handle> pipeline;
+    std::optional<PipelineManager::Handle> line_pipeline;
+    std::optional<PipelineManager::Handle> point_pipeline;
+    // only while there is terrain
+    std::optional<PipelineManager::Handle> terrain_pipeline;
+    std::optional<PipelineManager::Handle> shadow_pipeline;
+    // only while sensors are enabled
+    std::optional<PipelineManager::Handle> sensor_pipeline;
+    // replaced pipelines, released once their replacements are ready and no frame in flight uses them
+    std::vector<PipelineManager::Handle> retired_pipelines;
 
     vk::raii::CommandPool command_pool;
 
     vk::raii::DescriptorPool descriptor_pool;
 
     DepthBuffer depth_buffer;
+    RenderTarget render_target;
+
+    DynamicResolution dynamic_resolution;
+    GpuTimer gpu_timer;
+    // extent the current frame renders at, within the render target
+    vk::Extent2D render_extent;
+    std::optional<double> gpu_frame_ms;
+    std::optional<PipelineStatistics> pipeline_statistics;
+    std::optional<PipelineStatistics::Frame> frame_statistics;
+
+    bool sensor_outputs_enabled = false;
+    std::optional<SensorOutputs> sensor_outputs;
+    DepthPyramid depth_pyramid;
+
+    // occlusion culling tests against the previous frame's depth, as seen from its camera
+    bool depth_pyramid_valid = false;
+    glm::mat4 depth_pyramid_view_projection;
 
     Model model;
+    ClusterCuller cluster_culler;
+    DebugDraw debug_draw;
+    PointCloud point_cloud;
+
+    ShadowMaps shadow_maps;
+    // direction sunlight travels in
+    glm::vec3 light_direction;
+
+    ClusteredLighting clustered_lighting;
+    std::vector<scene::Light> lights;
+
+    std::optional<Terrain> terrain;
+
+    std::optional<SensorRenderer> sensor_renderer;
+    std::vector<scene::Camera> sensor_cameras;
+
+    scene::SceneGraph scene;
+    scene::SceneGraph::NodeId model_node;
+    scene::Camera camera;
+    bool animated = true;
+    std::optional<double> animation_time;
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    bool vsync = true;
+
+    // state the last drawn frame was rendered from, for detecting changes
+    bool damaged = true;
+    std::optional<scene::Camera> drawn_camera;
+    std::vector<scene::Light> drawn_lights;
+    std::vector<scene::Camera> drawn_sensor_cameras;
+    // frames still to draw after a change, so occlusion culling catches up with disocclusions
+    uint32_t settling_frames = 0;
+
+    // selected level of detail per instance, in instance index order
+    std::vector<uint32_t> instance_lods;
+
+    // handles stay no-ops until metrics are enabled
+    class FrameMetrics {
+    public:
+        profiling::Metrics::Counter frames;
+        profiling::Metrics::Histogram cpu_frame_ms;
+        profiling::Metrics::Histogram gpu_frame_ms;
+        profiling::Metrics::Gauge frame_rate;
+        profiling::Metrics::Gauge device_memory_bytes;
+        profiling::Metrics::Counter uploaded_bytes;
+    };
+
+    std::unique_ptr<profiling::Metrics> metrics;
+    FrameMetrics frame_metrics;
+    uint64_t published_uploads = 0;
+    std::optional<std::chrono::steady_clock::time_point> last_frame_start;
+    double smoothed_frame_rate = 0.0;
 
     static constexpr size_t max_frames_in_flight = 2;
     std::array<FrameResources, max_frames_in_flight> frames;
     size_t frame_index = 0;
+    std::optional<size_t> last_submitted_frame;
 
     SwapChain swap_chain;
 };
@@ -1,12 +1,19 @@
 #include "buffer.hpp"
 
+#include <utility>
+
 #include "memory.hpp"
 
 namespace visualization {
 namespace vulkan {
 
-Buffer::Requirements::Requirements(size_t size, vk::MemoryPropertyFlags properties, vk::BufferUsageFlags usage, vk::SharingMode sharing_mode, bool keep_mapped)
-    : size(size), properties(properties), usage(usage), sharing_mode(sharing_mode), keep_mapped(keep_mapped) {
+Buffer::Requirements::Requirements(size_t size,
+                                   vk::MemoryPropertyFlags properties,
+                                   vk::BufferUsageFlags usage,
+                                   vk::SharingMode sharing_mode,
+                                   bool keep_mapped,
+                                   MemoryUsage::Category category)
+    : size(size), properties(properties), preferred_properties(), usage(usage), sharing_mode(sharing_mode), keep_mapped(keep_mapped), category(category) {
     auto host_visible = vk::MemoryPropertyFlagBits::eHostVisible;
     bool can_map = (properties & host_visible) == host_visible;
     if (keep_mapped && !can_map) {
@@ -17,31 +24,89 @@ Buffer::Requirements::Requirements(size_t size, vk::MemoryPropertyFlags properti
 Buffer::Requirements Buffer::Requirements::staging(size_t size) {
     auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
     auto usage = vk::BufferUsageFlagBits::eTransferSrc;
-    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false);
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false, MemoryUsage::Category::staging);
+}
+
+Buffer::Requirements Buffer::Requirements::streamingStaging(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eTransferSrc;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::streaming);
 }
 
 Buffer::Requirements Buffer::Requirements::vertex(size_t size) {
     auto properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
     auto usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst;
-    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false);
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false, MemoryUsage::Category::geometry);
 }
 
 Buffer::Requirements Buffer::Requirements::index(size_t size) {
     auto properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
     auto usage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst;
-    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false);
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false, MemoryUsage::Category::geometry);
 }
 
 Buffer::Requirements Buffer::Requirements::uniform(size_t size) {
     auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
     auto usage = vk::BufferUsageFlagBits::eUniformBuffer;
-    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true);
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::uniform);
+}
+
+Buffer::Requirements Buffer::Requirements::instance(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::streaming);
+}
+
+Buffer::Requirements Buffer::Requirements::streamingVertex(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eVertexBuffer;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::streaming);
+}
+
+Buffer::Requirements Buffer::Requirements::streamingStorage(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eStorageBuffer;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::streaming);
+}
+
+Buffer::Requirements Buffer::Requirements::streamingVertexStorage(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::streaming);
+}
+
+Buffer::Requirements Buffer::Requirements::storage(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+    auto usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false, MemoryUsage::Category::storage);
+}
+
+Buffer::Requirements Buffer::Requirements::indirect(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::streaming);
+}
+
+Buffer::Requirements Buffer::Requirements::generatedIndex(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+    auto usage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eStorageBuffer;
+    return Requirements(size, properties, usage, vk::SharingMode::eExclusive, false, MemoryUsage::Category::storage);
+}
+
+Buffer::Requirements Buffer::Requirements::readback(size_t size) {
+    auto properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    auto usage = vk::BufferUsageFlagBits::eTransferDst;
+    auto requirements = Requirements(size, properties, usage, vk::SharingMode::eExclusive, true, MemoryUsage::Category::readback);
+    // uncached memory is very slow for the CPU to read
+    requirements.preferred_properties = vk::MemoryPropertyFlagBits::eHostCached;
+    return requirements;
 }
 
 Buffer::Buffer(const Device& device, Requirements requirements)
-    : buffer(createBuffer(device, requirements)),
-      memory(vk::raii::DeviceMemory(device.logical(), Memory::allocationInfo(device, buffer.getMemoryRequirements(), requirements.properties))),
-      size(requirements.size) {
+    : buffer(createBuffer(device, requirements)), memory(nullptr), size(requirements.size) {
+    auto allocate_info = Memory::allocationInfo(device, buffer.getMemoryRequirements(), requirements.properties, requirements.preferred_properties);
+    memory = vk::raii::DeviceMemory(device.logical(), allocate_info);
+    allocation = device.memoryUsage().track(requirements.category, allocate_info);
     buffer.bindMemory(*memory, 0);
 
     if (requirements.keep_mapped) {
@@ -49,6 +114,30 @@ Buffer::Buffer(const Device& device, Requirements requirements)
     }
 }
 
+// moved-from buffers must not keep the mapping, otherwise they would unmap memory they no longer own
+Buffer::Buffer(Buffer&& other)
+    : buffer(std::move(other.buffer)),
+      memory(std::move(other.memory)),
+      allocation(std::move(other.allocation)),
+      size(other.size),
+      mapped_data(std::exchange(other.mapped_data, nullptr)) {}
+
+Buffer& Buffer::operator=(Buffer&& other) {
+    if (this != &other) {
+        if (mapped_data != nullptr) {
+            memory.unmapMemory();
+        }
+
+        buffer = std::move(other.buffer);
+        memory = std::move(other.memory);
+        allocation = std::move(other.allocation);
+        size = other.size;
+        mapped_data = std::exchange(other.mapped_data, nullptr);
+    }
+
+    return *this;
+}
+
 Buffer::~Buffer() {
     if (mapped_data != nullptr) {
         memory.unmapMemory();
@@ -56,7 +145,7 @@ Buffer::~Buffer() {
     }
 }
 
-Buffer Buffer::load(const Device& device, void* data, Requirements requirements) {
+Buffer Buffer::load(const Device& device, const void* data, Requirements requirements) {
     auto allocate_info = vk::CommandBufferAllocateInfo(device.transientPool(), vk::CommandBufferLevel::ePrimary, 1);
     auto command_buffers = vk::raii::CommandBuffers(device.logical(), allocate_info);
     auto command_buffer = std::move(command_buffers.front());
@@ -65,7 +154,8 @@ Buffer Buffer::load(const Device& device, void* data, Requirements requirements)
     command_buffer.begin(begin_info);
 
     Buffer staging = Buffer(device, Buffer::Requirements::staging(requirements.size));
-    staging.fill((void*)data, requirements.size);
+    staging.fill(data, requirements.size);
+    device.memoryUsage().recordUpload(requirements.size);
 
     Buffer primary = Buffer(device, requirements);
 
@@ -80,7 +170,7 @@ Buffer Buffer::load(const Device& device, void* data, Requirements requirements)
     return primary;
 }
 
-void Buffer::fill(void* data, size_t size) {
+void Buffer::fill(const void* data, size_t size) {
     assert(size == this->size);
     mapped_data = static_cast<uint8_t*>(memory.mapMemory(0, size));
     std::memcpy(mapped_data, data, size);
@@ -4,6 +4,7 @@
 #include <vulkan/vulkan_raii.hpp>
 
 #include "device.hpp"
+#include "memory_usage.hpp"
 
 namespace visualization {
 namespace vulkan {
@@ -16,18 +17,34 @@ public:
                      vk::MemoryPropertyFlags properties,
                      vk::BufferUsageFlags usage,
                      vk::SharingMode sharing_mode,
-                     bool keep_mapped);
+                     bool keep_mapped,
+                     MemoryUsage::Category category);
 
         static Requirements staging(size_t size);
+        // staging rewritten every frame, kept mapped
+        static Requirements streamingStaging(size_t size);
         static Requirements vertex(size_t size);
         static Requirements index(size_t size);
         static Requirements uniform(size_t size);
+        static Requirements instance(size_t size);
+        static Requirements streamingVertex(size_t size);
+        static Requirements streamingStorage(size_t size);
+        // streamed data read both as vertices and from shaders
+        static Requirements streamingVertexStorage(size_t size);
+        static Requirements storage(size_t size);
+        static Requirements indirect(size_t size);
+        static Requirements generatedIndex(size_t size);
+        static Requirements readback(size_t size);
 
         size_t size;
         vk::MemoryPropertyFlags properties;
+        // used in addition to `properties` when a memory type has them
+        vk::MemoryPropertyFlags preferred_properties;
         vk::BufferUsageFlags usage;
         vk::SharingMode sharing_mode;
         bool keep_mapped;
+        // what the buffer's memory is accounted as
+        MemoryUsage::Category category;
     };
 
     Buffer(const Device& device, Requirements requirements);
@@ -35,14 +52,14 @@ public:
     Buffer(const Buffer&) = delete;
     Buffer& operator=(const Buffer&) = delete;
 
-    Buffer(Buffer&&) = default;
-    Buffer& operator=(Buffer&&) = default;
+    Buffer(Buffer&& other);
+    Buffer& operator=(Buffer&& other);
 
     ~Buffer();
 
-    static Buffer load(const Device& device, void* data, Requirements requirements);
+    static Buffer load(const Device& device, const void* data, Requirements requirements);
 
-    void fill(void* data, size_t size);
+    void fill(const void* data, size_t size);
 
     size_t getSize() const;
     uint8_t* data() const;
@@ -57,6 +74,7 @@ private:
 
     vk::raii::Buffer buffer;
     vk::raii::DeviceMemory memory;
+    MemoryUsage::Allocation allocation;
     size_t size;
 
     uint8_t* mapped_data = nullptr;
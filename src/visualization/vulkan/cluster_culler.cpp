@@ -0,0 +1,179 @@
+#include "cluster_culler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "shaders.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+ClusterCuller::ClusterCuller(const Device& device, const Model& model, size_t frame_count)
+    : meshlet_count(model.meshletCount()),
+      full_detail_index_count(model.getLods().front().index_count),
+      meshlets_info(model.getMeshlets().descriptorInfo()),
+      meshlet_indices_info(model.getMeshletIndices().descriptorInfo()),
+      multi_draw_indirect(device.features().multiDrawIndirect),
+      draw_indirect_first_instance(device.features().drawIndirectFirstInstance),
+      descriptor_layout(createDescriptorLayout(device)),
+      pipeline_layout(device.logical(), vk::PipelineLayoutCreateInfo({}, *descriptor_layout, {})),
+      pipeline(createPipeline(device, *pipeline_layout)),
+      descriptor_sets(createDescriptorSets(device, *descriptor_layout, frame_count)) {
+    frames.reserve(frame_count);
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        frames.emplace_back(device);
+    }
+}
+
+bool ClusterCuller::isSupported() const {
+    return draw_indirect_first_instance;
+}
+
+void ClusterCuller::prepare(const Device& device,
+                            size_t frame,
+                            const std::vector<uint32_t>& instance_lods,
+                            const Buffer& instances,
+                            const DepthPyramid& depth_pyramid,
+                            const shaders::CullUniforms& uniforms) {
+    auto& data = frames.at(frame);
+
+    if (!draw_indirect_first_instance) {
+        data.instance_count = 0;
+        return;
+    }
+
+    data.instance_count = static_cast<uint32_t>(instance_lods.size());
+    if (data.instance_count == 0) {
+        return;
+    }
+
+    // starts at exactly the instances needed, then doubles
+    if (instance_lods.size() > data.instance_capacity) {
+        data.instance_capacity = std::max(instance_lods.size(), 2 * data.instance_capacity);
+
+        data.commands.emplace(device, Buffer::Requirements::indirect(data.instance_capacity * sizeof(vk::DrawIndexedIndirectCommand)));
+        data.output_indices.emplace(device, Buffer::Requirements::generatedIndex(data.instance_capacity * full_detail_index_count * sizeof(uint32_t)));
+    }
+
+    // index counts start at zero and are accumulated by the culling pass,
+    // instances drawn at a coarser level of detail keep an empty command
+    auto commands = reinterpret_cast<vk::DrawIndexedIndirectCommand*>(data.commands->data());
+    for (uint32_t instance = 0; instance < data.instance_count; instance++) {
+        uint32_t instance_count = instance_lods[instance] == 0 ? 1 : 0;
+        commands[instance] = vk::DrawIndexedIndirectCommand(0, instance_count, instance * full_detail_index_count, 0, instance);
+    }
+
+    std::memcpy(data.uniforms.data(), &uniforms, sizeof(uniforms));
+
+    auto uniforms_info = data.uniforms.descriptorInfo();
+    auto instances_info = instances.descriptorInfo();
+    auto commands_info = data.commands->descriptorInfo();
+    auto output_info = data.output_indices->descriptorInfo();
+    auto pyramid_info = depth_pyramid.descriptorInfo();
+
+    auto set = descriptor_sets[frame];
+    auto descriptor_writes = std::array<vk::WriteDescriptorSet, 7>{
+        vk::WriteDescriptorSet(set, 0, 0, vk::DescriptorType::eUniformBuffer, {}, uniforms_info),
+        vk::WriteDescriptorSet(set, 1, 0, vk::DescriptorType::eStorageBuffer, {}, meshlets_info),
+        vk::WriteDescriptorSet(set, 2, 0, vk::DescriptorType::eStorageBuffer, {}, meshlet_indices_info),
+        vk::WriteDescriptorSet(set, 3, 0, vk::DescriptorType::eStorageBuffer, {}, instances_info),
+        vk::WriteDescriptorSet(set, 4, 0, vk::DescriptorType::eStorageBuffer, {}, commands_info),
+        vk::WriteDescriptorSet(set, 5, 0, vk::DescriptorType::eStorageBuffer, {}, output_info),
+        vk::WriteDescriptorSet(set, 6, 0, vk::DescriptorType::eCombinedImageSampler, pyramid_info)};
+    device.logical().updateDescriptorSets(descriptor_writes, {});
+}
+
+void ClusterCuller::recordCulling(vk::CommandBuffer command_buffer, size_t frame) const {
+    const auto& data = frames.at(frame);
+    if (data.instance_count == 0) {
+        return;
+    }
+
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0, descriptor_sets[frame], {});
+    command_buffer.dispatch((meshlet_count + group_size - 1) / group_size, data.instance_count, 1);
+
+    auto culled = vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eIndexRead);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                   vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+                                   {},
+                                   culled,
+                                   {},
+                                   {});
+}
+
+void ClusterCuller::recordDraw(vk::CommandBuffer command_buffer, size_t frame) const {
+    const auto& data = frames.at(frame);
+    if (data.instance_count == 0) {
+        return;
+    }
+
+    command_buffer.bindIndexBuffer(data.output_indices->get(), vk::DeviceSize(0), vk::IndexType::eUint32);
+
+    constexpr uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+    if (multi_draw_indirect) {
+        command_buffer.drawIndexedIndirect(data.commands->get(), 0, data.instance_count, stride);
+    } else {
+        for (uint32_t instance = 0; instance < data.instance_count; instance++) {
+            command_buffer.drawIndexedIndirect(data.commands->get(), instance * stride, 1, stride);
+        }
+    }
+}
+
+void ClusterCuller::frustumPlanes(const glm::mat4& view_projection, glm::vec4 planes[6]) {
+    auto row = [&](int i) {
+        return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    };
+
+    planes[0] = row(3) + row(0);  // left
+    planes[1] = row(3) - row(0);  // right
+    planes[2] = row(3) + row(1);  // bottom
+    planes[3] = row(3) - row(1);  // top
+    planes[4] = row(2);           // near, depth range is [0, 1]
+    planes[5] = row(3) - row(2);  // far
+
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+ClusterCuller::FrameData::FrameData(const Device& device)
+    : uniforms(device, Buffer::Requirements::uniform(sizeof(shaders::CullUniforms))),
+      instance_capacity(0),
+      instance_count(0) {}
+
+vk::raii::DescriptorSetLayout ClusterCuller::createDescriptorLayout(const Device& device) {
+    auto stage = vk::ShaderStageFlagBits::eCompute;
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 7>{
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eStorageBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(5, vk::DescriptorType::eStorageBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(6, vk::DescriptorType::eCombinedImageSampler, 1, stage)};
+
+    return vk::raii::DescriptorSetLayout(device.logical(), vk::DescriptorSetLayoutCreateInfo({}, bindings));
+}
+
+DescriptorSets ClusterCuller::createDescriptorSets(const Device& device, const vk::DescriptorSetLayout& layout, size_t frame_count) {
+    uint32_t sets = static_cast<uint32_t>(frame_count);
+    auto pool_sizes = std::array<vk::DescriptorPoolSize, 3>{
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, sets),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 5 * sets),
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, sets)};
+    auto layouts = std::vector<vk::DescriptorSetLayout>(frame_count, layout);
+
+    return DescriptorSets(device, pool_sizes, layouts);
+}
+
+vk::raii::Pipeline ClusterCuller::createPipeline(const Device& device, const vk::PipelineLayout& layout) {
+    auto shader_module = vk::raii::ShaderModule(device.logical(), vk::ShaderModuleCreateInfo({}, shaders::cull_shader));
+    auto stage = vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, *shader_module, "main");
+
+    return vk::raii::Pipeline(device.logical(), nullptr, vk::ComputePipelineCreateInfo({}, stage, layout));
+}
+
+}  // namespace vulkan
+}  // namespace visualization
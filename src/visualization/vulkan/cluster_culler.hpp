@@ -0,0 +1,100 @@
+#ifndef BB8_VISUALIZATION_VULKAN_CLUSTER_CULLER_HPP
+#define BB8_VISUALIZATION_VULKAN_CLUSTER_CULLER_HPP
+
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "buffer.hpp"
+#include "depth_pyramid.hpp"
+#include "descriptor_sets.hpp"
+#include "device.hpp"
+#include "model.hpp"
+#include "shaders/cull_uniforms.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// GPU culling of full-detail instances at meshlet granularity.
+//
+// A compute pass tests every meshlet of every full-detail instance against the
+// view frustum, its normal cone, and the depth pyramid of the previous frame, then
+// appends the indices of surviving meshlets into a per-frame index buffer. Each
+// instance gets its own indirect draw command, whose index count is filled in by
+// the culling pass. Those commands need drawIndirectFirstInstance; without it,
+// nothing is culled and full-detail instances are left to the caller.
+class ClusterCuller {
+public:
+    ClusterCuller(const Device& device, const Model& model, size_t frame_count);
+
+    ClusterCuller(const ClusterCuller&) = delete;
+    ClusterCuller& operator=(const ClusterCuller&) = delete;
+
+    ClusterCuller(ClusterCuller&&) = default;
+    ClusterCuller& operator=(ClusterCuller&&) = default;
+
+    ~ClusterCuller() = default;
+
+    // whether full-detail instances are drawn by the culler, otherwise the
+    // caller draws them directly
+    bool isSupported() const;
+
+    // writes the frame's draw commands and culling inputs, instances with a
+    // level of detail other than 0 are skipped
+    void prepare(const Device& device,
+                 size_t frame,
+                 const std::vector<uint32_t>& instance_lods,
+                 const Buffer& instances,
+                 const DepthPyramid& depth_pyramid,
+                 const shaders::CullUniforms& uniforms);
+
+    // must be recorded outside of a render pass
+    void recordCulling(vk::CommandBuffer command_buffer, size_t frame) const;
+
+    // must be recorded inside a render pass, with the model's vertex and instance buffers bound
+    void recordDraw(vk::CommandBuffer command_buffer, size_t frame) const;
+
+    // extracts world-space frustum planes from a view-projection matrix
+    static void frustumPlanes(const glm::mat4& view_projection, glm::vec4 planes[6]);
+
+private:
+    class FrameData {
+    public:
+        explicit FrameData(const Device& device);
+
+        Buffer uniforms;
+        // allocated by the first prepare() with instances, since each instance
+        // reserves room for all of the model's full-detail indices
+        std::optional<Buffer> commands;
+        std::optional<Buffer> output_indices;
+        size_t instance_capacity;
+        uint32_t instance_count;
+    };
+
+    static vk::raii::DescriptorSetLayout createDescriptorLayout(const Device& device);
+    static DescriptorSets createDescriptorSets(const Device& device, const vk::DescriptorSetLayout& layout, size_t frame_count);
+    static vk::raii::Pipeline createPipeline(const Device& device, const vk::PipelineLayout& layout);
+
+    static constexpr uint32_t group_size = 64;
+
+    uint32_t meshlet_count;
+    uint32_t full_detail_index_count;
+    vk::DescriptorBufferInfo meshlets_info;
+    vk::DescriptorBufferInfo meshlet_indices_info;
+
+    bool multi_draw_indirect;
+    bool draw_indirect_first_instance;
+
+    vk::raii::DescriptorSetLayout descriptor_layout;
+    vk::raii::PipelineLayout pipeline_layout;
+    vk::raii::Pipeline pipeline;
+
+    std::vector<FrameData> frames;
+    // one per frame
+    DescriptorSets descriptor_sets;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_CLUSTER_CULLER_HPP
@@ -0,0 +1,126 @@
+#include "clustered_lighting.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "shaders.hpp"
+#include "shaders/light.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+ClusteredLighting::ClusteredLighting(const Device& device, size_t frame_count)
+    : descriptor_layout(createDescriptorLayout(device)),
+      pipeline_layout(device.logical(), vk::PipelineLayoutCreateInfo({}, *descriptor_layout, {})),
+      pipeline(createPipeline(device, *pipeline_layout)),
+      descriptor_sets(createDescriptorSets(device, *descriptor_layout, frame_count)) {
+    frames.reserve(frame_count);
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        frames.emplace_back(device);
+    }
+}
+
+void ClusteredLighting::prepare(const Device& device,
+                                size_t frame,
+                                const std::vector<scene::Light>& lights,
+                                const scene::Camera& camera,
+                                vk::Extent2D viewport,
+                                shaders::LightingUniforms& uniforms) {
+    auto& data = frames.at(frame);
+
+    if (lights.size() > data.light_capacity) {
+        while (data.light_capacity < lights.size()) {
+            data.light_capacity *= 2;
+        }
+
+        data.lights = Buffer(device, Buffer::Requirements::streamingStorage(data.light_capacity * sizeof(shaders::Light)));
+    }
+
+    auto packed = reinterpret_cast<shaders::Light*>(data.lights.data());
+    for (const auto& light : lights) {
+        float outer_cos = light.isSpot() ? std::cos(light.outer_angle) : -2.0f;
+        // keeps the falloff between the cone angles well defined when they're equal
+        float inner_cos = light.isSpot() ? std::max(std::cos(light.inner_angle), outer_cos + 1.0e-4f) : -1.0f;
+        *packed++ = shaders::Light{light.position, light.range, light.color, inner_cos, light.direction, outer_cos};
+    }
+    device.memoryUsage().recordUpload(lights.size() * sizeof(shaders::Light));
+
+    float near = camera.near_plane;
+    float far = camera.far_plane;
+
+    uniforms.cluster_grid = glm::uvec4(grid_x, grid_y, grid_z, static_cast<uint32_t>(lights.size()));
+    glm::vec2 viewport_size = glm::vec2(viewport.width, viewport.height);
+    uniforms.cluster_tile = glm::vec4(viewport_size / glm::vec2(grid_x, grid_y), viewport_size);
+    uniforms.cluster_depth = glm::vec4(near, far, grid_z / std::log(far / near), 0.0f);
+}
+
+void ClusteredLighting::bind(const Device& device, size_t frame, const Buffer& camera_uniforms, const Buffer& lighting_uniforms) {
+    const auto& data = frames.at(frame);
+
+    auto camera_info = camera_uniforms.descriptorInfo();
+    auto lighting_info = lighting_uniforms.descriptorInfo();
+    auto lights_info = data.lights.descriptorInfo();
+    auto clusters_info = data.clusters.descriptorInfo();
+
+    auto set = descriptor_sets[frame];
+    auto descriptor_writes = std::array<vk::WriteDescriptorSet, 4>{
+        vk::WriteDescriptorSet(set, 0, 0, vk::DescriptorType::eUniformBuffer, {}, camera_info),
+        vk::WriteDescriptorSet(set, 1, 0, vk::DescriptorType::eUniformBuffer, {}, lighting_info),
+        vk::WriteDescriptorSet(set, 2, 0, vk::DescriptorType::eStorageBuffer, {}, lights_info),
+        vk::WriteDescriptorSet(set, 3, 0, vk::DescriptorType::eStorageBuffer, {}, clusters_info)};
+    device.logical().updateDescriptorSets(descriptor_writes, {});
+}
+
+void ClusteredLighting::recordBinning(vk::CommandBuffer command_buffer, size_t frame) const {
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0, descriptor_sets[frame], {});
+    command_buffer.dispatch((cluster_count + group_size - 1) / group_size, 1, 1);
+
+    auto binned = vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eFragmentShader, {}, binned, {}, {});
+}
+
+const Buffer& ClusteredLighting::getLights(size_t frame) const {
+    return frames.at(frame).lights;
+}
+
+const Buffer& ClusteredLighting::getClusters(size_t frame) const {
+    return frames.at(frame).clusters;
+}
+
+ClusteredLighting::FrameData::FrameData(const Device& device)
+    : lights(device, Buffer::Requirements::streamingStorage(initial_light_capacity * sizeof(shaders::Light))),
+      light_capacity(initial_light_capacity),
+      clusters(device, Buffer::Requirements::storage(cluster_count * (max_cluster_lights + 1) * sizeof(uint32_t))) {}
+
+vk::raii::DescriptorSetLayout ClusteredLighting::createDescriptorLayout(const Device& device) {
+    auto stage = vk::ShaderStageFlagBits::eCompute;
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 4>{
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eUniformBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, stage),
+        vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, stage)};
+
+    return vk::raii::DescriptorSetLayout(device.logical(), vk::DescriptorSetLayoutCreateInfo({}, bindings));
+}
+
+DescriptorSets ClusteredLighting::createDescriptorSets(const Device& device, const vk::DescriptorSetLayout& layout, size_t frame_count) {
+    uint32_t sets = static_cast<uint32_t>(frame_count);
+    auto pool_sizes = std::array<vk::DescriptorPoolSize, 2>{
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, 2 * sets),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 2 * sets)};
+    auto layouts = std::vector<vk::DescriptorSetLayout>(frame_count, layout);
+
+    return DescriptorSets(device, pool_sizes, layouts);
+}
+
+vk::raii::Pipeline ClusteredLighting::createPipeline(const Device& device, const vk::PipelineLayout& layout) {
+    auto shader_module = vk::raii::ShaderModule(device.logical(), vk::ShaderModuleCreateInfo({}, shaders::light_cluster_shader));
+    auto stage = vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, *shader_module, "main");
+
+    return vk::raii::Pipeline(device.logical(), nullptr, vk::ComputePipelineCreateInfo({}, stage, layout));
+}
+
+}  // namespace vulkan
+}  // namespace visualization
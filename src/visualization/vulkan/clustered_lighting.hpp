@@ -0,0 +1,90 @@
+#ifndef BB8_VISUALIZATION_VULKAN_CLUSTERED_LIGHTING_HPP
+#define BB8_VISUALIZATION_VULKAN_CLUSTERED_LIGHTING_HPP
+
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../scene/camera.hpp"
+#include "../scene/light.hpp"
+#include "buffer.hpp"
+#include "descriptor_sets.hpp"
+#include "device.hpp"
+#include "shaders/lighting_uniforms.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Clustered forward shading of many local lights.
+//
+// The view frustum is divided into a grid of clusters: screen tiles, each split into
+// depth slices spaced exponentially between the camera's near and far planes. Every
+// frame a compute pass bins lights into the clusters their bounding spheres touch,
+// and fragments only loop over the lights of their own cluster, so shading cost
+// depends on how many lights overlap a point rather than on the total light count.
+class ClusteredLighting {
+public:
+    ClusteredLighting(const Device& device, size_t frame_count);
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    ClusteredLighting(ClusteredLighting&&) = default;
+    ClusteredLighting& operator=(ClusteredLighting&&) = default;
+
+    ~ClusteredLighting() = default;
+
+    // uploads the frame's lights, and fills in the cluster parameters of `uniforms`
+    void prepare(const Device& device,
+                 size_t frame,
+                 const std::vector<scene::Light>& lights,
+                 const scene::Camera& camera,
+                 vk::Extent2D viewport,
+                 shaders::LightingUniforms& uniforms);
+
+    // binds the frame's camera and lighting uniforms, must be called after prepare()
+    void bind(const Device& device, size_t frame, const Buffer& camera_uniforms, const Buffer& lighting_uniforms);
+
+    // must be recorded outside of a render pass, before any draw shading with the clusters
+    void recordBinning(vk::CommandBuffer command_buffer, size_t frame) const;
+
+    const Buffer& getLights(size_t frame) const;
+    const Buffer& getClusters(size_t frame) const;
+
+    // lights beyond this many in a single cluster are dropped
+    static constexpr uint32_t max_cluster_lights = 127;
+
+private:
+    class FrameData {
+    public:
+        explicit FrameData(const Device& device);
+
+        Buffer lights;
+        size_t light_capacity;
+        Buffer clusters;
+    };
+
+    static vk::raii::DescriptorSetLayout createDescriptorLayout(const Device& device);
+    static DescriptorSets createDescriptorSets(const Device& device, const vk::DescriptorSetLayout& layout, size_t frame_count);
+    static vk::raii::Pipeline createPipeline(const Device& device, const vk::PipelineLayout& layout);
+
+    static constexpr uint32_t grid_x = 16;
+    static constexpr uint32_t grid_y = 9;
+    static constexpr uint32_t grid_z = 24;
+    static constexpr uint32_t cluster_count = grid_x * grid_y * grid_z;
+
+    static constexpr uint32_t group_size = 64;
+    static constexpr size_t initial_light_capacity = 64;
+
+    vk::raii::DescriptorSetLayout descriptor_layout;
+    vk::raii::PipelineLayout pipeline_layout;
+    vk::raii::Pipeline pipeline;
+
+    std::vector<FrameData> frames;
+    // one per frame
+    DescriptorSets descriptor_sets;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_CLUSTERED_LIGHTING_HPP
@@ -0,0 +1,172 @@
+#include "debug_draw.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace visualization {
+namespace vulkan {
+
+DebugDraw::DebugDraw(const Device& device, size_t frames_in_flight) : device(&device) {
+    regions.reserve(frames_in_flight + 1);
+    for (size_t i = 0; i < frames_in_flight + 1; i++) {
+        regions.emplace_back(device, initial_capacity);
+    }
+
+    for (size_t i = 0; i <= sphere_segments; i++) {
+        float angle = 2.0f * glm::pi<float>() * i / sphere_segments;
+        circle[i] = glm::vec2(std::cos(angle), std::sin(angle));
+    }
+}
+
+void DebugDraw::line(glm::vec3 from, glm::vec3 to, glm::vec4 color) {
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto vertices = allocate(2);
+    vertices[0] = shaders::LineVertex{from, packed};
+    vertices[1] = shaders::LineVertex{to, packed};
+}
+
+void DebugDraw::arrow(glm::vec3 from, glm::vec3 to, glm::vec4 color) {
+    glm::vec3 direction = to - from;
+    float length = glm::length(direction);
+    if (length == 0.0f) {
+        return;
+    }
+    direction /= length;
+
+    // any pair of directions perpendicular to the shaft
+    glm::vec3 helper = std::abs(direction.z) < 0.9f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 u = glm::normalize(glm::cross(direction, helper)) * (arrow_head_width * length);
+    glm::vec3 v = glm::cross(direction, u);
+    glm::vec3 base = to - direction * (arrow_head_length * length);
+
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto vertices = allocate(10);
+    glm::vec3 endpoints[5] = {from, base + u, base - u, base + v, base - v};
+    for (int i = 0; i < 5; i++) {
+        vertices[2 * i] = shaders::LineVertex{endpoints[i], packed};
+        vertices[2 * i + 1] = shaders::LineVertex{to, packed};
+    }
+}
+
+void DebugDraw::point(glm::vec3 position, float size, glm::vec4 color) {
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto vertices = allocate(6);
+    float half = 0.5f * size;
+    for (int axis = 0; axis < 3; axis++) {
+        glm::vec3 offset(0.0f);
+        offset[axis] = half;
+        vertices[2 * axis] = shaders::LineVertex{position - offset, packed};
+        vertices[2 * axis + 1] = shaders::LineVertex{position + offset, packed};
+    }
+}
+
+void DebugDraw::box(glm::vec3 center, glm::vec3 half_extents, glm::vec4 color) {
+    box(glm::translate(glm::mat4(1.0f), center), half_extents, color);
+}
+
+void DebugDraw::box(const glm::mat4& transform, glm::vec3 half_extents, glm::vec4 color) {
+    glm::vec3 corners[8];
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 local((corner & 1) ? half_extents.x : -half_extents.x,
+                        (corner & 2) ? half_extents.y : -half_extents.y,
+                        (corner & 4) ? half_extents.z : -half_extents.z);
+        corners[corner] = glm::vec3(transform * glm::vec4(local, 1.0f));
+    }
+
+    // each edge joins two corners differing in exactly one axis bit
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto vertices = allocate(24);
+    for (int corner = 0; corner < 8; corner++) {
+        for (int bit = 1; bit < 8; bit <<= 1) {
+            if ((corner & bit) == 0) {
+                *vertices++ = shaders::LineVertex{corners[corner], packed};
+                *vertices++ = shaders::LineVertex{corners[corner | bit], packed};
+            }
+        }
+    }
+}
+
+void DebugDraw::sphere(glm::vec3 center, float radius, glm::vec4 color) {
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto vertices = allocate(3 * 2 * sphere_segments);
+    for (int axis = 0; axis < 3; axis++) {
+        int a = (axis + 1) % 3;
+        int b = (axis + 2) % 3;
+        for (size_t i = 0; i < sphere_segments; i++) {
+            glm::vec3 start = center;
+            start[a] += radius * circle[i].x;
+            start[b] += radius * circle[i].y;
+
+            glm::vec3 end = center;
+            end[a] += radius * circle[i + 1].x;
+            end[b] += radius * circle[i + 1].y;
+
+            *vertices++ = shaders::LineVertex{start, packed};
+            *vertices++ = shaders::LineVertex{end, packed};
+        }
+    }
+}
+
+void DebugDraw::polyline(const glm::vec3* points, size_t count, glm::vec4 color) {
+    if (count < 2) {
+        return;
+    }
+
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto vertices = allocate(2 * (count - 1));
+    for (size_t i = 0; i + 1 < count; i++) {
+        *vertices++ = shaders::LineVertex{points[i], packed};
+        *vertices++ = shaders::LineVertex{points[i + 1], packed};
+    }
+}
+
+size_t DebugDraw::lineCount() const {
+    return vertex_count / 2;
+}
+
+void DebugDraw::recordDraw(vk::CommandBuffer command_buffer) const {
+    if (vertex_count == 0) {
+        return;
+    }
+
+    command_buffer.bindVertexBuffers(0, regions[current].buffer.get(), vk::DeviceSize(0));
+    command_buffer.draw(static_cast<uint32_t>(vertex_count), 1, 0, 0);
+}
+
+void DebugDraw::endFrame() {
+    // vertices are written one primitive at a time, so they're counted once per frame
+    device->memoryUsage().recordUpload(vertex_count * sizeof(shaders::LineVertex));
+    current = (current + 1) % regions.size();
+    vertex_count = 0;
+}
+
+void DebugDraw::clear() {
+    vertex_count = 0;
+}
+
+DebugDraw::Region::Region(const Device& device, size_t capacity)
+    : buffer(device, Buffer::Requirements::streamingVertex(capacity * sizeof(shaders::LineVertex))), capacity(capacity) {}
+
+shaders::LineVertex* DebugDraw::allocate(size_t count) {
+    auto& region = regions[current];
+    if (vertex_count + count > region.capacity) {
+        size_t capacity = region.capacity;
+        while (capacity < vertex_count + count) {
+            capacity *= 2;
+        }
+
+        // the current region is never in use by the GPU, so it can be replaced immediately
+        auto grown = Region(*device, capacity);
+        std::memcpy(grown.buffer.data(), region.buffer.data(), vertex_count * sizeof(shaders::LineVertex));
+        region = std::move(grown);
+    }
+
+    auto vertices = reinterpret_cast<shaders::LineVertex*>(region.buffer.data()) + vertex_count;
+    vertex_count += count;
+    return vertices;
+}
+
+}  // namespace vulkan
+}  // namespace visualization
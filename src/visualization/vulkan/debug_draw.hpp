@@ -0,0 +1,91 @@
+#ifndef BB8_VISUALIZATION_VULKAN_DEBUG_DRAW_HPP
+#define BB8_VISUALIZATION_VULKAN_DEBUG_DRAW_HPP
+
+#include <array>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "buffer.hpp"
+#include "device.hpp"
+#include "glm.hpp"
+#include "shaders/line_vertex.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Immediate-mode debug drawing of lines and wireframe shapes.
+//
+// Primitives are written straight into a persistently mapped vertex buffer, and are
+// drawn once with the next frame in a single draw call, then discarded. Buffers form a
+// ring one longer than the number of frames in flight, so the buffer being written is
+// never one the GPU may still be reading. Buffers grow by doubling when full, so
+// steady-state drawing doesn't allocate.
+class DebugDraw {
+public:
+    DebugDraw(const Device& device, size_t frames_in_flight);
+
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    DebugDraw(DebugDraw&&) = default;
+    DebugDraw& operator=(DebugDraw&&) = default;
+
+    ~DebugDraw() = default;
+
+    void line(glm::vec3 from, glm::vec3 to, glm::vec4 color);
+    void arrow(glm::vec3 from, glm::vec3 to, glm::vec4 color);
+
+    // three axis-aligned segments crossing at `position`, for marking contact points
+    void point(glm::vec3 position, float size, glm::vec4 color);
+
+    void box(glm::vec3 center, glm::vec3 half_extents, glm::vec4 color);
+    void box(const glm::mat4& transform, glm::vec3 half_extents, glm::vec4 color);
+
+    // three orthogonal great circles
+    void sphere(glm::vec3 center, float radius, glm::vec4 color);
+
+    // continuous path through consecutive points
+    void polyline(const glm::vec3* points, size_t count, glm::vec4 color);
+
+    size_t lineCount() const;
+
+    // draws everything added since the last frame, must be recorded inside
+    // a render pass with the line pipeline and its descriptors bound
+    void recordDraw(vk::CommandBuffer command_buffer) const;
+
+    // call once the frame that drew the current lines has been submitted
+    void endFrame();
+    // drops the current lines without drawing them
+    void clear();
+
+private:
+    class Region {
+    public:
+        Region(const Device& device, size_t capacity);
+
+        Buffer buffer;
+        size_t capacity;
+    };
+
+    // reserves space for `count` vertices in the current region
+    shaders::LineVertex* allocate(size_t count);
+
+    static constexpr size_t initial_capacity = 1 << 16;
+    static constexpr size_t sphere_segments = 24;
+    // arrow head length and half-width, relative to the arrow length
+    static constexpr float arrow_head_length = 0.2f;
+    static constexpr float arrow_head_width = 0.08f;
+
+    const Device* device;
+
+    std::vector<Region> regions;
+    size_t current = 0;
+    size_t vertex_count = 0;
+
+    std::array<glm::vec2, sphere_segments + 1> circle;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_DEBUG_DRAW_HPP
@@ -18,7 +18,8 @@ vk::Format DepthBuffer::findFormat(const Device& device) {
     std::vector<vk::Format> formats = {
         vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint};
 
-    vk::FormatFeatureFlags depth_usage = vk::FormatFeatureFlagBits::eDepthStencilAttachment;
+    // depth is sampled afterwards to build the occlusion culling depth pyramid
+    vk::FormatFeatureFlags depth_usage = vk::FormatFeatureFlagBits::eDepthStencilAttachment | vk::FormatFeatureFlagBits::eSampledImage;
     for (auto format : formats) {
         if (device.supportsFormatUsage(format, tiling, depth_usage)) {
             return format;
@@ -31,7 +32,7 @@ vk::Format DepthBuffer::findFormat(const Device& device) {
 Image::Parameters DepthBuffer::parametersFor(const Device& device) {
     auto format = findFormat(device);
     auto memory = vk::MemoryPropertyFlagBits::eDeviceLocal;
-    auto usage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
+    auto usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled;
     auto aspects = vk::ImageAspectFlagBits::eDepth;
     auto mipmap = false;
 
@@ -0,0 +1,176 @@
+#include "depth_pyramid.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "shaders.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+DepthPyramid::DepthPyramid(const Device& device, const DepthBuffer& depth_buffer, vk::Extent2D depth_extent)
+    : extent(previousPowerOfTwo(depth_extent.width), previousPowerOfTwo(depth_extent.height)),
+      image(device, extent.width, extent.height, parameters()),
+      sampler(createSampler(device, image.getMIPMapLevels())),
+      descriptor_layout(createDescriptorLayout(device)),
+      pipeline_layout(createPipelineLayout(device, *descriptor_layout)),
+      pipeline(createPipeline(device, *pipeline_layout)),
+      descriptor_sets(nullptr) {
+    uint32_t levels = image.getMIPMapLevels();
+
+    for (uint32_t level = 0; level < levels; level++) {
+        auto subresource = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1);
+        auto view_info = vk::ImageViewCreateInfo({}, image.get(), vk::ImageViewType::e2D, image.getFormat(), {}, subresource);
+        level_views.emplace_back(device.logical(), view_info);
+    }
+
+    auto sampler_size = vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, levels);
+    auto storage_size = vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, levels);
+    auto pool_sizes = std::array<vk::DescriptorPoolSize, 2>{sampler_size, storage_size};
+    auto layouts = std::vector<vk::DescriptorSetLayout>(levels, *descriptor_layout);
+    descriptor_sets = DescriptorSets(device, pool_sizes, layouts);
+
+    for (uint32_t level = 0; level < levels; level++) {
+        auto source_info = level == 0
+                               ? vk::DescriptorImageInfo(*sampler, depth_buffer.getView(), depth_layout)
+                               : vk::DescriptorImageInfo(*sampler, *level_views[level - 1], vk::ImageLayout::eGeneral);
+        auto destination_info = vk::DescriptorImageInfo(nullptr, *level_views[level], vk::ImageLayout::eGeneral);
+
+        auto descriptor_writes = std::array<vk::WriteDescriptorSet, 2>{
+            vk::WriteDescriptorSet(descriptor_sets[level], 0, 0, vk::DescriptorType::eCombinedImageSampler, source_info),
+            vk::WriteDescriptorSet(descriptor_sets[level], 1, 0, vk::DescriptorType::eStorageImage, destination_info)};
+        device.logical().updateDescriptorSets(descriptor_writes, {});
+    }
+
+    // culling binds the pyramid before it is first built, so move it out of the undefined layout
+    auto allocate_info = vk::CommandBufferAllocateInfo(device.transientPool(), vk::CommandBufferLevel::ePrimary, 1);
+    auto command_buffers = vk::raii::CommandBuffers(device.logical(), allocate_info);
+    auto command_buffer = std::move(command_buffers.front());
+    command_buffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+    auto all_levels = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, levels, 0, 1);
+    auto barrier = vk::ImageMemoryBarrier({}, {}, vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.get(), all_levels);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, barrier);
+    command_buffer.end();
+
+    auto submit_info = vk::SubmitInfo({}, {}, *command_buffer, {});
+    device.transferQueue().submit(submit_info);
+    device.transferQueue().waitIdle();
+}
+
+void DepthPyramid::recordBuild(vk::CommandBuffer command_buffer, vk::Extent2D rendered) const {
+    uint32_t levels = image.getMIPMapLevels();
+
+    // previous contents are discarded, but culling may still be reading them
+    auto all_levels = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, levels, 0, 1);
+    auto discard = vk::ImageMemoryBarrier(
+        {},
+        vk::AccessFlagBits::eShaderWrite,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eGeneral,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        image.get(),
+        all_levels);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, discard);
+
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+
+    auto source_size = std::array<int32_t, 2>{static_cast<int32_t>(rendered.width), static_cast<int32_t>(rendered.height)};
+    for (uint32_t level = 0; level < levels; level++) {
+        uint32_t width = std::max(extent.width >> level, 1u);
+        uint32_t height = std::max(extent.height >> level, 1u);
+
+        command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0, descriptor_sets[level], {});
+        command_buffer.pushConstants<int32_t>(*pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, source_size);
+        command_buffer.dispatch((width + group_size - 1) / group_size, (height + group_size - 1) / group_size, 1);
+
+        // next level (and next frame's culling) reads what was just written
+        auto level_range = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1);
+        auto written = vk::ImageMemoryBarrier(
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eGeneral,
+            vk::ImageLayout::eGeneral,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            image.get(),
+            level_range);
+        command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, written);
+
+        source_size = {static_cast<int32_t>(width), static_cast<int32_t>(height)};
+    }
+}
+
+vk::DescriptorImageInfo DepthPyramid::descriptorInfo() const {
+    return vk::DescriptorImageInfo(*sampler, image.getView(), vk::ImageLayout::eGeneral);
+}
+
+vk::Extent2D DepthPyramid::getExtent() const {
+    return extent;
+}
+
+uint32_t DepthPyramid::previousPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+    while (result * 2 <= value) {
+        result *= 2;
+    }
+
+    return result;
+}
+
+Image::Parameters DepthPyramid::parameters() {
+    return Image::Parameters(
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        vk::ImageTiling::eOptimal,
+        vk::Format::eR32Sfloat,
+        vk::ImageAspectFlagBits::eColor,
+        true);
+}
+
+vk::raii::Sampler DepthPyramid::createSampler(const Device& device, uint32_t levels) {
+    auto sampler_info = vk::SamplerCreateInfo(
+        {},                                      // flags
+        vk::Filter::eNearest,                    // mag(nification) filter
+        vk::Filter::eNearest,                    // min(imization) filter
+        vk::SamplerMipmapMode::eNearest,         // mipmap mode
+        vk::SamplerAddressMode::eClampToEdge,    // U address mode
+        vk::SamplerAddressMode::eClampToEdge,    // V address mode
+        vk::SamplerAddressMode::eClampToEdge,    // W address mode
+        0.0,                                     // mipmap LOD (level-of-detail) bias
+        false,                                   // enable anisotropy
+        1.0,                                     // max anisotropy
+        false,                                   // enable compare
+        vk::CompareOp::eAlways,                  // compare op
+        0.0,                                     // min LOD
+        static_cast<float>(levels),              // max LOD
+        vk::BorderColor::eFloatOpaqueWhite,      // border color for clamp-to-border address mode
+        false                                    // unnormalized coordinates
+    );
+
+    return vk::raii::Sampler(device.logical(), sampler_info);
+}
+
+vk::raii::DescriptorSetLayout DepthPyramid::createDescriptorLayout(const Device& device) {
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 2>{
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute)};
+
+    return vk::raii::DescriptorSetLayout(device.logical(), vk::DescriptorSetLayoutCreateInfo({}, bindings));
+}
+
+vk::raii::PipelineLayout DepthPyramid::createPipelineLayout(const Device& device, const vk::DescriptorSetLayout& descriptor_layout) {
+    auto push_constants = vk::PushConstantRange(vk::ShaderStageFlagBits::eCompute, 0, 2 * sizeof(int32_t));
+    return vk::raii::PipelineLayout(device.logical(), vk::PipelineLayoutCreateInfo({}, descriptor_layout, push_constants));
+}
+
+vk::raii::Pipeline DepthPyramid::createPipeline(const Device& device, const vk::PipelineLayout& layout) {
+    auto shader_module = vk::raii::ShaderModule(device.logical(), vk::ShaderModuleCreateInfo({}, shaders::depth_reduce_shader));
+    auto stage = vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, *shader_module, "main");
+
+    return vk::raii::Pipeline(device.logical(), nullptr, vk::ComputePipelineCreateInfo({}, stage, layout));
+}
+
+}  // namespace vulkan
+}  // namespace visualization
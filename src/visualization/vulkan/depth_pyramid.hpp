@@ -0,0 +1,68 @@
+#ifndef BB8_VISUALIZATION_VULKAN_DEPTH_PYRAMID_HPP
+#define BB8_VISUALIZATION_VULKAN_DEPTH_PYRAMID_HPP
+
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "depth_buffer.hpp"
+#include "descriptor_sets.hpp"
+#include "device.hpp"
+#include "image.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Hierarchical depth buffer used for occlusion culling. Each texel of each
+// level holds the farthest depth of the area it covers in the depth buffer.
+// Level 0 is the largest power of two not exceeding the depth buffer size, and
+// covers whichever region of the depth buffer was rendered.
+class DepthPyramid {
+public:
+    DepthPyramid(const Device& device, const DepthBuffer& depth_buffer, vk::Extent2D depth_extent);
+
+    DepthPyramid(const DepthPyramid&) = delete;
+    DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+    DepthPyramid(DepthPyramid&&) = default;
+    DepthPyramid& operator=(DepthPyramid&&) = default;
+
+    ~DepthPyramid() = default;
+
+    // reduces the rendered region of the depth buffer into the pyramid, must be recorded
+    // after the render pass has left the depth buffer in a shader-readable layout
+    void recordBuild(vk::CommandBuffer command_buffer, vk::Extent2D rendered) const;
+
+    vk::DescriptorImageInfo descriptorInfo() const;
+    vk::Extent2D getExtent() const;
+
+    static constexpr vk::ImageLayout depth_layout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+
+private:
+    static uint32_t previousPowerOfTwo(uint32_t value);
+    static Image::Parameters parameters();
+
+    static vk::raii::Sampler createSampler(const Device& device, uint32_t levels);
+    static vk::raii::DescriptorSetLayout createDescriptorLayout(const Device& device);
+    static vk::raii::PipelineLayout createPipelineLayout(const Device& device, const vk::DescriptorSetLayout& descriptor_layout);
+    static vk::raii::Pipeline createPipeline(const Device& device, const vk::PipelineLayout& layout);
+
+    static constexpr uint32_t group_size = 8;
+
+    vk::Extent2D extent;
+    Image image;
+
+    vk::raii::Sampler sampler;
+    std::vector<vk::raii::ImageView> level_views;
+
+    vk::raii::DescriptorSetLayout descriptor_layout;
+    vk::raii::PipelineLayout pipeline_layout;
+    vk::raii::Pipeline pipeline;
+
+    // one per level, each reading from the level above it (or the depth buffer)
+    DescriptorSets descriptor_sets;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_DEPTH_PYRAMID_HPP
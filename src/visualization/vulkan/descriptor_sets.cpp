@@ -0,0 +1,30 @@
+#include "descriptor_sets.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+DescriptorSets::DescriptorSets(std::nullptr_t) : pool(nullptr) {}
+
+DescriptorSets::DescriptorSets(const Device& device, vk::ArrayProxy<const vk::DescriptorPoolSize> pool_sizes, vk::ArrayProxy<const vk::DescriptorSetLayout> layouts)
+    : pool(device.logical(), vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, layouts.size(), pool_sizes)),
+      sets(vk::raii::DescriptorSets(device.logical(), vk::DescriptorSetAllocateInfo(*pool, layouts))) {}
+
+DescriptorSets& DescriptorSets::operator=(DescriptorSets&& other) {
+    if (this != &other) {
+        sets.clear();
+        pool = std::move(other.pool);
+        sets = std::move(other.sets);
+    }
+    return *this;
+}
+
+vk::DescriptorSet DescriptorSets::operator[](size_t index) const {
+    return *sets[index];
+}
+
+size_t DescriptorSets::size() const {
+    return sets.size();
+}
+
+}  // namespace vulkan
+}  // namespace visualization
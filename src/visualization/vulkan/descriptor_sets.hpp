@@ -0,0 +1,42 @@
+#ifndef BB8_VISUALIZATION_VULKAN_DESCRIPTOR_SETS_HPP
+#define BB8_VISUALIZATION_VULKAN_DESCRIPTOR_SETS_HPP
+
+#include <cstddef>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "device.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Descriptor sets together with the pool they're allocated from, one set per layout.
+// The sets are freed before their pool whenever it's destroyed or replaced by move
+// assignment, so owners need no particular member order or destructor.
+class DescriptorSets {
+public:
+    // holds no pool or sets
+    DescriptorSets(std::nullptr_t);
+    DescriptorSets(const Device& device, vk::ArrayProxy<const vk::DescriptorPoolSize> pool_sizes, vk::ArrayProxy<const vk::DescriptorSetLayout> layouts);
+
+    DescriptorSets(const DescriptorSets&) = delete;
+    DescriptorSets& operator=(const DescriptorSets&) = delete;
+
+    DescriptorSets(DescriptorSets&&) = default;
+    DescriptorSets& operator=(DescriptorSets&& other);
+
+    ~DescriptorSets() = default;
+
+    vk::DescriptorSet operator[](size_t index) const;
+    size_t size() const;
+
+private:
+    // declared first so it's destroyed after the sets
+    vk::raii::DescriptorPool pool;
+    std::vector<vk::raii::DescriptorSet> sets;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_DESCRIPTOR_SETS_HPP
@@ -15,16 +15,18 @@ Device::Device(const vk::raii::Instance& instance, const vk::SurfaceKHR& surface
     : physical_device(selectPhysicalDevice(instance, surface, layers, extensions)),
       queue_families(queryQueueFamilies(*physical_device, surface)),
       enabled_features(selectFeatures(*physical_device)),
-      logical_device(buildLogicalDevice(physical_device, queue_families, enabled_features, layers, extensions)),
+      extended_features(selectExtendedFeatures(*physical_device)),
+      logical_device(buildLogicalDevice(physical_device, queue_families, enabled_features, extended_features, layers, extensions)),
       graphics_queue(logical_device.getQueue(queue_families.graphics.value(), 0)),
       present_queue(logical_device.getQueue(queue_families.present.value(), 0)),
-      transient_pool(createPool(true)) {}
+      transient_pool(createPool(true)),
+      memory_usage(std::make_unique<MemoryUsage>(*physical_device, extended_features.memory_budget)) {}
 
 void Device::waitIdle() {
     logical_device.waitIdle();
 }
 
-vk::raii::CommandPool Device::createPool(bool transient) {
+vk::raii::CommandPool Device::createPool(bool transient) const {
     auto flags = transient ? vk::CommandPoolCreateFlagBits::eTransient : vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
     auto create_info = vk::CommandPoolCreateInfo(flags, queue_families.graphics.value());
     return vk::raii::CommandPool(logical_device, create_info);
@@ -50,6 +52,10 @@ const vk::Queue& Device::transferQueue() const {
     return *graphics_queue;
 }
 
+uint32_t Device::graphicsFamily() const {
+    return queue_families.graphics.value();
+}
+
 const vk::CommandPool& Device::transientPool() const {
     return *transient_pool;
 }
@@ -62,6 +68,14 @@ const vk::PhysicalDeviceFeatures Device::features() const {
     return enabled_features;
 }
 
+const Device::ExtendedFeatures& Device::extendedFeatures() const {
+    return extended_features;
+}
+
+MemoryUsage& Device::memoryUsage() const {
+    return *memory_usage;
+}
+
 bool Device::supportsFormatUsage(vk::Format format, vk::ImageTiling tiling, vk::FormatFeatureFlags usage) const {
     auto properties = physical_device.getFormatProperties(format);
 
@@ -85,7 +99,8 @@ Device::QueueFamilies Device::queryQueueFamilies(const vk::PhysicalDevice& devic
             graphics_families.insert(index);
         }
 
-        vk::Bool32 present_support = device.getSurfaceSupportKHR(index, surface);
+        // without a surface nothing is presented, so any graphics queue will do
+        vk::Bool32 present_support = surface ? device.getSurfaceSupportKHR(index, surface) : vk::Bool32(false);
         if (present_support) {
             present_families.insert(index);
         }
@@ -98,7 +113,10 @@ Device::QueueFamilies Device::queryQueueFamilies(const vk::PhysicalDevice& devic
                           std::back_inserter(intersection));
 
     QueueFamilies families;
-    if (intersection.size() > 0) {
+    if (!surface) {
+        families.graphics = graphics_families.size() > 0 ? *graphics_families.begin() : std::optional<uint32_t>();
+        families.present = families.graphics;
+    } else if (intersection.size() > 0) {
         families.graphics = intersection.at(0);
         families.present = intersection.at(0);
     } else {
@@ -151,7 +169,7 @@ vk::raii::PhysicalDevice Device::selectPhysicalDevice(const vk::raii::Instance&
             continue;
         }
 
-        if (!supportsSwapChain(*device, surface)) {
+        if (surface && !supportsSwapChain(*device, surface)) {
             device_scores.push_back(0);
             continue;
         }
@@ -185,13 +203,44 @@ vk::raii::PhysicalDevice Device::selectPhysicalDevice(const vk::raii::Instance&
 }
 
 vk::PhysicalDeviceFeatures Device::selectFeatures(const vk::PhysicalDevice& physical_device) {
-    auto supports_anisotropy = physical_device.getFeatures().samplerAnisotropy;
+    auto supported = physical_device.getFeatures();
     auto features = vk::PhysicalDeviceFeatures();
-    features.samplerAnisotropy = supports_anisotropy;
+    features.samplerAnisotropy = supported.samplerAnisotropy;
+    features.multiDrawIndirect = supported.multiDrawIndirect;
+    // cluster culling draws each instance through its own indirect command
+    features.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+    // only used when pipeline statistics are enabled, but enabling it costs nothing otherwise
+    features.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+    // only used by point cloud splatting, whose 64-bit atomics also need an extension
+    features.shaderInt64 = supported.shaderInt64;
     return features;
 }
 
-vk::raii::Device Device::buildLogicalDevice(const vk::raii::PhysicalDevice& physical_device, const QueueFamilies& queue_families, vk::PhysicalDeviceFeatures features, const Layers required_layers, const Extensions required_extensions) {
+Device::ExtendedFeatures Device::selectExtendedFeatures(const vk::PhysicalDevice& physical_device) {
+    ExtendedFeatures features;
+
+    // features core in Vulkan 1.1
+    if (physical_device.getProperties().apiVersion >= VK_API_VERSION_1_1) {
+        auto supported = physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceMultiviewFeatures>();
+        features.multiview = supported.get<vk::PhysicalDeviceMultiviewFeatures>().multiview;
+
+        if (physical_device.getFeatures().shaderInt64 && supportsExtensions(physical_device, {VK_KHR_SHADER_ATOMIC_INT64_EXTENSION_NAME})) {
+            auto atomics = physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceShaderAtomicInt64Features>();
+            features.shader_atomic_int64 = atomics.get<vk::PhysicalDeviceShaderAtomicInt64Features>().shaderBufferInt64Atomics;
+        }
+    }
+
+    features.memory_budget = supportsExtensions(physical_device, {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME});
+
+    return features;
+}
+
+vk::raii::Device Device::buildLogicalDevice(const vk::raii::PhysicalDevice& physical_device,
+                                            const QueueFamilies& queue_families,
+                                            vk::PhysicalDeviceFeatures features,
+                                            const ExtendedFeatures& extended_features,
+                                            const Layers required_layers,
+                                            const Extensions required_extensions) {
     constexpr float queue_priority = 0.0f;
 
     std::vector<vk::DeviceQueueCreateInfo> queue_create_infos;
@@ -203,8 +252,28 @@ vk::raii::Device Device::buildLogicalDevice(const vk::raii::PhysicalDevice& phys
 
     auto enabled_layers = gatherLayers(physical_device.enumerateDeviceLayerProperties(), required_layers);
     auto enabled_extensions = gatherExtensions(physical_device.enumerateDeviceExtensionProperties(), required_extensions);
+    if (extended_features.memory_budget) {
+        enabled_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    if (extended_features.shader_atomic_int64) {
+        enabled_extensions.push_back(VK_KHR_SHADER_ATOMIC_INT64_EXTENSION_NAME);
+    }
+
+    // feature structures are only chained when enabled, a Vulkan 1.0 device doesn't know them
+    void* next = nullptr;
+    auto atomic_int64_features = vk::PhysicalDeviceShaderAtomicInt64Features(true, false);
+    if (extended_features.shader_atomic_int64) {
+        atomic_int64_features.pNext = next;
+        next = &atomic_int64_features;
+    }
+    auto multiview_features = vk::PhysicalDeviceMultiviewFeatures(true);
+    if (extended_features.multiview) {
+        multiview_features.pNext = next;
+        next = &multiview_features;
+    }
 
     auto device_create_info = vk::DeviceCreateInfo(vk::DeviceCreateFlags(), queue_create_infos, enabled_layers, enabled_extensions, &features);
+    device_create_info.pNext = next;
     return vk::raii::Device(physical_device, device_create_info);
 }
 
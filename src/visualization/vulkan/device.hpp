@@ -2,11 +2,14 @@
 #define BB8_VISUALIZATION_VULKAN_DEVICE_HPP
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
+#include "memory_usage.hpp"
+
 namespace visualization {
 namespace vulkan {
 
@@ -15,25 +18,41 @@ public:
     using Layers = std::vector<std::string>;
     using Extensions = std::vector<std::string>;
 
+    // optional features beyond VkPhysicalDeviceFeatures, enabled when supported
+    class ExtendedFeatures {
+    public:
+        bool multiview = false;
+        // VK_EXT_memory_budget, for reporting heap usage against budget
+        bool memory_budget = false;
+        // VK_KHR_shader_atomic_int64 with 64-bit integers, for splatting point clouds in compute
+        bool shader_atomic_int64 = false;
+    };
+
+    // a null surface selects a device without presentation, whose present queue is the graphics queue
     Device(const vk::raii::Instance& instance, const vk::SurfaceKHR& surface, Layers required_layers, Extensions required_extensions);
 
     void waitIdle();
 
-    vk::raii::CommandPool createPool(bool transient);
+    vk::raii::CommandPool createPool(bool transient) const;
 
     const vk::PhysicalDevice physical() const;
     const vk::raii::Device& logical() const;
     const vk::Queue& graphicsQueue() const;
     const vk::Queue& presentQueue() const;
     const vk::Queue& transferQueue() const;
+    uint32_t graphicsFamily() const;
 
     const vk::CommandPool& transientPool() const;
 
     const vk::PhysicalDeviceProperties properties() const;
     const vk::PhysicalDeviceFeatures features() const;
+    const ExtendedFeatures& extendedFeatures() const;
 
     bool supportsFormatUsage(vk::Format format, vk::ImageTiling tiling, vk::FormatFeatureFlags usage) const;
 
+    // device memory allocated by buffers and images, which any holder of the device may allocate
+    MemoryUsage& memoryUsage() const;
+
 private:
     class QueueFamilies {
     public:
@@ -48,18 +67,27 @@ private:
 
     static vk::raii::PhysicalDevice selectPhysicalDevice(const vk::raii::Instance& instance, const vk::SurfaceKHR& surface, const Layers required_layers, const Extensions required_extensions);
     static vk::PhysicalDeviceFeatures selectFeatures(const vk::PhysicalDevice& physical_device);
-    static vk::raii::Device buildLogicalDevice(const vk::raii::PhysicalDevice& physical_device, const QueueFamilies& queue_families, vk::PhysicalDeviceFeatures features, const Layers required_layers, const Extensions required_extensions);
+    static ExtendedFeatures selectExtendedFeatures(const vk::PhysicalDevice& physical_device);
+    static vk::raii::Device buildLogicalDevice(const vk::raii::PhysicalDevice& physical_device,
+                                               const QueueFamilies& queue_families,
+                                               vk::PhysicalDeviceFeatures features,
+                                               const ExtendedFeatures& extended_features,
+                                               const Layers required_layers,
+                                               const Extensions required_extensions);
 
     const vk::raii::PhysicalDevice physical_device;
 
     const QueueFamilies queue_families;
     const vk::PhysicalDeviceFeatures enabled_features;
+    const ExtendedFeatures extended_features;
     const vk::raii::Device logical_device;
 
     const vk::raii::Queue graphics_queue;
     const vk::raii::Queue present_queue;
 
     const vk::raii::CommandPool transient_pool;
+
+    const std::unique_ptr<MemoryUsage> memory_usage;
 };
 
 }  // namespace vulkan
@@ -0,0 +1,87 @@
+#include "dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace visualization {
+namespace vulkan {
+
+DynamicResolution::DynamicResolution(Settings settings)
+    : settings(settings), scale(settings.max_scale) {
+    validate(settings);
+}
+
+void DynamicResolution::update(double gpu_frame_ms) {
+    frames_since_change++;
+    if (frames_since_change <= settle_frames) {
+        return;
+    }
+
+    smoothed_ms = smoothed_ms.has_value() ? *smoothed_ms + smoothing * (gpu_frame_ms - *smoothed_ms) : gpu_frame_ms;
+
+    double ratio = settings.target_frame_ms / std::max(*smoothed_ms, 1e-3);
+    if (std::abs(ratio - 1.0) <= tolerance) {
+        return;
+    }
+
+    float desired = scale * static_cast<float>(std::sqrt(ratio));
+    desired = std::clamp(desired, scale * (1.0f - max_step), scale * (1.0f + max_step));
+
+    // always move at least one quantum, otherwise small corrections round back to the current scale
+    float quantized = std::round(desired / quantum) * quantum;
+    if (quantized == scale) {
+        quantized = ratio > 1.0 ? scale + quantum : scale - quantum;
+    }
+
+    float next = std::clamp(quantized, settings.min_scale, settings.max_scale);
+    if (next != scale) {
+        scale = next;
+        frames_since_change = 0;
+        smoothed_ms.reset();
+    }
+}
+
+const DynamicResolution::Settings& DynamicResolution::getSettings() const {
+    return settings;
+}
+
+void DynamicResolution::setSettings(Settings new_settings) {
+    validate(new_settings);
+
+    settings = new_settings;
+    scale = std::clamp(scale, settings.min_scale, settings.max_scale);
+    frames_since_change = 0;
+    smoothed_ms.reset();
+}
+
+float DynamicResolution::getScale() const {
+    return scale;
+}
+
+vk::Extent2D DynamicResolution::renderExtent(vk::Extent2D output) const {
+    return scaled(output, scale);
+}
+
+vk::Extent2D DynamicResolution::maxExtent(vk::Extent2D output) const {
+    return scaled(output, settings.max_scale);
+}
+
+void DynamicResolution::validate(const Settings& settings) {
+    if (!(settings.target_frame_ms > 0.0f)) {
+        throw std::runtime_error("dynamic resolution target frame time must be positive");
+    }
+
+    if (!(settings.min_scale > 0.0f) || settings.min_scale > settings.max_scale) {
+        throw std::runtime_error("dynamic resolution scales must satisfy 0 < min_scale <= max_scale");
+    }
+}
+
+vk::Extent2D DynamicResolution::scaled(vk::Extent2D extent, float scale) {
+    uint32_t width = static_cast<uint32_t>(std::floor(extent.width * scale));
+    uint32_t height = static_cast<uint32_t>(std::floor(extent.height * scale));
+    return vk::Extent2D(std::max(width, 1u), std::max(height, 1u));
+}
+
+}  // namespace vulkan
+}  // namespace visualization
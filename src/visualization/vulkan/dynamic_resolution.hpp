@@ -0,0 +1,64 @@
+#ifndef BB8_VISUALIZATION_VULKAN_DYNAMIC_RESOLUTION_HPP
+#define BB8_VISUALIZATION_VULKAN_DYNAMIC_RESOLUTION_HPP
+
+#include <cstdint>
+#include <optional>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace visualization {
+namespace vulkan {
+
+// Chooses the fraction of the output resolution to render at, so that GPU frame
+// time stays near a target. Rendering cost scales roughly with pixel count, so the
+// scale moves by the square root of the ratio between target and measured time.
+class DynamicResolution {
+public:
+    class Settings {
+    public:
+        float target_frame_ms = 1000.0f / 60.0f;
+        // fractions of the output width and height, equal min and max disable scaling
+        float min_scale = 0.5f;
+        float max_scale = 1.0f;
+    };
+
+    explicit DynamicResolution(Settings settings);
+
+    // feeds the GPU time of a completed frame
+    void update(double gpu_frame_ms);
+
+    const Settings& getSettings() const;
+    void setSettings(Settings settings);
+
+    float getScale() const;
+
+    // extent to render at for the current scale, never larger than maxExtent
+    vk::Extent2D renderExtent(vk::Extent2D output) const;
+    // largest extent any allowed scale renders at, which render targets are allocated for
+    vk::Extent2D maxExtent(vk::Extent2D output) const;
+
+private:
+    static void validate(const Settings& settings);
+    static vk::Extent2D scaled(vk::Extent2D extent, float scale);
+
+    // weight of each new measurement in the smoothed frame time
+    static constexpr double smoothing = 0.1;
+    // frame times within this fraction of the target leave the scale alone
+    static constexpr double tolerance = 0.05;
+    // largest relative change to the scale in one step
+    static constexpr float max_step = 0.1f;
+    // scales are multiples of this, so small fluctuations don't change the extent every frame
+    static constexpr float quantum = 1.0f / 32.0f;
+    // measurements after a change still include frames rendered at the old scale
+    static constexpr uint32_t settle_frames = 4;
+
+    Settings settings;
+    float scale;
+
+    std::optional<double> smoothed_ms;
+    uint32_t frames_since_change = 0;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_DYNAMIC_RESOLUTION_HPP
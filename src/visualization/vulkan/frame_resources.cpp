@@ -1,5 +1,8 @@
 #include "frame_resources.hpp"
 
+#include <array>
+
+#include "shaders/instance.hpp"
 #include "shaders/uniform_buffer_object.hpp"
 
 namespace visualization {
@@ -9,10 +12,14 @@ FrameResources::FrameResources(const Device& device,
                                const vk::CommandPool& command_pool,
                                const vk::DescriptorPool& descriptor_pool,
                                const vk::DescriptorSetLayout& layout,
-                               const Texture& texture)
+                               const Texture& texture,
+                               const ShadowMaps& shadow_maps)
     : command_buffer(createCommandBuffer(device, command_pool)),
       ubo_buffer(Buffer(device, Buffer::Requirements::uniform(sizeof(shaders::UniformBufferObject)))),
-      descriptor_set(createDescriptors(device, descriptor_pool, layout, ubo_buffer, texture)),
+      lighting_buffer(Buffer(device, Buffer::Requirements::uniform(sizeof(shaders::LightingUniforms)))),
+      instance_buffer(Buffer(device, Buffer::Requirements::instance(initial_instance_capacity * sizeof(shaders::Instance)))),
+      instance_capacity(initial_instance_capacity),
+      descriptor_set(createDescriptors(device, descriptor_pool, layout, ubo_buffer, lighting_buffer, texture, shadow_maps)),
       image_available_semaphore(device.logical(), vk::SemaphoreCreateInfo()),
       render_finished_semaphore(device.logical(), vk::SemaphoreCreateInfo()),
       in_flight_fence(device.logical(), vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled)) {}
@@ -21,7 +28,9 @@ vk::raii::DescriptorSet FrameResources::createDescriptors(const Device& device,
                                                           const vk::DescriptorPool& pool,
                                                           const vk::DescriptorSetLayout& layout,
                                                           const Buffer& ubo_buffer,
-                                                          const Texture& texture) {
+                                                          const Buffer& lighting_buffer,
+                                                          const Texture& texture,
+                                                          const ShadowMaps& shadow_maps) {
     auto allocate_info = vk::DescriptorSetAllocateInfo(pool, layout);
     auto descriptor_sets = vk::raii::DescriptorSets(device.logical(), allocate_info);
     vk::raii::DescriptorSet descriptor = std::move(descriptor_sets.at(0));
@@ -32,7 +41,21 @@ vk::raii::DescriptorSet FrameResources::createDescriptors(const Device& device,
     auto image_info = texture.descriptorInfo();
     auto sampler_descriptor_write = vk::WriteDescriptorSet(*descriptor, 1, 0, vk::DescriptorType::eCombinedImageSampler, image_info);
 
-    auto descriptor_writes = std::vector<vk::WriteDescriptorSet>{ubo_descriptor_write, sampler_descriptor_write};
+    auto lighting_info = lighting_buffer.descriptorInfo();
+    auto lighting_descriptor_write = vk::WriteDescriptorSet(*descriptor, 2, 0, vk::DescriptorType::eUniformBuffer, {}, lighting_info);
+
+    auto static_shadow_info = shadow_maps.staticDescriptorInfo();
+    auto static_shadow_descriptor_write = vk::WriteDescriptorSet(*descriptor, 3, 0, vk::DescriptorType::eCombinedImageSampler, static_shadow_info);
+
+    auto dynamic_shadow_info = shadow_maps.dynamicDescriptorInfo();
+    auto dynamic_shadow_descriptor_write = vk::WriteDescriptorSet(*descriptor, 4, 0, vk::DescriptorType::eCombinedImageSampler, dynamic_shadow_info);
+
+    auto descriptor_writes = std::vector<vk::WriteDescriptorSet>{
+        ubo_descriptor_write,
+        sampler_descriptor_write,
+        lighting_descriptor_write,
+        static_shadow_descriptor_write,
+        dynamic_shadow_descriptor_write};
     device.logical().updateDescriptorSets(descriptor_writes, {});
 
     return descriptor;
@@ -63,12 +86,56 @@ void FrameResources::writeUniformBuffer(const shaders::UniformBufferObject& ubo)
     std::memcpy(ubo_buffer.data(), &ubo, sizeof(ubo));
 }
 
+void FrameResources::writeLightingUniforms(const shaders::LightingUniforms& lighting) {
+    std::memcpy(lighting_buffer.data(), &lighting, sizeof(lighting));
+}
+
+const Buffer& FrameResources::getUniformBuffer() const {
+    return ubo_buffer;
+}
+
+const Buffer& FrameResources::getLightingBuffer() const {
+    return lighting_buffer;
+}
+
+void FrameResources::writeLightBuffers(const Device& device, const Buffer& lights, const Buffer& clusters) {
+    auto lights_info = lights.descriptorInfo();
+    auto clusters_info = clusters.descriptorInfo();
+
+    auto descriptor_writes = std::array<vk::WriteDescriptorSet, 2>{
+        vk::WriteDescriptorSet(*descriptor_set, 5, 0, vk::DescriptorType::eStorageBuffer, {}, lights_info),
+        vk::WriteDescriptorSet(*descriptor_set, 6, 0, vk::DescriptorType::eStorageBuffer, {}, clusters_info)};
+    device.logical().updateDescriptorSets(descriptor_writes, {});
+}
+
 const vk::DescriptorSet& FrameResources::getDescriptors() const {
     return *descriptor_set;
 }
 
+void FrameResources::writeInstances(const Device& device, const scene::SceneGraph& scene) {
+    if (scene.size() > instance_capacity) {
+        while (instance_capacity < scene.size()) {
+            instance_capacity *= 2;
+        }
+
+        instance_buffer = Buffer(device, Buffer::Requirements::instance(instance_capacity * sizeof(shaders::Instance)));
+        // new buffer has no valid contents, force a full upload
+        instance_generation = 0;
+    }
+
+    static_assert(sizeof(shaders::Instance) == sizeof(glm::mat4));
+    auto instances = reinterpret_cast<glm::mat4*>(instance_buffer.data());
+    size_t written = scene.packWorldMatrices(instances, instance_generation);
+    device.memoryUsage().recordUpload(written * sizeof(shaders::Instance));
+}
+
+const Buffer& FrameResources::getInstances() const {
+    return instance_buffer;
+}
+
 void FrameResources::submitTo(const vk::Queue& graphics_queue) {
-    const auto wait_dst_stage_mask = vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+    // swap chain image is first written by the upscale blit at the end of the frame
+    const auto wait_dst_stage_mask = vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer);
     auto submit_info = vk::SubmitInfo(*image_available_semaphore, wait_dst_stage_mask, *command_buffer, *render_finished_semaphore);
 
     graphics_queue.submit(submit_info, *in_flight_fence);
@@ -4,9 +4,12 @@
 #include <limits>
 #include <vulkan/vulkan_raii.hpp>
 
+#include "../scene/scene_graph.hpp"
 #include "buffer.hpp"
 #include "device.hpp"
+#include "shaders/lighting_uniforms.hpp"
 #include "shaders/uniform_buffer_object.hpp"
+#include "shadow_maps.hpp"
 #include "swap_chain.hpp"
 #include "texture.hpp"
 
@@ -19,7 +22,8 @@ public:
                    const vk::CommandPool& command_pool,
                    const vk::DescriptorPool& descriptor_pool,
                    const vk::DescriptorSetLayout& layout,
-                   const Texture& texture);
+                   const Texture& texture,
+                   const ShadowMaps& shadow_maps);
 
     const vk::CommandBuffer& getCommandBuffer() const;
 
@@ -29,8 +33,19 @@ public:
     std::tuple<vk::Result, uint32_t> acquireNextImage(SwapChain& swap_chain);
 
     void writeUniformBuffer(const shaders::UniformBufferObject& ubo);
+    void writeLightingUniforms(const shaders::LightingUniforms& lighting);
+    const Buffer& getUniformBuffer() const;
+    const Buffer& getLightingBuffer() const;
+
+    // points the frame's descriptors at this frame's clustered lights
+    void writeLightBuffers(const Device& device, const Buffer& lights, const Buffer& clusters);
+
     const vk::DescriptorSet& getDescriptors() const;
 
+    // uploads world matrices changed since this frame's instance buffer was last written
+    void writeInstances(const Device& device, const scene::SceneGraph& scene);
+    const Buffer& getInstances() const;
+
     void submitTo(const vk::Queue& graphics_queue);
     vk::Result presentTo(const vk::Queue& present_queue, SwapChain& swap_chain, uint32_t image_index);
 
@@ -40,13 +55,21 @@ private:
                                                      const vk::DescriptorPool& pool,
                                                      const vk::DescriptorSetLayout& layout,
                                                      const Buffer& ubo_buffer,
-                                                     const Texture& texture);
+                                                     const Buffer& lighting_buffer,
+                                                     const Texture& texture,
+                                                     const ShadowMaps& shadow_maps);
 
     static constexpr uint64_t timeout = std::numeric_limits<uint64_t>::max();
+    static constexpr size_t initial_instance_capacity = 64;
 
     vk::raii::CommandBuffer command_buffer;
 
     Buffer ubo_buffer;
+    Buffer lighting_buffer;
+
+    Buffer instance_buffer;
+    size_t instance_capacity;
+    uint64_t instance_generation = 0;
 
     vk::raii::DescriptorSet descriptor_set;
 
@@ -0,0 +1,64 @@
+#include "gpu_timer.hpp"
+
+#include <array>
+#include <limits>
+
+namespace visualization {
+namespace vulkan {
+
+GpuTimer::GpuTimer(const Device& device, size_t frame_count)
+    : period(device.properties().limits.timestampPeriod),
+      query_pool(device.logical(), vk::QueryPoolCreateInfo({}, vk::QueryType::eTimestamp, queries_per_frame * static_cast<uint32_t>(frame_count))),
+      recorded(frame_count, false) {
+    uint32_t valid_bits = device.physical().getQueueFamilyProperties().at(device.graphicsFamily()).timestampValidBits;
+    supported = valid_bits > 0;
+    valid_mask = valid_bits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << valid_bits) - 1;
+}
+
+void GpuTimer::recordStart(vk::CommandBuffer command_buffer, size_t frame) {
+    if (!supported) {
+        return;
+    }
+
+    uint32_t first = queries_per_frame * static_cast<uint32_t>(frame);
+    command_buffer.resetQueryPool(*query_pool, first, queries_per_frame);
+    command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *query_pool, first);
+    recorded.at(frame) = true;
+}
+
+void GpuTimer::recordEnd(vk::CommandBuffer command_buffer, size_t frame) const {
+    if (!supported) {
+        return;
+    }
+
+    uint32_t first = queries_per_frame * static_cast<uint32_t>(frame);
+    command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *query_pool, first + 1);
+}
+
+std::optional<double> GpuTimer::read(size_t frame) {
+    if (!supported || !recorded.at(frame)) {
+        return std::nullopt;
+    }
+    recorded.at(frame) = false;
+
+    uint32_t first = queries_per_frame * static_cast<uint32_t>(frame);
+    // read into a fixed array rather than getResults, which returns a vector, to keep frames allocation-free
+    auto [result, timestamps] = query_pool.getResult<std::array<uint64_t, queries_per_frame>>(first,
+                                                                                            queries_per_frame,
+                                                                                            sizeof(uint64_t),
+                                                                                            vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess) {
+        return std::nullopt;
+    }
+
+    // bits above the valid range are undefined, and the counter may wrap between timestamps
+    uint64_t ticks = ((timestamps[1] & valid_mask) - (timestamps[0] & valid_mask)) & valid_mask;
+    return static_cast<double>(ticks) * period * 1e-6;
+}
+
+bool GpuTimer::isSupported() const {
+    return supported;
+}
+
+}  // namespace vulkan
+}  // namespace visualization
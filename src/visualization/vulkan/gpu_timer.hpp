@@ -0,0 +1,55 @@
+#ifndef BB8_VISUALIZATION_VULKAN_GPU_TIMER_HPP
+#define BB8_VISUALIZATION_VULKAN_GPU_TIMER_HPP
+
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "device.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Measures how long each frame's commands take on the GPU, using a pair of
+// timestamp queries per frame. Results are read once the frame's fence has
+// signaled, so they trail recording by the number of frames in flight.
+class GpuTimer {
+public:
+    GpuTimer(const Device& device, size_t frame_count);
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    GpuTimer(GpuTimer&&) = default;
+    GpuTimer& operator=(GpuTimer&&) = default;
+
+    ~GpuTimer() = default;
+
+    // resets the frame's queries and writes its start timestamp, must be recorded first
+    void recordStart(vk::CommandBuffer command_buffer, size_t frame);
+    // writes the frame's end timestamp, must be recorded last
+    void recordEnd(vk::CommandBuffer command_buffer, size_t frame) const;
+
+    // milliseconds between the frame's timestamps, each measurement is returned only once
+    // and is only valid once the frame's commands have completed
+    std::optional<double> read(size_t frame);
+
+    // graphics queue doesn't support timestamps on some devices
+    bool isSupported() const;
+
+private:
+    static constexpr uint32_t queries_per_frame = 2;
+
+    bool supported;
+    // nanoseconds per timestamp tick
+    double period;
+    uint64_t valid_mask;
+
+    vk::raii::QueryPool query_pool;
+    std::vector<bool> recorded;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_GPU_TIMER_HPP
@@ -14,13 +14,21 @@ Image::Parameters::Parameters(vk::MemoryPropertyFlags memory_properties,
                               vk::ImageTiling tiling,
                               vk::Format format,
                               vk::ImageAspectFlags aspects,
-                              bool mipmap)
+                              bool mipmap,
+                              uint32_t layers)
     : memory_properties(memory_properties),
       usage(usage),
       tiling(tiling),
       format(format),
       aspects(aspects),
-      mipmap(mipmap) {
+      mipmap(mipmap),
+      layers(layers),
+      category(MemoryUsage::Category::texture) {
+    auto written = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eStorage;
+    if (usage & written) {
+        category = MemoryUsage::Category::attachment;
+    }
+
     // to generate a mipmap, we will need to transfer portions of the image to itself
     if (mipmap) {
         this->usage = usage | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
@@ -30,11 +38,15 @@ Image::Parameters::Parameters(vk::MemoryPropertyFlags memory_properties,
 Image Image::load(const Device& device,
                   std::filesystem::path image_file,
                   Parameters parameters) {
+    return load(device, resources::Image::load(image_file), parameters);
+}
+
+Image Image::load(const Device& device,
+                  const resources::Image& image_source,
+                  Parameters parameters) {
     // ensure we can transfer into the image
     parameters.usage = parameters.usage | vk::ImageUsageFlagBits::eTransferDst;
 
-    resources::Image image_source = resources::Image::load(image_file);
-
     auto allocate_info = vk::CommandBufferAllocateInfo(device.transientPool(), vk::CommandBufferLevel::ePrimary, 1);
     auto command_buffers = vk::raii::CommandBuffers(device.logical(), allocate_info);
     auto command_buffer = std::move(command_buffers.front());
@@ -43,7 +55,8 @@ Image Image::load(const Device& device,
     command_buffer.begin(begin_info);
 
     Buffer staging = Buffer(device, Buffer::Requirements::staging(image_source.size()));
-    staging.fill((void*)image_source.data(), image_source.size());
+    staging.fill(image_source.data(), image_source.size());
+    device.memoryUsage().recordUpload(image_source.size());
 
     auto image = Image(device, image_source.width(), image_source.height(), parameters);
 
@@ -65,6 +78,10 @@ Image Image::load(const Device& device,
     return image;
 }
 
+vk::Image Image::get() const {
+    return *image;
+}
+
 const vk::ImageView Image::getView() const {
     return *view;
 }
@@ -85,6 +102,10 @@ uint32_t Image::getMIPMapLevels() const {
     return mip_levels;
 }
 
+uint32_t Image::getLayers() const {
+    return layers;
+}
+
 Image::Image(const Device& device, uint32_t width, uint32_t height, Parameters parameters)
     : extent(width, height, 1),
       layout(vk::ImageLayout::eUndefined),
@@ -92,9 +113,11 @@ Image::Image(const Device& device, uint32_t width, uint32_t height, Parameters p
       format(parameters.format),
       aspects(parameters.aspects),
       mip_levels(parameters.mipmap ? computeMIPLevels(width, height) : 1),
+      layers(parameters.layers),
       image(createImage(device, extent, mip_levels, parameters)),
-      memory(allocateMemory(device, image.getMemoryRequirements(), parameters.memory_properties)),
+      memory(nullptr),
       view(nullptr) {
+    allocateMemory(device, parameters);
     image.bindMemory(*memory, 0);
     // can't create image view until image memory is bound
     view = createView(device);
@@ -112,7 +135,7 @@ vk::raii::Image Image::createImage(const Device& device, vk::Extent3D extent, ui
         parameters.format,            // format
         extent,                       // extent
         mip_levels,                   // mip levels
-        1,                            // array layers
+        parameters.layers,            // array layers
         vk::SampleCountFlagBits::e1,  // samples
         parameters.tiling,            // tiling
         parameters.usage,             // usage
@@ -124,14 +147,16 @@ vk::raii::Image Image::createImage(const Device& device, vk::Extent3D extent, ui
     return vk::raii::Image(device.logical(), create_info);
 }
 
-vk::raii::DeviceMemory Image::allocateMemory(const Device& device, vk::MemoryRequirements memory_requirements, vk::MemoryPropertyFlags property_requirements) {
-    auto memory_allocation = Memory::allocationInfo(device, memory_requirements, property_requirements);
-    return vk::raii::DeviceMemory(device.logical(), memory_allocation);
+void Image::allocateMemory(const Device& device, const Parameters& parameters) {
+    auto allocate_info = Memory::allocationInfo(device, image.getMemoryRequirements(), parameters.memory_properties);
+    memory = vk::raii::DeviceMemory(device.logical(), allocate_info);
+    allocation = device.memoryUsage().track(parameters.category, allocate_info);
 }
 
 vk::raii::ImageView Image::createView(const Device& device) {
-    auto subresource = vk::ImageSubresourceRange(aspects, 0, mip_levels, 0, 1);
-    auto view_info = vk::ImageViewCreateInfo({}, *image, vk::ImageViewType::e2D, format, {}, subresource);
+    auto subresource = vk::ImageSubresourceRange(aspects, 0, mip_levels, 0, layers);
+    auto view_type = layers > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D;
+    auto view_info = vk::ImageViewCreateInfo({}, *image, view_type, format, {}, subresource);
 
     return vk::raii::ImageView(device.logical(), view_info);
 }
@@ -185,7 +210,7 @@ bool Image::formatHasStencil(vk::Format format) const {
 }
 
 void Image::transitionLayout(const vk::CommandBuffer& command_buffer, vk::ImageLayout new_layout) {
-    auto subresource = vk::ImageSubresourceRange(aspects, 0, mip_levels, 0, 1);
+    auto subresource = vk::ImageSubresourceRange(aspects, 0, mip_levels, 0, layers);
     if (formatHasStencil(format)) {
         subresource.aspectMask = subresource.aspectMask | vk::ImageAspectFlagBits::eStencil;
     }
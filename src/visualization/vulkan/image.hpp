@@ -4,8 +4,10 @@
 #include <filesystem>
 #include <vulkan/vulkan_raii.hpp>
 
+#include "../resources/image.hpp"
 #include "buffer.hpp"
 #include "device.hpp"
+#include "memory_usage.hpp"
 
 namespace visualization {
 namespace vulkan {
@@ -19,7 +21,8 @@ public:
                    vk::ImageTiling tiling,
                    vk::Format format,
                    vk::ImageAspectFlags aspects,
-                   bool mipmap);
+                   bool mipmap,
+                   uint32_t layers = 1);
 
         vk::MemoryPropertyFlags memory_properties;
         vk::ImageUsageFlags usage;
@@ -27,11 +30,19 @@ public:
         vk::Format format;
         vk::ImageAspectFlags aspects;
         bool mipmap;
+        // images with more than one layer are viewed as 2D arrays
+        uint32_t layers;
+        // images the GPU renders or writes to are attachments, others textures
+        MemoryUsage::Category category;
     };
 
     static Image load(const Device& device,
                       std::filesystem::path image_file,
                       Parameters parameters);
+    // uploads an already decoded image
+    static Image load(const Device& device,
+                      const resources::Image& image_source,
+                      Parameters parameters);
 
     Image(const Device& device, uint32_t width, uint32_t height, Parameters parameters);
 
@@ -43,17 +54,19 @@ public:
 
     ~Image() = default;
 
+    vk::Image get() const;
     const vk::ImageView getView() const;
     vk::ImageLayout getLayout() const;
     vk::ImageTiling getTiling() const;
     vk::Format getFormat() const;
     uint32_t getMIPMapLevels() const;
+    uint32_t getLayers() const;
 
 private:
     static uint32_t computeMIPLevels(uint32_t width, uint32_t height);
     static vk::raii::Image createImage(const Device& device, vk::Extent3D extent, uint32_t mip_levels, Parameters parameters);
-    static vk::raii::DeviceMemory allocateMemory(const Device& device, vk::MemoryRequirements memory_requirements, vk::MemoryPropertyFlags property_requirements);
 
+    void allocateMemory(const Device& device, const Parameters& parameters);
     vk::raii::ImageView createView(const Device& device);
     void generateMIPMaps(vk::CommandBuffer command_buffer, const Device& device);
 
@@ -69,9 +82,11 @@ private:
     vk::ImageAspectFlags aspects;
 
     uint32_t mip_levels;
+    uint32_t layers;
 
     vk::raii::Image image;
     vk::raii::DeviceMemory memory;
+    MemoryUsage::Allocation allocation;
     vk::raii::ImageView view;
 };
 
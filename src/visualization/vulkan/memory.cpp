@@ -23,5 +23,16 @@ vk::MemoryAllocateInfo Memory::allocationInfo(const Device& device, const vk::Me
     return vk::MemoryAllocateInfo(memory_reqs.size, memory_type_index);
 }
 
+vk::MemoryAllocateInfo Memory::allocationInfo(const Device& device,
+                                              const vk::MemoryRequirements& memory_reqs,
+                                              const vk::MemoryPropertyFlags& required_properties,
+                                              const vk::MemoryPropertyFlags& preferred_properties) {
+    try {
+        return allocationInfo(device, memory_reqs, required_properties | preferred_properties);
+    } catch (std::runtime_error&) {
+        return allocationInfo(device, memory_reqs, required_properties);
+    }
+}
+
 }  // namespace vulkan
 }  // namespace visualization
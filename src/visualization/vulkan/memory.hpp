@@ -12,6 +12,12 @@ class Memory {
 public:
     static uint32_t findType(const Device& device, uint32_t required_type_bits, const vk::MemoryPropertyFlags& required_properties);
     static vk::MemoryAllocateInfo allocationInfo(const Device& device, const vk::MemoryRequirements& memory_reqs, const vk::MemoryPropertyFlags& required_properties);
+
+    // uses a memory type that also has the preferred properties if there is one
+    static vk::MemoryAllocateInfo allocationInfo(const Device& device,
+                                                 const vk::MemoryRequirements& memory_reqs,
+                                                 const vk::MemoryPropertyFlags& required_properties,
+                                                 const vk::MemoryPropertyFlags& preferred_properties);
 };
 
 }  // namespace vulkan
@@ -0,0 +1,266 @@
+#include "memory_usage.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+namespace visualization {
+namespace vulkan {
+
+namespace {
+
+double mebibytes(vk::DeviceSize bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+const char* MemoryUsage::categoryName(Category category) {
+    switch (category) {
+        case Category::geometry:
+            return "geometry";
+        case Category::texture:
+            return "texture";
+        case Category::attachment:
+            return "attachment";
+        case Category::uniform:
+            return "uniform";
+        case Category::streaming:
+            return "streaming";
+        case Category::storage:
+            return "storage";
+        case Category::staging:
+            return "staging";
+        case Category::readback:
+            return "readback";
+    }
+
+    return "unknown";
+}
+
+vk::DeviceSize MemoryUsage::Heap::limit() const {
+    return budget.value_or(size);
+}
+
+double MemoryUsage::Heap::pressure() const {
+    auto limit = this->limit();
+    return limit > 0 ? static_cast<double>(usage.value_or(allocated)) / static_cast<double>(limit) : 0.0;
+}
+
+void MemoryUsage::Report::write(std::ostream& out) const {
+    auto flags = out.flags();
+    auto precision = out.precision();
+
+    out << std::fixed << std::setprecision(1);
+    for (const auto& heap : heaps) {
+        out << "heap " << heap.index << (heap.device_local ? " (device local)" : "") << ": "
+            << mebibytes(heap.allocated) << " MiB allocated";
+        if (heap.usage.has_value() && heap.budget.has_value()) {
+            out << ", " << mebibytes(*heap.usage) << " MiB used of " << mebibytes(*heap.budget) << " MiB budget";
+        }
+        out << ", " << mebibytes(heap.size) << " MiB heap\n";
+    }
+
+    for (const auto& category : categories) {
+        if (category.allocations > 0) {
+            out << "  " << categoryName(category.category) << ": " << mebibytes(category.bytes) << " MiB in "
+                << category.allocations << " allocations\n";
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void MemoryUsage::Report::writeJson(std::ostream& out) const {
+    auto optional = [&out](const std::optional<vk::DeviceSize>& value) {
+        if (value.has_value()) {
+            out << *value;
+        } else {
+            out << "null";
+        }
+    };
+
+    out << "{\n";
+    out << "  \"heaps\": [\n";
+    for (size_t i = 0; i < heaps.size(); i++) {
+        const auto& heap = heaps[i];
+        out << "    {\"index\": " << heap.index << ", "
+            << "\"size\": " << heap.size << ", "
+            << "\"device_local\": " << (heap.device_local ? "true" : "false") << ", "
+            << "\"allocated\": " << heap.allocated << ", "
+            << "\"usage\": ";
+        optional(heap.usage);
+        out << ", \"budget\": ";
+        optional(heap.budget);
+        out << "}" << (i + 1 < heaps.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+
+    out << "  \"categories\": {\n";
+    for (size_t i = 0; i < categories.size(); i++) {
+        const auto& category = categories[i];
+        out << "    \"" << categoryName(category.category) << "\": {"
+            << "\"allocations\": " << category.allocations << ", "
+            << "\"bytes\": " << category.bytes << "}" << (i + 1 < categories.size() ? "," : "") << "\n";
+    }
+    out << "  }\n";
+    out << "}\n";
+}
+
+MemoryUsage::Allocation::Allocation(MemoryUsage* usage, Category category, uint32_t heap, vk::DeviceSize size)
+    : usage(usage), category(category), heap(heap), size(size) {}
+
+MemoryUsage::Allocation::Allocation(Allocation&& other)
+    : usage(std::exchange(other.usage, nullptr)), category(other.category), heap(other.heap), size(other.size) {}
+
+MemoryUsage::Allocation& MemoryUsage::Allocation::operator=(Allocation&& other) {
+    if (this != &other) {
+        release();
+
+        usage = std::exchange(other.usage, nullptr);
+        category = other.category;
+        heap = other.heap;
+        size = other.size;
+    }
+
+    return *this;
+}
+
+MemoryUsage::Allocation::~Allocation() {
+    release();
+}
+
+void MemoryUsage::Allocation::release() {
+    if (usage == nullptr) {
+        return;
+    }
+
+    auto category_index = static_cast<size_t>(category);
+    usage->heap_bytes[heap].fetch_sub(size, std::memory_order_relaxed);
+    usage->category_allocations[category_index].fetch_sub(1, std::memory_order_relaxed);
+    usage->category_bytes[category_index].fetch_sub(size, std::memory_order_relaxed);
+    usage = nullptr;
+}
+
+MemoryUsage::MemoryUsage(vk::PhysicalDevice physical_device, bool budget_supported)
+    : physical_device(physical_device),
+      properties(physical_device.getMemoryProperties()),
+      budget_supported(budget_supported),
+      last_check(clock::now()),
+      last_log(clock::now()) {}
+
+MemoryUsage::Allocation MemoryUsage::track(Category category, const vk::MemoryAllocateInfo& allocate_info) {
+    uint32_t heap = properties.memoryTypes[allocate_info.memoryTypeIndex].heapIndex;
+    auto category_index = static_cast<size_t>(category);
+
+    heap_bytes[heap].fetch_add(allocate_info.allocationSize, std::memory_order_relaxed);
+    category_allocations[category_index].fetch_add(1, std::memory_order_relaxed);
+    category_bytes[category_index].fetch_add(allocate_info.allocationSize, std::memory_order_relaxed);
+
+    return Allocation(this, category, heap, allocate_info.allocationSize);
+}
+
+void MemoryUsage::recordUpload(uint64_t bytes) {
+    uploaded_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void MemoryUsage::setSettings(Settings settings) {
+    this->settings = settings;
+}
+
+bool MemoryUsage::hasBudget() const {
+    return budget_supported;
+}
+
+MemoryUsage::Report MemoryUsage::report() const {
+    auto budget = queryBudget();
+
+    Report report;
+    for (uint32_t index = 0; index < properties.memoryHeapCount; index++) {
+        report.heaps.push_back(heap(index, budget));
+    }
+
+    for (size_t index = 0; index < category_count; index++) {
+        auto& category = report.categories[index];
+        category.category = static_cast<Category>(index);
+        category.allocations = category_allocations[index].load(std::memory_order_relaxed);
+        category.bytes = category_bytes[index].load(std::memory_order_relaxed);
+    }
+
+    return report;
+}
+
+vk::DeviceSize MemoryUsage::allocatedBytes() const {
+    vk::DeviceSize total = 0;
+    for (uint32_t index = 0; index < properties.memoryHeapCount; index++) {
+        total += heap_bytes[index].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t MemoryUsage::uploadedBytes() const {
+    return uploaded_bytes.load(std::memory_order_relaxed);
+}
+
+void MemoryUsage::poll() {
+    auto now = clock::now();
+    if (now - last_check < check_interval) {
+        return;
+    }
+    last_check = now;
+
+    // only allocates when something is logged, so steady-state frames stay allocation-free
+    auto budget = queryBudget();
+    for (uint32_t index = 0; index < properties.memoryHeapCount; index++) {
+        auto current = heap(index, budget);
+        uint32_t bit = 1u << index;
+
+        if (current.pressure() <= settings.warning_fraction) {
+            warned_heaps &= ~bit;
+        } else if ((warned_heaps & bit) == 0) {
+            warned_heaps |= bit;
+
+            auto flags = std::cerr.flags();
+            auto precision = std::cerr.precision();
+            std::cerr << std::fixed << std::setprecision(1) << "warning: memory heap " << index << " is at "
+                      << 100.0 * current.pressure() << "% of its " << (current.budget.has_value() ? "budget" : "size")
+                      << " (" << mebibytes(current.limit()) << " MiB)" << std::endl;
+            std::cerr.flags(flags);
+            std::cerr.precision(precision);
+        }
+    }
+
+    if (settings.log_interval.has_value() && now - last_log >= *settings.log_interval) {
+        last_log = now;
+        report().write(std::cerr);
+    }
+}
+
+std::optional<vk::PhysicalDeviceMemoryBudgetPropertiesEXT> MemoryUsage::queryBudget() const {
+    if (!budget_supported) {
+        return std::nullopt;
+    }
+
+    auto chain = physical_device.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    return chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+}
+
+MemoryUsage::Heap MemoryUsage::heap(uint32_t index, const std::optional<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>& budget) const {
+    const auto& properties_heap = properties.memoryHeaps[index];
+
+    Heap heap;
+    heap.index = index;
+    heap.size = properties_heap.size;
+    heap.device_local = static_cast<bool>(properties_heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+    heap.allocated = heap_bytes[index].load(std::memory_order_relaxed);
+    if (budget.has_value()) {
+        heap.usage = budget->heapUsage[index];
+        heap.budget = budget->heapBudget[index];
+    }
+
+    return heap;
+}
+
+}  // namespace vulkan
+}  // namespace visualization
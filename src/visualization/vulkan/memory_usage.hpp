@@ -0,0 +1,163 @@
+#ifndef BB8_VISUALIZATION_VULKAN_MEMORY_USAGE_HPP
+#define BB8_VISUALIZATION_VULKAN_MEMORY_USAGE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace visualization {
+namespace vulkan {
+
+// Accounts device memory allocated by buffers and images, per category and
+// memory heap. With VK_EXT_memory_budget, heaps also report the process' usage
+// and budget as seen by the driver, which includes memory allocated elsewhere
+// (swap chain images, pipelines, other processes sharing the budget).
+// Tracking is lock-free, so resources may be created on any thread.
+class MemoryUsage {
+public:
+    enum class Category {
+        geometry,
+        texture,
+        // render targets and images written by the GPU every frame
+        attachment,
+        uniform,
+        // host-visible buffers rewritten every frame
+        streaming,
+        storage,
+        staging,
+        readback,
+    };
+    static constexpr size_t category_count = 8;
+    static const char* categoryName(Category category);
+
+    class Settings {
+    public:
+        // fraction of a heap's budget, or of its size without VK_EXT_memory_budget, past which a warning is logged
+        double warning_fraction = 0.9;
+        // usage is logged this often, disabled if unset
+        std::optional<std::chrono::milliseconds> log_interval;
+    };
+
+    class Heap {
+    public:
+        uint32_t index;
+        vk::DeviceSize size;
+        bool device_local;
+        // bytes allocated through buffers and images
+        vk::DeviceSize allocated;
+        // nullopt without VK_EXT_memory_budget
+        std::optional<vk::DeviceSize> usage;
+        std::optional<vk::DeviceSize> budget;
+
+        // budget if known, otherwise the heap's size
+        vk::DeviceSize limit() const;
+        // best known usage, as a fraction of the limit
+        double pressure() const;
+    };
+
+    class CategoryUsage {
+    public:
+        Category category;
+        uint64_t allocations;
+        vk::DeviceSize bytes;
+    };
+
+    class Report {
+    public:
+        std::vector<Heap> heaps;
+        std::array<CategoryUsage, category_count> categories;
+
+        // one line per heap and per category in use
+        void write(std::ostream& out) const;
+        void writeJson(std::ostream& out) const;
+    };
+
+    // an allocation counted until it's destroyed
+    class Allocation {
+    public:
+        Allocation() = default;
+
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+
+        Allocation(Allocation&& other);
+        Allocation& operator=(Allocation&& other);
+
+        ~Allocation();
+
+    private:
+        friend class MemoryUsage;
+
+        Allocation(MemoryUsage* usage, Category category, uint32_t heap, vk::DeviceSize size);
+        void release();
+
+        MemoryUsage* usage = nullptr;
+        Category category = Category::geometry;
+        uint32_t heap = 0;
+        vk::DeviceSize size = 0;
+    };
+
+    MemoryUsage(vk::PhysicalDevice physical_device, bool budget_supported);
+
+    MemoryUsage(const MemoryUsage&) = delete;
+    MemoryUsage& operator=(const MemoryUsage&) = delete;
+
+    MemoryUsage(MemoryUsage&&) = delete;
+    MemoryUsage& operator=(MemoryUsage&&) = delete;
+
+    ~MemoryUsage() = default;
+
+    // counts an allocation of `allocate_info` until the returned allocation is destroyed
+    Allocation track(Category category, const vk::MemoryAllocateInfo& allocate_info);
+
+    void setSettings(Settings settings);
+    bool hasBudget() const;
+
+    Report report() const;
+
+    // counts `bytes` written by the host into memory the GPU reads, e.g. a frame's streamed instances
+    void recordUpload(uint64_t bytes);
+
+    // lock-free totals, cheap enough to read every frame
+    vk::DeviceSize allocatedBytes() const;
+    // bytes ever uploaded from the host, as recorded by recordUpload()
+    uint64_t uploadedBytes() const;
+
+    // warns about heaps nearing their limit, and logs usage once the log interval elapses.
+    // Called by the render thread every frame, but only queries the driver every `check_interval`
+    void poll();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::optional<vk::PhysicalDeviceMemoryBudgetPropertiesEXT> queryBudget() const;
+    Heap heap(uint32_t index, const std::optional<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>& budget) const;
+
+    // budgets change as other processes allocate, but needn't be queried every frame
+    static constexpr auto check_interval = std::chrono::milliseconds(500);
+
+    vk::PhysicalDevice physical_device;
+    vk::PhysicalDeviceMemoryProperties properties;
+    bool budget_supported;
+
+    std::array<std::atomic<vk::DeviceSize>, VK_MAX_MEMORY_HEAPS> heap_bytes{};
+    std::array<std::atomic<uint64_t>, category_count> category_allocations{};
+    std::array<std::atomic<vk::DeviceSize>, category_count> category_bytes{};
+    std::atomic<uint64_t> uploaded_bytes{0};
+
+    Settings settings;
+    clock::time_point last_check;
+    clock::time_point last_log;
+    // heaps that have already been warned about, re-armed once usage drops again
+    uint32_t warned_heaps = 0;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_MEMORY_USAGE_HPP
@@ -1,67 +1,47 @@
 #include "model.hpp"
 
-#include <string>
-#include <unordered_map>
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-
 namespace visualization {
 namespace vulkan {
 
 Model Model::load(const Device& device, std::filesystem::path obj_file, std::filesystem::path texture_file) {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    auto file_string = obj_file.string();
-    const char* file = file_string.c_str();
-    bool success = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file);
-    if (!success) {
-        throw std::runtime_error(warn + err);
-    }
+    return load(device, decode(obj_file, texture_file));
+}
 
-    std::vector<shaders::Vertex> vertices;
-    std::vector<uint32_t> indices;
-    std::unordered_map<shaders::Vertex, uint32_t> vertex_indices{};
-
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            glm::vec3 position = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]};
-            glm::vec2 texture_coordinate = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                // OBJ uses (0, 0) as lower left corner, need to invert
-                1.0 - attrib.texcoords[2 * index.texcoord_index + 1]};
-            glm::vec3 color = {1.0f, 1.0f, 1.0f};
-
-            // if we already have seen vertex, reference previous copy
-            auto vertex = shaders::Vertex(position, color, texture_coordinate);
-            if (vertex_indices.count(vertex) == 0) {
-                vertices.push_back(vertex);
-                vertex_indices[vertex] = vertices.size() - 1;
-            }
-
-            indices.push_back(vertex_indices[vertex]);
-        }
-    }
+Model::Assets Model::decode(std::filesystem::path obj_file, std::filesystem::path texture_file) {
+    auto mesh = resources::Mesh::load(obj_file);
+    mesh.generateLods(max_lods);
+    mesh.generateMeshlets();
+
+    auto bvh = buildBvh(mesh);
+    return Assets{std::move(mesh), resources::Image::load(texture_file), std::move(bvh)};
+}
+
+Model Model::load(const Device& device, Assets assets) {
+    const auto& mesh = assets.mesh;
 
+    const auto& vertices = mesh.getVertices();
     size_t vertices_size = vertices.size() * sizeof(vertices[0]);
     auto vertex_buffer = Buffer::load(device, vertices.data(), Buffer::Requirements::vertex(vertices_size));
 
+    const auto& indices = mesh.getIndices();
     size_t indices_size = indices.size() * sizeof(indices[0]);
     auto index_buffer = Buffer::load(device, indices.data(), Buffer::Requirements::index(indices_size));
 
-    auto texture = Texture::load(device, texture_file, vk::SamplerAddressMode::eRepeat);
+    const auto& meshlets = mesh.getMeshlets();
+    size_t meshlets_size = meshlets.size() * sizeof(meshlets[0]);
+    auto meshlet_buffer = Buffer::load(device, meshlets.data(), Buffer::Requirements::storage(meshlets_size));
 
-    return Model(std::move(texture), std::move(vertex_buffer), std::move(index_buffer), indices.size());
+    const auto& meshlet_indices = mesh.getMeshletIndices();
+    size_t meshlet_indices_size = meshlet_indices.size() * sizeof(meshlet_indices[0]);
+    auto meshlet_index_buffer = Buffer::load(device, meshlet_indices.data(), Buffer::Requirements::storage(meshlet_indices_size));
+
+    auto texture = Texture::load(device, assets.texture, vk::SamplerAddressMode::eRepeat);
+
+    return Model(mesh, std::move(assets.bvh), std::move(texture), std::move(vertex_buffer), std::move(index_buffer), std::move(meshlet_buffer), std::move(meshlet_index_buffer));
 }
 
 uint32_t Model::indexCount() const {
-    return index_count;
+    return lods.front().index_count;
 }
 
 const Texture& Model::getTexture() const {
@@ -76,8 +56,75 @@ const Buffer& Model::getIndices() const {
     return index_buffer;
 }
 
-Model::Model(Texture texture, Buffer vertex_buffer, Buffer index_buffer, uint32_t index_count)
-    : index_count(index_count), texture(std::move(texture)), vertex_buffer(std::move(vertex_buffer)), index_buffer(std::move(index_buffer)) {}
+const Buffer& Model::getMeshlets() const {
+    return meshlet_buffer;
+}
+
+const Buffer& Model::getMeshletIndices() const {
+    return meshlet_index_buffer;
+}
+
+uint32_t Model::meshletCount() const {
+    return meshlet_count;
+}
+
+const std::vector<Model::Lod>& Model::getLods() const {
+    return lods;
+}
+
+glm::vec3 Model::boundsCenter() const {
+    return bounds_center;
+}
+
+float Model::boundsRadius() const {
+    return bounds_radius;
+}
+
+const geometry::Bvh& Model::getBvh() const {
+    return bvh;
+}
+
+uint32_t Model::selectLod(float pixels_per_unit, uint32_t current_lod) const {
+    uint32_t selected = 0;
+    for (uint32_t level = 1; level < lods.size(); level++) {
+        float threshold = level > current_lod ? lod_hysteresis * lod_error_threshold : lod_error_threshold;
+        if (lods[level].error * pixels_per_unit >= threshold) {
+            break;
+        }
+
+        selected = level;
+    }
+
+    return selected;
+}
+
+geometry::Bvh Model::buildBvh(const resources::Mesh& mesh) {
+    const auto& vertices = mesh.getVertices();
+    const auto& indices = mesh.getIndices();
+    const auto& full_detail = mesh.getLods().front();
+
+    std::vector<geometry::Triangle> triangles;
+    triangles.reserve(full_detail.index_count / 3);
+    for (uint32_t i = full_detail.first_index; i + 2 < full_detail.first_index + full_detail.index_count; i += 3) {
+        triangles.push_back(geometry::Triangle::fromCorners(vertices[indices[i]].position,
+                                                            vertices[indices[i + 1]].position,
+                                                            vertices[indices[i + 2]].position));
+    }
+
+    return geometry::Bvh::build(std::move(triangles));
+}
+
+Model::Model(const resources::Mesh& mesh, geometry::Bvh bvh, Texture texture, Buffer vertex_buffer, Buffer index_buffer, Buffer meshlet_buffer, Buffer meshlet_index_buffer)
+    : lods(mesh.getLods()),
+      bounds_center(mesh.boundsCenter()),
+      bounds_radius(mesh.boundsRadius()),
+      bvh(std::move(bvh)),
+      texture(std::move(texture)),
+      vertex_buffer(std::move(vertex_buffer)),
+      index_buffer(std::move(index_buffer)),
+      meshlet_count(static_cast<uint32_t>(mesh.getMeshlets().size())),
+      meshlet_buffer(std::move(meshlet_buffer)),
+      meshlet_index_buffer(std::move(meshlet_index_buffer)) {}
 
 }  // namespace vulkan
 }  // namespace visualization
@@ -4,6 +4,9 @@
 #include <filesystem>
 #include <vector>
 
+#include "../geometry/bvh.hpp"
+#include "../resources/image.hpp"
+#include "../resources/mesh.hpp"
 #include "shaders/vertex.hpp"
 #include "texture.hpp"
 
@@ -12,20 +15,70 @@ namespace vulkan {
 
 class Model {
 public:
+    using Lod = resources::Mesh::Lod;
+
+    // CPU-side model data, which needs no device, so it can be prepared on another thread
+    class Assets {
+    public:
+        resources::Mesh mesh;
+        resources::Image texture;
+        // full-detail triangles in model space
+        geometry::Bvh bvh;
+    };
+
     static Model load(const Device& device, std::filesystem::path obj_file, std::filesystem::path texture_file);
 
+    // parses and decodes the model's files, and builds its levels of detail, meshlets and BVH
+    static Assets decode(std::filesystem::path obj_file, std::filesystem::path texture_file);
+    // uploads decoded assets to the GPU, keeping the BVH for CPU-side queries
+    static Model load(const Device& device, Assets assets);
+
     uint32_t indexCount() const;
     const Texture& getTexture() const;
     const Buffer& getVertices() const;
     const Buffer& getIndices() const;
 
+    // meshlets of the full-detail level, and the indices they draw
+    const Buffer& getMeshlets() const;
+    const Buffer& getMeshletIndices() const;
+    uint32_t meshletCount() const;
+
+    const std::vector<Lod>& getLods() const;
+    glm::vec3 boundsCenter() const;
+    float boundsRadius() const;
+
+    // full-detail geometry in model space, for picking, contacts and line-of-sight
+    const geometry::Bvh& getBvh() const;
+
+    // coarsest level of detail whose simplification error stays below a pixel, where
+    // `pixels_per_unit` converts model-space lengths at the instance's distance into pixels
+    uint32_t selectLod(float pixels_per_unit, uint32_t current_lod) const;
+
 private:
-    Model(Texture texture, Buffer vertex_buffer, Buffer index_buffer, uint32_t index_count);
+    Model(const resources::Mesh& mesh, geometry::Bvh bvh, Texture texture, Buffer vertex_buffer, Buffer index_buffer, Buffer meshlet_buffer, Buffer meshlet_index_buffer);
+
+    static geometry::Bvh buildBvh(const resources::Mesh& mesh);
+
+    static constexpr size_t max_lods = 4;
+
+    // largest projected simplification error, in pixels, that is considered invisible
+    static constexpr float lod_error_threshold = 1.0f;
+    // switching to a coarser level requires the error to be this much below the threshold,
+    // so instances near a boundary don't alternate between levels every frame
+    static constexpr float lod_hysteresis = 0.75f;
+
+    std::vector<Lod> lods;
+    glm::vec3 bounds_center;
+    float bounds_radius;
+    geometry::Bvh bvh;
 
-    uint32_t index_count;
     Texture texture;
     Buffer vertex_buffer;
     Buffer index_buffer;
+
+    uint32_t meshlet_count;
+    Buffer meshlet_buffer;
+    Buffer meshlet_index_buffer;
 };
 
 }  // namespace vulkan
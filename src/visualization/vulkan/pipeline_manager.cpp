@@ -0,0 +1,149 @@
+#include "pipeline_manager.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace visualization {
+namespace vulkan {
+
+PipelineManager::Entry::Entry(PipelineState state, size_t hash, std::optional<Handle> fallback)
+    : state(std::move(state)), hash(hash), fallback(fallback), pipeline(nullptr) {}
+
+PipelineManager::PipelineManager(const Device& device, uint32_t worker_count)
+    : device(&device),
+      pipeline_cache(device.logical(), vk::PipelineCacheCreateInfo()) {
+    for (uint32_t i = 0; i < std::max(worker_count, 1u); i++) {
+        workers.emplace_back(&PipelineManager::work, this);
+    }
+}
+
+PipelineManager::~PipelineManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+PipelineManager::Handle PipelineManager::request(PipelineState state, std::optional<Handle> fallback) {
+    size_t hash = state.hash();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto [begin, end] = by_hash.equal_range(hash);
+    for (auto it = begin; it != end; it++) {
+        if (entries[it->second].state == state) {
+            return it->second;
+        }
+    }
+
+    auto handle = static_cast<Handle>(entries.size());
+    entries.emplace_back(std::move(state), hash, fallback);
+    by_hash.emplace(hash, handle);
+    queue.push_back(handle);
+
+    work_available.notify_one();
+    return handle;
+}
+
+vk::Pipeline PipelineManager::get(Handle handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (std::optional<Handle> current = handle; current.has_value(); current = entries.at(*current).fallback) {
+        const auto& entry = entries.at(*current);
+        if (entry.ready && !entry.released && !entry.error) {
+            return *entry.pipeline;
+        }
+    }
+
+    return nullptr;
+}
+
+bool PipelineManager::isReady(Handle handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.at(handle).ready;
+}
+
+bool PipelineManager::hasFailed(Handle handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto& entry = entries.at(handle);
+    return entry.ready && entry.error;
+}
+
+vk::Pipeline PipelineManager::wait(Handle handle) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const auto& entry = entries.at(handle);
+    work_done.wait(lock, [&entry]() { return entry.ready; });
+
+    if (entry.error) {
+        std::rethrow_exception(entry.error);
+    }
+
+    return *entry.pipeline;
+}
+
+void PipelineManager::release(Handle handle) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto& entry = entries.at(handle);
+    work_done.wait(lock, [&entry]() { return entry.ready; });
+
+    auto [begin, end] = by_hash.equal_range(entry.hash);
+    for (auto it = begin; it != end; it++) {
+        if (it->second == handle) {
+            by_hash.erase(it);
+            break;
+        }
+    }
+
+    entry.released = true;
+    entry.pipeline = vk::raii::Pipeline(nullptr);
+}
+
+const vk::raii::PipelineCache& PipelineManager::cache() const {
+    return pipeline_cache;
+}
+
+uint32_t PipelineManager::defaultWorkerCount() {
+    // leave a core for the render thread, drivers often compile on threads of their own too
+    uint32_t cores = std::thread::hardware_concurrency();
+    return std::clamp(cores > 1 ? cores - 1 : 1u, 1u, 4u);
+}
+
+void PipelineManager::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        work_available.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        Handle handle = queue.front();
+        queue.pop_front();
+        auto& entry = entries[handle];
+
+        // state is immutable once requested, so it can be read without holding the lock
+        lock.unlock();
+
+        vk::raii::Pipeline pipeline = nullptr;
+        std::exception_ptr error;
+        try {
+            pipeline = entry.state.create(*device, pipeline_cache);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        entry.pipeline = std::move(pipeline);
+        entry.error = error;
+        entry.ready = true;
+        work_done.notify_all();
+    }
+}
+
+}  // namespace vulkan
+}  // namespace visualization
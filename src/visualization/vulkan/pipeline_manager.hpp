@@ -0,0 +1,97 @@
+#ifndef BB8_VISUALIZATION_VULKAN_PIPELINE_MANAGER_HPP
+#define BB8_VISUALIZATION_VULKAN_PIPELINE_MANAGER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "device.hpp"
+#include "pipeline_state.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Compiles graphics pipelines on worker threads, so creating them doesn't stall
+// startup or the frame that first needs them. Requests are keyed by their full
+// pipeline state, so identical requests share one pipeline, and all compilation
+// shares one pipeline cache.
+class PipelineManager {
+public:
+    using Handle = uint32_t;
+
+    PipelineManager(const Device& device, uint32_t worker_count = defaultWorkerCount());
+
+    PipelineManager(const PipelineManager&) = delete;
+    PipelineManager& operator=(const PipelineManager&) = delete;
+
+    // workers refer back to the manager, so it can't be moved
+    PipelineManager(PipelineManager&&) = delete;
+    PipelineManager& operator=(PipelineManager&&) = delete;
+
+    ~PipelineManager();
+
+    // queues the pipeline for compilation, unless an identical one was already requested.
+    // Until it is ready, get() returns the fallback (if it is ready), which must be compatible
+    Handle request(PipelineState state, std::optional<Handle> fallback = std::nullopt);
+
+    // the requested pipeline if it has compiled, otherwise the nearest ready fallback, otherwise null
+    vk::Pipeline get(Handle handle) const;
+    bool isReady(Handle handle) const;
+    // compilation finished with an error, get() falls back past it
+    bool hasFailed(Handle handle) const;
+
+    // blocks until the pipeline has compiled, rethrowing any compilation error
+    vk::Pipeline wait(Handle handle);
+
+    // destroys the pipeline once compiled, it must no longer be in use by the GPU.
+    // Handles of released pipelines must not be used again
+    void release(Handle handle);
+
+    const vk::raii::PipelineCache& cache() const;
+
+    static uint32_t defaultWorkerCount();
+
+private:
+    class Entry {
+    public:
+        Entry(PipelineState state, size_t hash, std::optional<Handle> fallback);
+
+        PipelineState state;
+        size_t hash;
+        std::optional<Handle> fallback;
+
+        bool ready = false;
+        bool released = false;
+        vk::raii::Pipeline pipeline;
+        std::exception_ptr error;
+    };
+
+    void work();
+
+    const Device* device;
+    vk::raii::PipelineCache pipeline_cache;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    // entries are never erased, so handles stay valid indices
+    std::deque<Entry> entries;
+    std::unordered_multimap<size_t, Handle> by_hash;
+    std::deque<Handle> queue;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_PIPELINE_MANAGER_HPP
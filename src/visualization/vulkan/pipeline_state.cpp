@@ -0,0 +1,191 @@
+#include "pipeline_state.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace visualization {
+namespace vulkan {
+
+namespace {
+
+template <typename T>
+void hashCombine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+template <typename Enum>
+void hashEnum(size_t& seed, Enum value) {
+    hashCombine(seed, static_cast<uint64_t>(value));
+}
+
+template <typename Flags>
+void hashFlags(size_t& seed, Flags flags) {
+    hashCombine(seed, static_cast<uint64_t>(static_cast<typename Flags::MaskType>(flags)));
+}
+
+void hashStencil(size_t& seed, const vk::StencilOpState& stencil) {
+    hashEnum(seed, stencil.failOp);
+    hashEnum(seed, stencil.passOp);
+    hashEnum(seed, stencil.depthFailOp);
+    hashEnum(seed, stencil.compareOp);
+    hashCombine(seed, stencil.compareMask);
+    hashCombine(seed, stencil.writeMask);
+    hashCombine(seed, stencil.reference);
+}
+
+}  // namespace
+
+PipelineState::PipelineState(vk::PipelineLayout layout, vk::RenderPass render_pass)
+    : layout(layout), render_pass(render_pass) {}
+
+void PipelineState::addStage(vk::ShaderStageFlagBits stage, const uint32_t* code, size_t code_size, Specialization specialization) {
+    stages.push_back(Stage{stage, code, code_size, std::move(specialization)});
+}
+
+size_t PipelineState::hash() const {
+    size_t seed = 0;
+
+    for (const auto& stage : stages) {
+        hashEnum(seed, stage.stage);
+        hashCombine(seed, stage.code_size);
+        // contents rather than address, shaders may be recompiled into the same storage
+        for (size_t i = 0; i < stage.code_size; i++) {
+            hashCombine(seed, stage.code[i]);
+        }
+
+        for (const auto& entry : stage.specialization.entries()) {
+            hashCombine(seed, entry.constantID);
+        }
+        for (uint32_t value : stage.specialization.values()) {
+            hashCombine(seed, value);
+        }
+    }
+
+    for (const auto& binding : bindings) {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, binding.stride);
+        hashEnum(seed, binding.inputRate);
+    }
+    for (const auto& attribute : attributes) {
+        hashCombine(seed, attribute.location);
+        hashCombine(seed, attribute.binding);
+        hashEnum(seed, attribute.format);
+        hashCombine(seed, attribute.offset);
+    }
+    hashEnum(seed, topology);
+
+    hashCombine(seed, rasterization.depthClampEnable);
+    hashCombine(seed, rasterization.rasterizerDiscardEnable);
+    hashEnum(seed, rasterization.polygonMode);
+    hashFlags(seed, rasterization.cullMode);
+    hashEnum(seed, rasterization.frontFace);
+    hashCombine(seed, rasterization.depthBiasEnable);
+    hashCombine(seed, rasterization.depthBiasConstantFactor);
+    hashCombine(seed, rasterization.depthBiasClamp);
+    hashCombine(seed, rasterization.depthBiasSlopeFactor);
+    hashCombine(seed, rasterization.lineWidth);
+
+    hashEnum(seed, samples);
+
+    hashCombine(seed, depth_stencil.depthTestEnable);
+    hashCombine(seed, depth_stencil.depthWriteEnable);
+    hashEnum(seed, depth_stencil.depthCompareOp);
+    hashCombine(seed, depth_stencil.depthBoundsTestEnable);
+    hashCombine(seed, depth_stencil.stencilTestEnable);
+    hashStencil(seed, depth_stencil.front);
+    hashStencil(seed, depth_stencil.back);
+    hashCombine(seed, depth_stencil.minDepthBounds);
+    hashCombine(seed, depth_stencil.maxDepthBounds);
+
+    for (const auto& blend : blend_attachments) {
+        hashCombine(seed, blend.blendEnable);
+        hashEnum(seed, blend.srcColorBlendFactor);
+        hashEnum(seed, blend.dstColorBlendFactor);
+        hashEnum(seed, blend.colorBlendOp);
+        hashEnum(seed, blend.srcAlphaBlendFactor);
+        hashEnum(seed, blend.dstAlphaBlendFactor);
+        hashEnum(seed, blend.alphaBlendOp);
+        hashFlags(seed, blend.colorWriteMask);
+    }
+    for (auto state : dynamic_states) {
+        hashEnum(seed, state);
+    }
+
+    hashCombine(seed, static_cast<VkPipelineLayout>(layout));
+    hashCombine(seed, static_cast<VkRenderPass>(render_pass));
+    hashCombine(seed, subpass);
+
+    return seed;
+}
+
+bool PipelineState::operator==(const PipelineState& other) const {
+    auto same_stage = [](const Stage& a, const Stage& b) {
+        return a.stage == b.stage &&
+               a.code_size == b.code_size &&
+               std::equal(a.code, a.code + a.code_size, b.code) &&
+               a.specialization.entries() == b.specialization.entries() &&
+               a.specialization.values() == b.specialization.values();
+    };
+
+    return std::equal(stages.begin(), stages.end(), other.stages.begin(), other.stages.end(), same_stage) &&
+           bindings == other.bindings &&
+           attributes == other.attributes &&
+           topology == other.topology &&
+           rasterization == other.rasterization &&
+           samples == other.samples &&
+           depth_stencil == other.depth_stencil &&
+           blend_attachments == other.blend_attachments &&
+           dynamic_states == other.dynamic_states &&
+           layout == other.layout &&
+           render_pass == other.render_pass &&
+           subpass == other.subpass;
+}
+
+vk::raii::Pipeline PipelineState::create(const Device& device, const vk::raii::PipelineCache& cache) const {
+    std::vector<vk::raii::ShaderModule> modules;
+    std::vector<vk::SpecializationInfo> specializations;
+    std::vector<vk::PipelineShaderStageCreateInfo> shader_stages;
+    modules.reserve(stages.size());
+    specializations.reserve(stages.size());
+
+    for (const auto& stage : stages) {
+        auto module_info = vk::ShaderModuleCreateInfo({}, stage.code_size * sizeof(uint32_t), stage.code);
+        modules.emplace_back(device.logical(), module_info);
+
+        const auto& entries = stage.specialization.entries();
+        const auto& values = stage.specialization.values();
+        specializations.emplace_back(static_cast<uint32_t>(entries.size()), entries.data(), values.size() * sizeof(uint32_t), values.data());
+
+        const auto* specialization = entries.empty() ? nullptr : &specializations.back();
+        shader_stages.emplace_back(vk::PipelineShaderStageCreateFlags(), stage.stage, *modules.back(), "main", specialization);
+    }
+
+    auto vertex_input = vk::PipelineVertexInputStateCreateInfo({}, bindings, attributes);
+    auto input_assembly = vk::PipelineInputAssemblyStateCreateInfo({}, topology, false);
+    auto viewport = vk::PipelineViewportStateCreateInfo({}, 1, nullptr, 1, nullptr);
+    auto multisample = vk::PipelineMultisampleStateCreateInfo({}, samples);
+    auto color_blend = vk::PipelineColorBlendStateCreateInfo({}, false, vk::LogicOp::eNoOp, blend_attachments, {{1.0f, 1.0f, 1.0f, 1.0f}});
+    auto dynamic = vk::PipelineDynamicStateCreateInfo({}, dynamic_states);
+
+    auto pipeline_create_info = vk::GraphicsPipelineCreateInfo(
+        {},               // flags
+        shader_stages,    // stages
+        &vertex_input,    // vertex input state
+        &input_assembly,  // input assembly state
+        nullptr,          // tessellation state
+        &viewport,        // viewport state
+        &rasterization,   // rasterization state
+        &multisample,     // multisample state
+        &depth_stencil,   // depth stencil state
+        &color_blend,     // color blend state
+        &dynamic,         // dynamic state
+        layout,           // layout
+        render_pass,      // render pass
+        subpass           // subpass
+    );
+
+    return vk::raii::Pipeline(device.logical(), cache, pipeline_create_info);
+}
+
+}  // namespace vulkan
+}  // namespace visualization
@@ -0,0 +1,64 @@
+#ifndef BB8_VISUALIZATION_VULKAN_PIPELINE_STATE_HPP
+#define BB8_VISUALIZATION_VULKAN_PIPELINE_STATE_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "device.hpp"
+#include "specialization.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Complete description of a graphics pipeline, owning everything its create info
+// points to (except shader code), so it can be hashed, compared, and compiled on
+// another thread. Pipelines have a single viewport and scissor, which are dynamic by default.
+class PipelineState {
+public:
+    class Stage {
+    public:
+        vk::ShaderStageFlagBits stage;
+        // must outlive compilation, embedded shaders live for the whole program
+        const uint32_t* code;
+        // in 32-bit words
+        size_t code_size;
+        Specialization specialization;
+    };
+
+    PipelineState(vk::PipelineLayout layout, vk::RenderPass render_pass);
+
+    void addStage(vk::ShaderStageFlagBits stage, const uint32_t* code, size_t code_size, Specialization specialization = Specialization());
+
+    template <size_t N>
+    void addStage(vk::ShaderStageFlagBits stage, const std::array<uint32_t, N>& code, Specialization specialization = Specialization()) {
+        addStage(stage, code.data(), code.size(), std::move(specialization));
+    }
+
+    size_t hash() const;
+    bool operator==(const PipelineState& other) const;
+
+    vk::raii::Pipeline create(const Device& device, const vk::raii::PipelineCache& cache) const;
+
+    std::vector<Stage> stages;
+
+    std::vector<vk::VertexInputBindingDescription> bindings;
+    std::vector<vk::VertexInputAttributeDescription> attributes;
+    vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+
+    vk::PipelineRasterizationStateCreateInfo rasterization;
+    vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+    vk::PipelineDepthStencilStateCreateInfo depth_stencil;
+    std::vector<vk::PipelineColorBlendAttachmentState> blend_attachments;
+    std::vector<vk::DynamicState> dynamic_states = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+
+    vk::PipelineLayout layout;
+    vk::RenderPass render_pass;
+    uint32_t subpass = 0;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_PIPELINE_STATE_HPP
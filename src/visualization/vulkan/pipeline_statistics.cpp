@@ -0,0 +1,76 @@
+#include "pipeline_statistics.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// queries write one 64-bit value per counted statistic, straight into Counters
+static_assert(sizeof(PipelineStatistics::Counters) == 7 * sizeof(uint64_t));
+
+const char* PipelineStatistics::passName(Pass pass) {
+    switch (pass) {
+        case Pass::compute:
+            return "compute";
+        case Pass::shadows:
+            return "shadows";
+        case Pass::main:
+            return "main";
+        case Pass::post:
+            return "post";
+    }
+
+    return "unknown";
+}
+
+PipelineStatistics::PipelineStatistics(const Device& device, size_t frame_count)
+    : query_pool(createPool(device, frame_count)), recorded(frame_count, false) {}
+
+bool PipelineStatistics::isSupported(const Device& device) {
+    return device.features().pipelineStatisticsQuery;
+}
+
+void PipelineStatistics::recordReset(vk::CommandBuffer command_buffer, size_t frame) {
+    command_buffer.resetQueryPool(*query_pool, query(frame, Pass::compute), static_cast<uint32_t>(pass_count));
+    recorded.at(frame) = true;
+}
+
+void PipelineStatistics::recordBegin(vk::CommandBuffer command_buffer, size_t frame, Pass pass) const {
+    command_buffer.beginQuery(*query_pool, query(frame, pass), {});
+}
+
+void PipelineStatistics::recordEnd(vk::CommandBuffer command_buffer, size_t frame, Pass pass) const {
+    command_buffer.endQuery(*query_pool, query(frame, pass));
+}
+
+std::optional<PipelineStatistics::Frame> PipelineStatistics::read(size_t frame) {
+    if (!recorded.at(frame)) {
+        return std::nullopt;
+    }
+    recorded.at(frame) = false;
+
+    // read into a fixed array rather than getResults, which returns a vector, to keep frames allocation-free
+    auto [result, counters] = query_pool.getResult<Frame>(query(frame, Pass::compute),
+                                                          static_cast<uint32_t>(pass_count),
+                                                          sizeof(Counters),
+                                                          vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess) {
+        return std::nullopt;
+    }
+
+    return counters;
+}
+
+vk::raii::QueryPool PipelineStatistics::createPool(const Device& device, size_t frame_count) {
+    if (!isSupported(device)) {
+        throw std::runtime_error("pipeline statistics queries aren't supported by the device");
+    }
+
+    auto query_count = static_cast<uint32_t>(pass_count * frame_count);
+    return vk::raii::QueryPool(device.logical(), vk::QueryPoolCreateInfo({}, vk::QueryType::ePipelineStatistics, query_count, counted));
+}
+
+uint32_t PipelineStatistics::query(size_t frame, Pass pass) const {
+    return static_cast<uint32_t>(frame * pass_count + static_cast<size_t>(pass));
+}
+
+}  // namespace vulkan
+}  // namespace visualization
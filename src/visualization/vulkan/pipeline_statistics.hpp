@@ -0,0 +1,87 @@
+#ifndef BB8_VISUALIZATION_VULKAN_PIPELINE_STATISTICS_HPP
+#define BB8_VISUALIZATION_VULKAN_PIPELINE_STATISTICS_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "device.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Counts vertex, primitive and shader invocations of each pass in a frame with
+// pipeline statistics queries. Like GpuTimer, results are read once the frame's
+// fence has signaled, so they never stall and trail recording by the frames in flight.
+// Needs the pipelineStatisticsQuery device feature.
+class PipelineStatistics {
+public:
+    enum class Pass {
+        // cluster culling and light binning
+        compute,
+        shadows,
+        main,
+        // depth pyramid, sensor readback and upscaling
+        post,
+    };
+    static constexpr size_t pass_count = 4;
+    static const char* passName(Pass pass);
+
+    // counters in the order the queries write them, which is the order of their flag bits
+    class Counters {
+    public:
+        uint64_t input_vertices = 0;
+        uint64_t input_primitives = 0;
+        uint64_t vertex_invocations = 0;
+        uint64_t clipping_invocations = 0;
+        uint64_t clipping_primitives = 0;
+        uint64_t fragment_invocations = 0;
+        uint64_t compute_invocations = 0;
+    };
+
+    using Frame = std::array<Counters, pass_count>;
+
+    PipelineStatistics(const Device& device, size_t frame_count);
+
+    PipelineStatistics(const PipelineStatistics&) = delete;
+    PipelineStatistics& operator=(const PipelineStatistics&) = delete;
+
+    PipelineStatistics(PipelineStatistics&&) = default;
+    PipelineStatistics& operator=(PipelineStatistics&&) = default;
+
+    ~PipelineStatistics() = default;
+
+    static bool isSupported(const Device& device);
+
+    // resets the frame's queries, must be recorded before any pass begins
+    void recordReset(vk::CommandBuffer command_buffer, size_t frame);
+    // passes must be recorded outside render passes, and not overlap
+    void recordBegin(vk::CommandBuffer command_buffer, size_t frame, Pass pass) const;
+    void recordEnd(vk::CommandBuffer command_buffer, size_t frame, Pass pass) const;
+
+    // counters of each pass, each frame's are returned only once
+    // and are only valid once the frame's commands have completed
+    std::optional<Frame> read(size_t frame);
+
+private:
+    static constexpr auto counted = vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+                                    vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+                                    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+                                    vk::QueryPipelineStatisticFlagBits::eClippingInvocations |
+                                    vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+                                    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+                                    vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+
+    static vk::raii::QueryPool createPool(const Device& device, size_t frame_count);
+    uint32_t query(size_t frame, Pass pass) const;
+
+    vk::raii::QueryPool query_pool;
+    std::vector<bool> recorded;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_PIPELINE_STATISTICS_HPP
@@ -0,0 +1,207 @@
+#include "point_cloud.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+#include "shaders.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+PointCloud::PointCloud(const Device& device, size_t frames_in_flight)
+    : device(&device),
+      compute(device.extendedFeatures().shader_atomic_int64),
+      descriptor_layout(createDescriptorLayout(device)),
+      pipeline_layout(createPipelineLayout(device, *descriptor_layout)),
+      pipeline(compute ? createPipeline(device, *pipeline_layout) : vk::raii::Pipeline(nullptr)),
+      descriptor_sets(nullptr) {
+    regions.reserve(frames_in_flight + 1);
+    for (size_t i = 0; i < frames_in_flight + 1; i++) {
+        regions.emplace_back(device, initial_capacity);
+    }
+
+    if (!compute) {
+        return;
+    }
+
+    auto set_count = static_cast<uint32_t>(regions.size());
+    auto pool_size = vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 2 * set_count);
+    auto layouts = std::vector<vk::DescriptorSetLayout>(set_count, *descriptor_layout);
+    descriptor_sets = DescriptorSets(device, pool_size, layouts);
+}
+
+shaders::Point* PointCloud::allocate(size_t count) {
+    auto& region = regions[current];
+    if (point_count + count > region.capacity) {
+        size_t capacity = region.capacity;
+        while (capacity < point_count + count) {
+            capacity *= 2;
+        }
+
+        // the current region is never in use by the GPU, so it (and its descriptors) can be replaced immediately
+        auto grown = Region(*device, capacity);
+        std::memcpy(grown.buffer.data(), region.buffer.data(), point_count * sizeof(shaders::Point));
+        region = std::move(grown);
+        writeDescriptors(current);
+    }
+
+    auto points = reinterpret_cast<shaders::Point*>(region.buffer.data()) + point_count;
+    point_count += count;
+    device->memoryUsage().recordUpload(count * sizeof(shaders::Point));
+    return points;
+}
+
+void PointCloud::add(const glm::vec3* positions, size_t count, glm::vec4 color) {
+    uint32_t packed = glm::packUnorm4x8(color);
+    auto points = allocate(count);
+    for (size_t i = 0; i < count; i++) {
+        points[i] = shaders::Point{positions[i], packed};
+    }
+}
+
+size_t PointCloud::pointCount() const {
+    return point_count;
+}
+
+bool PointCloud::usesCompute() const {
+    return compute;
+}
+
+void PointCloud::resize(vk::Extent2D target_extent) {
+    if (!compute) {
+        return;
+    }
+
+    extent = target_extent;
+    visibility.reset();
+    visibility.emplace(*device, Buffer::Requirements::storage(size_t(extent.width) * extent.height * sizeof(uint64_t)));
+
+    for (size_t region = 0; region < regions.size(); region++) {
+        writeDescriptors(region);
+    }
+}
+
+void PointCloud::recordSplat(vk::CommandBuffer command_buffer, const glm::mat4& view_projection, vk::Extent2D rendered) const {
+    if (!compute || point_count == 0 || !visibility.has_value()) {
+        return;
+    }
+
+    // the previous frame's composite may still be reading the visibility buffer
+    auto rendered_size = vk::DeviceSize(rendered.height) * extent.width * sizeof(uint64_t);
+    auto composited = vk::BufferMemoryBarrier(
+        vk::AccessFlagBits::eShaderRead,
+        vk::AccessFlagBits::eTransferWrite,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        visibility->get(),
+        0,
+        rendered_size);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader, vk::PipelineStageFlagBits::eTransfer, {}, {}, composited, {});
+
+    // all ones is farther than any depth, and marks pixels no point covers
+    command_buffer.fillBuffer(visibility->get(), 0, rendered_size, 0xffffffff);
+
+    auto cleared = vk::BufferMemoryBarrier(
+        vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        visibility->get(),
+        0,
+        rendered_size);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, {}, cleared, {});
+
+    auto push_constants = constants(view_projection, rendered);
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0, descriptor_sets[current], {});
+    command_buffer.pushConstants<shaders::PointConstants>(*pipeline_layout, constant_stages, 0, push_constants);
+
+    auto group_count = static_cast<uint32_t>(std::min<size_t>((point_count + group_size - 1) / group_size, max_group_count));
+    command_buffer.dispatch(group_count, 1, 1);
+
+    auto splatted = vk::BufferMemoryBarrier(
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eShaderRead,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        visibility->get(),
+        0,
+        rendered_size);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, splatted, {});
+}
+
+void PointCloud::recordDraw(vk::CommandBuffer command_buffer, const glm::mat4& view_projection, vk::Extent2D rendered) const {
+    if (point_count == 0 || (compute && !visibility.has_value())) {
+        return;
+    }
+
+    auto push_constants = constants(view_projection, rendered);
+    command_buffer.pushConstants<shaders::PointConstants>(*pipeline_layout, constant_stages, 0, push_constants);
+
+    if (compute) {
+        // fullscreen triangle, generated from vertex indices
+        command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0, descriptor_sets[current], {});
+        command_buffer.draw(3, 1, 0, 0);
+    } else {
+        command_buffer.bindVertexBuffers(0, regions[current].buffer.get(), vk::DeviceSize(0));
+        command_buffer.draw(static_cast<uint32_t>(point_count), 1, 0, 0);
+    }
+}
+
+void PointCloud::endFrame() {
+    current = (current + 1) % regions.size();
+    point_count = 0;
+}
+
+void PointCloud::clear() {
+    point_count = 0;
+}
+
+vk::PipelineLayout PointCloud::pipelineLayout() const {
+    return *pipeline_layout;
+}
+
+PointCloud::Region::Region(const Device& device, size_t capacity)
+    : buffer(device, Buffer::Requirements::streamingVertexStorage(capacity * sizeof(shaders::Point))), capacity(capacity) {}
+
+vk::raii::DescriptorSetLayout PointCloud::createDescriptorLayout(const Device& device) {
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 2>{
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eFragment)};
+
+    return vk::raii::DescriptorSetLayout(device.logical(), vk::DescriptorSetLayoutCreateInfo({}, bindings));
+}
+
+vk::raii::PipelineLayout PointCloud::createPipelineLayout(const Device& device, const vk::DescriptorSetLayout& descriptor_layout) {
+    auto push_constants = vk::PushConstantRange(constant_stages, 0, sizeof(shaders::PointConstants));
+    return vk::raii::PipelineLayout(device.logical(), vk::PipelineLayoutCreateInfo({}, descriptor_layout, push_constants));
+}
+
+vk::raii::Pipeline PointCloud::createPipeline(const Device& device, const vk::PipelineLayout& layout) {
+    auto shader_module = vk::raii::ShaderModule(device.logical(), vk::ShaderModuleCreateInfo({}, shaders::point_splat_shader));
+    auto stage = vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, *shader_module, "main");
+
+    return vk::raii::Pipeline(device.logical(), nullptr, vk::ComputePipelineCreateInfo({}, stage, layout));
+}
+
+shaders::PointConstants PointCloud::constants(const glm::mat4& view_projection, vk::Extent2D rendered) const {
+    return shaders::PointConstants{view_projection, rendered.width, rendered.height, extent.width, static_cast<uint32_t>(point_count)};
+}
+
+void PointCloud::writeDescriptors(size_t region) const {
+    if (!compute || !visibility.has_value()) {
+        return;
+    }
+
+    auto points_info = regions[region].buffer.descriptorInfo();
+    auto visibility_info = visibility->descriptorInfo();
+    auto descriptor_writes = std::array<vk::WriteDescriptorSet, 2>{
+        vk::WriteDescriptorSet(descriptor_sets[region], 0, 0, vk::DescriptorType::eStorageBuffer, {}, points_info),
+        vk::WriteDescriptorSet(descriptor_sets[region], 1, 0, vk::DescriptorType::eStorageBuffer, {}, visibility_info)};
+    device->logical().updateDescriptorSets(descriptor_writes, {});
+}
+
+}  // namespace vulkan
+}  // namespace visualization
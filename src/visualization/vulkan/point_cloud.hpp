@@ -0,0 +1,111 @@
+#ifndef BB8_VISUALIZATION_VULKAN_POINT_CLOUD_HPP
+#define BB8_VISUALIZATION_VULKAN_POINT_CLOUD_HPP
+
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "buffer.hpp"
+#include "descriptor_sets.hpp"
+#include "device.hpp"
+#include "glm.hpp"
+#include "shaders/point.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Point clouds streamed from sensors, such as lidar returns or depth images, with
+// millions of points each frame.
+//
+// Points are written into persistently mapped buffers forming a ring one longer than
+// the number of frames in flight, like debug lines, and are drawn with the next frame
+// only. Where the device has 64-bit buffer atomics, a compute shader splats them into a
+// visibility buffer holding the nearest point of each pixel, with its depth packed above
+// its color so a single atomicMin resolves both. The main pass then composites the
+// visibility buffer with a depth-tested fullscreen triangle. Rasterizing a point costs a
+// handful of instructions and one atomic, where the point list fallback costs a
+// primitive through the fixed-function pipeline.
+class PointCloud {
+public:
+    PointCloud(const Device& device, size_t frames_in_flight);
+
+    PointCloud(const PointCloud&) = delete;
+    PointCloud& operator=(const PointCloud&) = delete;
+
+    PointCloud(PointCloud&&) = default;
+    PointCloud& operator=(PointCloud&&) = default;
+
+    ~PointCloud() = default;
+
+    // reserves space for `count` points drawn with the next frame, which the caller fills in
+    shaders::Point* allocate(size_t count);
+    void add(const glm::vec3* positions, size_t count, glm::vec4 color);
+
+    size_t pointCount() const;
+
+    // whether points are splatted in compute, rather than drawn as a point list
+    bool usesCompute() const;
+
+    // sizes the visibility buffer for render targets of `target_extent`, must not be called while frames are in flight
+    void resize(vk::Extent2D target_extent);
+
+    // splats the current points into the rendered region, must be recorded outside a render pass
+    void recordSplat(vk::CommandBuffer command_buffer, const glm::mat4& view_projection, vk::Extent2D rendered) const;
+    // composites splatted points, or draws the point list, must be recorded inside
+    // a render pass with the point pipeline bound
+    void recordDraw(vk::CommandBuffer command_buffer, const glm::mat4& view_projection, vk::Extent2D rendered) const;
+
+    // call once the frame that drew the current points has been submitted
+    void endFrame();
+    // drops the current points without drawing them
+    void clear();
+
+    // layout the point pipeline is built with
+    vk::PipelineLayout pipelineLayout() const;
+
+private:
+    class Region {
+    public:
+        Region(const Device& device, size_t capacity);
+
+        Buffer buffer;
+        size_t capacity;
+    };
+
+    static vk::raii::DescriptorSetLayout createDescriptorLayout(const Device& device);
+    static vk::raii::PipelineLayout createPipelineLayout(const Device& device, const vk::DescriptorSetLayout& descriptor_layout);
+    static vk::raii::Pipeline createPipeline(const Device& device, const vk::PipelineLayout& layout);
+
+    shaders::PointConstants constants(const glm::mat4& view_projection, vk::Extent2D rendered) const;
+    void writeDescriptors(size_t region) const;
+
+    static constexpr size_t initial_capacity = 1 << 16;
+    static constexpr uint32_t group_size = 256;
+    // larger clouds are covered by each invocation splatting several points
+    static constexpr uint32_t max_group_count = 65535;
+    static constexpr vk::ShaderStageFlags constant_stages =
+        vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+
+    const Device* device;
+    bool compute;
+
+    std::vector<Region> regions;
+    size_t current = 0;
+    size_t point_count = 0;
+
+    // nearest point of each pixel of the render target, as 64-bit depth and color
+    vk::Extent2D extent;
+    std::optional<Buffer> visibility;
+
+    vk::raii::DescriptorSetLayout descriptor_layout;
+    vk::raii::PipelineLayout pipeline_layout;
+    vk::raii::Pipeline pipeline;
+
+    // one per region, only when splatting in compute
+    DescriptorSets descriptor_sets;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_POINT_CLOUD_HPP
@@ -0,0 +1,91 @@
+#include "render_target.hpp"
+
+#include <array>
+#include <stdexcept>
+
+namespace visualization {
+namespace vulkan {
+
+RenderTarget::RenderTarget(const Device& device, vk::Format format, vk::Extent2D extent)
+    : extent(extent),
+      filter(vk::Filter::eNearest),
+      image(device, extent.width, extent.height, parameters(format)),
+      framebuffer(nullptr) {
+    // target and swap chain share a format, so one blit both reads and writes it
+    auto blit_usage = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst;
+    if (!device.supportsFormatUsage(format, vk::ImageTiling::eOptimal, blit_usage)) {
+        throw std::runtime_error("swap chain format does not support blitting");
+    }
+
+    if (device.supportsFormatUsage(format, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
+        filter = vk::Filter::eLinear;
+    }
+}
+
+void RenderTarget::initializeFramebuffer(const Device& device,
+                                         const vk::RenderPass& render_pass,
+                                         const DepthBuffer& depth_buffer,
+                                         const std::vector<vk::ImageView>& extra_attachments) {
+    auto attachments = std::vector<vk::ImageView>{image.getView(), depth_buffer.getView()};
+    attachments.insert(attachments.end(), extra_attachments.begin(), extra_attachments.end());
+
+    auto framebuffer_create_info = vk::FramebufferCreateInfo({}, render_pass, attachments, extent.width, extent.height, 1);
+    framebuffer = vk::raii::Framebuffer(device.logical(), framebuffer_create_info);
+}
+
+void RenderTarget::recordUpscale(vk::CommandBuffer command_buffer, vk::Extent2D rendered, vk::Image output, vk::Extent2D output_extent) const {
+    auto color_range = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+
+    // previous contents of the swap chain image are overwritten entirely. The image available
+    // semaphore is waited on at the transfer stage, which this barrier chains after
+    auto to_transfer = vk::ImageMemoryBarrier(
+        {},
+        vk::AccessFlagBits::eTransferWrite,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eTransferDstOptimal,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        output,
+        color_range);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, to_transfer);
+
+    auto layers = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+    auto source_bounds = std::array<vk::Offset3D, 2>{
+        vk::Offset3D(0, 0, 0),
+        vk::Offset3D(static_cast<int32_t>(rendered.width), static_cast<int32_t>(rendered.height), 1)};
+    auto destination_bounds = std::array<vk::Offset3D, 2>{
+        vk::Offset3D(0, 0, 0),
+        vk::Offset3D(static_cast<int32_t>(output_extent.width), static_cast<int32_t>(output_extent.height), 1)};
+    auto region = vk::ImageBlit(layers, source_bounds, layers, destination_bounds);
+    command_buffer.blitImage(image.get(), vk::ImageLayout::eTransferSrcOptimal, output, vk::ImageLayout::eTransferDstOptimal, region, filter);
+
+    auto to_present = vk::ImageMemoryBarrier(
+        vk::AccessFlagBits::eTransferWrite,
+        {},
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::ImageLayout::ePresentSrcKHR,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        output,
+        color_range);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, to_present);
+}
+
+vk::Extent2D RenderTarget::getExtent() const {
+    return extent;
+}
+
+const vk::Framebuffer& RenderTarget::getFramebuffer() const {
+    return *framebuffer;
+}
+
+Image::Parameters RenderTarget::parameters(vk::Format format) {
+    auto memory = vk::MemoryPropertyFlagBits::eDeviceLocal;
+    auto usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc;
+    auto aspects = vk::ImageAspectFlagBits::eColor;
+
+    return Image::Parameters(memory, usage, vk::ImageTiling::eOptimal, format, aspects, false);
+}
+
+}  // namespace vulkan
+}  // namespace visualization
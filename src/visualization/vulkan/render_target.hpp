@@ -0,0 +1,55 @@
+#ifndef BB8_VISUALIZATION_VULKAN_RENDER_TARGET_HPP
+#define BB8_VISUALIZATION_VULKAN_RENDER_TARGET_HPP
+
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "depth_buffer.hpp"
+#include "device.hpp"
+#include "image.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Offscreen color image the main pass renders into, which is then upscaled onto
+// the swap chain. Allocated for the largest render extent, so frames rendering at
+// a smaller extent use its top left corner and resizing never stalls the GPU.
+class RenderTarget {
+public:
+    RenderTarget(const Device& device, vk::Format format, vk::Extent2D extent);
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    RenderTarget(RenderTarget&&) = default;
+    RenderTarget& operator=(RenderTarget&&) = default;
+
+    ~RenderTarget() = default;
+
+    // extra attachments follow the color and depth attachments
+    void initializeFramebuffer(const Device& device,
+                               const vk::RenderPass& render_pass,
+                               const DepthBuffer& depth_buffer,
+                               const std::vector<vk::ImageView>& extra_attachments = {});
+
+    // stretches the rendered region over the whole output image and leaves it ready to present,
+    // must be recorded after the render pass has left the color image as a transfer source
+    void recordUpscale(vk::CommandBuffer command_buffer, vk::Extent2D rendered, vk::Image output, vk::Extent2D output_extent) const;
+
+    vk::Extent2D getExtent() const;
+    const vk::Framebuffer& getFramebuffer() const;
+
+private:
+    static Image::Parameters parameters(vk::Format format);
+
+    vk::Extent2D extent;
+    vk::Filter filter;
+
+    Image image;
+    vk::raii::Framebuffer framebuffer;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_RENDER_TARGET_HPP
@@ -0,0 +1,85 @@
+#include "sensor_outputs.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+SensorOutputs::SensorOutputs(const Device& device, vk::Extent2D extent, size_t frame_count)
+    : extent(extent),
+      depth_image(device, extent.width, extent.height, attachmentParameters(depth_format)),
+      instance_image(device, extent.width, extent.height, attachmentParameters(instance_format)) {
+    size_t pixel_count = static_cast<size_t>(extent.width) * extent.height;
+
+    frames.reserve(frame_count);
+    for (size_t i = 0; i < frame_count; i++) {
+        frames.emplace_back(device, pixel_count);
+    }
+}
+
+std::array<vk::AttachmentDescription, 2> SensorOutputs::attachmentDescriptions() {
+    auto description = [](vk::Format format) {
+        return vk::AttachmentDescription(
+            {},
+            format,
+            vk::SampleCountFlagBits::e1,
+            vk::AttachmentLoadOp::eClear,
+            vk::AttachmentStoreOp::eStore,
+            vk::AttachmentLoadOp::eDontCare,
+            vk::AttachmentStoreOp::eDontCare,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eTransferSrcOptimal);
+    };
+
+    return {description(depth_format), description(instance_format)};
+}
+
+std::array<vk::ClearValue, 2> SensorOutputs::clearValues() {
+    auto clear_depth = vk::ClearValue(vk::ClearColorValue(std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f}));
+    auto clear_instance = vk::ClearValue(vk::ClearColorValue(std::array<uint32_t, 4>{0, 0, 0, 0}));
+    return {clear_depth, clear_instance};
+}
+
+std::vector<vk::ImageView> SensorOutputs::views() const {
+    return {depth_image.getView(), instance_image.getView()};
+}
+
+void SensorOutputs::recordReadback(vk::CommandBuffer command_buffer, size_t frame, vk::Extent2D rendered) {
+    auto& data = frames.at(frame);
+
+    auto layers = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+    auto region = vk::BufferImageCopy(0, 0, 0, layers, {0, 0, 0}, vk::Extent3D(rendered.width, rendered.height, 1));
+    command_buffer.copyImageToBuffer(depth_image.get(), vk::ImageLayout::eTransferSrcOptimal, data.depth.get(), region);
+    command_buffer.copyImageToBuffer(instance_image.get(), vk::ImageLayout::eTransferSrcOptimal, data.instance_ids.get(), region);
+
+    auto copied = vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, copied, {}, {});
+
+    data.extent = rendered;
+    data.written = true;
+}
+
+std::optional<SensorOutputs::Readback> SensorOutputs::readback(size_t frame) const {
+    const auto& data = frames.at(frame);
+    if (!data.written) {
+        return std::nullopt;
+    }
+
+    return Readback{reinterpret_cast<const float*>(data.depth.data()),
+                    reinterpret_cast<const uint32_t*>(data.instance_ids.data()),
+                    data.extent.width,
+                    data.extent.height};
+}
+
+SensorOutputs::FrameData::FrameData(const Device& device, size_t pixel_count)
+    : depth(device, Buffer::Requirements::readback(pixel_count * sizeof(float))),
+      instance_ids(device, Buffer::Requirements::readback(pixel_count * sizeof(uint32_t))) {}
+
+Image::Parameters SensorOutputs::attachmentParameters(vk::Format format) {
+    auto memory = vk::MemoryPropertyFlagBits::eDeviceLocal;
+    auto usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc;
+    auto aspects = vk::ImageAspectFlagBits::eColor;
+
+    return Image::Parameters(memory, usage, vk::ImageTiling::eOptimal, format, aspects, false);
+}
+
+}  // namespace vulkan
+}  // namespace visualization
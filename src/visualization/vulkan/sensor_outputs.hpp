@@ -0,0 +1,83 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SENSOR_OUTPUTS_HPP
+#define BB8_VISUALIZATION_VULKAN_SENSOR_OUTPUTS_HPP
+
+#include <array>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "buffer.hpp"
+#include "device.hpp"
+#include "image.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Per-pixel linear depth and instance ID, written by the main pass as extra color
+// attachments alongside the color image, so no additional geometry pass is needed.
+// Each frame copies both into its own persistently mapped readback buffers.
+class SensorOutputs {
+public:
+    // images of one frame, row-major and tightly packed
+    class Readback {
+    public:
+        // view-space depth, 0 where nothing was drawn
+        const float* depth;
+        // instance index plus one, 0 where nothing was drawn
+        const uint32_t* instance_ids;
+
+        uint32_t width;
+        uint32_t height;
+    };
+
+    SensorOutputs(const Device& device, vk::Extent2D extent, size_t frame_count);
+
+    SensorOutputs(const SensorOutputs&) = delete;
+    SensorOutputs& operator=(const SensorOutputs&) = delete;
+
+    SensorOutputs(SensorOutputs&&) = default;
+    SensorOutputs& operator=(SensorOutputs&&) = default;
+
+    ~SensorOutputs() = default;
+
+    // descriptions of the depth and instance ID attachments, in attachment order
+    static std::array<vk::AttachmentDescription, 2> attachmentDescriptions();
+    static std::array<vk::ClearValue, 2> clearValues();
+
+    std::vector<vk::ImageView> views() const;
+
+    // copies the rendered region of the outputs into the frame's readback buffers,
+    // must be recorded after the render pass
+    void recordReadback(vk::CommandBuffer command_buffer, size_t frame, vk::Extent2D rendered);
+
+    // only valid once the frame's commands have completed
+    std::optional<Readback> readback(size_t frame) const;
+
+    static constexpr vk::Format depth_format = vk::Format::eR32Sfloat;
+    static constexpr vk::Format instance_format = vk::Format::eR32Uint;
+
+private:
+    class FrameData {
+    public:
+        FrameData(const Device& device, size_t pixel_count);
+
+        Buffer depth;
+        Buffer instance_ids;
+        vk::Extent2D extent;
+        bool written = false;
+    };
+
+    static Image::Parameters attachmentParameters(vk::Format format);
+
+    vk::Extent2D extent;
+
+    Image depth_image;
+    Image instance_image;
+
+    std::vector<FrameData> frames;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SENSOR_OUTPUTS_HPP
@@ -0,0 +1,447 @@
+#include "sensor_renderer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "cluster_culler.hpp"
+#include "shaders/instance.hpp"
+#include "shaders/vertex.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+size_t SensorRenderer::Readback::imageSize() const {
+    return static_cast<size_t>(width) * height * 4;
+}
+
+const uint8_t* SensorRenderer::Readback::image(uint32_t camera) const {
+    return pixels + camera * imageSize();
+}
+
+SensorRenderer::SensorRenderer(const Device& device, const Model& model, vk::Extent2D resolution, uint32_t camera_count)
+    : device(&device),
+      model(&model),
+      resolution(resolution),
+      camera_count(camera_count),
+      multiview(device.extendedFeatures().multiview),
+      views_per_pass(viewsPerPass(device, camera_count)),
+      pass_count((camera_count + views_per_pass - 1) / views_per_pass),
+      depth_format(findDepthFormat(device)),
+      color_images(device,
+                   resolution.width,
+                   resolution.height,
+                   Image::Parameters(vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                     vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                                     vk::ImageTiling::eOptimal,
+                                     color_format,
+                                     vk::ImageAspectFlagBits::eColor,
+                                     false,
+                                     pass_count * views_per_pass)),
+      depth_images(device,
+                   resolution.width,
+                   resolution.height,
+                   Image::Parameters(vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                     vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                                     vk::ImageTiling::eOptimal,
+                                     depth_format,
+                                     vk::ImageAspectFlagBits::eDepth,
+                                     false,
+                                     pass_count * views_per_pass)),
+      render_pass(createRenderPass(device)),
+      descriptor_layout(createDescriptorLayout(device)),
+      pipeline_layout(createPipelineLayout(device)),
+      color_views(createPassViews(device, color_images, vk::ImageAspectFlagBits::eColor)),
+      depth_views(createPassViews(device, depth_images, vk::ImageAspectFlagBits::eDepth)),
+      framebuffers(createFramebuffers(device)),
+      command_pool(device.createPool(false)),
+      descriptor_sets(createDescriptorSets(device)) {
+    auto command_buffer_info = vk::CommandBufferAllocateInfo(*command_pool, vk::CommandBufferLevel::ePrimary, batch_count);
+    auto command_buffers = vk::raii::CommandBuffers(device.logical(), command_buffer_info);
+
+    size_t readback_size = static_cast<size_t>(resolution.width) * resolution.height * 4 * camera_count;
+    auto texture_info = model.getTexture().descriptorInfo();
+
+    batches.reserve(batch_count);
+    for (size_t i = 0; i < batch_count; i++) {
+        auto& batch = batches.emplace_back(device, std::move(command_buffers[i]), descriptor_sets[i], readback_size);
+
+        auto uniforms_info = batch.uniforms.descriptorInfo();
+        auto descriptor_writes = std::array<vk::WriteDescriptorSet, 2>{
+            vk::WriteDescriptorSet(batch.descriptor_set, 0, 0, vk::DescriptorType::eUniformBuffer, {}, uniforms_info),
+            vk::WriteDescriptorSet(batch.descriptor_set, 1, 0, vk::DescriptorType::eCombinedImageSampler, texture_info)};
+        device.logical().updateDescriptorSets(descriptor_writes, {});
+    }
+
+    lod_instances.resize(model.getLods().size());
+}
+
+SensorRenderer::~SensorRenderer() {
+    // batches still in flight reference their buffers and command buffers
+    for (auto& batch : batches) {
+        if (batch.pending) {
+            finish(batch);
+        }
+    }
+}
+
+void SensorRenderer::render(vk::Pipeline pipeline, const std::vector<scene::Camera>& cameras, const scene::SceneGraph& scene, glm::vec3 light_direction) {
+    if (cameras.size() != camera_count) {
+        throw std::runtime_error("sensor renderer needs exactly one camera per image");
+    }
+
+    auto& batch = batches[next_batch];
+    if (batch.pending) {
+        finish(batch);
+    }
+
+    // layers padding out the last pass get a zero matrix, which clips everything
+    shaders::SensorUniforms uniforms = {};
+    float aspect_ratio = resolution.width / static_cast<float>(resolution.height);
+    camera_planes.resize(camera_count);
+    for (uint32_t i = 0; i < camera_count; i++) {
+        uniforms.view_projections[i] = cameras[i].projection(aspect_ratio) * cameras[i].view();
+        ClusterCuller::frustumPlanes(uniforms.view_projections[i], camera_planes[i].data());
+    }
+    uniforms.light_direction = glm::vec4(glm::normalize(light_direction), ambient);
+    std::memcpy(batch.uniforms.data(), &uniforms, sizeof(uniforms));
+
+    packInstances(batch, cameras, scene);
+    record(batch, pipeline);
+
+    device->logical().resetFences(*batch.fence);
+    auto submit_info = vk::SubmitInfo({}, {}, *batch.command_buffer, {});
+    device->graphicsQueue().submit(submit_info, *batch.fence);
+
+    if (!first_submission.has_value()) {
+        first_submission = std::chrono::steady_clock::now();
+    }
+
+    batch.pending = true;
+    pending_count++;
+    next_batch = (next_batch + 1) % batch_count;
+}
+
+std::optional<SensorRenderer::Readback> SensorRenderer::readback() {
+    if (pending_count == 0) {
+        return std::nullopt;
+    }
+
+    auto& batch = batches[(next_batch + batch_count - pending_count) % batch_count];
+    finish(batch);
+
+    return Readback{batch.readback.data(), resolution.width, resolution.height, camera_count};
+}
+
+double SensorRenderer::imagesPerSecond() const {
+    if (!first_submission.has_value() || finished_images == 0) {
+        return 0.0;
+    }
+
+    double seconds = std::chrono::duration<double>(last_finish - *first_submission).count();
+    return seconds > 0.0 ? finished_images / seconds : 0.0;
+}
+
+uint32_t SensorRenderer::cameraCount() const {
+    return camera_count;
+}
+
+bool SensorRenderer::usesMultiview() const {
+    return multiview;
+}
+
+SensorRenderer::Batch::Batch(const Device& device, vk::raii::CommandBuffer command_buffer, vk::DescriptorSet descriptor_set, size_t readback_size)
+    : command_buffer(std::move(command_buffer)),
+      fence(device.logical(), vk::FenceCreateInfo()),
+      uniforms(device, Buffer::Requirements::uniform(sizeof(shaders::SensorUniforms))),
+      instances(device, Buffer::Requirements::instance(initial_instance_capacity * sizeof(shaders::Instance))),
+      instance_capacity(initial_instance_capacity),
+      readback(device, Buffer::Requirements::readback(readback_size)),
+      descriptor_set(descriptor_set) {}
+
+vk::Format SensorRenderer::findDepthFormat(const Device& device) {
+    std::vector<vk::Format> formats = {vk::Format::eD32Sfloat, vk::Format::eD16Unorm};
+
+    for (auto format : formats) {
+        if (device.supportsFormatUsage(format, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eDepthStencilAttachment)) {
+            return format;
+        }
+    }
+
+    throw std::runtime_error("could not find a supported sensor depth format");
+}
+
+uint32_t SensorRenderer::viewsPerPass(const Device& device, uint32_t camera_count) {
+    if (camera_count == 0 || camera_count > shaders::SensorUniforms::max_cameras) {
+        throw std::runtime_error("unsupported number of sensor cameras");
+    }
+
+    if (!device.extendedFeatures().multiview) {
+        return 1;
+    }
+
+    auto properties = device.physical().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceMultiviewProperties>();
+    uint32_t max_views = properties.get<vk::PhysicalDeviceMultiviewProperties>().maxMultiviewViewCount;
+
+    // view masks are 32 bits wide
+    return std::min({camera_count, max_views, 32u});
+}
+
+vk::raii::RenderPass SensorRenderer::createRenderPass(const Device& device) const {
+    auto color_attachment = vk::AttachmentDescription(
+        {},
+        color_format,
+        vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eClear,
+        vk::AttachmentStoreOp::eStore,
+        vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eTransferSrcOptimal);
+
+    auto depth_attachment = vk::AttachmentDescription(
+        {},
+        depth_format,
+        vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eClear,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+    auto color_reference = vk::AttachmentReference(0, vk::ImageLayout::eColorAttachmentOptimal);
+    auto depth_reference = vk::AttachmentReference(1, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    auto subpass = vk::SubpassDescription({}, vk::PipelineBindPoint::eGraphics, {}, color_reference, {}, &depth_reference, {});
+
+    // images are only overwritten once the previous batch has copied them out
+    auto write_dependency = vk::SubpassDependency(
+        VK_SUBPASS_EXTERNAL,
+        0u,
+        vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        {});
+
+    auto copy_dependency = vk::SubpassDependency(
+        0u,
+        VK_SUBPASS_EXTERNAL,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::AccessFlagBits::eColorAttachmentWrite,
+        vk::AccessFlagBits::eTransferRead,
+        {});
+
+    auto attachments = std::array<vk::AttachmentDescription, 2>{color_attachment, depth_attachment};
+    auto dependencies = std::array<vk::SubpassDependency, 2>{write_dependency, copy_dependency};
+    auto create_info = vk::RenderPassCreateInfo({}, attachments, subpass, dependencies, nullptr);
+
+    // every view of a pass is one layer, and the views see nearly the same geometry
+    uint32_t view_mask = views_per_pass == 32 ? std::numeric_limits<uint32_t>::max() : (1u << views_per_pass) - 1;
+    auto multiview_info = vk::RenderPassMultiviewCreateInfo(view_mask, {}, view_mask);
+    if (multiview) {
+        create_info.pNext = &multiview_info;
+    }
+
+    return vk::raii::RenderPass(device.logical(), create_info, nullptr);
+}
+
+vk::raii::DescriptorSetLayout SensorRenderer::createDescriptorLayout(const Device& device) const {
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 2>{
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment)};
+
+    return vk::raii::DescriptorSetLayout(device.logical(), vk::DescriptorSetLayoutCreateInfo({}, bindings));
+}
+
+vk::raii::PipelineLayout SensorRenderer::createPipelineLayout(const Device& device) const {
+    auto push_constants = vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(uint32_t));
+    auto create_info = vk::PipelineLayoutCreateInfo({}, *descriptor_layout, push_constants);
+
+    return vk::raii::PipelineLayout(device.logical(), create_info);
+}
+
+PipelineState SensorRenderer::pipelineState(ShaderCode vert_shader, ShaderCode frag_shader) const {
+    auto state = PipelineState(*pipeline_layout, *render_pass);
+    state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+    state.addStage(vk::ShaderStageFlagBits::eFragment, frag_shader.code, frag_shader.size);
+
+    auto vertex_attributes = shaders::Vertex::getAttributeDescriptions();
+    auto instance_attributes = shaders::Instance::getAttributeDescriptions();
+    state.bindings = {shaders::Vertex::getBindingDescription(), shaders::Instance::getBindingDescription()};
+    state.attributes.assign(vertex_attributes.begin(), vertex_attributes.end());
+    state.attributes.insert(state.attributes.end(), instance_attributes.begin(), instance_attributes.end());
+
+    state.rasterization = vk::PipelineRasterizationStateCreateInfo({}, false, false, vk::PolygonMode::eFill, vk::CullModeFlagBits::eNone, vk::FrontFace::eCounterClockwise, false, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    using ccflags = vk::ColorComponentFlagBits;
+    auto color_blend_attachment = vk::PipelineColorBlendAttachmentState();
+    color_blend_attachment.colorWriteMask = vk::ColorComponentFlags(ccflags::eR | ccflags::eG | ccflags::eB | ccflags::eA);
+    state.blend_attachments = {color_blend_attachment};
+
+    state.depth_stencil = vk::PipelineDepthStencilStateCreateInfo({}, true, true, vk::CompareOp::eLess, false, false, {}, {}, 0.0, 1.0);
+
+    return state;
+}
+
+std::vector<vk::raii::ImageView> SensorRenderer::createPassViews(const Device& device, const Image& image, vk::ImageAspectFlags aspects) const {
+    std::vector<vk::raii::ImageView> views;
+    for (uint32_t pass = 0; pass < pass_count; pass++) {
+        auto subresource = vk::ImageSubresourceRange(aspects, 0, 1, pass * views_per_pass, views_per_pass);
+        auto view_info = vk::ImageViewCreateInfo({}, image.get(), vk::ImageViewType::e2DArray, image.getFormat(), {}, subresource);
+        views.emplace_back(device.logical(), view_info);
+    }
+
+    return views;
+}
+
+std::vector<vk::raii::Framebuffer> SensorRenderer::createFramebuffers(const Device& device) const {
+    std::vector<vk::raii::Framebuffer> framebuffers;
+    for (uint32_t pass = 0; pass < pass_count; pass++) {
+        auto attachments = std::array<vk::ImageView, 2>{*color_views[pass], *depth_views[pass]};
+        // multiview framebuffers have a single layer, the view mask selects the layers rendered
+        auto framebuffer_info = vk::FramebufferCreateInfo({}, *render_pass, attachments, resolution.width, resolution.height, 1);
+        framebuffers.emplace_back(device.logical(), framebuffer_info);
+    }
+
+    return framebuffers;
+}
+
+DescriptorSets SensorRenderer::createDescriptorSets(const Device& device) const {
+    uint32_t sets = static_cast<uint32_t>(batch_count);
+    auto pool_sizes = std::array<vk::DescriptorPoolSize, 2>{
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, sets),
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, sets)};
+    auto layouts = std::vector<vk::DescriptorSetLayout>(batch_count, *descriptor_layout);
+
+    return DescriptorSets(device, pool_sizes, layouts);
+}
+
+void SensorRenderer::packInstances(Batch& batch, const std::vector<scene::Camera>& cameras, const scene::SceneGraph& scene) {
+    const auto& worlds = scene.worldMatrices();
+    instance_lods.resize(worlds.size(), 0);
+    for (auto& instances : lod_instances) {
+        instances.clear();
+    }
+
+    size_t visible_count = 0;
+    for (uint32_t instance = 0; instance < worlds.size(); instance++) {
+        const auto& world = worlds[instance];
+        float scale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        glm::vec3 center = glm::vec3(world * glm::vec4(model->boundsCenter(), 1.0f));
+        float radius = scale * model->boundsRadius();
+
+        // largest on-screen size among the cameras that see the instance
+        float detail = -1.0f;
+        for (uint32_t i = 0; i < camera_count; i++) {
+            const auto& planes = camera_planes[i];
+            bool visible = std::all_of(planes.begin(), planes.end(), [&](const glm::vec4& plane) {
+                return glm::dot(glm::vec3(plane), center) + plane.w >= -radius;
+            });
+
+            if (visible) {
+                const auto& camera = cameras[i];
+                float distance = std::max(glm::length(camera.position - center) - radius, camera.near_plane);
+                detail = std::max(detail, scale * camera.pixelsPerUnit(static_cast<float>(resolution.height)) / distance);
+            }
+        }
+
+        if (detail < 0.0f) {
+            continue;
+        }
+
+        uint32_t lod = model->selectLod(detail, instance_lods[instance]);
+        instance_lods[instance] = lod;
+        lod_instances[lod].push_back(instance);
+        visible_count++;
+    }
+
+    if (visible_count > batch.instance_capacity) {
+        while (batch.instance_capacity < visible_count) {
+            batch.instance_capacity *= 2;
+        }
+
+        batch.instances = Buffer(*device, Buffer::Requirements::instance(batch.instance_capacity * sizeof(shaders::Instance)));
+    }
+
+    static_assert(sizeof(shaders::Instance) == sizeof(glm::mat4));
+    auto destination = reinterpret_cast<glm::mat4*>(batch.instances.data());
+
+    draws.clear();
+    uint32_t first_instance = 0;
+    for (uint32_t lod = 0; lod < lod_instances.size(); lod++) {
+        const auto& instances = lod_instances[lod];
+        if (instances.empty()) {
+            continue;
+        }
+
+        draws.push_back(Draw{lod, first_instance, static_cast<uint32_t>(instances.size())});
+        for (uint32_t instance : instances) {
+            destination[first_instance++] = worlds[instance];
+        }
+    }
+}
+
+void SensorRenderer::record(Batch& batch, vk::Pipeline pipeline) const {
+    auto command_buffer = *batch.command_buffer;
+    command_buffer.reset();
+    command_buffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+    auto clear_color = vk::ClearValue(vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f));
+    auto clear_depth = vk::ClearValue(vk::ClearDepthStencilValue(1.0, 0));
+    auto clear_values = std::array<vk::ClearValue, 2>{clear_color, clear_depth};
+    auto render_area = vk::Rect2D({0, 0}, resolution);
+
+    auto vertex_buffers = std::array<vk::Buffer, 2>{model->getVertices().get(), batch.instances.get()};
+    auto vertex_offsets = std::array<vk::DeviceSize, 2>{0, 0};
+    const auto& lods = model->getLods();
+
+    for (uint32_t pass = 0; pass < pass_count; pass++) {
+        auto render_pass_info = vk::RenderPassBeginInfo(*render_pass, *framebuffers[pass], render_area, clear_values);
+        command_buffer.beginRenderPass(render_pass_info, vk::SubpassContents::eInline);
+
+        command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+        command_buffer.setViewport(0, vk::Viewport(0.0, 0.0, resolution.width, resolution.height, 0.0, 1.0));
+        command_buffer.setScissor(0, render_area);
+        command_buffer.bindVertexBuffers(0, vertex_buffers, vertex_offsets);
+        command_buffer.bindIndexBuffer(model->getIndices().get(), vk::DeviceSize(0), vk::IndexType::eUint32);
+        command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0, batch.descriptor_set, {});
+
+        uint32_t first_view = pass * views_per_pass;
+        command_buffer.pushConstants<uint32_t>(*pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, first_view);
+
+        for (const auto& draw : draws) {
+            const auto& lod = lods[draw.lod];
+            command_buffer.drawIndexed(lod.index_count, draw.instance_count, lod.first_index, 0, draw.first_instance);
+        }
+
+        command_buffer.endRenderPass();
+    }
+
+    // layers are copied out back to back, padding layers are skipped
+    auto layers = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, camera_count);
+    auto region = vk::BufferImageCopy(0, 0, 0, layers, {0, 0, 0}, vk::Extent3D(resolution.width, resolution.height, 1));
+    command_buffer.copyImageToBuffer(color_images.get(), vk::ImageLayout::eTransferSrcOptimal, batch.readback.get(), region);
+
+    auto copied = vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, copied, {}, {});
+
+    command_buffer.end();
+}
+
+void SensorRenderer::finish(Batch& batch) {
+    vk::Result wait_result = device->logical().waitForFences(*batch.fence, true, std::numeric_limits<uint64_t>::max());
+    assert(wait_result == vk::Result::eSuccess);
+    (void)wait_result;
+
+    batch.pending = false;
+    pending_count--;
+    finished_images += camera_count;
+    last_finish = std::chrono::steady_clock::now();
+}
+
+}  // namespace vulkan
+}  // namespace visualization
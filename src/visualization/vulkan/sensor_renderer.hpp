@@ -0,0 +1,167 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SENSOR_RENDERER_HPP
+#define BB8_VISUALIZATION_VULKAN_SENSOR_RENDERER_HPP
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../scene/camera.hpp"
+#include "../scene/scene_graph.hpp"
+#include "buffer.hpp"
+#include "descriptor_sets.hpp"
+#include "device.hpp"
+#include "image.hpp"
+#include "model.hpp"
+#include "pipeline_state.hpp"
+#include "shader_reloader.hpp"
+#include "shaders/sensor_uniforms.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Batch rendering of simulated onboard cameras.
+//
+// All cameras are rendered in a single submission into the layers of one color image
+// array, which is then copied into a persistently mapped readback buffer. With
+// multiview, each render pass draws the scene once for a group of cameras, and the
+// vertex shader picks the camera from the view index. Without it, each camera gets
+// its own pass. Instances are culled on the CPU against the union of all camera
+// frustums and their level of detail is chosen by the nearest camera, so every pass
+// shares the same instance data and draw calls.
+//
+// Batches are double buffered, so the images of one batch can be read while the
+// next one renders.
+class SensorRenderer {
+public:
+    // tightly packed R8G8B8A8 images of a finished batch, one per camera
+    class Readback {
+    public:
+        size_t imageSize() const;
+        const uint8_t* image(uint32_t camera) const;
+
+        const uint8_t* pixels;
+        uint32_t width;
+        uint32_t height;
+        uint32_t camera_count;
+    };
+
+    SensorRenderer(const Device& device, const Model& model, vk::Extent2D resolution, uint32_t camera_count);
+
+    SensorRenderer(const SensorRenderer&) = delete;
+    SensorRenderer& operator=(const SensorRenderer&) = delete;
+
+    SensorRenderer(SensorRenderer&&) = default;
+    SensorRenderer& operator=(SensorRenderer&&) = default;
+
+    ~SensorRenderer();
+
+    // state of the pipeline render() draws with, compiled by the owner. The vertex shader
+    // is the multiview variant if usesMultiview(), otherwise the layered one
+    PipelineState pipelineState(ShaderCode vert_shader, ShaderCode frag_shader) const;
+
+    // submits a batch rendering every camera with `pipeline`, first waiting for the oldest batch if all are in flight.
+    // Scene world transforms must be up to date.
+    void render(vk::Pipeline pipeline, const std::vector<scene::Camera>& cameras, const scene::SceneGraph& scene, glm::vec3 light_direction);
+
+    // waits for the oldest batch in flight and returns its images, which stay valid until the next render()
+    std::optional<Readback> readback();
+
+    // camera images finished per second, since the first batch was submitted
+    double imagesPerSecond() const;
+
+    uint32_t cameraCount() const;
+    bool usesMultiview() const;
+
+private:
+    class Batch {
+    public:
+        Batch(const Device& device, vk::raii::CommandBuffer command_buffer, vk::DescriptorSet descriptor_set, size_t readback_size);
+
+        vk::raii::CommandBuffer command_buffer;
+        vk::raii::Fence fence;
+
+        Buffer uniforms;
+        Buffer instances;
+        size_t instance_capacity;
+        Buffer readback;
+
+        // owned by the renderer's descriptor sets
+        vk::DescriptorSet descriptor_set;
+        bool pending = false;
+    };
+
+    // instances drawn with the same level of detail, packed contiguously in the instance buffer
+    class Draw {
+    public:
+        uint32_t lod;
+        uint32_t first_instance;
+        uint32_t instance_count;
+    };
+
+    static vk::Format findDepthFormat(const Device& device);
+    static uint32_t viewsPerPass(const Device& device, uint32_t camera_count);
+
+    vk::raii::RenderPass createRenderPass(const Device& device) const;
+    vk::raii::DescriptorSetLayout createDescriptorLayout(const Device& device) const;
+    vk::raii::PipelineLayout createPipelineLayout(const Device& device) const;
+    std::vector<vk::raii::ImageView> createPassViews(const Device& device, const Image& image, vk::ImageAspectFlags aspects) const;
+    std::vector<vk::raii::Framebuffer> createFramebuffers(const Device& device) const;
+    DescriptorSets createDescriptorSets(const Device& device) const;
+
+    // culls instances against every camera, and packs the visible ones into the batch's instance buffer
+    void packInstances(Batch& batch, const std::vector<scene::Camera>& cameras, const scene::SceneGraph& scene);
+    void record(Batch& batch, vk::Pipeline pipeline) const;
+    void finish(Batch& batch);
+
+    static constexpr size_t batch_count = 2;
+    static constexpr size_t initial_instance_capacity = 64;
+    static constexpr vk::Format color_format = vk::Format::eR8G8B8A8Unorm;
+    static constexpr float ambient = 0.25f;
+
+    const Device* device;
+    const Model* model;
+
+    vk::Extent2D resolution;
+    uint32_t camera_count;
+    bool multiview;
+    // cameras are rendered in groups of this many, the last group is padded with empty layers
+    uint32_t views_per_pass;
+    uint32_t pass_count;
+    vk::Format depth_format;
+
+    Image color_images;
+    Image depth_images;
+
+    vk::raii::RenderPass render_pass;
+    vk::raii::DescriptorSetLayout descriptor_layout;
+    vk::raii::PipelineLayout pipeline_layout;
+
+    std::vector<vk::raii::ImageView> color_views;
+    std::vector<vk::raii::ImageView> depth_views;
+    std::vector<vk::raii::Framebuffer> framebuffers;
+
+    vk::raii::CommandPool command_pool;
+
+    // one per batch
+    DescriptorSets descriptor_sets;
+    std::vector<Batch> batches;
+
+    size_t next_batch = 0;
+    size_t pending_count = 0;
+
+    std::vector<uint32_t> instance_lods;
+    std::vector<std::array<glm::vec4, 6>> camera_planes;
+    std::vector<std::vector<uint32_t>> lod_instances;
+    std::vector<Draw> draws;
+
+    uint64_t finished_images = 0;
+    std::optional<std::chrono::steady_clock::time_point> first_submission;
+    std::chrono::steady_clock::time_point last_finish;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SENSOR_RENDERER_HPP
@@ -0,0 +1,226 @@
+#include "shader_reloader.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef BB8_SHADER_HOT_RELOAD
+#include <shaderc/shaderc.hpp>
+#endif
+
+#include "shaders.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+ShaderReloader::ShaderReloader(std::filesystem::path source_directory, std::filesystem::path cache_directory)
+    : source_directory(std::move(source_directory)), cache_directory(std::move(cache_directory)) {
+    if (!isSupported()) {
+        throw std::runtime_error("shader hot reload requires building with the shader_hot_reload option");
+    }
+
+    std::filesystem::create_directories(this->cache_directory);
+    watcher = std::thread(&ShaderReloader::watch, this);
+}
+
+ShaderReloader::~ShaderReloader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stop_requested.notify_all();
+
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+}
+
+bool ShaderReloader::isSupported() {
+#ifdef BB8_SHADER_HOT_RELOAD
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ShaderReloader::update() {
+    std::vector<Compiled> compiled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        compiled.swap(pending);
+    }
+
+    for (auto& shader : compiled) {
+        versions.push_back(std::move(shader.code));
+        current[shader.name] = &versions.back();
+    }
+
+    return !compiled.empty();
+}
+
+bool ShaderReloader::hasUpdates() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending.empty();
+}
+
+ShaderCode ShaderReloader::code(std::string_view name) const {
+    auto reloaded = current.find(std::string(name));
+    if (reloaded != current.end()) {
+        return ShaderCode{reloaded->second->data(), reloaded->second->size()};
+    }
+
+    return embedded(name);
+}
+
+ShaderCode ShaderReloader::embedded(std::string_view name) {
+    const auto* shader = shaders::findShader(name);
+    if (shader == nullptr) {
+        throw std::runtime_error("no embedded shader named " + std::string(name));
+    }
+
+    return ShaderCode{shader->code, shader->size};
+}
+
+void ShaderReloader::watch() {
+    // embedded code was compiled from the sources as they are now, so only later changes are compiled
+    std::unordered_map<std::string, std::filesystem::file_time_type> seen;
+    for (const auto& shader : shaders::embedded_shaders) {
+        std::error_code error;
+        auto path = source_directory / shader.source;
+        seen[path.string()] = std::filesystem::last_write_time(path, error);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop_requested.wait_for(lock, poll_interval, [this]() { return stopping; })) {
+        lock.unlock();
+
+        std::vector<Compiled> compiled;
+        std::unordered_map<std::string, std::filesystem::file_time_type> modified;
+        for (const auto& shader : shaders::embedded_shaders) {
+            auto path = source_directory / shader.source;
+            auto extension = path.extension();
+            if (extension != ".vert" && extension != ".frag") {
+                continue;
+            }
+
+            std::error_code error;
+            auto write_time = std::filesystem::last_write_time(path, error);
+            if (error || write_time == seen[path.string()]) {
+                continue;
+            }
+            modified[path.string()] = write_time;
+
+            std::ifstream file(path);
+            std::stringstream source;
+            source << file.rdbuf();
+
+            // variants sharing a source are all recompiled
+            auto code = compile(shader.name, shader.source, shader.defines, source.str());
+            if (code.has_value()) {
+                compiled.push_back(Compiled{std::string(shader.name), std::move(*code)});
+            }
+        }
+
+        // sources that failed to compile aren't retried until they change again
+        for (const auto& [path, write_time] : modified) {
+            seen[path] = write_time;
+        }
+
+        lock.lock();
+        for (auto& shader : compiled) {
+            pending.push_back(std::move(shader));
+        }
+    }
+}
+
+std::optional<std::vector<uint32_t>> ShaderReloader::compile(std::string_view name,
+                                                             std::string_view source_file,
+                                                             std::string_view defines,
+                                                             const std::string& source) const {
+    std::stringstream cache_name;
+    cache_name << std::hex << std::setw(16) << std::setfill('0') << sourceHash(name, defines, source) << ".spv";
+    auto cache_path = cache_directory / cache_name.str();
+
+    std::ifstream cached(cache_path, std::ios::binary | std::ios::ate);
+    if (cached.is_open()) {
+        auto size = static_cast<size_t>(cached.tellg());
+        std::vector<uint32_t> code(size / sizeof(uint32_t));
+        cached.seekg(0);
+        cached.read(reinterpret_cast<char*>(code.data()), code.size() * sizeof(uint32_t));
+        if (cached && !code.empty()) {
+            return code;
+        }
+    }
+
+#ifdef BB8_SHADER_HOT_RELOAD
+    auto extension = std::filesystem::path(source_file).extension();
+    auto kind = extension == ".vert" ? shaderc_glsl_vertex_shader : shaderc_glsl_fragment_shader;
+
+    shaderc::CompileOptions options;
+    auto version = targetEnvironment(defines) == "vulkan1.1" ? shaderc_env_version_vulkan_1_1 : shaderc_env_version_vulkan_1_0;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, version);
+    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+
+    std::string define;
+    std::stringstream define_list{std::string(defines)};
+    while (std::getline(define_list, define, ',')) {
+        options.AddMacroDefinition(define);
+    }
+
+    shaderc::Compiler compiler;
+    auto result = compiler.CompileGlslToSpv(source, kind, std::string(source_file).c_str(), options);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+        std::cerr << "failed to compile " << name << ":\n"
+                  << result.GetErrorMessage() << std::endl;
+        return std::nullopt;
+    }
+
+    auto code = std::vector<uint32_t>(result.cbegin(), result.cend());
+
+    std::ofstream cache(cache_path, std::ios::binary);
+    cache.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(uint32_t));
+
+    return code;
+#else
+    (void)source_file;
+    return std::nullopt;
+#endif
+}
+
+uint64_t ShaderReloader::sourceHash(std::string_view name, std::string_view defines, const std::string& source) {
+    // FNV-1a, which unlike std::hash is stable between runs, so it can key the disk cache
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto append = [&hash](std::string_view bytes) {
+        for (char byte : bytes) {
+            hash ^= static_cast<uint8_t>(byte);
+            hash *= 0x100000001b3ull;
+        }
+        // separator, so concatenations of different fields don't collide
+        hash ^= 0xff;
+        hash *= 0x100000001b3ull;
+    };
+
+    append(name);
+    append(defines);
+    append(targetEnvironment(defines));
+    append(source);
+
+    return hash;
+}
+
+std::string_view ShaderReloader::targetEnvironment(std::string_view defines) {
+    std::string define;
+    std::stringstream define_list{std::string(defines)};
+    while (std::getline(define_list, define, ',')) {
+        if (define == "MULTIVIEW") {
+            return "vulkan1.1";
+        }
+    }
+
+    return "vulkan1.0";
+}
+
+}  // namespace vulkan
+}  // namespace visualization
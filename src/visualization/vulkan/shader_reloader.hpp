@@ -0,0 +1,94 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADER_RELOADER_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADER_RELOADER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace visualization {
+namespace vulkan {
+
+// SPIR-V of one shader variant, in 32-bit words
+class ShaderCode {
+public:
+    const uint32_t* code;
+    size_t size;
+};
+
+// Development mode that recompiles embedded shader variants whenever their GLSL
+// sources change. A background thread polls the sources, compiles changed ones
+// in-process, and caches the SPIR-V on disk keyed by a hash of the source and its
+// defines, so unchanged shaders are never compiled twice. New code only becomes
+// current when the render thread calls update(), at a frame boundary.
+// Only available when built with the shader_hot_reload option.
+class ShaderReloader {
+public:
+    ShaderReloader(std::filesystem::path source_directory, std::filesystem::path cache_directory);
+
+    ShaderReloader(const ShaderReloader&) = delete;
+    ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+    // the watcher thread refers back to the reloader, so it can't be moved
+    ShaderReloader(ShaderReloader&&) = delete;
+    ShaderReloader& operator=(ShaderReloader&&) = delete;
+
+    ~ShaderReloader();
+
+    static bool isSupported();
+
+    // makes recompiled shaders current, returns whether any changed since the last call
+    bool update();
+    // whether recompiled shaders are waiting for update(). Safe to call from any thread
+    bool hasUpdates() const;
+
+    // latest successfully compiled code of the variant, or its embedded code. Code stays
+    // valid for the reloader's lifetime, so pipelines still compiling from it are unaffected
+    ShaderCode code(std::string_view name) const;
+
+    // embedded code of the variant, throws if there is no such variant
+    static ShaderCode embedded(std::string_view name);
+
+private:
+    class Compiled {
+    public:
+        std::string name;
+        std::vector<uint32_t> code;
+    };
+
+    void watch();
+    std::optional<std::vector<uint32_t>> compile(std::string_view name, std::string_view source_file, std::string_view defines, const std::string& source) const;
+
+    static uint64_t sourceHash(std::string_view name, std::string_view defines, const std::string& source);
+    // Vulkan version a variant is compiled for, as in the build: 1.1 for multiview variants, else 1.0
+    static std::string_view targetEnvironment(std::string_view defines);
+
+    static constexpr std::chrono::milliseconds poll_interval = std::chrono::milliseconds(250);
+
+    std::filesystem::path source_directory;
+    std::filesystem::path cache_directory;
+
+    // owned by the render thread. Every version is kept, as pipelines may still be compiling from it
+    std::deque<std::vector<uint32_t>> versions;
+    std::unordered_map<std::string, const std::vector<uint32_t>*> current;
+
+    mutable std::mutex mutex;
+    std::condition_variable stop_requested;
+    bool stopping = false;
+    std::vector<Compiled> pending;
+
+    std::thread watcher;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADER_RELOADER_HPP
@@ -0,0 +1,31 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_CULL_UNIFORMS_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_CULL_UNIFORMS_HPP
+
+#include <cstdint>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Matches `CullUniforms` in cull.comp (std140)
+class CullUniforms {
+public:
+    // world-space planes, pointing inwards
+    alignas(16) glm::vec4 frustum_planes[6];
+
+    // view-projection the depth pyramid was rendered with
+    alignas(16) glm::mat4 occlusion_view_projection;
+
+    alignas(16) glm::vec4 camera_position;
+    alignas(8) glm::vec2 pyramid_size;
+    uint32_t enable_cone_culling;
+    uint32_t enable_occlusion_culling;
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_CULL_UNIFORMS_HPP
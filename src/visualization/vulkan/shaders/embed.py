@@ -1,5 +1,7 @@
-# Embeds SPIR-V binaries into a C++ source file, so that the shaders are available at compile time
-# Usage: python embed.py <output file> <shader 1 name> <shader 1 SPIR-V file> <shader 2 name> <shader 2 SPIR-V> ...
+# Embeds SPIR-V binaries into a C++ header, so that the shaders are available at compile time.
+# Each shader becomes a constexpr array, so no allocation or copying happens during static
+# initialization, and a lookup table lists every variant with the source it was compiled from.
+# Usage: python embed.py <output file> <name> <GLSL source> <comma separated defines> <SPIR-V file> ...
 
 import os
 import struct
@@ -13,25 +15,63 @@ def embed_contents(name, file_path):
     uint32_contents = struct.unpack(f"{length}I", contents)
     initializer = ",".join(map(str,uint32_contents))
 
-    return f"const std::vector<uint32_t> {name} = std::vector<uint32_t> {{ {initializer} }};\n\n"
+    return f"inline constexpr std::array<uint32_t, {length}> {name} = {{ {initializer} }};\n\n"
+
+def table_entry(name, source, defines):
+    return f"    EmbeddedShader{{\"{name}\", \"{source}\", \"{defines}\", {name}.data(), {name}.size()}},\n"
 
 
 output_file_path = sys.argv[1]
-shaders = zip(sys.argv[2::2], sys.argv[3::2])
+arguments = sys.argv[2:]
+shaders = [arguments[i:i + 4] for i in range(0, len(arguments), 4)]
 
 output_file = os.path.basename(output_file_path)
 include_guard_name = output_file.replace(".", "_").upper()
 embedded_source = """\
 #ifndef BB8_VISUALIZATION_SHADERS_{}\n\
 #define BB8_VISUALIZATION_SHADERS_{}\n\n\
-#include <vector>\n#include <cstdint>\n\n\
+#include <array>\n#include <cstddef>\n#include <cstdint>\n#include <string_view>\n\n\
 namespace visualization {{\n\
 namespace vulkan {{\n\
 namespace shaders {{\n\n""".format(include_guard_name, include_guard_name)
 
-for name, file in shaders:
+for name, source, defines, file in shaders:
     embedded_source += embed_contents(name, file)
 
+embedded_source += """\
+class EmbeddedShader {
+public:
+    std::string_view name;
+    // GLSL source file and comma separated preprocessor definitions the variant was compiled from
+    std::string_view source;
+    std::string_view defines;
+
+    const uint32_t* code;
+    // in 32-bit words
+    size_t size;
+};
+
+"""
+
+embedded_source += f"inline constexpr std::array<EmbeddedShader, {len(shaders)}> embedded_shaders = {{\n"
+for name, source, defines, file in shaders:
+    embedded_source += table_entry(name, source, defines)
+embedded_source += "};\n\n"
+
+embedded_source += """\
+// nullptr if no variant has this name
+constexpr const EmbeddedShader* findShader(std::string_view name) {
+    for (const auto& shader : embedded_shaders) {
+        if (shader.name == name) {
+            return &shader;
+        }
+    }
+
+    return nullptr;
+}
+
+"""
+
 embedded_source += "}\n}\n}\n#endif"
 
 with open(output_file_path, mode='w') as file:
@@ -0,0 +1,23 @@
+#include "instance.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+vk::VertexInputBindingDescription Instance::getBindingDescription() {
+    return vk::VertexInputBindingDescription(binding, sizeof(Instance), vk::VertexInputRate::eInstance);
+}
+
+std::array<vk::VertexInputAttributeDescription, 4> Instance::getAttributeDescriptions() {
+    // a mat4 attribute occupies four consecutive locations, one per column
+    constexpr uint32_t column_size = sizeof(glm::vec4);
+    return {
+        vk::VertexInputAttributeDescription(3, binding, vk::Format::eR32G32B32A32Sfloat, offsetof(Instance, model) + 0 * column_size),
+        vk::VertexInputAttributeDescription(4, binding, vk::Format::eR32G32B32A32Sfloat, offsetof(Instance, model) + 1 * column_size),
+        vk::VertexInputAttributeDescription(5, binding, vk::Format::eR32G32B32A32Sfloat, offsetof(Instance, model) + 2 * column_size),
+        vk::VertexInputAttributeDescription(6, binding, vk::Format::eR32G32B32A32Sfloat, offsetof(Instance, model) + 3 * column_size)};
+}
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
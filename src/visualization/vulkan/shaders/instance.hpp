@@ -0,0 +1,28 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_INSTANCE_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_INSTANCE_HPP
+
+#include <array>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Per-instance vertex input, packed directly from scene::SceneGraph world matrices
+class Instance {
+public:
+    glm::mat4 model;
+
+    static constexpr uint32_t binding = 1;
+
+    static vk::VertexInputBindingDescription getBindingDescription();
+    static std::array<vk::VertexInputAttributeDescription, 4> getAttributeDescriptions();
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_INSTANCE_HPP
@@ -0,0 +1,31 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_LIGHT_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_LIGHT_HPP
+
+#include <cstdint>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// World-space point or spot light, matches `Light` in light_cluster.comp and shader.frag (std430)
+class Light {
+public:
+    glm::vec3 position;
+    float range;
+
+    glm::vec3 color;
+    // cosine of the cone's inner half-angle, -1 for point lights
+    float spot_inner_cos;
+
+    glm::vec3 direction;
+    // cosine of the cone's outer half-angle, below -1 for point lights so they light every direction
+    float spot_outer_cos;
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_LIGHT_HPP
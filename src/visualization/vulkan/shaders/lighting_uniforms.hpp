@@ -0,0 +1,43 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_LIGHTING_UNIFORMS_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_LIGHTING_UNIFORMS_HPP
+
+#include <cstdint>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Matches `Lighting` in shader.frag and light_cluster.comp (std140)
+class LightingUniforms {
+public:
+    static constexpr uint32_t max_cascades = 4;
+
+    alignas(16) glm::mat4 cascade_view_projections[max_cascades];
+
+    // view depth at which each cascade ends
+    alignas(16) glm::vec4 cascade_splits;
+
+    // direction light travels in, ambient fraction in w
+    alignas(16) glm::vec4 light_direction;
+
+    alignas(16) glm::vec4 camera_position;
+    uint32_t cascade_count;
+    uint32_t dynamic_shadows;
+
+    // clusters along x, y and z, number of local lights in w
+    alignas(16) glm::uvec4 cluster_grid;
+
+    // pixel size of a cluster tile, and viewport size
+    alignas(16) glm::vec4 cluster_tile;
+
+    // near and far depth of the clustered range, and depth slices per unit of log depth
+    alignas(16) glm::vec4 cluster_depth;
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_LIGHTING_UNIFORMS_HPP
@@ -0,0 +1,19 @@
+#include "line_vertex.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+vk::VertexInputBindingDescription LineVertex::getBindingDescription() {
+    return vk::VertexInputBindingDescription(0, sizeof(LineVertex), vk::VertexInputRate::eVertex);
+}
+
+std::array<vk::VertexInputAttributeDescription, 2> LineVertex::getAttributeDescriptions() {
+    return {
+        vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(LineVertex, position)),
+        vk::VertexInputAttributeDescription(1, 0, vk::Format::eR8G8B8A8Unorm, offsetof(LineVertex, color))};
+}
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
@@ -0,0 +1,28 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_LINE_VERTEX_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_LINE_VERTEX_HPP
+
+#include <array>
+#include <cstdint>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Vertex input of the debug line pipeline, color is packed RGBA8
+class LineVertex {
+public:
+    glm::vec3 position;
+    uint32_t color;
+
+    static vk::VertexInputBindingDescription getBindingDescription();
+    static std::array<vk::VertexInputAttributeDescription, 2> getAttributeDescriptions();
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_LINE_VERTEX_HPP
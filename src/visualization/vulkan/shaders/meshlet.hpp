@@ -0,0 +1,33 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_MESHLET_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_MESHLET_HPP
+
+#include <cstdint>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Cluster of triangles with culling bounds, matches `Meshlet` in cull.comp (std430)
+class Meshlet {
+public:
+    // bounding sphere center and radius
+    glm::vec4 sphere;
+
+    // backface cone axis and cutoff, the meshlet faces away from viewers inside the cone.
+    // A cutoff of 1 means the cone is degenerate and the meshlet can't be cone culled.
+    glm::vec4 cone;
+
+    // range in the meshlet index buffer
+    uint32_t first_index;
+    uint32_t index_count;
+
+    uint32_t padding[2];
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_MESHLET_HPP
@@ -0,0 +1,19 @@
+#include "point.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+vk::VertexInputBindingDescription Point::getBindingDescription() {
+    return vk::VertexInputBindingDescription(0, sizeof(Point), vk::VertexInputRate::eVertex);
+}
+
+std::array<vk::VertexInputAttributeDescription, 2> Point::getAttributeDescriptions() {
+    return {
+        vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Point, position)),
+        vk::VertexInputAttributeDescription(1, 0, vk::Format::eR8G8B8A8Unorm, offsetof(Point, color))};
+}
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
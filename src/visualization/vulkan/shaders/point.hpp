@@ -0,0 +1,40 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_POINT_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_POINT_HPP
+
+#include <array>
+#include <cstdint>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Point cloud point, read as a storage buffer by the splatting shader and as vertex input
+// by the point list fallback. Color is packed RGBA8, as for debug lines
+class Point {
+public:
+    glm::vec3 position;
+    uint32_t color;
+
+    static vk::VertexInputBindingDescription getBindingDescription();
+    static std::array<vk::VertexInputAttributeDescription, 2> getAttributeDescriptions();
+};
+
+// Push constants shared by every point cloud shader
+class PointConstants {
+public:
+    glm::mat4 view_projection;
+    // rendered region of the visibility buffer, whose rows are `row_stride` pixels apart
+    uint32_t width;
+    uint32_t height;
+    uint32_t row_stride;
+    uint32_t point_count;
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_POINT_HPP
@@ -0,0 +1,22 @@
+#version 450
+
+// Point list fallback for devices without 64-bit buffer atomics
+
+layout(push_constant) uniform PointConstants {
+    mat4 view_projection;
+    uint width;
+    uint height;
+    uint row_stride;
+    uint point_count;
+};
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec4 in_color;
+
+layout(location = 0) out vec4 frag_color;
+
+void main() {
+    gl_Position = view_projection * vec4(in_position, 1.0);
+    gl_PointSize = 1.0;
+    frag_color = in_color;
+}
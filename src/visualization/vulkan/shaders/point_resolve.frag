@@ -0,0 +1,31 @@
+#version 450
+
+// Writes the nearest splatted point of each pixel, at its own depth so the scene can hide it
+
+// 64-bit visibility values, read as their low (color) and high (depth) halves
+layout(std430, binding = 1) readonly buffer Visibility {
+    uvec2 visibility[];
+};
+
+layout(push_constant) uniform PointConstants {
+    mat4 view_projection;
+    uint width;
+    uint height;
+    uint row_stride;
+    uint point_count;
+};
+
+layout(location = 0) out vec4 output_color;
+
+void main() {
+    uvec2 pixel = uvec2(gl_FragCoord.xy);
+    uvec2 value = visibility[pixel.y * row_stride + pixel.x];
+
+    // cleared to all ones, which no splatted depth in [0, 1] reaches
+    if (value.y == 0xffffffffu) {
+        discard;
+    }
+
+    gl_FragDepth = uintBitsToFloat(value.y);
+    output_color = unpackUnorm4x8(value.x);
+}
@@ -0,0 +1,24 @@
+#version 450
+
+layout(binding = 0) uniform SensorUniforms {
+    mat4 view_projections[64];
+    vec4 light_direction;
+} sensor;
+
+layout(binding = 1) uniform sampler2D frag_sampler;
+
+layout(location = 0) in vec2 frag_texture;
+layout(location = 1) in vec3 frag_world_position;
+
+layout(location = 0) out vec4 output_color;
+
+void main() {
+    // face normal from screen-space derivatives, which (with y pointing down) always faces the camera
+    vec3 normal = normalize(cross(dFdy(frag_world_position), dFdx(frag_world_position)));
+
+    float ambient = sensor.light_direction.w;
+    float diffuse = max(dot(normal, -sensor.light_direction.xyz), 0.0);
+
+    vec4 albedo = texture(frag_sampler, frag_texture);
+    output_color = vec4(albedo.rgb * (ambient + (1.0 - ambient) * diffuse), albedo.a);
+}
@@ -0,0 +1,36 @@
+#version 450
+#ifdef MULTIVIEW
+#extension GL_EXT_multiview : require
+#endif
+
+// Renders one layer of a multiview pass per camera, or a single camera per pass
+// for devices without multiview
+
+layout(binding = 0) uniform SensorUniforms {
+    mat4 view_projections[64];
+    vec4 light_direction;
+} sensor;
+
+layout(push_constant) uniform Views {
+    // camera rendered into the pass's first view
+    uint first_view;
+} views;
+
+layout(location = 0) in vec3 in_position;
+layout(location = 2) in vec2 in_texture;
+layout(location = 3) in mat4 in_model;
+
+layout(location = 0) out vec2 frag_texture;
+layout(location = 1) out vec3 frag_world_position;
+
+void main() {
+    vec4 world_position = in_model * vec4(in_position, 1.0);
+#ifdef MULTIVIEW
+    gl_Position = sensor.view_projections[views.first_view + gl_ViewIndex] * world_position;
+#else
+    gl_Position = sensor.view_projections[views.first_view] * world_position;
+#endif
+
+    frag_texture = in_texture;
+    frag_world_position = world_position.xyz;
+}
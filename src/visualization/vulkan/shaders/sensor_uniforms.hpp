@@ -0,0 +1,27 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_SENSOR_UNIFORMS_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_SENSOR_UNIFORMS_HPP
+
+#include <cstdint>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Matches `SensorUniforms` in sensor.vert and sensor.frag (std140)
+class SensorUniforms {
+public:
+    static constexpr uint32_t max_cameras = 64;
+
+    alignas(16) glm::mat4 view_projections[max_cameras];
+
+    // direction light travels in, ambient fraction in w
+    alignas(16) glm::vec4 light_direction;
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_SENSOR_UNIFORMS_HPP
@@ -2,11 +2,138 @@
 
 layout(binding = 1) uniform sampler2D frag_sampler;
 
+layout(binding = 2) uniform Lighting {
+    mat4 cascade_view_projections[4];
+    vec4 cascade_splits;
+    vec4 light_direction;
+    vec4 camera_position;
+    uint cascade_count;
+    uint dynamic_shadows;
+    uvec4 cluster_grid;
+    vec4 cluster_tile;
+    vec4 cluster_depth;
+} lighting;
+
+// static casters are cached, dynamic casters are re-rendered every frame
+layout(binding = 3) uniform sampler2DArrayShadow static_shadows;
+layout(binding = 4) uniform sampler2DArrayShadow dynamic_shadows;
+
+// matches ClusteredLighting::max_cluster_lights
+const uint max_cluster_lights = 127;
+
+struct Light {
+    vec3 position;
+    float range;
+    vec3 color;
+    float spot_inner_cos;
+    vec3 direction;
+    float spot_outer_cos;
+};
+
+layout(std430, binding = 5) readonly buffer Lights {
+    Light lights[];
+};
+
+// per cluster, a light count followed by that many light indices
+layout(std430, binding = 6) readonly buffer ClusterLights {
+    uint cluster_lights[];
+};
+
+// variant writing linear depth and instance IDs, for render passes with the extra attachments
+layout(constant_id = 0) const bool write_sensor_outputs = false;
+
 layout(location = 0) in vec3 frag_color;
 layout(location = 1) in vec2 frag_texture;
+layout(location = 2) in vec3 frag_world_position;
+layout(location = 3) in float frag_view_depth;
+layout(location = 4) flat in uint frag_instance;
 
 layout(location = 0) out vec4 output_color;
+layout(location = 1) out float output_depth;
+layout(location = 2) out uint output_instance;
+
+// fraction of four taps around `position` that are lit
+float sampleShadow(sampler2DArrayShadow shadows, vec3 position, float layer) {
+    vec2 texel = 1.0 / vec2(textureSize(shadows, 0).xy);
+    float lit = 0.0;
+    lit += texture(shadows, vec4(position.xy + vec2(-0.5, -0.5) * texel, layer, position.z));
+    lit += texture(shadows, vec4(position.xy + vec2(0.5, -0.5) * texel, layer, position.z));
+    lit += texture(shadows, vec4(position.xy + vec2(-0.5, 0.5) * texel, layer, position.z));
+    lit += texture(shadows, vec4(position.xy + vec2(0.5, 0.5) * texel, layer, position.z));
+    return 0.25 * lit;
+}
+
+float shadow() {
+    uint cascade = 0;
+    while (cascade < lighting.cascade_count && frag_view_depth > lighting.cascade_splits[cascade]) {
+        cascade++;
+    }
+
+    // beyond the shadowed range
+    if (cascade == lighting.cascade_count) {
+        return 1.0;
+    }
+
+    vec4 clip = lighting.cascade_view_projections[cascade] * vec4(frag_world_position, 1.0);
+    vec3 position = vec3(clip.xy * 0.5 + 0.5, clip.z);
+
+    float lit = sampleShadow(static_shadows, position, float(cascade));
+    if (lighting.dynamic_shadows != 0) {
+        lit = min(lit, sampleShadow(dynamic_shadows, position, float(cascade)));
+    }
+
+    return lit;
+}
+
+// diffuse lighting from the local lights binned into this fragment's cluster
+vec3 localLighting(vec3 normal) {
+    uvec3 grid = lighting.cluster_grid.xyz;
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / lighting.cluster_tile.xy), grid.xy - 1);
+
+    float near = lighting.cluster_depth.x;
+    float slice = log(max(frag_view_depth, near) / near) * lighting.cluster_depth.z;
+    uint depth_slice = min(uint(slice), grid.z - 1);
+
+    uint base = (tile.x + grid.x * (tile.y + grid.y * depth_slice)) * (max_cluster_lights + 1);
+    uint count = cluster_lights[base];
+
+    vec3 total = vec3(0.0);
+    for (uint i = 0; i < count; i++) {
+        Light light = lights[cluster_lights[base + 1 + i]];
+
+        vec3 to_light = light.position - frag_world_position;
+        float distance_squared = dot(to_light, to_light);
+        vec3 direction = to_light * inversesqrt(max(distance_squared, 1.0e-8));
+
+        // inverse square falloff, windowed to reach zero at the light's range
+        float ratio = distance_squared / (light.range * light.range);
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / max(distance_squared, 0.01);
+
+        float spot = smoothstep(light.spot_outer_cos, light.spot_inner_cos, dot(-direction, light.direction));
+        total += light.color * (max(dot(normal, direction), 0.0) * attenuation * spot);
+    }
+
+    return total;
+}
 
 void main() {
-    output_color = texture(frag_sampler, frag_texture);
+    // no vertex normals, so light with the face normal, oriented towards the camera
+    vec3 normal = normalize(cross(dFdx(frag_world_position), dFdy(frag_world_position)));
+    if (dot(normal, lighting.camera_position.xyz - frag_world_position) < 0.0) {
+        normal = -normal;
+    }
+
+    float ambient = lighting.light_direction.w;
+    float diffuse = max(dot(normal, -lighting.light_direction.xyz), 0.0);
+
+    vec4 albedo = texture(frag_sampler, frag_texture);
+    vec3 light = vec3(ambient + (1.0 - ambient) * diffuse * shadow()) + localLighting(normal);
+    output_color = vec4(albedo.rgb * light, albedo.a);
+
+    if (write_sensor_outputs) {
+        output_depth = frag_view_depth;
+        // zero is left for the background
+        output_instance = frag_instance + 1;
+    }
 }
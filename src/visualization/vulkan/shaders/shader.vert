@@ -1,7 +1,6 @@
 #version 450
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 projection;
 } ubo;
@@ -9,12 +8,22 @@ layout(binding = 0) uniform UniformBufferObject {
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec3 in_color;
 layout(location = 2) in vec2 in_texture;
+layout(location = 3) in mat4 in_model;
 
 layout(location = 0) out vec3 frag_color;
 layout(location = 1) out vec2 frag_texture;
+layout(location = 2) out vec3 frag_world_position;
+layout(location = 3) out float frag_view_depth;
+layout(location = 4) flat out uint frag_instance;
 
 void main() {
-    gl_Position = ubo.projection * ubo.view * ubo.model * vec4(in_position, 1.0);
+    vec4 world_position = in_model * vec4(in_position, 1.0);
+    vec4 view_position = ubo.view * world_position;
+    gl_Position = ubo.projection * view_position;
+
     frag_color = in_color;
     frag_texture = in_texture;
+    frag_world_position = world_position.xyz;
+    frag_view_depth = -view_position.z;
+    frag_instance = uint(gl_InstanceIndex);
 }
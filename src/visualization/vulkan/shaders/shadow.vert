@@ -0,0 +1,14 @@
+#version 450
+
+// Depth-only rendering of shadow casters into one cascade
+
+layout(push_constant) uniform Cascade {
+    mat4 view_projection;
+} cascade;
+
+layout(location = 0) in vec3 in_position;
+layout(location = 3) in mat4 in_model;
+
+void main() {
+    gl_Position = cascade.view_projection * in_model * vec4(in_position, 1.0);
+}
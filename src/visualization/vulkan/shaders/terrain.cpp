@@ -0,0 +1,17 @@
+#include "terrain.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+vk::VertexInputBindingDescription TerrainVertex::getBindingDescription() {
+    return vk::VertexInputBindingDescription(0, sizeof(TerrainVertex), vk::VertexInputRate::eVertex);
+}
+
+std::array<vk::VertexInputAttributeDescription, 1> TerrainVertex::getAttributeDescriptions() {
+    return {vk::VertexInputAttributeDescription(0, 0, vk::Format::eR16G16Uint, offsetof(TerrainVertex, x))};
+}
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
@@ -0,0 +1,38 @@
+#version 450
+
+layout(push_constant) uniform TerrainConstants {
+    mat4 view_projection;
+    vec4 light_direction;
+    vec2 origin;
+    float spacing;
+    uint texture_mask;
+    ivec2 corner;
+    ivec2 center;
+    int level;
+    int half_cells;
+    uint flags;
+};
+
+layout(constant_id = 0) const bool write_sensor_outputs = false;
+
+layout(location = 0) in vec3 frag_normal;
+layout(location = 1) in float frag_view_depth;
+
+layout(location = 0) out vec4 output_color;
+layout(location = 1) out float output_depth;
+layout(location = 2) out uint output_instance;
+
+void main() {
+    vec3 normal = normalize(frag_normal);
+
+    // grass on level ground, bare rock on steep slopes
+    vec3 albedo = mix(vec3(0.42, 0.38, 0.33), vec3(0.31, 0.42, 0.22), smoothstep(0.75, 0.9, normal.z));
+    float diffuse = max(dot(normal, -light_direction.xyz), 0.0);
+    output_color = vec4(albedo * (0.25 + 0.75 * diffuse), 1.0);
+
+    if (write_sensor_outputs) {
+        output_depth = frag_view_depth;
+        // terrain isn't an instance, so it reads as background
+        output_instance = 0u;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADERS_TERRAIN_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADERS_TERRAIN_HPP
+
+#include <array>
+#include <cstdint>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../glm.hpp"
+
+namespace visualization {
+namespace vulkan {
+namespace shaders {
+
+// Vertex of a terrain clipmap mesh, as whole grid cells from the mesh's corner
+class TerrainVertex {
+public:
+    uint16_t x;
+    uint16_t y;
+
+    static vk::VertexInputBindingDescription getBindingDescription();
+    static std::array<vk::VertexInputAttributeDescription, 1> getAttributeDescriptions();
+};
+
+// Push constants of each terrain draw
+class TerrainConstants {
+public:
+    // mesh axes are swapped, turning a column strip into a row strip
+    static constexpr uint32_t swap_axes = 1;
+    // heights blend towards the next coarser level near the level's edge
+    static constexpr uint32_t morph = 2;
+
+    glm::mat4 view_projection;
+    glm::vec4 light_direction;
+    // world position and spacing of the heightfield's first sample
+    glm::vec2 origin;
+    float spacing;
+    // height textures wrap every `texture_mask` + 1 texels
+    uint32_t texture_mask;
+    // level cells of the mesh's corner, and of the level's center
+    glm::ivec2 corner;
+    glm::ivec2 center;
+    int32_t level;
+    // cells from the level's center to its edge
+    int32_t half_cells;
+    uint32_t flags;
+};
+
+}  // namespace shaders
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADERS_TERRAIN_HPP
@@ -0,0 +1,63 @@
+#version 450
+
+// Geometry clipmap level, or a strip filling the gap around the next finer level. Heights
+// are fetched from the level's layer of a toroidally addressed texture, and blend towards
+// the next coarser level over the outer tenth of the level, reaching its surface at the
+// edge so neighbouring levels meet without cracks.
+
+layout(binding = 0) uniform sampler2DArray heights;
+
+layout(push_constant) uniform TerrainConstants {
+    mat4 view_projection;
+    vec4 light_direction;
+    vec2 origin;
+    float spacing;
+    uint texture_mask;
+    ivec2 corner;
+    ivec2 center;
+    int level;
+    int half_cells;
+    uint flags;
+};
+
+const uint swap_axes = 1u;
+const uint morph = 2u;
+
+layout(location = 0) in uvec2 in_position;
+
+layout(location = 0) out vec3 frag_normal;
+layout(location = 1) out float frag_view_depth;
+
+float fetch(ivec2 coordinates, int layer) {
+    // wraps negative coordinates too, the texture size being a power of two
+    return texelFetch(heights, ivec3(coordinates & ivec2(texture_mask), layer), 0).r;
+}
+
+void main() {
+    ivec2 local = ivec2(in_position);
+    if ((flags & swap_axes) != 0u) {
+        local = local.yx;
+    }
+    ivec2 coordinates = corner + local;
+
+    float height = fetch(coordinates, level);
+    if ((flags & morph) != 0u) {
+        ivec2 from_center = abs(coordinates - center);
+        float width = float(half_cells) / 10.0;
+        float alpha = clamp((float(max(from_center.x, from_center.y)) - (float(half_cells) - width - 1.0)) / width, 0.0, 1.0);
+
+        // the coarser surface at an odd coordinate is halfway along the coarser
+        // edge or cell diagonal it lies on, whose ends round down and up
+        float coarse = 0.5 * (fetch(coordinates >> 1, level + 1) + fetch((coordinates + 1) >> 1, level + 1));
+        height = mix(height, coarse, alpha);
+    }
+
+    float cell_size = spacing * float(1 << level);
+    float slope_x = fetch(coordinates + ivec2(1, 0), level) - fetch(coordinates - ivec2(1, 0), level);
+    float slope_y = fetch(coordinates + ivec2(0, 1), level) - fetch(coordinates - ivec2(0, 1), level);
+    frag_normal = vec3(-slope_x, -slope_y, 2.0 * cell_size);
+
+    gl_Position = view_projection * vec4(origin + vec2(coordinates) * cell_size, height, 1.0);
+    // perspective projections put the view depth in w
+    frag_view_depth = gl_Position.w;
+}
@@ -11,7 +11,6 @@ namespace shaders {
 
 class UniformBufferObject {
 public:
-    alignas(16) glm::mat4 model;
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 projection;
 
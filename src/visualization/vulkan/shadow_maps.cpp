@@ -0,0 +1,326 @@
+#include "shadow_maps.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "shaders/instance.hpp"
+#include "shaders/vertex.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+ShadowMaps::ShadowMaps(const Device& device)
+    : format(findFormat(device)),
+      static_maps(device, resolution, resolution, mapParameters(format)),
+      dynamic_maps(device, resolution, resolution, mapParameters(format)),
+      render_pass(createRenderPass(device, format)),
+      sampler(createSampler(device)),
+      pipeline_layout(createPipelineLayout(device)),
+      static_views(createLayerViews(device, static_maps)),
+      dynamic_views(createLayerViews(device, dynamic_maps)),
+      static_framebuffers(createFramebuffers(device, static_views)),
+      dynamic_framebuffers(createFramebuffers(device, dynamic_views)) {}
+
+void ShadowMaps::update(const scene::Camera& camera, float aspect_ratio, glm::vec3 light_direction, const scene::SceneGraph& scene, const Model& model) {
+    this->light_direction = glm::normalize(light_direction);
+    glm::vec3 light_up = std::abs(this->light_direction.z) < 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    light_view = glm::lookAt(glm::vec3(0.0f), this->light_direction, light_up);
+
+    glm::mat4 inverse_view = glm::inverse(camera.view());
+    float tan_y = std::tan(0.5f * camera.vertical_fov);
+    float tan_x = tan_y * aspect_ratio;
+    float spread = tan_x * tan_x + tan_y * tan_y;
+
+    float near_depth = camera.near_plane;
+    float far_depth = std::min(camera.far_plane, max_shadow_distance);
+    float previous = near_depth;
+
+    for (uint32_t i = 0; i < cascade_count; i++) {
+        auto& cascade = cascades[i];
+
+        float fraction = static_cast<float>(i + 1) / cascade_count;
+        float logarithmic = near_depth * std::pow(far_depth / near_depth, fraction);
+        float uniform = near_depth + (far_depth - near_depth) * fraction;
+        float split = split_lambda * logarithmic + (1.0f - split_lambda) * uniform;
+
+        // smallest sphere around the frustum slice [previous, split] is centered on the view axis,
+        // and its size doesn't change as the camera moves or rotates
+        float center_depth = std::min(0.5f * (1.0f + spread) * (previous + split), split);
+        float radius = std::sqrt(spread * split * split + (split - center_depth) * (split - center_depth));
+        glm::vec3 center = glm::vec3(inverse_view * glm::vec4(0.0f, 0.0f, -center_depth, 1.0f));
+
+        // padding the square by one placement cell lets its center snap to whole cells,
+        // and cells are a whole number of texels
+        float half_size = radius * placement_cells / (placement_cells - 1.0f);
+        float cell = 2.0f * half_size / placement_cells;
+        glm::vec3 light_center = glm::round(glm::vec3(light_view * glm::vec4(center, 1.0f)) / cell) * cell;
+
+        cascade.lower = light_center - glm::vec3(half_size, half_size, half_size);
+        cascade.upper = light_center + glm::vec3(half_size, half_size, half_size + caster_distance);
+
+        // light looks down -z, so the near plane is at the upper z bound
+        auto projection = glm::ortho(cascade.lower.x, cascade.upper.x, cascade.lower.y, cascade.upper.y, -cascade.upper.z, -cascade.lower.z);
+        cascade.view_projection = projection * light_view;
+        cascade.split = split;
+
+        cascade.static_stale = !cascade.static_valid ||
+                               cascade.static_view_projection != cascade.view_projection ||
+                               cascade.static_generation != scene.staticGeneration();
+
+        previous = split;
+    }
+
+    const auto& worlds = scene.worldMatrices();
+    instance_bounds.resize(worlds.size());
+    has_dynamic_casters = false;
+    for (size_t instance = 0; instance < worlds.size(); instance++) {
+        const auto& world = worlds[instance];
+        float scale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        glm::vec3 center = glm::vec3(light_view * world * glm::vec4(model.boundsCenter(), 1.0f));
+        instance_bounds[instance] = glm::vec4(center, scale * model.boundsRadius());
+
+        has_dynamic_casters = has_dynamic_casters || !scene.isStatic(static_cast<uint32_t>(instance));
+    }
+}
+
+void ShadowMaps::record(vk::CommandBuffer command_buffer,
+                        vk::Pipeline pipeline,
+                        const Model& model,
+                        vk::Buffer instances,
+                        const scene::SceneGraph& scene,
+                        const std::vector<uint32_t>& instance_lods) {
+    auto vertex_buffers = std::array<vk::Buffer, 2>{model.getVertices().get(), instances};
+    auto vertex_offsets = std::array<vk::DeviceSize, 2>{0, 0};
+    command_buffer.bindVertexBuffers(0, vertex_buffers, vertex_offsets);
+    command_buffer.bindIndexBuffer(model.getIndices().get(), vk::DeviceSize(0), vk::IndexType::eUint32);
+
+    static_rendered = 0;
+    for (uint32_t i = 0; i < cascade_count; i++) {
+        auto& cascade = cascades[i];
+        if (!cascade.static_stale) {
+            continue;
+        }
+
+        renderCascade(command_buffer, pipeline, *static_framebuffers[i], cascade, model, scene, instance_lods, true);
+
+        cascade.static_valid = true;
+        cascade.static_stale = false;
+        cascade.static_view_projection = cascade.view_projection;
+        cascade.static_generation = scene.staticGeneration();
+        static_rendered += 1;
+    }
+
+    // once cleared, dynamic maps can be left alone until something moves
+    if (has_dynamic_casters || !dynamic_empty) {
+        for (uint32_t i = 0; i < cascade_count; i++) {
+            renderCascade(command_buffer, pipeline, *dynamic_framebuffers[i], cascades[i], model, scene, instance_lods, false);
+        }
+
+        dynamic_empty = !has_dynamic_casters;
+    }
+}
+
+void ShadowMaps::writeUniforms(shaders::LightingUniforms& uniforms) const {
+    for (uint32_t i = 0; i < cascade_count; i++) {
+        uniforms.cascade_view_projections[i] = cascades[i].view_projection;
+        uniforms.cascade_splits[i] = cascades[i].split;
+    }
+
+    uniforms.light_direction = glm::vec4(light_direction, ambient);
+    uniforms.cascade_count = cascade_count;
+    uniforms.dynamic_shadows = has_dynamic_casters ? 1 : 0;
+}
+
+vk::DescriptorImageInfo ShadowMaps::staticDescriptorInfo() const {
+    return vk::DescriptorImageInfo(*sampler, static_maps.getView(), vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+}
+
+vk::DescriptorImageInfo ShadowMaps::dynamicDescriptorInfo() const {
+    return vk::DescriptorImageInfo(*sampler, dynamic_maps.getView(), vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+}
+
+size_t ShadowMaps::staticCascadesRendered() const {
+    return static_rendered;
+}
+
+void ShadowMaps::renderCascade(vk::CommandBuffer command_buffer,
+                               vk::Pipeline pipeline,
+                               const vk::Framebuffer& framebuffer,
+                               const Cascade& cascade,
+                               const Model& model,
+                               const scene::SceneGraph& scene,
+                               const std::vector<uint32_t>& instance_lods,
+                               bool static_casters) const {
+    auto clear_depth = vk::ClearValue(vk::ClearDepthStencilValue(1.0, 0));
+    auto render_area = vk::Rect2D({0, 0}, vk::Extent2D(resolution, resolution));
+    auto render_pass_info = vk::RenderPassBeginInfo(*render_pass, framebuffer, render_area, clear_depth);
+    command_buffer.beginRenderPass(render_pass_info, vk::SubpassContents::eInline);
+
+    command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+    command_buffer.setViewport(0, vk::Viewport(0.0, 0.0, resolution, resolution, 0.0, 1.0));
+    command_buffer.setScissor(0, render_area);
+    command_buffer.pushConstants<glm::mat4>(*pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, cascade.view_projection);
+
+    const auto& lods = model.getLods();
+    for (uint32_t instance = 0; instance < instance_bounds.size(); instance++) {
+        if (scene.isStatic(instance) != static_casters) {
+            continue;
+        }
+
+        glm::vec3 center = glm::vec3(instance_bounds[instance]);
+        float radius = instance_bounds[instance].w;
+        if (glm::any(glm::lessThan(center + radius, cascade.lower)) || glm::any(glm::greaterThan(center - radius, cascade.upper))) {
+            continue;
+        }
+
+        const auto& lod = lods[instance_lods[instance]];
+        command_buffer.drawIndexed(lod.index_count, 1, lod.first_index, 0, instance);
+    }
+
+    command_buffer.endRenderPass();
+}
+
+vk::Format ShadowMaps::findFormat(const Device& device) {
+    std::vector<vk::Format> formats = {vk::Format::eD32Sfloat, vk::Format::eD16Unorm};
+
+    vk::FormatFeatureFlags usage = vk::FormatFeatureFlagBits::eDepthStencilAttachment | vk::FormatFeatureFlagBits::eSampledImage;
+    for (auto format : formats) {
+        if (device.supportsFormatUsage(format, vk::ImageTiling::eOptimal, usage)) {
+            return format;
+        }
+    }
+
+    throw std::runtime_error("could not find a supported shadow map format");
+}
+
+Image::Parameters ShadowMaps::mapParameters(vk::Format format) {
+    auto memory = vk::MemoryPropertyFlagBits::eDeviceLocal;
+    auto usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled;
+    auto aspects = vk::ImageAspectFlagBits::eDepth;
+
+    return Image::Parameters(memory, usage, vk::ImageTiling::eOptimal, format, aspects, false, cascade_count);
+}
+
+vk::raii::RenderPass ShadowMaps::createRenderPass(const Device& device, vk::Format format) {
+    auto depth_attachment = vk::AttachmentDescription(
+        {},
+        format,
+        vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eClear,
+        vk::AttachmentStoreOp::eStore,
+        vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+
+    auto depth_reference = vk::AttachmentReference(0, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    auto subpass = vk::SubpassDescription({}, vk::PipelineBindPoint::eGraphics, {}, {}, {}, &depth_reference, {});
+
+    // maps may still be sampled by the previous frame when they are re-rendered
+    auto write_dependency = vk::SubpassDependency(
+        VK_SUBPASS_EXTERNAL,
+        0u,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+        {},
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        {});
+
+    auto read_dependency = vk::SubpassDependency(
+        0u,
+        VK_SUBPASS_EXTERNAL,
+        vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::AccessFlagBits::eShaderRead,
+        {});
+
+    auto dependencies = std::array<vk::SubpassDependency, 2>{write_dependency, read_dependency};
+    auto create_info = vk::RenderPassCreateInfo({}, depth_attachment, subpass, dependencies, nullptr);
+
+    return vk::raii::RenderPass(device.logical(), create_info, nullptr);
+}
+
+vk::raii::Sampler ShadowMaps::createSampler(const Device& device) {
+    auto sampler_info = vk::SamplerCreateInfo(
+        {},                                       // flags
+        vk::Filter::eNearest,                     // mag(nification) filter
+        vk::Filter::eNearest,                     // min(imization) filter
+        vk::SamplerMipmapMode::eNearest,          // mipmap mode
+        vk::SamplerAddressMode::eClampToBorder,   // U address mode
+        vk::SamplerAddressMode::eClampToBorder,   // V address mode
+        vk::SamplerAddressMode::eClampToBorder,   // W address mode
+        0.0,                                      // mipmap LOD (level-of-detail) bias
+        false,                                    // enable anisotropy
+        1.0,                                      // max anisotropy
+        true,                                     // enable compare
+        vk::CompareOp::eLessOrEqual,              // compare op
+        0.0,                                      // min LOD
+        0.0,                                      // max LOD
+        vk::BorderColor::eFloatOpaqueWhite,       // outside the map counts as lit
+        false                                     // unnormalized coordinates
+    );
+
+    return vk::raii::Sampler(device.logical(), sampler_info);
+}
+
+vk::raii::PipelineLayout ShadowMaps::createPipelineLayout(const Device& device) {
+    auto push_constants = vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4));
+    auto create_info = vk::PipelineLayoutCreateInfo({}, {}, push_constants);
+
+    return vk::raii::PipelineLayout(device.logical(), create_info);
+}
+
+PipelineState ShadowMaps::pipelineState(ShaderCode vert_shader) const {
+    auto state = PipelineState(*pipeline_layout, *render_pass);
+    state.addStage(vk::ShaderStageFlagBits::eVertex, vert_shader.code, vert_shader.size);
+
+    // only positions are needed from the vertex data
+    auto instance_attributes = shaders::Instance::getAttributeDescriptions();
+    state.bindings = {shaders::Vertex::getBindingDescription(), shaders::Instance::getBindingDescription()};
+    state.attributes = {shaders::Vertex::getAttributeDescriptions()[0]};
+    state.attributes.insert(state.attributes.end(), instance_attributes.begin(), instance_attributes.end());
+
+    state.rasterization = vk::PipelineRasterizationStateCreateInfo({},                                // flags
+                                                                   false,                             // depthClampEnable
+                                                                   false,                             // rasterizerDiscardEnable
+                                                                   vk::PolygonMode::eFill,            // polygonMode
+                                                                   vk::CullModeFlagBits::eNone,       // cullMode
+                                                                   vk::FrontFace::eCounterClockwise,  // frontFace
+                                                                   true,                              // depthBiasEnable
+                                                                   depth_bias_constant,               // depthBiasConstantFactor
+                                                                   0.0f,                              // depthBiasClamp
+                                                                   depth_bias_slope,                  // depthBiasSlopeFactor
+                                                                   1.0f                               // lineWidth
+    );
+
+    // depth only, no color attachments to blend
+    state.depth_stencil = vk::PipelineDepthStencilStateCreateInfo({}, true, true, vk::CompareOp::eLess, false, false, {}, {}, 0.0, 1.0);
+
+    return state;
+}
+
+std::vector<vk::raii::ImageView> ShadowMaps::createLayerViews(const Device& device, const Image& image) const {
+    std::vector<vk::raii::ImageView> views;
+    for (uint32_t layer = 0; layer < cascade_count; layer++) {
+        auto subresource = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth, 0, 1, layer, 1);
+        auto view_info = vk::ImageViewCreateInfo({}, image.get(), vk::ImageViewType::e2D, format, {}, subresource);
+        views.emplace_back(device.logical(), view_info);
+    }
+
+    return views;
+}
+
+std::vector<vk::raii::Framebuffer> ShadowMaps::createFramebuffers(const Device& device, const std::vector<vk::raii::ImageView>& views) const {
+    std::vector<vk::raii::Framebuffer> framebuffers;
+    for (const auto& view : views) {
+        auto framebuffer_info = vk::FramebufferCreateInfo({}, *render_pass, *view, resolution, resolution, 1);
+        framebuffers.emplace_back(device.logical(), framebuffer_info);
+    }
+
+    return framebuffers;
+}
+
+}  // namespace vulkan
+}  // namespace visualization
@@ -0,0 +1,145 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SHADOW_MAPS_HPP
+#define BB8_VISUALIZATION_VULKAN_SHADOW_MAPS_HPP
+
+#include <array>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../scene/camera.hpp"
+#include "../scene/scene_graph.hpp"
+#include "device.hpp"
+#include "image.hpp"
+#include "model.hpp"
+#include "pipeline_state.hpp"
+#include "shader_reloader.hpp"
+#include "shaders/lighting_uniforms.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Cascaded shadow maps for a single directional light.
+//
+// Each cascade covers a slice of the camera frustum with a light-space bounding
+// square whose size only depends on the slice, and whose position is snapped to a
+// coarse grid of whole texels, so shadows don't shimmer as the camera moves.
+// Static and dynamic casters are rendered into separate map arrays: static maps are
+// only re-rendered when the light, the static geometry, or the cascade placement
+// changes, while dynamic maps hold just the moving casters and are redrawn every frame.
+// Shading takes the darker of the two.
+class ShadowMaps {
+public:
+    explicit ShadowMaps(const Device& device);
+
+    ShadowMaps(const ShadowMaps&) = delete;
+    ShadowMaps& operator=(const ShadowMaps&) = delete;
+
+    ShadowMaps(ShadowMaps&&) = default;
+    ShadowMaps& operator=(ShadowMaps&&) = default;
+
+    ~ShadowMaps() = default;
+
+    // places cascades for the current camera, and works out which static cascades are stale
+    void update(const scene::Camera& camera, float aspect_ratio, glm::vec3 light_direction, const scene::SceneGraph& scene, const Model& model);
+
+    // state of the pipeline record() draws casters with, compiled by the owner
+    PipelineState pipelineState(ShaderCode vert_shader) const;
+
+    // renders stale static cascades and all dynamic cascades with `pipeline`, must be recorded outside of a render pass
+    void record(vk::CommandBuffer command_buffer,
+                vk::Pipeline pipeline,
+                const Model& model,
+                vk::Buffer instances,
+                const scene::SceneGraph& scene,
+                const std::vector<uint32_t>& instance_lods);
+
+    void writeUniforms(shaders::LightingUniforms& uniforms) const;
+
+    vk::DescriptorImageInfo staticDescriptorInfo() const;
+    vk::DescriptorImageInfo dynamicDescriptorInfo() const;
+
+    // number of static cascades re-rendered by the last record()
+    size_t staticCascadesRendered() const;
+
+private:
+    class Cascade {
+    public:
+        glm::mat4 view_projection;
+        float split;
+
+        // light-space bounds, for culling casters
+        glm::vec3 lower;
+        glm::vec3 upper;
+
+        // placement and static geometry the cached static map was rendered with
+        bool static_valid = false;
+        bool static_stale = true;
+        glm::mat4 static_view_projection;
+        uint64_t static_generation = 0;
+    };
+
+    static vk::Format findFormat(const Device& device);
+    static Image::Parameters mapParameters(vk::Format format);
+    static vk::raii::RenderPass createRenderPass(const Device& device, vk::Format format);
+    static vk::raii::Sampler createSampler(const Device& device);
+    static vk::raii::PipelineLayout createPipelineLayout(const Device& device);
+
+    std::vector<vk::raii::ImageView> createLayerViews(const Device& device, const Image& image) const;
+    std::vector<vk::raii::Framebuffer> createFramebuffers(const Device& device, const std::vector<vk::raii::ImageView>& views) const;
+
+    void renderCascade(vk::CommandBuffer command_buffer,
+                       vk::Pipeline pipeline,
+                       const vk::Framebuffer& framebuffer,
+                       const Cascade& cascade,
+                       const Model& model,
+                       const scene::SceneGraph& scene,
+                       const std::vector<uint32_t>& instance_lods,
+                       bool static_casters) const;
+
+    static constexpr uint32_t cascade_count = shaders::LightingUniforms::max_cascades;
+    static constexpr uint32_t resolution = 1024;
+
+    // distance covered by shadows, capped by the camera's far plane
+    static constexpr float max_shadow_distance = 20.0f;
+    // blend between logarithmic (1) and uniform (0) cascade splits
+    static constexpr float split_lambda = 0.75f;
+    // cascades snap to a grid of this many cells across, the fewer, the less often static cascades re-render
+    static constexpr float placement_cells = 8.0f;
+    // how far behind each cascade casters are still included
+    static constexpr float caster_distance = 20.0f;
+    static constexpr float ambient = 0.25f;
+
+    // constant and slope-scaled depth bias, in depth buffer units
+    static constexpr float depth_bias_constant = 1.25f;
+    static constexpr float depth_bias_slope = 1.75f;
+
+    vk::Format format;
+
+    Image static_maps;
+    Image dynamic_maps;
+
+    vk::raii::RenderPass render_pass;
+    vk::raii::Sampler sampler;
+    vk::raii::PipelineLayout pipeline_layout;
+
+    std::vector<vk::raii::ImageView> static_views;
+    std::vector<vk::raii::ImageView> dynamic_views;
+    std::vector<vk::raii::Framebuffer> static_framebuffers;
+    std::vector<vk::raii::Framebuffer> dynamic_framebuffers;
+
+    std::array<Cascade, cascade_count> cascades;
+    glm::vec3 light_direction;
+    glm::mat4 light_view;
+
+    bool has_dynamic_casters = true;
+    // dynamic maps were last rendered without any casters
+    bool dynamic_empty = false;
+    size_t static_rendered = 0;
+
+    // light-space bounding sphere of each instance, updated by update()
+    std::vector<glm::vec4> instance_bounds;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SHADOW_MAPS_HPP
@@ -0,0 +1,57 @@
+#include "specialization.hpp"
+
+#include <cstring>
+
+namespace visualization {
+namespace vulkan {
+
+Specialization& Specialization::set(uint32_t constant_id, uint32_t value) {
+    return setBits(constant_id, value);
+}
+
+Specialization& Specialization::set(uint32_t constant_id, int32_t value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return setBits(constant_id, bits);
+}
+
+Specialization& Specialization::set(uint32_t constant_id, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return setBits(constant_id, bits);
+}
+
+Specialization& Specialization::setBool(uint32_t constant_id, bool value) {
+    return setBits(constant_id, value ? VK_TRUE : VK_FALSE);
+}
+
+const vk::SpecializationInfo* Specialization::info() {
+    specialization_info = vk::SpecializationInfo(static_cast<uint32_t>(map_entries.size()), map_entries.data(), data.size() * sizeof(uint32_t), data.data());
+    return &specialization_info;
+}
+
+const std::vector<vk::SpecializationMapEntry>& Specialization::entries() const {
+    return map_entries;
+}
+
+const std::vector<uint32_t>& Specialization::values() const {
+    return data;
+}
+
+Specialization& Specialization::setBits(uint32_t constant_id, uint32_t bits) {
+    for (size_t i = 0; i < map_entries.size(); i++) {
+        if (map_entries[i].constantID == constant_id) {
+            data[i] = bits;
+            return *this;
+        }
+    }
+
+    auto offset = static_cast<uint32_t>(data.size() * sizeof(uint32_t));
+    map_entries.emplace_back(constant_id, offset, sizeof(uint32_t));
+    data.push_back(bits);
+
+    return *this;
+}
+
+}  // namespace vulkan
+}  // namespace visualization
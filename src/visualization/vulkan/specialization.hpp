@@ -0,0 +1,40 @@
+#ifndef BB8_VISUALIZATION_VULKAN_SPECIALIZATION_HPP
+#define BB8_VISUALIZATION_VULKAN_SPECIALIZATION_HPP
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace visualization {
+namespace vulkan {
+
+// Specialization constant values for one shader stage, selecting a shader variant
+// when the pipeline is created rather than when the shader is compiled.
+// Every constant is 32 bits, booleans are stored as VkBool32.
+class Specialization {
+public:
+    Specialization& set(uint32_t constant_id, uint32_t value);
+    Specialization& set(uint32_t constant_id, int32_t value);
+    Specialization& set(uint32_t constant_id, float value);
+    Specialization& setBool(uint32_t constant_id, bool value);
+
+    // points into this object, so it must outlive pipeline creation and not be modified meanwhile
+    const vk::SpecializationInfo* info();
+
+    // constant IDs and values in the order they were set, e.g. for telling variants apart
+    const std::vector<vk::SpecializationMapEntry>& entries() const;
+    const std::vector<uint32_t>& values() const;
+
+private:
+    Specialization& setBits(uint32_t constant_id, uint32_t bits);
+
+    std::vector<vk::SpecializationMapEntry> map_entries;
+    std::vector<uint32_t> data;
+
+    vk::SpecializationInfo specialization_info;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_SPECIALIZATION_HPP
@@ -0,0 +1,86 @@
+#include "startup_profile.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace visualization {
+namespace vulkan {
+
+StartupProfile::StartupProfile() : origin(clock::now()), main_thread(std::this_thread::get_id()) {
+    recorded.reserve(expected_phases);
+}
+
+void StartupProfile::markFirstFrame() {
+    auto now = clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!first_frame_ms.has_value()) {
+        first_frame_ms = since(now);
+    }
+}
+
+std::vector<StartupProfile::Phase> StartupProfile::phases() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto sorted = recorded;
+    std::sort(sorted.begin(), sorted.end(), [](const Phase& a, const Phase& b) { return a.start_ms < b.start_ms; });
+    return sorted;
+}
+
+std::optional<double> StartupProfile::timeToFirstFrame() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return first_frame_ms;
+}
+
+void StartupProfile::writeJson(std::ostream& out) const {
+    auto sorted = phases();
+    auto first_frame = timeToFirstFrame();
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"time_to_first_frame_ms\": ";
+    if (first_frame.has_value()) {
+        out << *first_frame;
+    } else {
+        out << "null";
+    }
+    out << ",\n";
+
+    out << "  \"phases\": [\n";
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const auto& phase = sorted[i];
+        out << "    {\"name\": \"" << phase.name << "\", "
+            << "\"start_ms\": " << phase.start_ms << ", "
+            << "\"duration_ms\": " << phase.duration_ms << ", "
+            << "\"background\": " << (phase.background ? "true" : "false") << "}"
+            << (i + 1 < sorted.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+StartupProfile::Measurement::Measurement(StartupProfile& profile, std::string name)
+    : profile(profile), name(std::move(name)), start(clock::now()) {}
+
+StartupProfile::Measurement::~Measurement() {
+    // destructors can't throw, a phase that fails to record is dropped from the profile
+    try {
+        profile.record(std::move(name), start, clock::now());
+    } catch (...) {
+    }
+}
+
+void StartupProfile::record(std::string name, clock::time_point start, clock::time_point end) {
+    bool background = std::this_thread::get_id() != main_thread;
+    auto phase = Phase{std::move(name), since(start), std::chrono::duration<double, std::milli>(end - start).count(), background};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    recorded.push_back(std::move(phase));
+}
+
+double StartupProfile::since(clock::time_point time) const {
+    return std::chrono::duration<double, std::milli>(time - origin).count();
+}
+
+}  // namespace vulkan
+}  // namespace visualization
@@ -0,0 +1,89 @@
+#ifndef BB8_VISUALIZATION_VULKAN_STARTUP_PROFILE_HPP
+#define BB8_VISUALIZATION_VULKAN_STARTUP_PROFILE_HPP
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace visualization {
+namespace vulkan {
+
+// Wall-clock timeline of startup, from the profile's creation to the first
+// presented frame. Phases may be measured on any thread, so phases running in
+// parallel show up as overlapping intervals.
+class StartupProfile {
+public:
+    class Phase {
+    public:
+        std::string name;
+        // milliseconds since the profile was created
+        double start_ms;
+        double duration_ms;
+        // whether the phase ran off the thread that created the profile
+        bool background;
+    };
+
+    StartupProfile();
+
+    StartupProfile(const StartupProfile&) = delete;
+    StartupProfile& operator=(const StartupProfile&) = delete;
+
+    StartupProfile(StartupProfile&&) = delete;
+    StartupProfile& operator=(StartupProfile&&) = delete;
+
+    ~StartupProfile() = default;
+
+    // runs `phase`, recording how long it took, and returns its result.
+    // The result is returned directly, so it needn't be movable
+    template <typename Function>
+    auto measure(std::string name, Function&& phase) -> decltype(phase()) {
+        Measurement measurement(*this, std::move(name));
+        return phase();
+    }
+
+    // only the first call has an effect
+    void markFirstFrame();
+
+    std::vector<Phase> phases() const;
+    std::optional<double> timeToFirstFrame() const;
+
+    void writeJson(std::ostream& out) const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    // records a phase from its construction until its destruction
+    class Measurement {
+    public:
+        Measurement(StartupProfile& profile, std::string name);
+        ~Measurement();
+
+    private:
+        StartupProfile& profile;
+        std::string name;
+        clock::time_point start;
+    };
+
+    void record(std::string name, clock::time_point start, clock::time_point end);
+    double since(clock::time_point time) const;
+
+    // enough for every phase of a normal startup, so recording them doesn't allocate
+    static constexpr size_t expected_phases = 32;
+
+    clock::time_point origin;
+    std::thread::id main_thread;
+
+    mutable std::mutex mutex;
+    std::vector<Phase> recorded;
+    std::optional<double> first_frame_ms;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_STARTUP_PROFILE_HPP
@@ -1,5 +1,6 @@
 #include "swap_chain.hpp"
 
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
 
@@ -19,10 +20,18 @@ SwapChain::Support SwapChain::Support::query(const vk::PhysicalDevice& device, c
 SwapChain::SwapChain(
     const Device& device,
     const vk::SurfaceKHR& surface,
-    const vk::Extent2D window_size)
+    const vk::Extent2D window_size,
+    bool vsync)
     : swap_chain(nullptr) {
     auto support = Support::query(device.physical(), surface);
     auto surface_format = chooseSurfaceFormat(support.formats);
+
+    // frames are rendered offscreen and then blitted onto the swap chain image
+    auto usage = vk::ImageUsageFlags(vk::ImageUsageFlagBits::eTransferDst);
+    if (!(support.capabilities.supportedUsageFlags & usage)) {
+        throw std::runtime_error("swap chain images can't be transfer destinations");
+    }
+
     extent = chooseExtent(support.capabilities, window_size);
     format = surface_format.format;
 
@@ -35,33 +44,18 @@ SwapChain::SwapChain(
         surface_format.colorSpace,
         extent,
         image_layers,
-        vk::ImageUsageFlagBits::eColorAttachment,
+        usage,
         vk::SharingMode::eExclusive,
         {},
         support.capabilities.currentTransform,
         vk::CompositeAlphaFlagBitsKHR::eOpaque,
-        vk::PresentModeKHR::eFifo,
+        choosePresentMode(support.present_modes, vsync),
         true,
         nullptr);
 
     swap_chain = vk::raii::SwapchainKHR(device.logical(), create_into);
 
     images = swap_chain.getImages();
-
-    for (auto image : images) {
-        auto image_view_create_info = vk::ImageViewCreateInfo({}, image, vk::ImageViewType::e2D, format, {}, {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
-        image_views.emplace_back(device.logical(), image_view_create_info);
-    }
-}
-
-void SwapChain::initializeFramebuffers(const Device& device, const vk::RenderPass& render_pass, const DepthBuffer& depth_buffer) {
-    framebuffers.clear();
-
-    for (auto& image_view : image_views) {
-        auto attachments = std::vector<vk::ImageView>{*image_view, depth_buffer.getView()};
-        auto framebuffer_create_info = vk::FramebufferCreateInfo({}, render_pass, attachments, extent.width, extent.height, 1);
-        framebuffers.emplace_back(device.logical(), framebuffer_create_info);
-    }
 }
 
 std::tuple<vk::Result, uint32_t> SwapChain::acquireNextImage(const vk::Semaphore& semaphore) {
@@ -80,8 +74,8 @@ size_t SwapChain::length() const {
     return images.size();
 }
 
-const vk::Framebuffer& SwapChain::getFramebuffer(size_t index) const {
-    return *framebuffers.at(index);
+vk::Image SwapChain::getImage(size_t index) const {
+    return images.at(index);
 }
 
 const vk::SwapchainKHR& SwapChain::get() const {
@@ -113,6 +107,21 @@ vk::Extent2D SwapChain::chooseExtent(const vk::SurfaceCapabilitiesKHR& capabilit
     }
 }
 
+vk::PresentModeKHR SwapChain::choosePresentMode(const std::vector<vk::PresentModeKHR>& available_modes, bool vsync) {
+    // FIFO is always supported, and is the only mode that waits for vertical blank
+    if (vsync) {
+        return vk::PresentModeKHR::eFifo;
+    }
+
+    for (auto mode : {vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eMailbox}) {
+        if (std::find(available_modes.begin(), available_modes.end(), mode) != available_modes.end()) {
+            return mode;
+        }
+    }
+
+    return vk::PresentModeKHR::eFifo;
+}
+
 uint32_t SwapChain::chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities) {
     uint32_t image_count = capabilities.minImageCount + 1;
     if (capabilities.maxImageCount > 0) {
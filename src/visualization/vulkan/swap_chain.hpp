@@ -7,7 +7,6 @@
 #include <vulkan/vulkan_raii.hpp>
 
 #include "device.hpp"
-#include "depth_buffer.hpp"
 
 namespace visualization {
 namespace vulkan {
@@ -25,9 +24,8 @@ public:
 
     SwapChain(const Device& device,
               const vk::SurfaceKHR& surface,
-              const vk::Extent2D window_size);
-
-    void initializeFramebuffers(const Device& device, const vk::RenderPass& render_pass, const DepthBuffer& depth_buffer);
+              const vk::Extent2D window_size,
+              bool vsync = true);
 
     std::tuple<vk::Result, uint32_t> acquireNextImage(const vk::Semaphore& semaphore);
 
@@ -36,12 +34,13 @@ public:
 
     size_t length() const;
 
-    const vk::Framebuffer& getFramebuffer(size_t index) const;
+    vk::Image getImage(size_t index) const;
     const vk::SwapchainKHR& get() const;
 
 private:
     static vk::SurfaceFormatKHR chooseSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& available_formats);
     static vk::Extent2D chooseExtent(const vk::SurfaceCapabilitiesKHR& capabilities, const vk::Extent2D window_size);
+    static vk::PresentModeKHR choosePresentMode(const std::vector<vk::PresentModeKHR>& available_modes, bool vsync);
     static uint32_t chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities);
 
     static constexpr uint64_t timeout = std::numeric_limits<uint64_t>::max();
@@ -52,8 +51,6 @@ private:
     vk::raii::SwapchainKHR swap_chain;
 
     std::vector<vk::Image> images;
-    std::vector<vk::raii::ImageView> image_views;
-    std::vector<vk::raii::Framebuffer> framebuffers;
 };
 
 }  // namespace vulkan
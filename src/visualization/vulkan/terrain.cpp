@@ -0,0 +1,350 @@
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "shaders.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+Terrain::Terrain(const Device& device, geometry::Heightfield heightfield, size_t frames_in_flight, Settings settings)
+    : Terrain(device, std::move(heightfield), frames_in_flight, settings, buildMeshes(settings)) {}
+
+Terrain::Terrain(const Device& device, geometry::Heightfield heightfield, size_t frames_in_flight, Settings settings, Meshes meshes)
+    : device(&device),
+      heightfield(std::move(heightfield)),
+      settings(settings),
+      texture_size(textureSize(settings.cells)),
+      vertices(Buffer::load(device, meshes.vertices.data(), Buffer::Requirements::vertex(meshes.vertices.size() * sizeof(shaders::TerrainVertex)))),
+      indices(Buffer::load(device, meshes.indices.data(), Buffer::Requirements::index(meshes.indices.size() * sizeof(uint32_t)))),
+      grid(meshes.grid),
+      ring(meshes.ring),
+      strip(meshes.strip),
+      levels(settings.levels),
+      heights(device, texture_size, texture_size, textureParameters(settings.levels)),
+      sampler(createSampler(device)),
+      descriptor_layout(createDescriptorLayout(device)),
+      pipeline_layout(createPipelineLayout(device, *descriptor_layout)),
+      descriptor_sets(nullptr) {
+    size_t staging_size = size_t(settings.levels) * texture_size * texture_size * sizeof(float);
+    for (size_t i = 0; i < frames_in_flight; i++) {
+        staging.emplace_back(device, Buffer::Requirements::streamingStaging(staging_size));
+    }
+    // each level stages at most two rectangles, wrapping into four copies each
+    copies.reserve(8 * settings.levels);
+
+    auto pool_size = vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, 1);
+    descriptor_sets = DescriptorSets(device, pool_size, *descriptor_layout);
+
+    auto image_info = vk::DescriptorImageInfo(*sampler, heights.getView(), vk::ImageLayout::eShaderReadOnlyOptimal);
+    auto descriptor_write = vk::WriteDescriptorSet(descriptor_sets[0], 0, 0, vk::DescriptorType::eCombinedImageSampler, image_info);
+    device.logical().updateDescriptorSets(descriptor_write, {});
+
+    // updates preserve what the texture holds, so it starts out in the layout they return it to
+    auto allocate_info = vk::CommandBufferAllocateInfo(device.transientPool(), vk::CommandBufferLevel::ePrimary, 1);
+    auto command_buffers = vk::raii::CommandBuffers(device.logical(), allocate_info);
+    auto command_buffer = std::move(command_buffers.front());
+    command_buffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+    auto all_layers = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, settings.levels);
+    auto barrier = vk::ImageMemoryBarrier({}, {}, vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, heights.get(), all_layers);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, barrier);
+    command_buffer.end();
+
+    auto submit_info = vk::SubmitInfo({}, {}, *command_buffer, {});
+    device.transferQueue().submit(submit_info);
+    device.transferQueue().waitIdle();
+}
+
+void Terrain::update(size_t frame_index, glm::vec3 camera_position) {
+    copies.clear();
+    staged_texels = 0;
+
+    auto camera = (glm::vec2(camera_position) - heightfield.origin()) / heightfield.spacing();
+    float half_cells = 0.5f * settings.cells;
+    auto size = static_cast<int32_t>(texture_size);
+
+    for (uint32_t index = 0; index < settings.levels; index++) {
+        auto& level = levels[index];
+
+        // snapped to even cells, so the corners lie on the next coarser level's vertices
+        auto position = camera / float(1u << index);
+        level.corner = 2 * glm::ivec2(glm::floor(0.5f * (position - half_cells)));
+
+        // starts a texel early, for the normals of the first vertices
+        auto resident = level.corner - 1;
+        auto moved = resident - level.resident;
+        if (!level.valid || std::abs(moved.x) + std::abs(moved.y) >= size) {
+            stage(frame_index, index, resident, resident + size);
+        } else {
+            // rows and columns moved onto replace those moved off, in the same texels
+            int32_t row_strip_start = resident.x;
+            int32_t row_strip_end = resident.x + size;
+            if (moved.x > 0) {
+                stage(frame_index, index, glm::ivec2(level.resident.x + size, resident.y), resident + size);
+                row_strip_end = level.resident.x + size;
+            } else if (moved.x < 0) {
+                stage(frame_index, index, resident, glm::ivec2(level.resident.x, resident.y + size));
+                row_strip_start = level.resident.x;
+            }
+            // rows skip the columns just staged, regions of one copy mustn't overlap
+            if (moved.y > 0) {
+                stage(frame_index, index, glm::ivec2(row_strip_start, level.resident.y + size), glm::ivec2(row_strip_end, resident.y + size));
+            } else if (moved.y < 0) {
+                stage(frame_index, index, glm::ivec2(row_strip_start, resident.y), glm::ivec2(row_strip_end, level.resident.y));
+            }
+        }
+
+        level.resident = resident;
+        level.valid = true;
+    }
+}
+
+void Terrain::recordUpdate(vk::CommandBuffer command_buffer, size_t frame_index) {
+    if (copies.empty()) {
+        return;
+    }
+
+    // earlier frames may still be drawing with the texels being replaced
+    auto all_layers = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, settings.levels);
+    auto writable = vk::ImageMemoryBarrier(
+        {},
+        vk::AccessFlagBits::eTransferWrite,
+        vk::ImageLayout::eShaderReadOnlyOptimal,
+        vk::ImageLayout::eTransferDstOptimal,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        heights.get(),
+        all_layers);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eVertexShader, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, writable);
+
+    command_buffer.copyBufferToImage(staging[frame_index].get(), heights.get(), vk::ImageLayout::eTransferDstOptimal, copies);
+
+    auto readable = vk::ImageMemoryBarrier(
+        vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eShaderRead,
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::ImageLayout::eShaderReadOnlyOptimal,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        heights.get(),
+        all_layers);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexShader, {}, {}, {}, readable);
+}
+
+void Terrain::recordDraw(vk::CommandBuffer command_buffer, const glm::mat4& view_projection, glm::vec3 light_direction) const {
+    if (!levels.front().valid) {
+        return;
+    }
+
+    command_buffer.bindVertexBuffers(0, vertices.get(), vk::DeviceSize(0));
+    command_buffer.bindIndexBuffer(indices.get(), vk::DeviceSize(0), vk::IndexType::eUint32);
+    command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0, descriptor_sets[0], {});
+
+    auto half_cells = static_cast<int32_t>(settings.cells / 2);
+    auto quarter_cells = static_cast<int32_t>(settings.cells / 4);
+
+    shaders::TerrainConstants constants;
+    constants.view_projection = view_projection;
+    constants.light_direction = glm::vec4(light_direction, 0.0f);
+    constants.origin = heightfield.origin();
+    constants.spacing = heightfield.spacing();
+    constants.texture_mask = texture_size - 1;
+    constants.half_cells = half_cells;
+
+    auto draw = [&](const Mesh& mesh, uint32_t index_count, glm::ivec2 corner, uint32_t flags) {
+        constants.corner = corner;
+        constants.flags = flags;
+        command_buffer.pushConstants<shaders::TerrainConstants>(*pipeline_layout, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, constants);
+        command_buffer.drawIndexed(index_count, 1, mesh.first_index, mesh.vertex_offset, 0);
+    };
+
+    for (uint32_t index = 0; index < settings.levels; index++) {
+        const auto& level = levels[index];
+        constants.level = static_cast<int32_t>(index);
+        constants.center = level.corner + half_cells;
+        // the coarsest level has nothing to blend towards
+        uint32_t flags = index + 1 < settings.levels ? shaders::TerrainConstants::morph : 0;
+
+        if (index == 0) {
+            draw(grid, grid.index_count, level.corner, flags);
+            continue;
+        }
+
+        draw(ring, ring.index_count, level.corner, flags);
+
+        // the finer level is one cell off the ring's hole on one side of each axis, which the strips fill
+        auto finer = levels[index - 1].corner / 2 - level.corner;
+        auto column = finer.x == quarter_cells ? 3 * quarter_cells : quarter_cells;
+        auto row = finer.y == quarter_cells ? 3 * quarter_cells : quarter_cells;
+        draw(strip, strip.index_count, level.corner + glm::ivec2(column, quarter_cells), flags);
+        draw(strip, strip.index_count - 6, level.corner + glm::ivec2(finer.x, row), flags | shaders::TerrainConstants::swap_axes);
+    }
+}
+
+const geometry::Heightfield& Terrain::getHeightfield() const {
+    return heightfield;
+}
+
+vk::PipelineLayout Terrain::pipelineLayout() const {
+    return *pipeline_layout;
+}
+
+size_t Terrain::triangleCount() const {
+    size_t ring_indices = ring.index_count + 2 * strip.index_count - 6;
+    return (grid.index_count + (settings.levels - 1) * ring_indices) / 3;
+}
+
+size_t Terrain::texelsUploaded() const {
+    return staged_texels;
+}
+
+Terrain::Meshes Terrain::buildMeshes(Settings settings) {
+    if (settings.levels == 0 || settings.cells == 0 || settings.cells % 8 != 0 || settings.cells >= 0xffff) {
+        throw std::runtime_error("terrain needs at least one level, and a multiple of 8 cells across each");
+    }
+
+    Meshes meshes;
+    uint32_t cells = settings.cells;
+    meshes.grid = addGrid(meshes, cells, cells, 0, 0);
+    // the finer level covers half the cells, one cell off the center on either side
+    meshes.ring = addGrid(meshes, cells, cells, cells / 4, cells / 2 + 1);
+    meshes.strip = addGrid(meshes, 1, cells / 2 + 1, 0, 0);
+    return meshes;
+}
+
+Terrain::Mesh Terrain::addGrid(Meshes& meshes, uint32_t columns, uint32_t rows, uint32_t hole_start, uint32_t hole_size) {
+    Mesh mesh;
+    mesh.first_index = static_cast<uint32_t>(meshes.indices.size());
+    mesh.vertex_offset = static_cast<int32_t>(meshes.vertices.size());
+
+    for (uint32_t y = 0; y <= rows; y++) {
+        for (uint32_t x = 0; x <= columns; x++) {
+            meshes.vertices.push_back(shaders::TerrainVertex{static_cast<uint16_t>(x), static_cast<uint16_t>(y)});
+        }
+    }
+
+    auto in_hole = [&](uint32_t cell) { return cell >= hole_start && cell < hole_start + hole_size; };
+
+    // row by row, so a prefix of a strip's indices is a shorter strip
+    for (uint32_t y = 0; y < rows; y++) {
+        for (uint32_t x = 0; x < columns; x++) {
+            if (in_hole(x) && in_hole(y)) {
+                continue;
+            }
+
+            uint32_t v00 = y * (columns + 1) + x;
+            uint32_t v10 = v00 + 1;
+            uint32_t v01 = v00 + columns + 1;
+            uint32_t v11 = v01 + 1;
+            meshes.indices.insert(meshes.indices.end(), {v00, v10, v11, v00, v11, v01});
+        }
+    }
+
+    mesh.index_count = static_cast<uint32_t>(meshes.indices.size()) - mesh.first_index;
+    return mesh;
+}
+
+uint32_t Terrain::textureSize(uint32_t cells) {
+    // a level's vertices, and one more texel on each side for normals
+    uint32_t size = 1;
+    while (size < cells + 3) {
+        size *= 2;
+    }
+
+    return size;
+}
+
+Image::Parameters Terrain::textureParameters(uint32_t levels) {
+    return Image::Parameters(
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+        vk::ImageTiling::eOptimal,
+        vk::Format::eR32Sfloat,
+        vk::ImageAspectFlagBits::eColor,
+        false,
+        levels);
+}
+
+vk::raii::Sampler Terrain::createSampler(const Device& device) {
+    // only texelFetch reads the heights, but combined image samplers need one
+    auto sampler_info = vk::SamplerCreateInfo(
+        {},                                      // flags
+        vk::Filter::eNearest,                    // mag(nification) filter
+        vk::Filter::eNearest,                    // min(imization) filter
+        vk::SamplerMipmapMode::eNearest,         // mipmap mode
+        vk::SamplerAddressMode::eRepeat,         // U address mode
+        vk::SamplerAddressMode::eRepeat,         // V address mode
+        vk::SamplerAddressMode::eClampToEdge,    // W address mode
+        0.0,                                     // mipmap LOD (level-of-detail) bias
+        false,                                   // enable anisotropy
+        1.0,                                     // max anisotropy
+        false,                                   // enable compare
+        vk::CompareOp::eAlways,                  // compare op
+        0.0,                                     // min LOD
+        0.0,                                     // max LOD
+        vk::BorderColor::eFloatOpaqueBlack,      // border color for clamp-to-border address mode
+        false                                    // unnormalized coordinates
+    );
+
+    return vk::raii::Sampler(device.logical(), sampler_info);
+}
+
+vk::raii::DescriptorSetLayout Terrain::createDescriptorLayout(const Device& device) {
+    auto binding = vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eVertex);
+    return vk::raii::DescriptorSetLayout(device.logical(), vk::DescriptorSetLayoutCreateInfo({}, binding));
+}
+
+vk::raii::PipelineLayout Terrain::createPipelineLayout(const Device& device, const vk::DescriptorSetLayout& descriptor_layout) {
+    auto push_constants = vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, sizeof(shaders::TerrainConstants));
+    return vk::raii::PipelineLayout(device.logical(), vk::PipelineLayoutCreateInfo({}, descriptor_layout, push_constants));
+}
+
+void Terrain::stage(size_t frame_index, uint32_t level, glm::ivec2 start, glm::ivec2 end) {
+    auto texels = reinterpret_cast<float*>(staging[frame_index].data());
+    auto first_texel = staged_texels;
+    uint32_t mask = texture_size - 1;
+
+    // a range of up to a texture's size wraps around its edge at most once
+    auto split = [&](int32_t from, int32_t to, std::array<std::array<int32_t, 2>, 2>& pieces) {
+        int32_t wrap = from + static_cast<int32_t>(texture_size - (static_cast<uint32_t>(from) & mask));
+        pieces[0] = {from, std::min(to, wrap)};
+        pieces[1] = {wrap, std::max(to, wrap)};
+    };
+
+    std::array<std::array<int32_t, 2>, 2> columns;
+    std::array<std::array<int32_t, 2>, 2> rows;
+    split(start.x, end.x, columns);
+    split(start.y, end.y, rows);
+
+    // level cells are every 2^level-th heightfield sample
+    int64_t step = int64_t(1) << level;
+    for (const auto& row_range : rows) {
+        for (const auto& column_range : columns) {
+            auto width = static_cast<uint32_t>(column_range[1] - column_range[0]);
+            auto height = static_cast<uint32_t>(row_range[1] - row_range[0]);
+            if (width == 0 || height == 0) {
+                continue;
+            }
+
+            auto offset = staged_texels;
+            for (int32_t y = row_range[0]; y < row_range[1]; y++) {
+                for (int32_t x = column_range[0]; x < column_range[1]; x++) {
+                    texels[staged_texels++] = heightfield.sample(x * step, y * step);
+                }
+            }
+
+            auto layers = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, level, 1);
+            auto texel_offset = vk::Offset3D(static_cast<int32_t>(static_cast<uint32_t>(column_range[0]) & mask), static_cast<int32_t>(static_cast<uint32_t>(row_range[0]) & mask), 0);
+            copies.emplace_back(offset * sizeof(float), width, height, layers, texel_offset, vk::Extent3D(width, height, 1));
+        }
+    }
+
+    device->memoryUsage().recordUpload((staged_texels - first_texel) * sizeof(float));
+}
+
+}  // namespace vulkan
+}  // namespace visualization
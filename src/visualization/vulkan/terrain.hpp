@@ -0,0 +1,138 @@
+#ifndef BB8_VISUALIZATION_VULKAN_TERRAIN_HPP
+#define BB8_VISUALIZATION_VULKAN_TERRAIN_HPP
+
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+#include "../geometry/heightfield.hpp"
+#include "buffer.hpp"
+#include "descriptor_sets.hpp"
+#include "device.hpp"
+#include "glm.hpp"
+#include "image.hpp"
+#include "shaders/terrain.hpp"
+
+namespace visualization {
+namespace vulkan {
+
+// Heightfield terrain rendered with geometry clipmaps.
+//
+// Levels are square grids of the same number of cells, centered on the camera, each
+// with twice the cell size of the one inside it. The finest is a full grid, coarser
+// ones are rings around the next finer level, with two one-cell strips filling the gap
+// its snapping leaves on two sides. These few meshes are all there is, however large the
+// heightfield, and only their heights come from it: each level has a layer of a height
+// texture holding the heightfield's samples around it, decimated to its cell size. As
+// the camera moves, the texture is addressed toroidally, so only the rows and columns
+// a level moves onto are uploaded, and the rest stay where they are.
+class Terrain {
+public:
+    class Settings {
+    public:
+        uint32_t levels = 8;
+        // cells across each level, a multiple of 8
+        uint32_t cells = 248;
+    };
+
+    Terrain(const Device& device, geometry::Heightfield heightfield, size_t frames_in_flight, Settings settings);
+
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    Terrain(Terrain&&) = default;
+    Terrain& operator=(Terrain&&) = default;
+
+    ~Terrain() = default;
+
+    // centers the levels on the camera, staging the heights they move onto
+    void update(size_t frame_index, glm::vec3 camera_position);
+    // uploads staged heights, must be recorded outside a render pass
+    void recordUpdate(vk::CommandBuffer command_buffer, size_t frame_index);
+    // must be recorded inside a render pass with the terrain pipeline bound
+    void recordDraw(vk::CommandBuffer command_buffer, const glm::mat4& view_projection, glm::vec3 light_direction) const;
+
+    const geometry::Heightfield& getHeightfield() const;
+    // layout the terrain pipeline is built with
+    vk::PipelineLayout pipelineLayout() const;
+
+    // triangles drawn every frame, which only depends on the settings
+    size_t triangleCount() const;
+    // height texels uploaded by the last update
+    size_t texelsUploaded() const;
+
+private:
+    class Mesh {
+    public:
+        uint32_t first_index;
+        uint32_t index_count;
+        int32_t vertex_offset;
+    };
+
+    class Meshes {
+    public:
+        std::vector<shaders::TerrainVertex> vertices;
+        std::vector<uint32_t> indices;
+        Mesh grid;
+        Mesh ring;
+        Mesh strip;
+    };
+
+    // texels of the level around its grid, whose corner is `corner` in level cells
+    class Level {
+    public:
+        glm::ivec2 corner = glm::ivec2(0);
+        // first texel held in each direction, or invalid before the first update
+        glm::ivec2 resident = glm::ivec2(0);
+        bool valid = false;
+    };
+
+    Terrain(const Device& device, geometry::Heightfield heightfield, size_t frames_in_flight, Settings settings, Meshes meshes);
+
+    static Meshes buildMeshes(Settings settings);
+
+    // grid of the given cells with an optional square hole, each cell split along
+    // the same diagonal as the heightfield's cells
+    static Mesh addGrid(Meshes& meshes, uint32_t columns, uint32_t rows, uint32_t hole_start, uint32_t hole_size);
+
+    static uint32_t textureSize(uint32_t cells);
+    static Image::Parameters textureParameters(uint32_t levels);
+    static vk::raii::Sampler createSampler(const Device& device);
+    static vk::raii::DescriptorSetLayout createDescriptorLayout(const Device& device);
+    static vk::raii::PipelineLayout createPipelineLayout(const Device& device, const vk::DescriptorSetLayout& descriptor_layout);
+
+    // stages the heights of level cells [start, end), which must be resident
+    void stage(size_t frame_index, uint32_t level, glm::ivec2 start, glm::ivec2 end);
+
+    const Device* device;
+
+    geometry::Heightfield heightfield;
+    Settings settings;
+    uint32_t texture_size;
+
+    Buffer vertices;
+    Buffer indices;
+    Mesh grid;
+    Mesh ring;
+    // column strip, whose first `cells` / 2 cells also make a row strip
+    Mesh strip;
+
+    std::vector<Level> levels;
+
+    Image heights;
+    vk::raii::Sampler sampler;
+
+    // one persistently mapped staging buffer per frame in flight, holding a full upload
+    std::vector<Buffer> staging;
+    size_t staged_texels = 0;
+    std::vector<vk::BufferImageCopy> copies;
+
+    vk::raii::DescriptorSetLayout descriptor_layout;
+    vk::raii::PipelineLayout pipeline_layout;
+
+    DescriptorSets descriptor_sets;
+};
+
+}  // namespace vulkan
+}  // namespace visualization
+
+#endif  // !BB8_VISUALIZATION_VULKAN_TERRAIN_HPP
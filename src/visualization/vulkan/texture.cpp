@@ -4,6 +4,10 @@ namespace visualization {
 namespace vulkan {
 
 Texture Texture::load(const Device& device, std::filesystem::path texture_file, vk::SamplerAddressMode address_mode) {
+    return load(device, resources::Image::load(texture_file), address_mode);
+}
+
+Texture Texture::load(const Device& device, const resources::Image& image_source, vk::SamplerAddressMode address_mode) {
     auto parameters = Image::Parameters(
         vk::MemoryPropertyFlagBits::eDeviceLocal,
         vk::ImageUsageFlagBits::eSampled,
@@ -12,7 +16,7 @@ Texture Texture::load(const Device& device, std::filesystem::path texture_file,
         vk::ImageAspectFlagBits::eColor,
         true);
 
-    return Texture(device, Image::load(device, texture_file, parameters), address_mode);
+    return Texture(device, Image::load(device, image_source, parameters), address_mode);
 }
 
 vk::DescriptorImageInfo Texture::descriptorInfo() const {
@@ -13,6 +13,9 @@ public:
     static Texture load(const Device& device,
                         std::filesystem::path image_file,
                         vk::SamplerAddressMode address_mode);
+    static Texture load(const Device& device,
+                        const resources::Image& image_source,
+                        vk::SamplerAddressMode address_mode);
 
     vk::DescriptorImageInfo descriptorInfo() const;
 
@@ -31,6 +31,7 @@ Window::Window(std::string name) {
 
     glfwSetWindowUserPointer(window_handle, this);
     glfwSetFramebufferSizeCallback(window_handle, resizeCallback);
+    glfwSetWindowRefreshCallback(window_handle, refreshCallback);
 }
 
 Window::~Window() {
@@ -93,10 +94,27 @@ bool Window::wait() {
     return false;
 }
 
+bool Window::wait(double timeout) {
+    if (glfwWindowShouldClose(window_handle)) {
+        return true;
+    }
+
+    glfwWaitEventsTimeout(timeout);
+    return false;
+}
+
+void Window::wake() {
+    glfwPostEmptyEvent();
+}
+
 void Window::setResizeCallback(std::function<void()> callback) {
     resize_callback = callback;
 }
 
+void Window::setRefreshCallback(std::function<void()> callback) {
+    refresh_callback = callback;
+}
+
 void Window::resizeCallback(GLFWwindow* window_handle, int, int) {
     auto window = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window_handle));
 
@@ -105,5 +123,13 @@ void Window::resizeCallback(GLFWwindow* window_handle, int, int) {
     }
 }
 
+void Window::refreshCallback(GLFWwindow* window_handle) {
+    auto window = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window_handle));
+
+    if (window->refresh_callback) {
+        window->refresh_callback();
+    }
+}
+
 }  // namespace vulkan
 }  // namespace visualization
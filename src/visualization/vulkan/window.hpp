@@ -27,8 +27,15 @@ public:
 
     bool update();
     bool wait();
+    // waits for events for at most `timeout` seconds
+    bool wait(double timeout);
+
+    // wakes a wait() from any thread
+    static void wake();
 
     void setResizeCallback(std::function<void()> callback);
+    // called when the window's contents were damaged and must be drawn again
+    void setRefreshCallback(std::function<void()> callback);
 
 private:
     static constexpr uint32_t default_width = 800;
@@ -37,8 +44,10 @@ private:
     GLFWwindow* window_handle;
 
     std::function<void()> resize_callback;
+    std::function<void()> refresh_callback;
 
     static void resizeCallback(GLFWwindow* window, int, int);
+    static void refreshCallback(GLFWwindow* window);
 };
 
 }  // namespace vulkan
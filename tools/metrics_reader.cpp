@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "visualization/profiling/metrics_segment.hpp"
+#include "visualization/utilities.hpp"
+
+namespace {
+
+using visualization::parseNumber;
+using visualization::profiling::MetricsSegment;
+
+void printUsage() {
+    std::cerr << "usage: bb8_metrics [--segment NAME] [--watch SECONDS] [--buckets]\n"
+              << "  --segment NAME   shared-memory segment to read (default " << MetricsSegment::default_name << ")\n"
+              << "  --watch S        print again every S seconds until interrupted\n"
+              << "  --buckets        print every histogram bucket\n";
+}
+
+// upper bound of the bucket containing the `fraction` quantile, or the last bound if it's in the overflow bucket
+double quantileBound(const MetricsSegment::Histogram& histogram, uint64_t count, double fraction) {
+    auto rank = static_cast<uint64_t>(fraction * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < histogram.bound_count; bucket++) {
+        seen += histogram.buckets[bucket].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            return histogram.bounds[bucket];
+        }
+    }
+
+    return histogram.bound_count > 0 ? histogram.bounds[histogram.bound_count - 1] : 0.0;
+}
+
+void print(const MetricsSegment& segment, bool buckets) {
+    const auto& header = segment.header();
+
+    auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    auto now_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+    double uptime = static_cast<double>(now_ns - header.created_ns) * 1e-9;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "writer " << header.writer_pid << ", up " << uptime << " s\n";
+
+    uint32_t metric_count = header.metric_count.load(std::memory_order_acquire);
+    for (uint32_t index = 0; index < metric_count; index++) {
+        const auto& metric = segment.metric(index);
+        uint64_t value = metric.value.load(std::memory_order_relaxed);
+
+        std::cout << std::left << std::setw(10) << (metric.kind == MetricsSegment::Kind::counter ? "counter" : "gauge")
+                  << std::setw(32) << metric.name.data() << std::right;
+        if (metric.kind == MetricsSegment::Kind::counter) {
+            std::cout << value << "\n";
+        } else {
+            std::cout << MetricsSegment::fromBits(value) << "\n";
+        }
+    }
+
+    uint32_t histogram_count = header.histogram_count.load(std::memory_order_acquire);
+    for (uint32_t index = 0; index < histogram_count; index++) {
+        const auto& histogram = segment.histogram(index);
+        // count and sum are updated separately, so the mean may be slightly off while being recorded
+        uint64_t count = histogram.count.load(std::memory_order_relaxed);
+        double sum = MetricsSegment::fromBits(histogram.sum.load(std::memory_order_relaxed));
+
+        std::cout << std::left << std::setw(10) << "histogram" << std::setw(32) << histogram.name.data() << std::right
+                  << "count " << count;
+        if (count > 0) {
+            std::cout << ", mean " << sum / static_cast<double>(count)
+                      << ", p50 <= " << quantileBound(histogram, count, 0.50)
+                      << ", p95 <= " << quantileBound(histogram, count, 0.95)
+                      << ", p99 <= " << quantileBound(histogram, count, 0.99);
+        }
+        std::cout << "\n";
+
+        if (buckets) {
+            for (uint32_t bucket = 0; bucket <= histogram.bound_count; bucket++) {
+                std::cout << "    ";
+                if (bucket < histogram.bound_count) {
+                    std::cout << "<= " << histogram.bounds[bucket];
+                } else {
+                    std::cout << "overflow";
+                }
+                std::cout << ": " << histogram.buckets[bucket].load(std::memory_order_relaxed) << "\n";
+            }
+        }
+    }
+
+    std::cout << std::flush;
+}
+
+}  // namespace
+
+// Prints the metrics a running bb8_simulation publishes with --metrics
+int main(int argc, char** argv) {
+    std::string segment_name = MetricsSegment::default_name;
+    std::optional<double> watch_seconds;
+    bool buckets = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        bool valid = true;
+
+        if (arg == "--segment" && has_value) {
+            segment_name = argv[++i];
+        } else if (arg == "--watch" && has_value) {
+            double seconds = 0.0;
+            valid = parseNumber(argv[++i], seconds) && std::isfinite(seconds) && seconds > 0.0;
+            if (valid) {
+                watch_seconds = seconds;
+            }
+        } else if (arg == "--buckets") {
+            buckets = true;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        auto segment = MetricsSegment::open(segment_name);
+        print(segment, buckets);
+
+        while (watch_seconds.has_value()) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(*watch_seconds));
+            std::cout << "\n";
+            print(segment, buckets);
+        }
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}